@@ -0,0 +1,256 @@
+/**
+ * @file async_log.c
+ * @brief Deferred, non-blocking log sink implementation for Halow RTOS
+ *
+ * The ring is a bounded multi-producer queue of fixed slots with a sequence
+ * number per slot (Vyukov style). A producer claims a slot with one CAS on
+ * the write index, formats straight into it and publishes it by storing the
+ * sequence number. Nothing waits: a full ring drops the message. The single
+ * consumer is the drain task, woken by a task notification, which only
+ * touches slots whose sequence says they are published.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "async_log.h"
+#include "esp_log.h"
+#include "esp_console.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#if CONFIG_ASYNC_LOG_ENABLE
+
+#define ASYNC_LOG_SLOTS         CONFIG_ASYNC_LOG_SLOTS
+#define ASYNC_LOG_MASK          (ASYNC_LOG_SLOTS - 1)
+#define ASYNC_LOG_LINE_MAX      CONFIG_ASYNC_LOG_LINE_MAX
+#define ASYNC_LOG_TASK_STACK    3072
+#define ASYNC_LOG_TASK_PRIORITY 1
+
+_Static_assert((ASYNC_LOG_SLOTS & ASYNC_LOG_MASK) == 0, "CONFIG_ASYNC_LOG_SLOTS must be a power of two");
+
+typedef struct {
+    uint32_t seq;               // == index when free, index + 1 when published
+    uint16_t len;
+    char text[ASYNC_LOG_LINE_MAX];
+} async_log_slot_t;
+
+static async_log_slot_t log_slots[ASYNC_LOG_SLOTS];
+static uint32_t log_write_idx = 0;      // Producers, CAS
+static uint32_t log_read_idx = 0;       // Drain task only
+static TaskHandle_t log_task_handle = NULL;
+
+static uint32_t log_written = 0;
+static uint32_t log_dropped = 0;
+static uint32_t log_truncated = 0;
+static uint32_t log_high_water = 0;
+
+/**
+ * @brief Claim, fill and publish one slot
+ */
+static int async_log_enqueue(const char *fmt, va_list args)
+{
+    uint32_t pos = __atomic_load_n(&log_write_idx, __ATOMIC_RELAXED);
+    async_log_slot_t *slot;
+
+    for (;;) {
+        slot = &log_slots[pos & ASYNC_LOG_MASK];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&log_write_idx, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+            // pos was reloaded by the failed CAS
+        } else if (diff < 0) {
+            // Slot still holds an undrained message: ring full
+            __atomic_fetch_add(&log_dropped, 1, __ATOMIC_RELAXED);
+            return 0;
+        } else {
+            pos = __atomic_load_n(&log_write_idx, __ATOMIC_RELAXED);
+        }
+    }
+
+    int n = vsnprintf(slot->text, sizeof(slot->text), fmt, args);
+    if (n < 0) {
+        n = 0;
+    } else if (n >= (int)sizeof(slot->text)) {
+        n = sizeof(slot->text) - 1;
+        __atomic_fetch_add(&log_truncated, 1, __ATOMIC_RELAXED);
+    }
+    slot->len = (uint16_t)n;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    __atomic_fetch_add(&log_written, 1, __ATOMIC_RELAXED);
+    uint32_t depth = pos + 1 - __atomic_load_n(&log_read_idx, __ATOMIC_RELAXED);
+    if (depth > log_high_water) {
+        log_high_water = depth;     // Statistic only, a lost race is harmless
+    }
+
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(log_task_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGive(log_task_handle);
+    }
+    return n;
+}
+
+/**
+ * @brief Drain task, writes published slots to the console in order
+ */
+static void async_log_task(void *arg)
+{
+    uint32_t dropped_reported = 0;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        for (;;) {
+            async_log_slot_t *slot = &log_slots[log_read_idx & ASYNC_LOG_MASK];
+            if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != log_read_idx + 1) {
+                break;
+            }
+            fwrite(slot->text, 1, slot->len, stdout);
+            __atomic_store_n(&slot->seq, log_read_idx + ASYNC_LOG_SLOTS, __ATOMIC_RELEASE);
+            __atomic_store_n(&log_read_idx, log_read_idx + 1, __ATOMIC_RELAXED);
+        }
+
+        uint32_t dropped = __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+        if (dropped != dropped_reported) {
+            printf(COLOR_YELLOW "[log: %lu messages dropped]\n" COLOR_RESET,
+                   (unsigned long)(dropped - dropped_reported));
+            dropped_reported = dropped;
+        }
+        fflush(stdout);
+    }
+}
+
+#endif // CONFIG_ASYNC_LOG_ENABLE
+
+/**
+ * @brief Start the drain task and route ESP_LOG output through the ring
+ */
+esp_err_t async_log_init(void)
+{
+#if CONFIG_ASYNC_LOG_ENABLE
+    if (log_task_handle) {
+        return ESP_OK;
+    }
+    for (uint32_t i = 0; i < ASYNC_LOG_SLOTS; i++) {
+        log_slots[i].seq = i;
+    }
+    if (xTaskCreate(async_log_task, "async_log", ASYNC_LOG_TASK_STACK, NULL,
+                    ASYNC_LOG_TASK_PRIORITY, &log_task_handle) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_log_set_vprintf(async_log_vprintf);
+#endif
+    return ESP_OK;
+}
+
+/**
+ * @brief vprintf into the ring
+ */
+int async_log_vprintf(const char *fmt, va_list args)
+{
+#if CONFIG_ASYNC_LOG_ENABLE
+    if (log_task_handle) {
+        return async_log_enqueue(fmt, args);
+    }
+#endif
+    return vprintf(fmt, args);
+}
+
+/**
+ * @brief printf into the ring
+ */
+int async_log_printf(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int n = async_log_vprintf(fmt, args);
+    va_end(args);
+    return n;
+}
+
+/**
+ * @brief Get ring statistics
+ */
+void async_log_get_stats(async_log_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+#if CONFIG_ASYNC_LOG_ENABLE
+    stats->slots = ASYNC_LOG_SLOTS;
+    stats->queued = __atomic_load_n(&log_write_idx, __ATOMIC_RELAXED) -
+                    __atomic_load_n(&log_read_idx, __ATOMIC_RELAXED);
+    stats->high_water = log_high_water;
+    stats->written = log_written;
+    stats->dropped = log_dropped;
+    stats->truncated = log_truncated;
+#endif
+}
+
+static const char *log_level_names[] = { "none", "error", "warn", "info", "debug", "verbose" };
+
+static int log_cmd(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "level") == 0) {
+        if (argc < 4) {
+            printf(COLOR_RED "Usage: log level <tag|*> <none|error|warn|info|debug|verbose>\n" COLOR_RESET);
+            return 1;
+        }
+        for (int level = ESP_LOG_NONE; level <= ESP_LOG_VERBOSE; level++) {
+            if (strcmp(argv[3], log_level_names[level]) == 0) {
+                esp_log_level_set(argv[2], (esp_log_level_t)level);
+                printf(COLOR_GREEN "Log level of '%s' set to %s\n" COLOR_RESET, argv[2], log_level_names[level]);
+                return 0;
+            }
+        }
+        printf(COLOR_RED "Unknown level '%s'\n" COLOR_RESET, argv[3]);
+        return 1;
+    }
+    if (argc >= 2 && strcmp(argv[1], "status") != 0) {
+        printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+        printf("  log [status]                 - Deferred log ring statistics\n");
+        printf("  log level <tag|*> <level>    - Set ESP_LOG level (none|error|warn|info|debug|verbose)\n");
+        return 1;
+    }
+
+#if CONFIG_ASYNC_LOG_ENABLE
+    async_log_stats_t st;
+    async_log_get_stats(&st);
+    printf(COLOR_CYAN "Deferred log:\n" COLOR_RESET);
+    printf("  Ring:       %lu/%lu messages queued (peak %lu), %d bytes each\n",
+           (unsigned long)st.queued, (unsigned long)st.slots, (unsigned long)st.high_water, ASYNC_LOG_LINE_MAX);
+    printf("  Written:    %lu\n", (unsigned long)st.written);
+    printf("  Dropped:    %s%lu" COLOR_RESET "\n", st.dropped ? COLOR_YELLOW : "", (unsigned long)st.dropped);
+    printf("  Truncated:  %lu\n", (unsigned long)st.truncated);
+#else
+    printf(COLOR_YELLOW "Deferred logging is disabled (CONFIG_ASYNC_LOG_ENABLE), output is synchronous\n" COLOR_RESET);
+#endif
+    return 0;
+}
+
+/**
+ * @brief Register the 'log' console command
+ */
+void register_async_log_commands(void)
+{
+    const esp_console_cmd_t log_cmd_def = {
+        .command = "log",
+        .help = "Deferred log statistics and log levels. Usage: log [status] | log level <tag|*> <level>",
+        .hint = NULL,
+        .func = &log_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&log_cmd_def));
+}
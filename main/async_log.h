@@ -0,0 +1,66 @@
+/**
+ * @file async_log.h
+ * @brief Deferred, non-blocking log sink for Halow RTOS
+ *
+ * Features:
+ * - Callers format into a lock-free multi-producer ring of fixed slots and
+ *   return immediately, the UART is drained by a low-priority task
+ * - Installed as the ESP_LOG vprintf hook, so ESP_LOGx from WLAN callbacks
+ *   no longer waits for the console
+ * - Messages that find the ring full are dropped and counted, the count is
+ *   printed once the ring drains
+ * - 'log' console command for ring statistics and runtime log levels
+ */
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Ring statistics
+typedef struct {
+    uint32_t slots;             // Ring capacity in messages
+    uint32_t queued;            // Messages waiting for the drain task
+    uint32_t high_water;        // Most messages waiting at once
+    uint32_t written;           // Messages accepted
+    uint32_t dropped;           // Messages lost to a full ring
+    uint32_t truncated;         // Messages cut to the slot size
+} async_log_stats_t;
+
+/**
+ * @brief Start the drain task and route ESP_LOG output through the ring
+ * Output before this call, or with CONFIG_ASYNC_LOG_ENABLE off, is written
+ * synchronously.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task could not be created
+ */
+esp_err_t async_log_init(void);
+
+/**
+ * @brief printf into the ring, never blocks (for WLAN/MQTT callbacks and tasks)
+ * @param fmt printf format
+ * @return Number of characters queued, 0 if the message was dropped
+ */
+int async_log_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief vprintf into the ring (signature of vprintf_like_t)
+ * @param fmt printf format
+ * @param args Arguments
+ * @return Number of characters queued, 0 if the message was dropped
+ */
+int async_log_vprintf(const char *fmt, va_list args);
+
+/**
+ * @brief Get ring statistics
+ * @param stats Pointer to store the statistics
+ */
+void async_log_get_stats(async_log_stats_t *stats);
+
+/**
+ * @brief Register the 'log' console command
+ */
+void register_async_log_commands(void);
+
+#endif // ASYNC_LOG_H
@@ -0,0 +1,1004 @@
+/**
+ * @file blob_store.c
+ * @brief Indexed, CRC-protected blob store implementation for Halow RTOS
+ *
+ * Layout: sectors 0 and 1 are the A/B index, the rest of the partition holds
+ * blob data. The valid index with the highest generation wins at mount; a
+ * commit always rewrites the other sector, so an interrupted commit leaves
+ * the previous index intact.
+ *
+ * Every blob is one contiguous, sector-aligned extent, which is what lets
+ * esp_partition_mmap() hand out a single pointer to it. Extents are placed
+ * first-fit and erased when they are handed to a writer, so a replacement is
+ * written next to the old copy and only becomes visible with the index
+ * commit. Freed extents are erased right away so deleted keys do not linger
+ * in flash.
+ *
+ * CRCs are checked on every copy read and on the first mapping after boot;
+ * mapped data is read-only flash, so it can not change under a reader until
+ * the mapping is released.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stddef.h>
+#include "blob_store.h"
+#include "esp_log.h"
+#include "esp_crc.h"
+#include "esp_console.h"
+#include "spi_flash_mmap.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "blob_store";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define BLOB_INDEX_MAGIC            0x424F4C42  // "BLOB"
+#define BLOB_FORMAT_VERSION         1
+#define BLOB_INDEX_SECTORS          2
+#define BLOB_CRC_CHUNK              256
+
+#define BLOB_PUT_MAX_SIZE           16384       // Extent reserved by 'blob put'
+#define BLOB_PUT_LINE_MAX           128
+#define BLOB_PUT_IDLE_MS            30000
+#define BLOB_PUT_POLL_MS            10
+#define BLOB_CAT_HEX_MAX            512
+
+// Index sector header
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // BLOB_INDEX_MAGIC
+    uint16_t version;           // BLOB_FORMAT_VERSION
+    uint16_t count;             // Entries following the header
+    uint32_t generation;        // Incremented by every commit
+    uint32_t crc;               // CRC32 of the header up to here, then of the entries
+} blob_index_header_t;
+
+// Index entry
+typedef struct __attribute__((packed)) {
+    char name[BLOB_STORE_NAME_MAX_LEN + 1];
+    uint32_t offset;            // Partition offset, sector aligned
+    uint32_t size;
+    uint32_t crc;               // CRC32 of the data
+    uint32_t reserved;
+} blob_index_entry_t;
+
+typedef struct __attribute__((packed)) {
+    blob_index_header_t hdr;
+    blob_index_entry_t entries[BLOB_STORE_MAX_BLOBS];
+} blob_index_t;
+
+_Static_assert(sizeof(blob_index_t) <= SPI_FLASH_SEC_SIZE, "index must fit one sector");
+
+static const esp_partition_t *blob_part = NULL;
+static uint32_t blob_sector_count = 0;
+static blob_index_t blob_index;
+static uint32_t blob_active_slot = 0;               // Index sector holding blob_index
+static uint8_t blob_map_count[BLOB_STORE_MAX_BLOBS]; // Live mappings per entry
+static bool blob_verified[BLOB_STORE_MAX_BLOBS];     // CRC checked since boot
+static uint32_t blob_pending_sector = 0;            // Extent of the active writer, 0 = none
+static uint32_t blob_pending_sectors = 0;
+static SemaphoreHandle_t blob_mutex = NULL;
+static blob_store_stats_t blob_stats;
+
+/**
+ * @brief Sectors taken by a blob of the given size
+ */
+static uint32_t blob_sectors(uint32_t size)
+{
+    return size ? (size + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE : 1;
+}
+
+/**
+ * @brief CRC of an index (header up to the CRC field, then the entries)
+ */
+static uint32_t blob_index_crc(const blob_index_t *idx)
+{
+    uint32_t crc = esp_crc32_le(0, (const uint8_t *)&idx->hdr, offsetof(blob_index_header_t, crc));
+    return esp_crc32_le(crc, (const uint8_t *)idx->entries, idx->hdr.count * sizeof(blob_index_entry_t));
+}
+
+/**
+ * @brief Check a name for length
+ */
+static bool blob_name_valid(const char *name)
+{
+    size_t len = name ? strnlen(name, BLOB_STORE_NAME_MAX_LEN + 1) : 0;
+    return len > 0 && len <= BLOB_STORE_NAME_MAX_LEN;
+}
+
+/**
+ * @brief Find an entry by name (mutex held)
+ * @return Entry index, -1 if not found
+ */
+static int blob_find(const char *name)
+{
+    for (int i = 0; i < blob_index.hdr.count; i++) {
+        if (strncmp(blob_index.entries[i].name, name, sizeof(blob_index.entries[i].name)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Check a sector range against all extents, including the active writer's
+ * @return End sector of an overlapping extent, 0 if the range is free
+ */
+static uint32_t blob_overlap(uint32_t start, uint32_t count)
+{
+    for (int i = 0; i < blob_index.hdr.count; i++) {
+        uint32_t s = blob_index.entries[i].offset / SPI_FLASH_SEC_SIZE;
+        uint32_t e = s + blob_sectors(blob_index.entries[i].size);
+        if (start < e && s < start + count) {
+            return e;
+        }
+    }
+    if (blob_pending_sector && start < blob_pending_sector + blob_pending_sectors &&
+        blob_pending_sector < start + count) {
+        return blob_pending_sector + blob_pending_sectors;
+    }
+    return 0;
+}
+
+/**
+ * @brief First-fit search for free sectors
+ * @return First sector of the range, 0 if nothing is large enough
+ */
+static uint32_t blob_alloc(uint32_t count)
+{
+    uint32_t s = BLOB_INDEX_SECTORS;
+
+    while (s + count <= blob_sector_count) {
+        uint32_t end = blob_overlap(s, count);
+        if (end == 0) {
+            return s;
+        }
+        s = end;
+    }
+    return 0;
+}
+
+/**
+ * @brief Write the RAM index to the inactive index sector (mutex held)
+ */
+static esp_err_t blob_index_commit(void)
+{
+    uint32_t slot = blob_active_slot ^ 1;
+    uint32_t generation = blob_index.hdr.generation;
+
+    blob_index.hdr.magic = BLOB_INDEX_MAGIC;
+    blob_index.hdr.version = BLOB_FORMAT_VERSION;
+    blob_index.hdr.generation = generation + 1;
+    blob_index.hdr.crc = blob_index_crc(&blob_index);
+
+    esp_err_t err = esp_partition_erase_range(blob_part, slot * SPI_FLASH_SEC_SIZE, SPI_FLASH_SEC_SIZE);
+    if (err == ESP_OK) {
+        err = esp_partition_write(blob_part, slot * SPI_FLASH_SEC_SIZE, &blob_index,
+                                  sizeof(blob_index_header_t) + blob_index.hdr.count * sizeof(blob_index_entry_t));
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Index write failed: %s", esp_err_to_name(err));
+        blob_index.hdr.generation = generation;
+        return err;
+    }
+
+    blob_active_slot = slot;
+    blob_stats.index_writes++;
+    return ESP_OK;
+}
+
+/**
+ * @brief Erase the extent of a dropped blob
+ */
+static void blob_erase_extent(uint32_t offset, uint32_t size)
+{
+    esp_err_t err = esp_partition_erase_range(blob_part, offset, blob_sectors(size) * SPI_FLASH_SEC_SIZE);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to erase freed extent at 0x%lx: %s", (unsigned long)offset, esp_err_to_name(err));
+    }
+}
+
+/**
+ * @brief CRC of a blob read from flash in small chunks (mutex held)
+ */
+static esp_err_t blob_flash_crc(const blob_index_entry_t *entry, uint32_t *crc)
+{
+    uint8_t buf[BLOB_CRC_CHUNK];
+    uint32_t value = 0;
+
+    for (uint32_t pos = 0; pos < entry->size; pos += sizeof(buf)) {
+        uint32_t n = entry->size - pos < sizeof(buf) ? entry->size - pos : sizeof(buf);
+        esp_err_t err = esp_partition_read(blob_part, entry->offset + pos, buf, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+        value = esp_crc32_le(value, buf, n);
+    }
+    *crc = value;
+    return ESP_OK;
+}
+
+/**
+ * @brief Read and validate one index sector
+ */
+static bool blob_load_index(uint32_t slot, blob_index_t *idx)
+{
+    if (esp_partition_read(blob_part, slot * SPI_FLASH_SEC_SIZE, &idx->hdr, sizeof(idx->hdr)) != ESP_OK ||
+        idx->hdr.magic != BLOB_INDEX_MAGIC || idx->hdr.version != BLOB_FORMAT_VERSION ||
+        idx->hdr.count > BLOB_STORE_MAX_BLOBS) {
+        return false;
+    }
+    if (idx->hdr.count > 0 &&
+        esp_partition_read(blob_part, slot * SPI_FLASH_SEC_SIZE + sizeof(idx->hdr), idx->entries,
+                           idx->hdr.count * sizeof(blob_index_entry_t)) != ESP_OK) {
+        return false;
+    }
+    if (idx->hdr.crc != blob_index_crc(idx)) {
+        return false;
+    }
+
+    for (int i = 0; i < idx->hdr.count; i++) {
+        const blob_index_entry_t *e = &idx->entries[i];
+        if (e->offset % SPI_FLASH_SEC_SIZE != 0 || e->offset / SPI_FLASH_SEC_SIZE < BLOB_INDEX_SECTORS ||
+            e->size == 0 || e->offset / SPI_FLASH_SEC_SIZE + blob_sectors(e->size) > blob_sector_count ||
+            memchr(e->name, '\0', sizeof(e->name)) == NULL) {
+            ESP_LOGW(TAG, "Index %lu has a bad entry, ignoring it", (unsigned long)slot);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Pick the newest valid index, formatting the partition if there is none
+ */
+static esp_err_t blob_mount(void)
+{
+    blob_index_t *candidate = malloc(sizeof(blob_index_t));
+    bool found = false;
+
+    if (!candidate) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t slot = 0; slot < BLOB_INDEX_SECTORS; slot++) {
+        if (blob_load_index(slot, candidate) &&
+            (!found || candidate->hdr.generation > blob_index.hdr.generation)) {
+            memcpy(&blob_index, candidate, sizeof(blob_index));
+            blob_active_slot = slot;
+            found = true;
+        }
+    }
+    free(candidate);
+
+    if (found) {
+        return ESP_OK;
+    }
+
+    // Data sectors are erased when they are allocated, only the index needs clearing
+    ESP_LOGI(TAG, "Formatting blob store (%lu sectors)", (unsigned long)blob_sector_count);
+    esp_err_t err = esp_partition_erase_range(blob_part, 0, BLOB_INDEX_SECTORS * SPI_FLASH_SEC_SIZE);
+    if (err != ESP_OK) {
+        return err;
+    }
+    memset(&blob_index, 0, sizeof(blob_index));
+    blob_active_slot = 1;
+    return blob_index_commit();
+}
+
+/**
+ * @brief Mount the blob partition
+ */
+esp_err_t blob_store_init(void)
+{
+    if (blob_part) {
+        return ESP_OK;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                           BLOB_STORE_PARTITION);
+    if (!part) {
+        ESP_LOGW(TAG, "No '%s' partition, blob store disabled", BLOB_STORE_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    blob_sector_count = part->size / SPI_FLASH_SEC_SIZE;
+    if (blob_sector_count <= BLOB_INDEX_SECTORS) {
+        ESP_LOGE(TAG, "'%s' partition too small", BLOB_STORE_PARTITION);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (!blob_mutex) {
+        blob_mutex = xSemaphoreCreateMutex();
+        if (!blob_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    blob_part = part;
+    esp_err_t err = blob_mount();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Blob store mount failed: %s", esp_err_to_name(err));
+        blob_part = NULL;
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Blob store mounted: %u blobs, generation %lu",
+             blob_index.hdr.count, (unsigned long)blob_index.hdr.generation);
+    return ESP_OK;
+}
+
+/**
+ * @brief Start writing a blob in pieces
+ */
+esp_err_t blob_store_begin(blob_store_writer_t *writer, const char *name, size_t max_size)
+{
+    if (!writer || !blob_name_valid(name) || max_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(writer, 0, sizeof(*writer));
+    if (!blob_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+
+    int i = blob_find(name);
+    esp_err_t err = ESP_OK;
+    uint32_t count = blob_sectors(max_size);
+    uint32_t sector = 0;
+
+    if (blob_pending_sector || (i >= 0 && blob_map_count[i] > 0)) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if ((i < 0 && blob_index.hdr.count >= BLOB_STORE_MAX_BLOBS) || (sector = blob_alloc(count)) == 0) {
+        err = ESP_ERR_NO_MEM;
+    } else {
+        err = esp_partition_erase_range(blob_part, sector * SPI_FLASH_SEC_SIZE, count * SPI_FLASH_SEC_SIZE);
+    }
+
+    if (err == ESP_OK) {
+        blob_pending_sector = sector;
+        blob_pending_sectors = count;
+        strncpy(writer->name, name, sizeof(writer->name) - 1);
+        writer->offset = sector * SPI_FLASH_SEC_SIZE;
+        writer->capacity = max_size;
+    }
+
+    xSemaphoreGive(blob_mutex);
+    return err;
+}
+
+/**
+ * @brief Append data to a blob being written
+ */
+esp_err_t blob_store_append(blob_store_writer_t *writer, const void *data, size_t len)
+{
+    if (!writer || !writer->offset) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len == 0) {
+        return ESP_OK;
+    }
+    if (!data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len > writer->capacity - writer->written) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // The extent is reserved for this writer, no lock needed
+    esp_err_t err = esp_partition_write(blob_part, writer->offset + writer->written, data, len);
+    if (err != ESP_OK) {
+        return err;
+    }
+    writer->crc = esp_crc32_le(writer->crc, data, len);
+    writer->written += len;
+    return ESP_OK;
+}
+
+/**
+ * @brief Release the active writer's extent (mutex held)
+ */
+static void blob_release_writer(blob_store_writer_t *writer)
+{
+    if (blob_pending_sector * SPI_FLASH_SEC_SIZE == writer->offset) {
+        blob_pending_sector = 0;
+        blob_pending_sectors = 0;
+    }
+    writer->offset = 0;
+}
+
+/**
+ * @brief Publish a blob being written
+ */
+esp_err_t blob_store_commit(blob_store_writer_t *writer)
+{
+    if (!writer || !writer->offset) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+
+    esp_err_t err = ESP_OK;
+    int i = blob_find(writer->name);
+
+    if (writer->written == 0) {
+        err = ESP_ERR_INVALID_SIZE;
+    } else if (i >= 0 && blob_map_count[i] > 0) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if (i < 0 && blob_index.hdr.count >= BLOB_STORE_MAX_BLOBS) {
+        err = ESP_ERR_NO_MEM;
+    }
+
+    if (err == ESP_OK) {
+        blob_index_entry_t old = {0};
+        bool replace = i >= 0;
+
+        if (replace) {
+            old = blob_index.entries[i];
+        } else {
+            i = blob_index.hdr.count++;
+        }
+
+        blob_index_entry_t *entry = &blob_index.entries[i];
+        memset(entry, 0, sizeof(*entry));
+        strncpy(entry->name, writer->name, sizeof(entry->name) - 1);
+        entry->offset = writer->offset;
+        entry->size = writer->written;
+        entry->crc = writer->crc;
+        blob_map_count[i] = 0;
+        blob_verified[i] = false;     // First read checks what actually landed in flash
+
+        err = blob_index_commit();
+        if (err != ESP_OK) {
+            if (replace) {
+                *entry = old;
+            } else {
+                blob_index.hdr.count--;
+            }
+        } else if (replace) {
+            blob_erase_extent(old.offset, old.size);
+        }
+    }
+
+    blob_release_writer(writer);
+    xSemaphoreGive(blob_mutex);
+    return err;
+}
+
+/**
+ * @brief Drop a blob being written
+ */
+void blob_store_abort(blob_store_writer_t *writer)
+{
+    if (!writer || !writer->offset) {
+        return;
+    }
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+    blob_release_writer(writer);
+    xSemaphoreGive(blob_mutex);
+}
+
+/**
+ * @brief Create or replace a blob
+ */
+esp_err_t blob_store_write(const char *name, const void *data, size_t len)
+{
+    blob_store_writer_t writer;
+
+    esp_err_t err = blob_store_begin(&writer, name, len);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = blob_store_append(&writer, data, len);
+    if (err != ESP_OK) {
+        blob_store_abort(&writer);
+        return err;
+    }
+    return blob_store_commit(&writer);
+}
+
+/**
+ * @brief Copy a blob into a buffer, verifying its CRC
+ */
+esp_err_t blob_store_read(const char *name, void *buf, size_t size, size_t *len)
+{
+    if (!blob_name_valid(name) || !buf || !len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!blob_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    int i = blob_find(name);
+
+    if (i >= 0) {
+        const blob_index_entry_t *entry = &blob_index.entries[i];
+        *len = entry->size;
+        if (size < entry->size) {
+            err = ESP_ERR_INVALID_SIZE;
+        } else {
+            err = esp_partition_read(blob_part, entry->offset, buf, entry->size);
+        }
+        if (err == ESP_OK && esp_crc32_le(0, buf, entry->size) != entry->crc) {
+            ESP_LOGE(TAG, "Blob '%s' failed CRC check", name);
+            blob_stats.crc_errors++;
+            err = ESP_ERR_INVALID_CRC;
+        } else if (err == ESP_OK) {
+            blob_verified[i] = true;
+        }
+    }
+
+    xSemaphoreGive(blob_mutex);
+    return err;
+}
+
+/**
+ * @brief Map a blob into the data address space
+ */
+esp_err_t blob_store_mmap(const char *name, blob_store_map_t *map)
+{
+    if (!blob_name_valid(name) || !map) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(map, 0, sizeof(*map));
+    if (!blob_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    int i = blob_find(name);
+
+    if (i >= 0) {
+        const blob_index_entry_t *entry = &blob_index.entries[i];
+        const void *ptr = NULL;
+        esp_partition_mmap_handle_t handle;
+
+        err = esp_partition_mmap(blob_part, entry->offset, entry->size, ESP_PARTITION_MMAP_DATA, &ptr, &handle);
+        if (err == ESP_OK && !blob_verified[i]) {
+            if (esp_crc32_le(0, ptr, entry->size) != entry->crc) {
+                ESP_LOGE(TAG, "Blob '%s' failed CRC check", name);
+                blob_stats.crc_errors++;
+                esp_partition_munmap(handle);
+                err = ESP_ERR_INVALID_CRC;
+            } else {
+                blob_verified[i] = true;
+            }
+        }
+        if (err == ESP_OK) {
+            blob_map_count[i]++;
+            map->data = ptr;
+            map->size = entry->size;
+            map->offset = entry->offset;
+            map->handle = handle;
+        }
+    }
+
+    xSemaphoreGive(blob_mutex);
+    return err;
+}
+
+/**
+ * @brief Release a mapping from blob_store_mmap()
+ */
+void blob_store_munmap(blob_store_map_t *map)
+{
+    if (!map || !map->data) {
+        return;
+    }
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+    for (int i = 0; i < blob_index.hdr.count; i++) {
+        if (blob_index.entries[i].offset == map->offset && blob_map_count[i] > 0) {
+            blob_map_count[i]--;
+            break;
+        }
+    }
+    xSemaphoreGive(blob_mutex);
+
+    esp_partition_munmap(map->handle);
+    memset(map, 0, sizeof(*map));
+}
+
+/**
+ * @brief Fill a description from an entry
+ */
+static void blob_fill_info(const blob_index_entry_t *entry, blob_store_info_t *info)
+{
+    strncpy(info->name, entry->name, sizeof(info->name) - 1);
+    info->name[sizeof(info->name) - 1] = '\0';
+    info->size = entry->size;
+    info->crc = entry->crc;
+    info->offset = entry->offset;
+}
+
+/**
+ * @brief Look up a blob
+ */
+esp_err_t blob_store_stat(const char *name, blob_store_info_t *info)
+{
+    if (!blob_name_valid(name)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!blob_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+    int i = blob_find(name);
+    if (i >= 0 && info) {
+        blob_fill_info(&blob_index.entries[i], info);
+    }
+    xSemaphoreGive(blob_mutex);
+
+    return i >= 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief List blobs
+ */
+esp_err_t blob_store_list(blob_store_info_t *info, size_t max, size_t *count)
+{
+    if (!count || (max > 0 && !info)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *count = 0;
+    if (!blob_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+    for (int i = 0; i < blob_index.hdr.count && *count < max; i++) {
+        blob_fill_info(&blob_index.entries[i], &info[(*count)++]);
+    }
+    xSemaphoreGive(blob_mutex);
+    return ESP_OK;
+}
+
+/**
+ * @brief Delete a blob and erase its data
+ */
+esp_err_t blob_store_delete(const char *name)
+{
+    if (!blob_name_valid(name)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!blob_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    int i = blob_find(name);
+
+    if (i >= 0 && blob_map_count[i] > 0) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if (i >= 0) {
+        blob_index_entry_t entry = blob_index.entries[i];
+        bool verified = blob_verified[i];
+        int tail = blob_index.hdr.count - i - 1;
+
+        memmove(&blob_index.entries[i], &blob_index.entries[i + 1], tail * sizeof(blob_index_entry_t));
+        memmove(&blob_map_count[i], &blob_map_count[i + 1], tail * sizeof(blob_map_count[0]));
+        memmove(&blob_verified[i], &blob_verified[i + 1], tail * sizeof(blob_verified[0]));
+        blob_index.hdr.count--;
+
+        err = blob_index_commit();
+        if (err == ESP_OK) {
+            blob_erase_extent(entry.offset, entry.size);
+        } else {
+            // Put the entry back where it was
+            memmove(&blob_index.entries[i + 1], &blob_index.entries[i], tail * sizeof(blob_index_entry_t));
+            memmove(&blob_map_count[i + 1], &blob_map_count[i], tail * sizeof(blob_map_count[0]));
+            memmove(&blob_verified[i + 1], &blob_verified[i], tail * sizeof(blob_verified[0]));
+            blob_index.entries[i] = entry;
+            blob_map_count[i] = 0;
+            blob_verified[i] = verified;
+            blob_index.hdr.count++;
+        }
+    }
+
+    xSemaphoreGive(blob_mutex);
+    return err;
+}
+
+/**
+ * @brief Get store statistics
+ */
+void blob_store_get_stats(blob_store_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    *stats = blob_stats;
+    stats->mounted = blob_part != NULL;
+    if (!blob_part) {
+        return;
+    }
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+    stats->sectors = blob_sector_count - BLOB_INDEX_SECTORS;
+    stats->blobs = blob_index.hdr.count;
+    stats->generation = blob_index.hdr.generation;
+    stats->used_bytes = 0;
+    stats->used_sectors = 0;
+    for (int i = 0; i < blob_index.hdr.count; i++) {
+        stats->used_bytes += blob_index.entries[i].size;
+        stats->used_sectors += blob_sectors(blob_index.entries[i].size);
+    }
+
+    uint32_t largest = 0;
+    uint32_t s = BLOB_INDEX_SECTORS;
+    while (s < blob_sector_count) {
+        uint32_t end = blob_overlap(s, 1);
+        if (end) {
+            s = end;
+            continue;
+        }
+        uint32_t start = s;
+        while (s < blob_sector_count && blob_overlap(s, 1) == 0) {
+            s++;
+        }
+        if (s - start > largest) {
+            largest = s - start;
+        }
+    }
+    stats->largest_free = largest * SPI_FLASH_SEC_SIZE;
+    xSemaphoreGive(blob_mutex);
+}
+
+/**
+ * @brief Read one console line without echo
+ * @param line Buffer, NUL terminated on return
+ * @param size Buffer size
+ * @param eol Set when the line ended with a newline (false if it was split)
+ * @return Line length, -1 if nothing arrived for BLOB_PUT_IDLE_MS
+ */
+static int blob_read_line(char *line, size_t size, bool *eol)
+{
+    size_t len = 0;
+    uint32_t idle_ms = 0;
+
+    *eol = false;
+    while (len + 1 < size) {
+        int ch = getchar();
+        if (ch == EOF) {
+            if (idle_ms >= BLOB_PUT_IDLE_MS) {
+                return -1;
+            }
+            vTaskDelay(pdMS_TO_TICKS(BLOB_PUT_POLL_MS));
+            idle_ms += BLOB_PUT_POLL_MS;
+            continue;
+        }
+        idle_ms = 0;
+        if (ch == '\r') {
+            continue;
+        }
+        if (ch == '\n') {
+            *eol = true;
+            break;
+        }
+        line[len++] = (char)ch;
+    }
+    line[len] = '\0';
+    return (int)len;
+}
+
+/**
+ * @brief 'blob put': store pasted text, NUL terminated so PEM parsers can use it in place
+ */
+static int blob_put_cmd(const char *name)
+{
+    blob_store_writer_t writer;
+    char line[BLOB_PUT_LINE_MAX];
+    bool eol;
+    int n;
+
+    esp_err_t err = blob_store_begin(&writer, name, BLOB_PUT_MAX_SIZE);
+    if (err != ESP_OK) {
+        printf(COLOR_RED "Cannot write '%s': %s\n" COLOR_RESET, name, esp_err_to_name(err));
+        if (err == ESP_ERR_INVALID_STATE) {
+            printf("The blob is mapped (for TLS blobs run 'mqtt stop' first)\n");
+        }
+        return 1;
+    }
+
+    printf("Paste the data, then a line with a single '.' (max %d bytes)\n", BLOB_PUT_MAX_SIZE - 1);
+    fflush(stdout);
+    while ((n = blob_read_line(line, sizeof(line) - 1, &eol)) >= 0) {
+        if (eol && strcmp(line, ".") == 0) {
+            break;
+        }
+        if (eol) {
+            line[n++] = '\n';
+        }
+        err = blob_store_append(&writer, line, n);
+        if (err != ESP_OK) {
+            break;
+        }
+    }
+
+    if (n < 0) {
+        err = ESP_ERR_TIMEOUT;
+    } else if (err == ESP_OK) {
+        err = blob_store_append(&writer, "", 1);
+    }
+    if (err != ESP_OK) {
+        blob_store_abort(&writer);
+        printf(COLOR_RED "\nPut aborted: %s\n" COLOR_RESET, esp_err_to_name(err));
+        return 1;
+    }
+
+    uint32_t size = writer.written;
+    err = blob_store_commit(&writer);
+    if (err != ESP_OK) {
+        printf(COLOR_RED "Commit failed: %s\n" COLOR_RESET, esp_err_to_name(err));
+        return 1;
+    }
+    printf(COLOR_GREEN "Stored '%s' (%lu bytes)\n" COLOR_RESET, name, (unsigned long)size);
+    return 0;
+}
+
+/**
+ * @brief 'blob cat': print text blobs as text, anything else as hex
+ */
+static int blob_cat_cmd(const char *name)
+{
+    blob_store_map_t map;
+
+    esp_err_t err = blob_store_mmap(name, &map);
+    if (err != ESP_OK) {
+        printf(COLOR_RED "Cannot map '%s': %s\n" COLOR_RESET, name, esp_err_to_name(err));
+        return 1;
+    }
+
+    const uint8_t *data = map.data;
+    size_t len = map.size;
+    if (len > 0 && data[len - 1] == '\0') {
+        len--;
+    }
+
+    bool text = true;
+    for (size_t i = 0; i < len && text; i++) {
+        text = isprint(data[i]) || isspace(data[i]);
+    }
+
+    if (text) {
+        fwrite(data, 1, len, stdout);
+        if (len > 0 && data[len - 1] != '\n') {
+            printf("\n");
+        }
+    } else {
+        size_t shown = map.size < BLOB_CAT_HEX_MAX ? map.size : BLOB_CAT_HEX_MAX;
+        for (size_t i = 0; i < shown; i++) {
+            printf("%02x%s", data[i], (i % 32 == 31 || i + 1 == shown) ? "\n" : " ");
+        }
+        if (shown < map.size) {
+            printf("... (%lu more bytes)\n", (unsigned long)(map.size - shown));
+        }
+    }
+
+    blob_store_munmap(&map);
+    return 0;
+}
+
+/**
+ * @brief 'blob verify': recompute the CRC of every blob
+ */
+static int blob_verify_cmd(void)
+{
+    int bad = 0;
+
+    xSemaphoreTake(blob_mutex, portMAX_DELAY);
+    for (int i = 0; i < blob_index.hdr.count; i++) {
+        const blob_index_entry_t *entry = &blob_index.entries[i];
+        uint32_t crc = 0;
+        esp_err_t err = blob_flash_crc(entry, &crc);
+        bool ok = err == ESP_OK && crc == entry->crc;
+
+        printf("  %-16s %s\n", entry->name,
+               ok ? COLOR_GREEN "ok" COLOR_RESET : err != ESP_OK ? esp_err_to_name(err) : COLOR_RED "CRC mismatch" COLOR_RESET);
+        if (ok) {
+            blob_verified[i] = true;
+        } else {
+            blob_stats.crc_errors++;
+            bad++;
+        }
+    }
+    xSemaphoreGive(blob_mutex);
+
+    return bad ? 1 : 0;
+}
+
+static int blob_cmd(int argc, char **argv)
+{
+    if (!blob_part) {
+        printf(COLOR_YELLOW "Blob store not available (no '%s' partition)\n" COLOR_RESET, BLOB_STORE_PARTITION);
+        return 1;
+    }
+
+    if (argc < 2 || strcmp(argv[1], "list") == 0) {
+        blob_store_info_t info[BLOB_STORE_MAX_BLOBS];
+        size_t count = 0;
+        blob_store_list(info, BLOB_STORE_MAX_BLOBS, &count);
+        if (count == 0) {
+            printf("No blobs stored\n");
+            return 0;
+        }
+        printf("%-16s %-8s %-10s %s\n", "Name", "Size", "CRC", "Offset");
+        for (size_t i = 0; i < count; i++) {
+            printf("%-16s %-8lu %08lx   0x%06lx\n", info[i].name, (unsigned long)info[i].size,
+                   (unsigned long)info[i].crc, (unsigned long)info[i].offset);
+        }
+        return 0;
+    }
+
+    const char *subcmd = argv[1];
+
+    if (strcmp(subcmd, "info") == 0) {
+        blob_store_stats_t stats;
+        blob_store_get_stats(&stats);
+        printf(COLOR_CYAN "Blob store:\n" COLOR_RESET);
+        printf("  Partition:  %lu data sectors, %lu used, largest free extent %lu KB\n",
+               (unsigned long)stats.sectors, (unsigned long)stats.used_sectors,
+               (unsigned long)(stats.largest_free / 1024));
+        printf("  Blobs:      %lu of %d, %lu bytes\n",
+               (unsigned long)stats.blobs, BLOB_STORE_MAX_BLOBS, (unsigned long)stats.used_bytes);
+        printf("  Index:      generation %lu, %lu commits since boot, %lu CRC errors\n",
+               (unsigned long)stats.generation, (unsigned long)stats.index_writes,
+               (unsigned long)stats.crc_errors);
+    } else if (strcmp(subcmd, "put") == 0 && argc >= 3) {
+        return blob_put_cmd(argv[2]);
+    } else if (strcmp(subcmd, "cat") == 0 && argc >= 3) {
+        return blob_cat_cmd(argv[2]);
+    } else if (strcmp(subcmd, "rm") == 0 && argc >= 3) {
+        esp_err_t err = blob_store_delete(argv[2]);
+        if (err != ESP_OK) {
+            printf(COLOR_RED "Delete failed: %s\n" COLOR_RESET, esp_err_to_name(err));
+            return 1;
+        }
+        printf(COLOR_GREEN "Deleted '%s'\n" COLOR_RESET, argv[2]);
+    } else if (strcmp(subcmd, "verify") == 0) {
+        return blob_verify_cmd();
+    } else {
+        printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+        printf("  blob [list]        - List stored blobs\n");
+        printf("  blob info          - Show space and index state\n");
+        printf("  blob put <name>    - Store pasted text (e.g. a PEM certificate)\n");
+        printf("  blob cat <name>    - Print a blob\n");
+        printf("  blob rm <name>     - Delete a blob and erase its data\n");
+        printf("  blob verify        - Check the CRC of every blob\n");
+        printf("Well-known blobs: %s, %s, %s\n", BLOB_MQTT_CA_CERT, BLOB_MQTT_CLIENT_CERT, BLOB_MQTT_CLIENT_KEY);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Register blob store console commands
+ */
+void register_blob_store_commands(void)
+{
+    const esp_console_cmd_t blob_cmd_def = {
+        .command = "blob",
+        .help = "Blob store: list, info, put, cat, rm, verify",
+        .hint = NULL,
+        .func = &blob_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&blob_cmd_def));
+}
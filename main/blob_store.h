@@ -0,0 +1,189 @@
+/**
+ * @file blob_store.h
+ * @brief Indexed, CRC-protected blob store for certificates and large objects for Halow RTOS
+ *
+ * Features:
+ * - Dedicated "blobs" data partition, raw flash (not NVS), so large objects
+ *   do not slow down NVS mounts and small keys stay in the "keys" NVS
+ * - Named blobs in contiguous, sector-aligned extents with a CRC32 each
+ * - A/B index sectors with a generation counter: a replace or delete is one
+ *   index write, and power loss leaves either the old or the new state
+ * - Memory-mapped reads (esp_partition_mmap), so TLS setup can use
+ *   certificates in place without copying them into heap
+ * - Streaming writes for objects larger than a RAM buffer
+ */
+
+#ifndef BLOB_STORE_H
+#define BLOB_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+
+#define BLOB_STORE_PARTITION        "blobs"
+#define BLOB_STORE_NAME_MAX_LEN     15
+#define BLOB_STORE_MAX_BLOBS        32
+
+// Well-known blobs. PEM blobs include the terminating NUL, as mbedTLS expects.
+#define BLOB_MQTT_CA_CERT           "mqtt_ca"       // CA certificate for mqtts:// brokers
+#define BLOB_MQTT_CLIENT_CERT       "mqtt_cert"     // Client certificate (mutual TLS)
+#define BLOB_MQTT_CLIENT_KEY        "mqtt_key"      // Client private key (mutual TLS)
+
+// Blob description
+typedef struct {
+    char name[BLOB_STORE_NAME_MAX_LEN + 1];
+    uint32_t size;
+    uint32_t crc;               // CRC32 of the data
+    uint32_t offset;            // Partition offset of the data
+} blob_store_info_t;
+
+// Mapped blob from blob_store_mmap()
+typedef struct {
+    const void *data;           // Read-only view of the blob in flash
+    size_t size;
+    uint32_t offset;
+    esp_partition_mmap_handle_t handle;
+} blob_store_map_t;
+
+// Streaming writer from blob_store_begin()
+typedef struct {
+    char name[BLOB_STORE_NAME_MAX_LEN + 1];
+    uint32_t offset;            // Extent being written, 0 = writer not active
+    uint32_t capacity;
+    uint32_t written;
+    uint32_t crc;
+} blob_store_writer_t;
+
+// Store statistics
+typedef struct {
+    bool mounted;
+    uint32_t sectors;           // Data sectors in the partition
+    uint32_t blobs;
+    uint32_t used_bytes;        // Bytes in blobs
+    uint32_t used_sectors;      // Sectors taken by blob extents
+    uint32_t largest_free;      // Largest blob that fits right now, in bytes
+    uint32_t generation;        // Index generation
+    uint32_t index_writes;      // Index commits since boot
+    uint32_t crc_errors;        // Blobs that failed CRC verification since boot
+} blob_store_stats_t;
+
+/**
+ * @brief Mount the blob partition
+ * Formats the partition if neither index sector is valid.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no "blobs" partition
+ */
+esp_err_t blob_store_init(void);
+
+/**
+ * @brief Create or replace a blob
+ * @param name Blob name (at most BLOB_STORE_NAME_MAX_LEN characters)
+ * @param data Blob data
+ * @param len Data length
+ * @return As blob_store_begin() and blob_store_commit()
+ */
+esp_err_t blob_store_write(const char *name, const void *data, size_t len);
+
+/**
+ * @brief Start writing a blob in pieces
+ * Reserves and erases an extent for max_size bytes. Only one writer can be
+ * active at a time. The old blob of that name stays readable until commit.
+ * @param writer Writer state
+ * @param name Blob name
+ * @param max_size Upper bound of the blob size
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad name or size,
+ *         ESP_ERR_INVALID_STATE if another writer is active or the blob is mapped,
+ *         ESP_ERR_NO_MEM if the index is full or no extent is large enough
+ */
+esp_err_t blob_store_begin(blob_store_writer_t *writer, const char *name, size_t max_size);
+
+/**
+ * @brief Append data to a blob being written
+ * @param writer Writer from blob_store_begin()
+ * @param data Data
+ * @param len Data length
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE beyond max_size, flash error otherwise
+ */
+esp_err_t blob_store_append(blob_store_writer_t *writer, const void *data, size_t len);
+
+/**
+ * @brief Publish a blob being written
+ * Writes the index; the extent of a replaced blob is erased afterwards.
+ * The writer is released whatever the result.
+ * @param writer Writer from blob_store_begin()
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if nothing was written,
+ *         ESP_ERR_INVALID_STATE if the old blob was mapped meanwhile, flash error otherwise
+ */
+esp_err_t blob_store_commit(blob_store_writer_t *writer);
+
+/**
+ * @brief Drop a blob being written
+ * @param writer Writer from blob_store_begin()
+ */
+void blob_store_abort(blob_store_writer_t *writer);
+
+/**
+ * @brief Copy a blob into a buffer, verifying its CRC
+ * @param name Blob name
+ * @param buf Buffer
+ * @param size Buffer size
+ * @param len Pointer to store the blob size
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND, ESP_ERR_INVALID_SIZE if buf is
+ *         too small (len still set), ESP_ERR_INVALID_CRC if the data is corrupt
+ */
+esp_err_t blob_store_read(const char *name, void *buf, size_t size, size_t *len);
+
+/**
+ * @brief Map a blob into the data address space
+ * The CRC is verified on the first mapping after boot. A mapped blob can not
+ * be replaced or deleted until every mapping is released.
+ * @param name Blob name
+ * @param map Pointer to store the mapping
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND, ESP_ERR_INVALID_CRC if the data
+ *         is corrupt, mmap error otherwise
+ */
+esp_err_t blob_store_mmap(const char *name, blob_store_map_t *map);
+
+/**
+ * @brief Release a mapping from blob_store_mmap()
+ * @param map Mapping (cleared)
+ */
+void blob_store_munmap(blob_store_map_t *map);
+
+/**
+ * @brief Look up a blob
+ * @param name Blob name
+ * @param info Pointer to store the description (may be NULL)
+ * @return ESP_OK if the blob exists, ESP_ERR_NOT_FOUND otherwise
+ */
+esp_err_t blob_store_stat(const char *name, blob_store_info_t *info);
+
+/**
+ * @brief List blobs
+ * @param info Array for descriptions
+ * @param max Capacity of info
+ * @param count Pointer to store the number of descriptions stored
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not mounted
+ */
+esp_err_t blob_store_list(blob_store_info_t *info, size_t max, size_t *count);
+
+/**
+ * @brief Delete a blob and erase its data
+ * @param name Blob name
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND, ESP_ERR_INVALID_STATE if mapped
+ */
+esp_err_t blob_store_delete(const char *name);
+
+/**
+ * @brief Get store statistics
+ * @param stats Pointer to store statistics
+ */
+void blob_store_get_stats(blob_store_stats_t *stats);
+
+/**
+ * @brief Register blob store console commands
+ */
+void register_blob_store_commands(void);
+
+#endif // BLOB_STORE_H
@@ -0,0 +1,195 @@
+/**
+ * @file boot_profile.c
+ * @brief Boot stage timing implementation for Halow RTOS
+ *
+ * Each stage is written by exactly one task (the main task or the HaLow boot
+ * task), so the table only needs a spinlock to keep a stage's fields
+ * consistent against a concurrent 'boot_profile' reader.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "boot_profile.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+typedef struct {
+    int64_t start_us;           // 0 = not started
+    int64_t end_us;             // 0 = still running
+    esp_err_t result;
+    int core;
+    char task[configMAX_TASK_NAME_LEN];
+} boot_stage_record_t;
+
+static const char *boot_stage_names[BOOT_STAGE_COUNT] = {
+    [BOOT_STAGE_NVS]          = "nvs",
+    [BOOT_STAGE_PARTITIONS]   = "partitions",
+    [BOOT_STAGE_CONFIG]       = "config",
+    [BOOT_STAGE_TLOG]         = "tlog",
+    [BOOT_STAGE_BLOBS]        = "blobs",
+    [BOOT_STAGE_LOGIN_INIT]   = "login_init",
+    [BOOT_STAGE_GPIO]         = "gpio",
+    [BOOT_STAGE_HALOW_INIT]   = "halow_init",
+    [BOOT_STAGE_HALOW_START]  = "halow_start",
+    [BOOT_STAGE_TOOLS]        = "tools",
+    [BOOT_STAGE_MQTT]         = "mqtt",
+    [BOOT_STAGE_LOGIN_PROMPT] = "login_prompt",
+    [BOOT_STAGE_CONSOLE]      = "console",
+};
+
+static boot_stage_record_t boot_stages[BOOT_STAGE_COUNT];
+static portMUX_TYPE boot_profile_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Mark the start of a boot stage
+ */
+void boot_profile_begin(boot_stage_t stage)
+{
+    if (stage >= BOOT_STAGE_COUNT) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    const char *name = pcTaskGetName(NULL);
+
+    portENTER_CRITICAL(&boot_profile_lock);
+    boot_stage_record_t *rec = &boot_stages[stage];
+    rec->start_us = now;
+    rec->end_us = 0;
+    rec->result = ESP_OK;
+    rec->core = xPortGetCoreID();
+    strncpy(rec->task, name ? name : "?", sizeof(rec->task) - 1);
+    rec->task[sizeof(rec->task) - 1] = '\0';
+    portEXIT_CRITICAL(&boot_profile_lock);
+}
+
+/**
+ * @brief Mark the end of a boot stage
+ */
+void boot_profile_end(boot_stage_t stage, esp_err_t result)
+{
+    if (stage >= BOOT_STAGE_COUNT) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&boot_profile_lock);
+    if (boot_stages[stage].start_us != 0) {
+        boot_stages[stage].end_us = now;
+        boot_stages[stage].result = result;
+    }
+    portEXIT_CRITICAL(&boot_profile_lock);
+}
+
+/**
+ * @brief Check whether a stage has finished
+ */
+bool boot_profile_is_done(boot_stage_t stage)
+{
+    if (stage >= BOOT_STAGE_COUNT) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&boot_profile_lock);
+    bool done = boot_stages[stage].end_us != 0;
+    portEXIT_CRITICAL(&boot_profile_lock);
+    return done;
+}
+
+/**
+ * @brief Print the boot profile table
+ */
+void boot_profile_print(void)
+{
+    boot_stage_record_t snapshot[BOOT_STAGE_COUNT];
+
+    portENTER_CRITICAL(&boot_profile_lock);
+    memcpy(snapshot, boot_stages, sizeof(snapshot));
+    portEXIT_CRITICAL(&boot_profile_lock);
+
+    int64_t now = esp_timer_get_time();
+    int64_t ready_us = 0;   // Console usable: login prompt shown
+    int64_t last_us = 0;    // Last stage to finish
+
+    printf(COLOR_CYAN "Boot profile (ms since esp_timer start):\n" COLOR_RESET);
+    printf("%-13s %-16s %-4s %10s %10s %10s  %s\n",
+           "Stage", "Task", "Core", "Start", "End", "Duration", "Result");
+    printf("------------- ---------------- ---- ---------- ---------- ----------  ------\n");
+
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        const boot_stage_record_t *rec = &snapshot[i];
+
+        if (rec->start_us == 0) {
+            printf("%-13s %-16s %-4s %10s %10s %10s  " COLOR_YELLOW "not run\n" COLOR_RESET,
+                   boot_stage_names[i], "-", "-", "-", "-", "-");
+            continue;
+        }
+
+        if (rec->end_us == 0) {
+            printf("%-13s %-16s %-4d %10.1f %10s %10.1f  " COLOR_YELLOW "running\n" COLOR_RESET,
+                   boot_stage_names[i], rec->task, rec->core,
+                   rec->start_us / 1000.0, "-", (now - rec->start_us) / 1000.0);
+            continue;
+        }
+
+        printf("%-13s %-16s %-4d %10.1f %10.1f %10.1f  %s%s\n" COLOR_RESET,
+               boot_stage_names[i], rec->task, rec->core,
+               rec->start_us / 1000.0, rec->end_us / 1000.0,
+               (rec->end_us - rec->start_us) / 1000.0,
+               rec->result == ESP_OK ? COLOR_GREEN : COLOR_RED,
+               rec->result == ESP_OK ? "OK" : esp_err_to_name(rec->result));
+
+        if (rec->end_us > last_us) {
+            last_us = rec->end_us;
+        }
+    }
+
+    // The login prompt stage starts as soon as the console can take input
+    if (snapshot[BOOT_STAGE_LOGIN_PROMPT].start_us != 0) {
+        ready_us = snapshot[BOOT_STAGE_LOGIN_PROMPT].start_us;
+        printf("\nTime to login prompt: %.1f ms\n", ready_us / 1000.0);
+    }
+    if (last_us != 0) {
+        printf("Last stage finished:  %.1f ms\n", last_us / 1000.0);
+    }
+}
+
+/**
+ * @brief Print the boot profile as one JSON line (benchmark suite)
+ */
+void boot_profile_print_json(void)
+{
+    boot_stage_record_t snapshot[BOOT_STAGE_COUNT];
+
+    portENTER_CRITICAL(&boot_profile_lock);
+    memcpy(snapshot, boot_stages, sizeof(snapshot));
+    portEXIT_CRITICAL(&boot_profile_lock);
+
+    // The login prompt waits for the user, only its start is a boot figure
+    int64_t last_us = 0;
+    printf("{\"bench\":\"boot\",\"ready_ms\":%.1f,\"stages\":{",
+           snapshot[BOOT_STAGE_LOGIN_PROMPT].start_us / 1000.0);
+    bool first = true;
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        const boot_stage_record_t *rec = &snapshot[i];
+        if (i == BOOT_STAGE_LOGIN_PROMPT || rec->start_us == 0 || rec->end_us == 0) {
+            continue;
+        }
+        printf("%s\"%s\":{\"ms\":%.1f,\"ok\":%s}", first ? "" : ",", boot_stage_names[i],
+               (rec->end_us - rec->start_us) / 1000.0, rec->result == ESP_OK ? "true" : "false");
+        first = false;
+        if (i != BOOT_STAGE_CONSOLE && rec->end_us > last_us) {
+            last_us = rec->end_us;
+        }
+    }
+    printf("},\"init_done_ms\":%.1f}\n", last_us / 1000.0);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file boot_profile.h
+ * @brief Boot stage timing for Halow RTOS
+ *
+ * Features:
+ * - esp_timer microsecond timestamps for each boot stage
+ * - Records the task and core each stage ran on
+ * - Safe to update from the main task and the HaLow boot task concurrently
+ * - Report printed by the 'boot_profile' console command
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Boot stages in dependency order
+typedef enum {
+    BOOT_STAGE_NVS,             // NVS partitions (default, config, keys)
+    BOOT_STAGE_PARTITIONS,      // Partition availability check
+    BOOT_STAGE_CONFIG,          // Config manager cache load
+    BOOT_STAGE_TLOG,            // Telemetry log mount
+    BOOT_STAGE_BLOBS,           // Blob store mount
+    BOOT_STAGE_LOGIN_INIT,      // Login credential store
+    BOOT_STAGE_GPIO,            // GPIO control system
+    BOOT_STAGE_HALOW_INIT,      // HaLow HAL/WLAN init (HaLow boot task)
+    BOOT_STAGE_HALOW_START,     // HaLow boot, network stack and auto-connect (HaLow boot task)
+    BOOT_STAGE_TOOLS,           // Network tools
+    BOOT_STAGE_MQTT,            // MQTT publisher
+    BOOT_STAGE_LOGIN_PROMPT,    // Login banner shown until the user logged in
+    BOOT_STAGE_CONSOLE,         // Command registration and REPL start
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+/**
+ * @brief Mark the start of a boot stage
+ * @param stage Boot stage
+ */
+void boot_profile_begin(boot_stage_t stage);
+
+/**
+ * @brief Mark the end of a boot stage
+ * @param stage Boot stage
+ * @param result Stage result (ESP_OK on success)
+ */
+void boot_profile_end(boot_stage_t stage, esp_err_t result);
+
+/**
+ * @brief Check whether a stage has finished
+ * @param stage Boot stage
+ * @return true if the stage ended, false if pending or running
+ */
+bool boot_profile_is_done(boot_stage_t stage);
+
+/**
+ * @brief Print the boot profile table
+ */
+void boot_profile_print(void);
+
+/**
+ * @brief Print the boot profile as one JSON line (benchmark suite)
+ * Stage durations in ms; stages that did not finish are left out.
+ */
+void boot_profile_print_json(void);
+
+#endif // BOOT_PROFILE_H
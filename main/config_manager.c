@@ -0,0 +1,508 @@
+/**
+ * @file config_manager.c
+ * @brief System configuration management implementation for Halow RTOS
+ *
+ * Every section lives in RAM for the lifetime of the system. A save only
+ * touches flash once the section has been stable for the commit delay, so a
+ * burst of saves (e.g. connect, IP change, link hint update) costs one blob
+ * write per section instead of one open/set/commit/close per field.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "config_manager.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "nvs.h"
+
+static const char *TAG = "config_mgr";
+
+#define CONFIG_PARTITION            "config"
+#define CONFIG_BLOB_KEY             "data"
+
+// A continuous stream of saves is still written at least this often
+#define CONFIG_COMMIT_MAX_DELAY_MS  (CONFIG_CFG_COMMIT_DELAY_MS * 4)
+
+#define CONFIG_COMMIT_TASK_STACK    3072
+#define CONFIG_COMMIT_TASK_PRIORITY 2
+
+// On-flash blob layout: header followed by the structure
+typedef struct {
+    uint16_t version;
+    uint16_t length;
+} config_blob_header_t;
+
+typedef struct {
+    const char *name_space;
+    uint16_t version;
+    uint16_t size;
+    void *data;
+    const void *defaults;
+    const uint16_t *version_sizes;  // Valid bytes per older version, NULL if there is only one
+    bool present;               // Loaded from flash or saved since boot
+    bool dirty;                 // RAM differs from flash
+} config_section_t;
+
+typedef enum {
+    CONFIG_SECTION_GPIO,
+    CONFIG_SECTION_HALOW,
+    CONFIG_SECTION_MQTT,
+    CONFIG_SECTION_SYSTEM,
+    CONFIG_SECTION_COUNT
+} config_section_id_t;
+
+// Largest structure, sizes the flash I/O buffer
+typedef union {
+    gpio_board_config_t gpio;
+    halow_wifi_config_t halow;
+    mqtt_config_t mqtt;
+    system_config_t system;
+} config_any_t;
+
+static const gpio_board_config_t gpio_defaults = {
+    .led_pin = 0xFF,
+    .reset_pin = 0xFF,
+    .status_pins = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF },
+    .gpio_invert_flags = false,
+};
+
+static const halow_wifi_config_t halow_defaults = {
+    .auto_connect = true,
+    .max_retry = 3,
+};
+
+static const mqtt_config_t mqtt_defaults = {
+    .port = 1883,
+    .keepalive = 60,
+};
+
+static const system_config_t system_defaults = {
+    .log_level = ESP_LOG_INFO,
+    .timezone = "UTC0",
+    .watchdog_enable = true,
+    .watchdog_timeout_ms = 5000,
+};
+
+// Fields up to each version; a v1 blob is as long as v2 because
+// low_power_profile took what used to be tail padding
+static const uint16_t halow_version_sizes[CONFIG_VERSION_HALOW + 1] = {
+    [1] = offsetof(halow_wifi_config_t, low_power_profile),
+    [2] = sizeof(halow_wifi_config_t),
+};
+
+static gpio_board_config_t gpio_cache;
+static halow_wifi_config_t halow_cache;
+static mqtt_config_t mqtt_cache;
+static system_config_t system_cache;
+
+static config_section_t config_sections[CONFIG_SECTION_COUNT] = {
+    [CONFIG_SECTION_GPIO]   = { CONFIG_NAMESPACE_GPIO,   CONFIG_VERSION_GPIO,   sizeof(gpio_board_config_t), &gpio_cache,   &gpio_defaults },
+    [CONFIG_SECTION_HALOW]  = { CONFIG_NAMESPACE_HALOW,  CONFIG_VERSION_HALOW,  sizeof(halow_wifi_config_t), &halow_cache,  &halow_defaults, halow_version_sizes },
+    [CONFIG_SECTION_MQTT]   = { CONFIG_NAMESPACE_MQTT,   CONFIG_VERSION_MQTT,   sizeof(mqtt_config_t),       &mqtt_cache,   &mqtt_defaults },
+    [CONFIG_SECTION_SYSTEM] = { CONFIG_NAMESPACE_SYSTEM, CONFIG_VERSION_SYSTEM, sizeof(system_config_t),     &system_cache, &system_defaults },
+};
+
+static SemaphoreHandle_t config_mutex = NULL;      // Guards the RAM cache
+static SemaphoreHandle_t config_flush_mutex = NULL; // Serialises flash writes
+static TaskHandle_t config_commit_task_handle = NULL;
+static bool config_partition_ready = false;
+
+/**
+ * @brief Read one section blob from flash into the cache
+ * Missing or unreadable blobs leave the defaults in place.
+ */
+static void config_section_read(config_section_t *sec)
+{
+    uint8_t buf[sizeof(config_blob_header_t) + sizeof(config_any_t)];
+    config_blob_header_t hdr;
+    nvs_handle_t handle;
+
+    memcpy(sec->data, sec->defaults, sec->size);
+    sec->present = false;
+    sec->dirty = false;
+
+    if (nvs_open_from_partition(CONFIG_PARTITION, sec->name_space, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+
+    size_t len = sizeof(buf);
+    esp_err_t err = nvs_get_blob(handle, CONFIG_BLOB_KEY, buf, &len);
+    nvs_close(handle);
+
+    if (err != ESP_OK || len < sizeof(hdr)) {
+        return;
+    }
+
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (hdr.length != len - sizeof(hdr) || hdr.version > sec->version) {
+        ESP_LOGW(TAG, "%s: unsupported blob (v%u, %u bytes), using defaults",
+                 sec->name_space, hdr.version, hdr.length);
+        return;
+    }
+
+    // Older versions are a prefix of the current layout. Only take the fields
+    // that version had: its tail padding may cover newer fields, which keep
+    // their defaults.
+    size_t valid = hdr.length < sec->size ? hdr.length : sec->size;
+    if (sec->version_sizes && hdr.version < sec->version && sec->version_sizes[hdr.version] != 0 &&
+        sec->version_sizes[hdr.version] < valid) {
+        valid = sec->version_sizes[hdr.version];
+    }
+    memcpy(sec->data, buf + sizeof(hdr), valid);
+    sec->present = true;
+
+    if (hdr.version != sec->version || hdr.length != sec->size) {
+        ESP_LOGI(TAG, "%s: upgrading blob v%u -> v%u", sec->name_space, hdr.version, sec->version);
+        sec->dirty = true;
+    }
+}
+
+/**
+ * @brief Write (or erase) one section blob
+ * @param sec Section descriptor
+ * @param data Snapshot of the section data
+ * @param present false to erase the blob
+ */
+static esp_err_t config_section_write(const config_section_t *sec, const void *data, bool present)
+{
+    uint8_t buf[sizeof(config_blob_header_t) + sizeof(config_any_t)];
+    config_blob_header_t hdr = { .version = sec->version, .length = sec->size };
+    nvs_handle_t handle;
+
+    esp_err_t err = nvs_open_from_partition(CONFIG_PARTITION, sec->name_space, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (present) {
+        memcpy(buf, &hdr, sizeof(hdr));
+        memcpy(buf + sizeof(hdr), data, sec->size);
+        err = nvs_set_blob(handle, CONFIG_BLOB_KEY, buf, sizeof(hdr) + sec->size);
+    } else {
+        err = nvs_erase_key(handle, CONFIG_BLOB_KEY);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+    }
+
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+/**
+ * @brief Commit task: waits for the save burst to settle, then flushes
+ */
+static void config_commit_task(void *pvParameters)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Restart the delay on every save, bounded so a busy writer still commits
+        TickType_t first = xTaskGetTickCount();
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_CFG_COMMIT_DELAY_MS)) > 0 &&
+               (xTaskGetTickCount() - first) < pdMS_TO_TICKS(CONFIG_COMMIT_MAX_DELAY_MS)) {
+        }
+
+        config_flush();
+    }
+}
+
+/**
+ * @brief Flush before esp_restart() so pending saves survive a reboot
+ */
+static void config_shutdown_handler(void)
+{
+    config_flush();
+}
+
+/**
+ * @brief Copy a section out of the cache
+ */
+static esp_err_t config_section_load(config_section_id_t id, void *out)
+{
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!config_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    config_section_t *sec = &config_sections[id];
+
+    xSemaphoreTake(config_mutex, portMAX_DELAY);
+    memcpy(out, sec->data, sec->size);
+    bool present = sec->present;
+    xSemaphoreGive(config_mutex);
+
+    return present ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+/**
+ * @brief Update a section in the cache and schedule a commit
+ * @param data New contents, NULL to reset to defaults and erase
+ */
+static esp_err_t config_section_store(config_section_id_t id, const void *data)
+{
+    if (!config_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    config_section_t *sec = &config_sections[id];
+    const void *src = data ? data : sec->defaults;
+    bool changed;
+
+    xSemaphoreTake(config_mutex, portMAX_DELAY);
+    changed = (sec->present != (data != NULL)) || memcmp(sec->data, src, sec->size) != 0;
+    if (changed) {
+        memcpy(sec->data, src, sec->size);
+        sec->present = (data != NULL);
+        sec->dirty = true;
+    }
+    xSemaphoreGive(config_mutex);
+
+    if (changed && config_commit_task_handle) {
+        xTaskNotifyGive(config_commit_task_handle);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Initialize configuration manager
+ */
+esp_err_t config_manager_init(void)
+{
+    if (config_mutex) {
+        return ESP_OK;
+    }
+
+    config_mutex = xSemaphoreCreateMutex();
+    config_flush_mutex = xSemaphoreCreateMutex();
+    if (!config_mutex || !config_flush_mutex) {
+        ESP_LOGE(TAG, "Failed to create config mutexes");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Probe the partition once, the sections below are read-only opens
+    nvs_handle_t handle;
+    config_partition_ready = nvs_open_from_partition(CONFIG_PARTITION, CONFIG_NAMESPACE_SYSTEM,
+                                                     NVS_READWRITE, &handle) == ESP_OK;
+    if (config_partition_ready) {
+        nvs_close(handle);
+    } else {
+        ESP_LOGW(TAG, "Config partition unavailable, settings will not persist");
+    }
+
+    bool upgrade = false;
+    for (int i = 0; i < CONFIG_SECTION_COUNT; i++) {
+        config_section_read(&config_sections[i]);
+        upgrade |= config_sections[i].dirty;
+    }
+
+    if (config_partition_ready) {
+        if (xTaskCreate(config_commit_task, "config_commit", CONFIG_COMMIT_TASK_STACK, NULL,
+                        CONFIG_COMMIT_TASK_PRIORITY, &config_commit_task_handle) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create config commit task");
+            return ESP_ERR_NO_MEM;
+        }
+        esp_register_shutdown_handler(config_shutdown_handler);
+
+        if (upgrade) {
+            xTaskNotifyGive(config_commit_task_handle);
+        }
+    }
+
+    ESP_LOGI(TAG, "Config manager initialized (commit delay %d ms)", CONFIG_CFG_COMMIT_DELAY_MS);
+    return ESP_OK;
+}
+
+/**
+ * @brief Write all dirty configuration to flash now
+ */
+esp_err_t config_flush(void)
+{
+    if (!config_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!config_partition_ready) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    config_any_t snapshot;
+    esp_err_t result = ESP_OK;
+
+    xSemaphoreTake(config_flush_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < CONFIG_SECTION_COUNT; i++) {
+        config_section_t *sec = &config_sections[i];
+
+        // Snapshot under the cache lock, write to flash without it so loads never wait on flash
+        xSemaphoreTake(config_mutex, portMAX_DELAY);
+        bool dirty = sec->dirty;
+        bool present = sec->present;
+        if (dirty) {
+            memcpy(&snapshot, sec->data, sec->size);
+            sec->dirty = false;
+        }
+        xSemaphoreGive(config_mutex);
+
+        if (!dirty) {
+            continue;
+        }
+
+        esp_err_t err = config_section_write(sec, &snapshot, present);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to commit %s: %s", sec->name_space, esp_err_to_name(err));
+            xSemaphoreTake(config_mutex, portMAX_DELAY);
+            sec->dirty = true;
+            xSemaphoreGive(config_mutex);
+            if (result == ESP_OK) {
+                result = err;
+            }
+        } else {
+            ESP_LOGD(TAG, "Committed %s", sec->name_space);
+        }
+    }
+
+    xSemaphoreGive(config_flush_mutex);
+    return result;
+}
+
+/**
+ * @brief Load GPIO configuration from config partition
+ */
+esp_err_t config_load_gpio(gpio_board_config_t* gpio_cfg)
+{
+    return config_section_load(CONFIG_SECTION_GPIO, gpio_cfg);
+}
+
+/**
+ * @brief Save GPIO configuration to config partition
+ */
+esp_err_t config_save_gpio(const gpio_board_config_t* gpio_cfg)
+{
+    if (!gpio_cfg) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return config_section_store(CONFIG_SECTION_GPIO, gpio_cfg);
+}
+
+/**
+ * @brief Load HaLow WiFi configuration from config partition
+ */
+esp_err_t config_load_halow_wifi(halow_wifi_config_t* halow_cfg)
+{
+    return config_section_load(CONFIG_SECTION_HALOW, halow_cfg);
+}
+
+/**
+ * @brief Save HaLow WiFi configuration to config partition
+ */
+esp_err_t config_save_halow_wifi(const halow_wifi_config_t* halow_cfg)
+{
+    if (!halow_cfg) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return config_section_store(CONFIG_SECTION_HALOW, halow_cfg);
+}
+
+/**
+ * @brief Remove HaLow WiFi configuration
+ */
+esp_err_t config_clear_halow_wifi(void)
+{
+    return config_section_store(CONFIG_SECTION_HALOW, NULL);
+}
+
+/**
+ * @brief Load MQTT configuration from config partition
+ */
+esp_err_t config_load_mqtt(mqtt_config_t* mqtt_cfg)
+{
+    return config_section_load(CONFIG_SECTION_MQTT, mqtt_cfg);
+}
+
+/**
+ * @brief Save MQTT configuration to config partition
+ */
+esp_err_t config_save_mqtt(const mqtt_config_t* mqtt_cfg)
+{
+    if (!mqtt_cfg) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return config_section_store(CONFIG_SECTION_MQTT, mqtt_cfg);
+}
+
+/**
+ * @brief Load system configuration from config partition
+ */
+esp_err_t config_load_system(system_config_t* system_cfg)
+{
+    return config_section_load(CONFIG_SECTION_SYSTEM, system_cfg);
+}
+
+/**
+ * @brief Save system configuration to config partition
+ */
+esp_err_t config_save_system(const system_config_t* system_cfg)
+{
+    if (!system_cfg) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return config_section_store(CONFIG_SECTION_SYSTEM, system_cfg);
+}
+
+/**
+ * @brief Check if config partition is available and functioning
+ */
+bool config_partition_available(void)
+{
+    return config_partition_ready;
+}
+
+/**
+ * @brief Reset all configuration to defaults
+ */
+esp_err_t config_reset_all(void)
+{
+    for (int i = 0; i < CONFIG_SECTION_COUNT; i++) {
+        esp_err_t err = config_section_store((config_section_id_t)i, NULL);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return config_flush();
+}
+
+/**
+ * @brief Label of the key NVS partition on this device
+ */
+const char *config_keys_partition(void)
+{
+    if (esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, KEYS_PARTITION)) {
+        return KEYS_PARTITION;
+    }
+    if (esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, LEGACY_CERTS_PARTITION)) {
+        return LEGACY_CERTS_PARTITION;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Open a namespace on the key NVS partition
+ */
+esp_err_t config_keys_nvs_open(const char *name_space, nvs_open_mode_t mode, nvs_handle_t *handle)
+{
+    const char *label = config_keys_partition();
+    if (!label) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return nvs_open_from_partition(label, name_space, mode, handle);
+}
@@ -7,13 +7,27 @@
  * - MQTT settings (broker, topics)
  * - System parameters (timezone, logging level)
  * - HaLow specific settings
+ *
+ * Each structure is cached in RAM and loaded once at boot. Loads are memory
+ * copies; saves mark the structure dirty and a commit task writes all dirty
+ * structures after CONFIG_CFG_COMMIT_DELAY_MS without further saves. On flash
+ * each structure is one versioned blob; fields may only be appended, so a
+ * blob written by an older version loads with the new fields at defaults.
  */
 
 #ifndef CONFIG_MANAGER_H
 #define CONFIG_MANAGER_H
 
 #include "esp_err.h"
+#include "nvs.h"
 #include <stdbool.h>
+#include <stdint.h>
+
+// Key NVS partition (64KB, login credentials and other small keys). OTA
+// updates do not rewrite the partition table, so devices updated from older
+// firmware still have the same data in the legacy "certs" NVS.
+#define KEYS_PARTITION              "keys"
+#define LEGACY_CERTS_PARTITION      "certs"
 
 // Configuration keys for config partition (512KB total)
 #define CONFIG_NAMESPACE_GPIO       "gpio_cfg"      // GPIO pin configurations
@@ -21,13 +35,20 @@
 #define CONFIG_NAMESPACE_MQTT       "mqtt_cfg"      // MQTT broker settings
 #define CONFIG_NAMESPACE_SYSTEM     "system_cfg"    // System parameters
 
-// GPIO Configuration
+// Blob versions, bump when a structure gains fields and record the old
+// layout's size in config_manager.c (new fields may land in old tail padding)
+#define CONFIG_VERSION_GPIO         1
+#define CONFIG_VERSION_HALOW        2
+#define CONFIG_VERSION_MQTT         1
+#define CONFIG_VERSION_SYSTEM       1
+
+// GPIO Configuration (not gpio_config_t, which driver/gpio.h already defines)
 typedef struct {
     uint8_t led_pin;
     uint8_t reset_pin;
     uint8_t status_pins[8];  // Up to 8 status indicator pins
     bool gpio_invert_flags;
-} gpio_config_t;
+} gpio_board_config_t;
 
 // HaLow WiFi Configuration (802.11ah)
 typedef struct {
@@ -37,6 +58,10 @@ typedef struct {
     int max_retry;
     uint8_t channel;         // HaLow specific channel
     bool low_power_mode;     // HaLow power saving
+    uint8_t bssid[6];        // Last associated BSS, all zero if unknown
+    uint32_t channel_freq_hz;  // Centre frequency of the last link, 0 if unknown
+    uint8_t channel_bw_mhz;  // Bandwidth of the last link
+    uint8_t low_power_profile;  // halow_power_profile_t used when low_power_mode is set (v2)
 } halow_wifi_config_t;
 
 // MQTT Configuration
@@ -63,19 +88,25 @@ typedef struct {
  */
 esp_err_t config_manager_init(void);
 
+/**
+ * @brief Write all dirty configuration to flash now
+ * Called automatically after the commit delay and on restart.
+ * @return ESP_OK on success, error code of the first failed write otherwise
+ */
+esp_err_t config_flush(void);
 /**
  * @brief Load GPIO configuration from config partition
  * @param gpio_cfg Pointer to GPIO configuration structure
  * @return ESP_OK on success, ESP_ERR_NVS_NOT_FOUND if not configured
  */
-esp_err_t config_load_gpio(gpio_config_t* gpio_cfg);
+esp_err_t config_load_gpio(gpio_board_config_t* gpio_cfg);
 
 /**
  * @brief Save GPIO configuration to config partition
  * @param gpio_cfg Pointer to GPIO configuration structure
  * @return ESP_OK on success
  */
-esp_err_t config_save_gpio(const gpio_config_t* gpio_cfg);
+esp_err_t config_save_gpio(const gpio_board_config_t* gpio_cfg);
 
 /**
  * @brief Load HaLow WiFi configuration from config partition
@@ -91,6 +122,12 @@ esp_err_t config_load_halow_wifi(halow_wifi_config_t* halow_cfg);
  */
 esp_err_t config_save_halow_wifi(const halow_wifi_config_t* halow_cfg);
 
+/**
+ * @brief Remove HaLow WiFi configuration (erased on the next commit)
+ * @return ESP_OK on success
+ */
+esp_err_t config_clear_halow_wifi(void);
+
 /**
  * @brief Load MQTT configuration from config partition
  * @param mqtt_cfg Pointer to MQTT configuration structure
@@ -105,6 +142,20 @@ esp_err_t config_load_mqtt(mqtt_config_t* mqtt_cfg);
  */
 esp_err_t config_save_mqtt(const mqtt_config_t* mqtt_cfg);
 
+/**
+ * @brief Load system configuration from config partition
+ * @param system_cfg Pointer to system configuration structure
+ * @return ESP_OK on success, ESP_ERR_NVS_NOT_FOUND if not configured
+ */
+esp_err_t config_load_system(system_config_t* system_cfg);
+
+/**
+ * @brief Save system configuration to config partition
+ * @param system_cfg Pointer to system configuration structure
+ * @return ESP_OK on success
+ */
+esp_err_t config_save_system(const system_config_t* system_cfg);
+
 /**
  * @brief Check if config partition is available and functioning
  * @return true if config partition is ready for use
@@ -117,4 +168,20 @@ bool config_partition_available(void);
  */
 esp_err_t config_reset_all(void);
 
-#endif // CONFIG_MANAGER_H
\ No newline at end of file
+/**
+ * @brief Label of the key NVS partition on this device
+ * @return KEYS_PARTITION, LEGACY_CERTS_PARTITION on an old partition table,
+ *         NULL if there is neither
+ */
+const char *config_keys_partition(void);
+
+/**
+ * @brief Open a namespace on the key NVS partition (keys, or legacy certs)
+ * @param name_space Namespace
+ * @param mode NVS_READONLY or NVS_READWRITE
+ * @param handle Pointer to store the handle
+ * @return As nvs_open_from_partition(), ESP_ERR_NOT_FOUND without a key NVS partition
+ */
+esp_err_t config_keys_nvs_open(const char *name_space, nvs_open_mode_t mode, nvs_handle_t *handle);
+
+#endif // CONFIG_MANAGER_H
@@ -0,0 +1,112 @@
+/**
+ * @file console_input.c
+ * @brief Blocking, interrupt-driven console input implementation for Halow RTOS
+ *
+ * esp_console_new_repl_uart() / _usb_serial_jtag() install the driver
+ * themselves and fail if it already exists, so the driver installed here is
+ * removed again in console_input_end() right before the REPL is created.
+ * The USB CDC console has no driver-level read API; it keeps polling stdin.
+ */
+
+#include <stdio.h>
+#include "console_input.h"
+#include "esp_log.h"
+#include "freertos/task.h"
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+#include "driver/usb_serial_jtag.h"
+#include "driver/usb_serial_jtag_vfs.h"
+#endif
+
+static const char *TAG = "console_input";
+
+#define CONSOLE_INPUT_RX_BUFFER     256
+#define CONSOLE_INPUT_POLL_MS       10      // Fallback when no driver is installed
+
+static bool console_driver_active = false;
+
+/**
+ * @brief Install the console driver for blocking reads
+ */
+esp_err_t console_input_begin(void)
+{
+    esp_err_t err = ESP_ERR_NOT_SUPPORTED;
+
+    if (console_driver_active) {
+        return ESP_OK;
+    }
+
+    fflush(stdout);
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+    err = uart_driver_install(CONFIG_ESP_CONSOLE_UART_NUM, CONSOLE_INPUT_RX_BUFFER, 0, 0, NULL, 0);
+    if (err == ESP_OK) {
+        uart_vfs_dev_use_driver(CONFIG_ESP_CONSOLE_UART_NUM);
+    }
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+    usb_serial_jtag_driver_config_t jtag_cfg = USB_SERIAL_JTAG_DRIVER_CONFIG_DEFAULT();
+    jtag_cfg.rx_buffer_size = CONSOLE_INPUT_RX_BUFFER;
+    err = usb_serial_jtag_driver_install(&jtag_cfg);
+    if (err == ESP_OK) {
+        usb_serial_jtag_vfs_use_driver();
+    }
+#endif
+
+    if (err == ESP_OK) {
+        console_driver_active = true;
+    } else {
+        ESP_LOGW(TAG, "No blocking console driver (%s), polling input", esp_err_to_name(err));
+    }
+    return err;
+}
+
+/**
+ * @brief Wait for one input byte
+ */
+int console_input_getc(TickType_t timeout)
+{
+    uint8_t c;
+
+    if (console_driver_active) {
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+        return uart_read_bytes(CONFIG_ESP_CONSOLE_UART_NUM, &c, 1, timeout) == 1 ? c : -1;
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+        return usb_serial_jtag_read_bytes(&c, 1, timeout) == 1 ? c : -1;
+#endif
+    }
+
+    // No driver: poll the non-blocking stdin until the timeout
+    TickType_t start = xTaskGetTickCount();
+    for (;;) {
+        int ch = getchar();
+        if (ch != EOF) {
+            return ch;
+        }
+        if (xTaskGetTickCount() - start >= timeout) {
+            return -1;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONSOLE_INPUT_POLL_MS));
+    }
+}
+
+/**
+ * @brief Remove the driver again so esp_console can create the REPL
+ */
+void console_input_end(void)
+{
+    if (!console_driver_active) {
+        return;
+    }
+
+    fflush(stdout);
+#if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
+    uart_wait_tx_done(CONFIG_ESP_CONSOLE_UART_NUM, portMAX_DELAY);
+    uart_vfs_dev_use_nonblocking(CONFIG_ESP_CONSOLE_UART_NUM);
+    uart_driver_delete(CONFIG_ESP_CONSOLE_UART_NUM);
+#elif defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+    usb_serial_jtag_vfs_use_nonblocking();
+    usb_serial_jtag_driver_uninstall();
+#endif
+    console_driver_active = false;
+}
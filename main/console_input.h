@@ -0,0 +1,41 @@
+/**
+ * @file console_input.h
+ * @brief Blocking, interrupt-driven console input for Halow RTOS
+ *
+ * Features:
+ * - Installs the UART or USB-Serial-JTAG driver of the configured console
+ *   before the REPL exists, so the login prompt can block on the driver's
+ *   RX ring buffer instead of polling getchar()
+ * - The reading task sleeps until a byte arrives or the timeout expires,
+ *   there are no periodic wakeups while nobody types
+ * - stdout is routed through the same driver meanwhile, so other tasks can
+ *   keep printing
+ * - Handed back before the REPL is created, which installs its own driver
+ */
+
+#ifndef CONSOLE_INPUT_H
+#define CONSOLE_INPUT_H
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @brief Install the console driver for blocking reads
+ * @return ESP_OK on success, error code from the driver otherwise
+ *         (console_input_getc() then falls back to polling)
+ */
+esp_err_t console_input_begin(void);
+
+/**
+ * @brief Wait for one input byte
+ * @param timeout Maximum time to block
+ * @return Byte value (0-255), or -1 on timeout
+ */
+int console_input_getc(TickType_t timeout);
+
+/**
+ * @brief Remove the driver again so esp_console can create the REPL
+ */
+void console_input_end(void);
+
+#endif // CONSOLE_INPUT_H
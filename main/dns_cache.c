@@ -0,0 +1,545 @@
+/**
+ * @file dns_cache.c
+ * @brief Shared DNS resolver cache implementation for Halow RTOS
+ *
+ * gethostbyname() does not report the record TTL, so misses are resolved
+ * with a single A query sent straight to the DNS server mmipal learned from
+ * DHCP (or the static config). The answer's lowest TTL along the CNAME chain
+ * sets the expiry. Only definite answers are cached: NXDOMAIN and empty
+ * answers as negative entries, timeouts and server errors not at all, so a
+ * lookup made while the link was down does not stick. Without a DNS server
+ * the lwIP resolver is used and the entry gets the maximum TTL. Names too
+ * long for an entry, and lookups before the cache is up, go to the lwIP
+ * resolver uncached, as they did before the cache existed.
+ *
+ * The table is small enough that linear search by name is cheaper than
+ * hashing. The mutex is not held across the query; two tasks missing on the
+ * same name at once both ask the server and the later answer wins.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "dns_cache.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_console.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lwip/inet.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+
+// Morse Micro SDK includes
+#include "mmipal.h"
+
+static const char *TAG = "dns_cache";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define DNS_PORT                53
+#define DNS_QUERY_TIMEOUT_MS    2500    // Per attempt, HaLow round trips can take hundreds of ms
+#define DNS_QUERY_ATTEMPTS      2
+#define DNS_MSG_MAX_LEN         512     // Classic UDP DNS limit
+#define DNS_HEADER_LEN          12
+#define DNS_TYPE_A              1
+#define DNS_TYPE_CNAME          5
+#define DNS_CLASS_IN            1
+#define DNS_FLAG_QR             0x8000
+#define DNS_FLAG_RD             0x0100
+#define DNS_FLAG_TC             0x0200
+#define DNS_RCODE_MASK          0x000F
+#define DNS_RCODE_NXDOMAIN      3
+
+typedef struct {
+    bool in_use;
+    bool negative;              // Name does not exist / has no A record
+    char name[DNS_CACHE_NAME_MAX_LEN + 1];
+    struct in_addr addr;
+    int64_t expires_us;
+    int64_t last_used_us;
+    uint32_t hits;
+} dns_cache_entry_t;
+
+static dns_cache_entry_t dns_cache[CONFIG_DNS_CACHE_ENTRIES];
+static dns_cache_stats_t dns_stats;
+static SemaphoreHandle_t dns_cache_mutex = NULL;
+
+/**
+ * @brief Find the slot holding a name
+ * Caller holds dns_cache_mutex.
+ * @return Slot index, -1 if not cached
+ */
+static int dns_cache_index_of(const char *name)
+{
+    for (int i = 0; i < CONFIG_DNS_CACHE_ENTRIES; i++) {
+        if (dns_cache[i].in_use && strcasecmp(dns_cache[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Pick a slot for a new name: a free or expired slot, else the least recently used
+ * Caller holds dns_cache_mutex.
+ */
+static int dns_cache_victim(int64_t now_us)
+{
+    int oldest = 0;
+    for (int i = 0; i < CONFIG_DNS_CACHE_ENTRIES; i++) {
+        if (!dns_cache[i].in_use || dns_cache[i].expires_us <= now_us) {
+            return i;
+        }
+        if (dns_cache[i].last_used_us < dns_cache[oldest].last_used_us) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+/**
+ * @brief Store an answer
+ * @param name Queried name
+ * @param addr Address, NULL for a negative entry
+ * @param ttl_s Time to live in seconds
+ */
+static void dns_cache_store(const char *name, const struct in_addr *addr, uint32_t ttl_s)
+{
+    if (ttl_s == 0) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(dns_cache_mutex, portMAX_DELAY);
+    int idx = dns_cache_index_of(name);
+    if (idx < 0) {
+        idx = dns_cache_victim(now);
+    }
+    dns_cache_entry_t *e = &dns_cache[idx];
+    memset(e, 0, sizeof(*e));
+    e->in_use = true;
+    e->negative = (addr == NULL);
+    strncpy(e->name, name, DNS_CACHE_NAME_MAX_LEN);
+    if (addr) {
+        e->addr = *addr;
+    }
+    e->expires_us = now + (int64_t)ttl_s * 1000000;
+    e->last_used_us = now;
+    xSemaphoreGive(dns_cache_mutex);
+}
+
+/**
+ * @brief Skip an encoded (possibly compressed) name in a DNS message
+ * @return Offset after the name, -1 if malformed
+ */
+static int dns_skip_name(const uint8_t *msg, int len, int pos)
+{
+    while (pos < len) {
+        uint8_t label = msg[pos];
+        if (label == 0) {
+            return pos + 1;
+        }
+        if ((label & 0xC0) == 0xC0) {
+            return pos + 2 <= len ? pos + 2 : -1;
+        }
+        pos += label + 1;
+    }
+    return -1;
+}
+
+/**
+ * @brief Build an A query for name
+ * @return Message length, -1 if the name does not fit
+ */
+static int dns_build_query(uint8_t *msg, uint16_t id, const char *name)
+{
+    memset(msg, 0, DNS_HEADER_LEN);
+    msg[0] = id >> 8;
+    msg[1] = id & 0xFF;
+    msg[2] = DNS_FLAG_RD >> 8;
+    msg[5] = 1;                 // One question
+
+    int pos = DNS_HEADER_LEN;
+    const char *label = name;
+    while (*label) {
+        const char *dot = strchr(label, '.');
+        size_t label_len = dot ? (size_t)(dot - label) : strlen(label);
+        if (label_len == 0 || label_len > 63 || pos + (int)label_len + 1 + 5 > DNS_MSG_MAX_LEN) {
+            return -1;
+        }
+        msg[pos++] = (uint8_t)label_len;
+        memcpy(&msg[pos], label, label_len);
+        pos += label_len;
+        label += label_len + (dot ? 1 : 0);
+    }
+    msg[pos++] = 0;
+    msg[pos++] = 0;
+    msg[pos++] = DNS_TYPE_A;
+    msg[pos++] = 0;
+    msg[pos++] = DNS_CLASS_IN;
+    return pos;
+}
+
+/**
+ * @brief Parse an answer to our query
+ * @param addr Pointer to store the first A record
+ * @param ttl_s Pointer to store the lowest TTL seen up to that record
+ * @return ESP_OK with an address, ESP_ERR_NOT_FOUND for NXDOMAIN or no A
+ *         record, ESP_FAIL for a server error or malformed/truncated message
+ */
+static esp_err_t dns_parse_answer(const uint8_t *msg, int len, struct in_addr *addr, uint32_t *ttl_s)
+{
+    uint16_t flags = (msg[2] << 8) | msg[3];
+    uint16_t qdcount = (msg[4] << 8) | msg[5];
+    uint16_t ancount = (msg[6] << 8) | msg[7];
+
+    if ((flags & DNS_RCODE_MASK) == DNS_RCODE_NXDOMAIN) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if ((flags & DNS_RCODE_MASK) != 0 || (flags & DNS_FLAG_TC)) {
+        return ESP_FAIL;
+    }
+
+    int pos = DNS_HEADER_LEN;
+    for (int i = 0; i < qdcount; i++) {
+        pos = dns_skip_name(msg, len, pos);
+        if (pos < 0 || pos + 4 > len) {
+            return ESP_FAIL;
+        }
+        pos += 4;
+    }
+
+    uint32_t min_ttl = UINT32_MAX;
+    for (int i = 0; i < ancount; i++) {
+        pos = dns_skip_name(msg, len, pos);
+        if (pos < 0 || pos + 10 > len) {
+            return ESP_FAIL;
+        }
+        uint16_t type = (msg[pos] << 8) | msg[pos + 1];
+        uint16_t cls = (msg[pos + 2] << 8) | msg[pos + 3];
+        uint32_t ttl = ((uint32_t)msg[pos + 4] << 24) | ((uint32_t)msg[pos + 5] << 16) |
+                       ((uint32_t)msg[pos + 6] << 8) | msg[pos + 7];
+        uint16_t rdlen = (msg[pos + 8] << 8) | msg[pos + 9];
+        pos += 10;
+        if (pos + rdlen > len) {
+            return ESP_FAIL;
+        }
+        if (cls == DNS_CLASS_IN && (type == DNS_TYPE_CNAME || type == DNS_TYPE_A)) {
+            min_ttl = ttl < min_ttl ? ttl : min_ttl;
+        }
+        if (cls == DNS_CLASS_IN && type == DNS_TYPE_A && rdlen == 4) {
+            memcpy(&addr->s_addr, &msg[pos], 4);
+            *ttl_s = min_ttl;
+            return ESP_OK;
+        }
+        pos += rdlen;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief Send an A query to the DNS server and wait for the answer
+ */
+static esp_err_t dns_query(const struct in_addr *server, const char *name, struct in_addr *addr,
+                           uint32_t *ttl_s, uint32_t *rtt_ms)
+{
+    uint8_t query[DNS_MSG_MAX_LEN];
+    uint8_t msg[DNS_MSG_MAX_LEN];
+    uint16_t id = (uint16_t)esp_random();
+    int query_len = dns_build_query(query, id, name);
+    if (query_len < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Failed to create socket (errno %d)", errno);
+        return ESP_FAIL;
+    }
+    struct timeval tv = { .tv_sec = DNS_QUERY_TIMEOUT_MS / 1000, .tv_usec = (DNS_QUERY_TIMEOUT_MS % 1000) * 1000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in dest = {
+        .sin_family = AF_INET,
+        .sin_port = htons(DNS_PORT),
+        .sin_addr = *server,
+    };
+    esp_err_t result = ESP_ERR_TIMEOUT;
+    for (int attempt = 0; attempt < DNS_QUERY_ATTEMPTS && result == ESP_ERR_TIMEOUT; attempt++) {
+        if (sendto(sock, query, query_len, 0, (struct sockaddr *)&dest, sizeof(dest)) != query_len) {
+            result = ESP_FAIL;
+            break;
+        }
+        int64_t start = esp_timer_get_time();
+        while ((esp_timer_get_time() - start) / 1000 < DNS_QUERY_TIMEOUT_MS) {
+            struct sockaddr_in from;
+            socklen_t from_len = sizeof(from);
+            int len = recvfrom(sock, msg, sizeof(msg), 0, (struct sockaddr *)&from, &from_len);
+            if (len < 0) {
+                break;      // Receive timeout, retransmit
+            }
+            // Ignore stray datagrams and answers to someone else's query
+            if (len < DNS_HEADER_LEN || from.sin_addr.s_addr != server->s_addr ||
+                ((msg[0] << 8) | msg[1]) != id || !(((msg[2] << 8) | msg[3]) & DNS_FLAG_QR)) {
+                continue;
+            }
+            *rtt_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+            result = dns_parse_answer(msg, len, addr, ttl_s);
+            break;
+        }
+    }
+
+    close(sock);
+    return result;
+}
+
+/**
+ * @brief Get the first IPv4 DNS server known to mmipal
+ */
+static bool dns_get_server(struct in_addr *server)
+{
+    mmipal_ip_addr_t addr_str = {0};
+    if (mmipal_get_dns_server(0, addr_str) != MMIPAL_SUCCESS) {
+        return false;
+    }
+    return inet_pton(AF_INET, addr_str, server) == 1 && server->s_addr != 0;
+}
+
+/**
+ * @brief Initialize the cache
+ */
+esp_err_t dns_cache_init(void)
+{
+    if (dns_cache_mutex) {
+        return ESP_OK;
+    }
+
+    dns_cache_mutex = xSemaphoreCreateMutex();
+    if (!dns_cache_mutex) {
+        ESP_LOGE(TAG, "Failed to create DNS cache mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(dns_cache, 0, sizeof(dns_cache));
+    memset(&dns_stats, 0, sizeof(dns_stats));
+    return ESP_OK;
+}
+
+/**
+ * @brief Resolve through lwIP (gethostbyname) without the cache
+ */
+static esp_err_t dns_resolve_lwip(const char *host, struct in_addr *addr)
+{
+    struct hostent *hostent = gethostbyname(host);
+    if (hostent && hostent->h_addr_list[0]) {
+        memcpy(&addr->s_addr, hostent->h_addr_list[0], sizeof(addr->s_addr));
+        return ESP_OK;
+    }
+    return ESP_FAIL;
+}
+
+/**
+ * @brief Resolve a host name or IPv4 literal
+ */
+esp_err_t dns_cache_resolve(const char *host, struct in_addr *addr)
+{
+    if (!host || !addr || host[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (inet_pton(AF_INET, host, addr) == 1) {
+        return ESP_OK;
+    }
+    if (!dns_cache_mutex || strlen(host) > DNS_CACHE_NAME_MAX_LEN) {
+        return dns_resolve_lwip(host, addr);
+    }
+
+    int64_t now = esp_timer_get_time();
+    esp_err_t cached = ESP_ERR_NOT_FINISHED;
+
+    xSemaphoreTake(dns_cache_mutex, portMAX_DELAY);
+    int idx = dns_cache_index_of(host);
+    if (idx >= 0 && dns_cache[idx].expires_us > now) {
+        dns_cache_entry_t *e = &dns_cache[idx];
+        e->hits++;
+        e->last_used_us = now;
+        if (e->negative) {
+            dns_stats.negative_hits++;
+            cached = ESP_ERR_NOT_FOUND;
+        } else {
+            dns_stats.hits++;
+            *addr = e->addr;
+            cached = ESP_OK;
+        }
+    } else {
+        dns_stats.misses++;
+    }
+    xSemaphoreGive(dns_cache_mutex);
+
+    if (cached != ESP_ERR_NOT_FINISHED) {
+        return cached;
+    }
+
+    struct in_addr server;
+    uint32_t ttl_s = CONFIG_DNS_CACHE_MAX_TTL_S;
+    uint32_t rtt_ms = 0;
+    esp_err_t err;
+
+    if (dns_get_server(&server)) {
+        err = dns_query(&server, host, addr, &ttl_s, &rtt_ms);
+        xSemaphoreTake(dns_cache_mutex, portMAX_DELAY);
+        dns_stats.last_query_ms = rtt_ms;
+        xSemaphoreGive(dns_cache_mutex);
+    } else {
+        // No server from mmipal, let lwIP try (its DNS table may be set up elsewhere)
+        err = dns_resolve_lwip(host, addr);
+    }
+
+    if (err == ESP_OK) {
+        dns_cache_store(host, addr, ttl_s < CONFIG_DNS_CACHE_MAX_TTL_S ? ttl_s : CONFIG_DNS_CACHE_MAX_TTL_S);
+    } else if (err == ESP_ERR_NOT_FOUND) {
+        dns_cache_store(host, NULL, CONFIG_DNS_CACHE_NEGATIVE_TTL_S);
+    } else {
+        xSemaphoreTake(dns_cache_mutex, portMAX_DELAY);
+        dns_stats.failures++;
+        xSemaphoreGive(dns_cache_mutex);
+    }
+    return err;
+}
+
+/**
+ * @brief Drop all entries
+ */
+void dns_cache_flush(void)
+{
+    if (!dns_cache_mutex) {
+        return;
+    }
+
+    xSemaphoreTake(dns_cache_mutex, portMAX_DELAY);
+    memset(dns_cache, 0, sizeof(dns_cache));
+    xSemaphoreGive(dns_cache_mutex);
+}
+
+/**
+ * @brief Get resolver counters
+ */
+void dns_cache_get_stats(dns_cache_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    if (!dns_cache_mutex) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(dns_cache_mutex, portMAX_DELAY);
+    *stats = dns_stats;
+    xSemaphoreGive(dns_cache_mutex);
+}
+
+/**
+ * @brief Print the cache contents and counters
+ */
+static void dns_cache_print(void)
+{
+    dns_cache_entry_t entries[CONFIG_DNS_CACHE_ENTRIES];
+    dns_cache_stats_t st;
+    int64_t now = esp_timer_get_time();
+    int count = 0;
+
+    xSemaphoreTake(dns_cache_mutex, portMAX_DELAY);
+    for (int i = 0; i < CONFIG_DNS_CACHE_ENTRIES; i++) {
+        if (dns_cache[i].in_use && dns_cache[i].expires_us > now) {
+            entries[count++] = dns_cache[i];
+        }
+    }
+    st = dns_stats;
+    xSemaphoreGive(dns_cache_mutex);
+
+    struct in_addr server;
+    printf(COLOR_CYAN "DNS cache (%d/%d entries, max TTL %ds, negative TTL %ds):\n" COLOR_RESET,
+           count, CONFIG_DNS_CACHE_ENTRIES, CONFIG_DNS_CACHE_MAX_TTL_S, CONFIG_DNS_CACHE_NEGATIVE_TTL_S);
+    printf("  Server:   %s\n", dns_get_server(&server) ? inet_ntoa(server) : "(none, using lwIP resolver)");
+    printf("  Lookups:  %lu hits, %lu negative hits, %lu misses, %lu failures\n",
+           (unsigned long)st.hits, (unsigned long)st.negative_hits,
+           (unsigned long)st.misses, (unsigned long)st.failures);
+    if (st.misses > 0) {
+        printf("  Last query round trip: %lu ms\n", (unsigned long)st.last_query_ms);
+    }
+    if (count == 0) {
+        printf(COLOR_YELLOW "  No cached names\n" COLOR_RESET);
+        return;
+    }
+
+    printf("\n%-32s %-15s %6s %5s\n", "Name", "Address", "TTL(s)", "Hits");
+    printf("-------------------------------- --------------- ------ -----\n");
+    for (int i = 0; i < count; i++) {
+        const dns_cache_entry_t *e = &entries[i];
+        printf("%-32s %-15s %6lld %5lu\n", e->name,
+               e->negative ? "(no such name)" : inet_ntoa(e->addr),
+               (long long)((e->expires_us - now) / 1000000), (unsigned long)e->hits);
+    }
+}
+
+/**
+ * @brief Console handler for 'dns [show|flush|lookup <host>]'
+ */
+static int dns_cmd(int argc, char **argv)
+{
+    if (!dns_cache_mutex) {
+        printf(COLOR_RED "DNS cache not initialized\n" COLOR_RESET);
+        return 1;
+    }
+
+    if (argc < 2 || strcmp(argv[1], "show") == 0) {
+        dns_cache_print();
+        return 0;
+    }
+    if (strcmp(argv[1], "flush") == 0) {
+        dns_cache_flush();
+        printf(COLOR_GREEN "DNS cache flushed\n" COLOR_RESET);
+        return 0;
+    }
+    if (strcmp(argv[1], "lookup") == 0 && argc >= 3) {
+        struct in_addr addr;
+        int64_t start = esp_timer_get_time();
+        esp_err_t err = dns_cache_resolve(argv[2], &addr);
+        double ms = (esp_timer_get_time() - start) / 1000.0;
+        if (err == ESP_OK) {
+            printf(COLOR_GREEN "%s -> %s" COLOR_RESET " (%.1f ms)\n", argv[2], inet_ntoa(addr), ms);
+            return 0;
+        }
+        printf(COLOR_RED "Could not resolve '%s': %s" COLOR_RESET " (%.1f ms)\n", argv[2],
+               err == ESP_ERR_NOT_FOUND ? "no such name" : esp_err_to_name(err), ms);
+        return 1;
+    }
+
+    printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+    printf("  dns [show]            - Cached names, remaining TTL and counters\n");
+    printf("  dns flush             - Drop all cached names\n");
+    printf("  dns lookup <host>     - Resolve through the cache\n");
+    return 1;
+}
+
+/**
+ * @brief Register the 'dns' console command
+ */
+void register_dns_commands(void)
+{
+    const esp_console_cmd_t dns_cmd_def = {
+        .command = "dns",
+        .help = "DNS resolver cache. Usage: dns [show] | dns flush | dns lookup <host>",
+        .hint = NULL,
+        .func = &dns_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&dns_cmd_def));
+}
@@ -0,0 +1,67 @@
+/**
+ * @file dns_cache.h
+ * @brief Shared DNS resolver cache for Halow RTOS
+ *
+ * Features:
+ * - One resolver for ping, iperf and the OTA client, so repeated lookups
+ *   of the same host skip the round trip over the HaLow link
+ * - Entries expire after the record TTL from the DNS answer, capped by
+ *   CONFIG_DNS_CACHE_MAX_TTL_S
+ * - NXDOMAIN and empty answers are cached for CONFIG_DNS_CACHE_NEGATIVE_TTL_S
+ * - Least recently used entry is replaced when the table is full
+ * - 'dns' console command to show, flush or test the cache
+ */
+
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lwip/sockets.h"
+
+#define DNS_CACHE_NAME_MAX_LEN  63
+
+// Resolver counters
+typedef struct {
+    uint32_t hits;              // Answered from a fresh positive entry
+    uint32_t negative_hits;     // Answered from a fresh negative entry
+    uint32_t misses;            // Went to the DNS server
+    uint32_t failures;          // No usable answer (timeout, server error)
+    uint32_t last_query_ms;     // Round trip of the last server query
+} dns_cache_stats_t;
+
+/**
+ * @brief Initialize the cache
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t dns_cache_init(void);
+
+/**
+ * @brief Resolve a host name or dotted IPv4 literal to an IPv4 address
+ * Blocks for up to two server round trips on a miss. Names longer than
+ * DNS_CACHE_NAME_MAX_LEN are resolved through lwIP and not cached.
+ * @param host Host name or IPv4 literal
+ * @param addr Pointer to store the address (network byte order)
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the name does not exist,
+ *         ESP_ERR_TIMEOUT if the server did not answer, ESP_FAIL otherwise
+ */
+esp_err_t dns_cache_resolve(const char *host, struct in_addr *addr);
+
+/**
+ * @brief Drop all entries
+ */
+void dns_cache_flush(void);
+
+/**
+ * @brief Get resolver counters
+ * @param stats Pointer to store the counters
+ */
+void dns_cache_get_stats(dns_cache_stats_t *stats);
+
+/**
+ * @brief Register the 'dns' console command
+ */
+void register_dns_commands(void);
+
+#endif // DNS_CACHE_H
@@ -0,0 +1,580 @@
+/**
+ * @file gpio_mirror.c
+ * @brief GPIO-over-HaLow mirroring implementation for Halow RTOS
+ *
+ * The sender hooks the GPIO monitor: an accepted edge is sent as a raw
+ * HALOW_RAW_TYPE_GPIO message from the monitor task, so the path from the
+ * ISR timestamp to mmwlan is one queue hop and one frame build. The
+ * receiver drives the output from the RX worker with task_gpio_bank_write(),
+ * which needs no lock beyond a short critical section.
+ *
+ * Every update carries the sender's boot epoch and a sequence number from
+ * one counter shared by all links of the sender. A receiver applies an
+ * update unless it is older than the last one from the same sender and
+ * epoch, so a delayed edge cannot undo a newer one and a rebooted sender is
+ * picked up straight away. Refreshes repeat the link's last sequence number
+ * with the sampled level.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "gpio_mirror.h"
+#include "gpio_monitor.h"
+#include "task_gpio.h"
+#include "halow_raw.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "gpio_mirror";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define GPIO_MIRROR_PIN_BIT(pin)    (1ULL << (pin))
+#define GPIO_MIRROR_FLAG_REFRESH    0x01
+
+// Wire format of a HALOW_RAW_TYPE_GPIO message (little endian)
+typedef struct __attribute__((packed)) {
+    uint8_t pin;            // Output pin on the receiver
+    uint8_t level;
+    uint8_t flags;          // GPIO_MIRROR_FLAG_*
+    uint8_t reserved;
+    uint16_t epoch;         // Random per sender boot
+    uint32_t seq;           // Sender-wide update counter
+} gpio_mirror_msg_t;
+
+// Sender side: one input mirrored to one peer output
+typedef struct {
+    bool in_use;
+    bool owns_watch;        // Monitoring was started by gpio_mirror_add()
+    uint8_t in_pin;
+    uint8_t remote_pin;
+    uint8_t dst[HALOW_RAW_MAC_LEN];
+    uint32_t seq;           // Sequence number of the last edge
+    uint32_t edges;         // Edges sent
+    uint32_t errors;        // Edges that could not be sent
+    uint64_t latency_sum_us;
+    uint32_t latency_max_us;
+} gpio_mirror_link_t;
+
+// Receiver side: last update applied to an accepted output
+typedef struct {
+    bool seen;
+    uint8_t src[HALOW_RAW_MAC_LEN];
+    uint16_t epoch;
+    uint32_t seq;
+    uint8_t level;
+    uint32_t applied;
+    int64_t last_us;
+} gpio_mirror_rx_pin_t;
+
+static gpio_mirror_link_t mirror_links[GPIO_MIRROR_MAX_LINKS];
+static gpio_mirror_rx_pin_t mirror_rx_pins[GPIO_MAX_PIN + 1];
+static uint64_t mirror_accept_mask = 0;
+static portMUX_TYPE mirror_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool mirror_initialized = false;
+static uint16_t mirror_epoch = 0;
+static uint32_t mirror_seq = 0;         // Protected by mirror_lock
+static esp_timer_handle_t mirror_refresh_timer = NULL;
+
+// Counters
+static uint32_t mirror_refreshes = 0;
+static uint32_t mirror_rx_stale = 0;
+static uint32_t mirror_rx_rejected = 0;
+
+/**
+ * @brief Send one level update, as its own frame or batched
+ */
+static esp_err_t gpio_mirror_send(const uint8_t *dst, uint8_t remote_pin, int level,
+                                  uint32_t seq, bool refresh)
+{
+    gpio_mirror_msg_t msg = {
+        .pin = remote_pin,
+        .level = level ? 1 : 0,
+        .flags = refresh ? GPIO_MIRROR_FLAG_REFRESH : 0,
+        .epoch = mirror_epoch,
+        .seq = seq,
+    };
+
+    if (refresh) {
+        return halow_raw_send_batched(dst, HALOW_RAW_TYPE_GPIO, &msg, sizeof(msg));
+    }
+    return halow_raw_send(dst, HALOW_RAW_TYPE_GPIO, &msg, sizeof(msg));
+}
+
+/**
+ * @brief GPIO monitor consumer: forward the edge to every link of the pin
+ */
+static void gpio_mirror_edge_cb(const gpio_monitor_event_t *event, void *arg)
+{
+    for (int i = 0; i < GPIO_MIRROR_MAX_LINKS; i++) {
+        gpio_mirror_link_t *link = &mirror_links[i];
+
+        portENTER_CRITICAL(&mirror_lock);
+        bool match = link->in_use && link->in_pin == event->pin;
+        uint8_t dst[HALOW_RAW_MAC_LEN];
+        uint8_t remote_pin = 0;
+        uint32_t seq = 0;
+        if (match) {
+            seq = link->seq = ++mirror_seq;
+            remote_pin = link->remote_pin;
+            memcpy(dst, link->dst, sizeof(dst));
+        }
+        portEXIT_CRITICAL(&mirror_lock);
+
+        if (!match) {
+            continue;
+        }
+
+        esp_err_t err = gpio_mirror_send(dst, remote_pin, event->level, seq, false);
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - event->timestamp_us);
+
+        portENTER_CRITICAL(&mirror_lock);
+        if (err == ESP_OK) {
+            link->edges++;
+            link->latency_sum_us += latency_us;
+            if (latency_us > link->latency_max_us) {
+                link->latency_max_us = latency_us;
+            }
+        } else {
+            link->errors++;
+        }
+        portEXIT_CRITICAL(&mirror_lock);
+    }
+}
+
+/**
+ * @brief Resend all input levels, batched (raw TX task)
+ */
+static void gpio_mirror_refresh(void *arg)
+{
+    bool sent = false;
+
+    for (int i = 0; i < GPIO_MIRROR_MAX_LINKS; i++) {
+        gpio_mirror_link_t *link = &mirror_links[i];
+
+        portENTER_CRITICAL(&mirror_lock);
+        bool in_use = link->in_use;
+        uint8_t in_pin = link->in_pin;
+        uint8_t remote_pin = link->remote_pin;
+        uint32_t seq = link->seq;
+        uint8_t dst[HALOW_RAW_MAC_LEN];
+        memcpy(dst, link->dst, sizeof(dst));
+        portEXIT_CRITICAL(&mirror_lock);
+
+        if (!in_use) {
+            continue;
+        }
+
+        int level = task_gpio_get_input_level(in_pin);
+        if (level >= 0 && gpio_mirror_send(dst, remote_pin, level, seq, true) == ESP_OK) {
+            sent = true;
+        }
+    }
+
+    if (sent) {
+        halow_raw_flush();
+        mirror_refreshes++;
+    }
+}
+
+/**
+ * @brief Refresh period (esp_timer task); sending could block, so defer it
+ * A refresh that does not fit in the work queue is skipped, the next one follows.
+ */
+static void gpio_mirror_refresh_cb(void *arg)
+{
+    halow_raw_defer(gpio_mirror_refresh, NULL);
+}
+
+/**
+ * @brief Raw message handler: drive an accepted output
+ */
+static void gpio_mirror_rx_handler(const halow_raw_msg_t *raw, void *arg)
+{
+    gpio_mirror_msg_t msg;
+    if (raw->len < sizeof(msg)) {
+        mirror_rx_rejected++;
+        return;
+    }
+    memcpy(&msg, raw->data, sizeof(msg));
+
+    if (msg.pin > GPIO_MAX_PIN || !(mirror_accept_mask & GPIO_MIRROR_PIN_BIT(msg.pin))) {
+        mirror_rx_rejected++;
+        return;
+    }
+
+    gpio_mirror_rx_pin_t *rp = &mirror_rx_pins[msg.pin];
+    bool same_sender = rp->seen && rp->epoch == msg.epoch &&
+                       memcmp(rp->src, raw->src, HALOW_RAW_MAC_LEN) == 0;
+    if (same_sender && (int32_t)(msg.seq - rp->seq) < 0) {
+        mirror_rx_stale++;
+        return;
+    }
+
+    uint64_t bit = GPIO_MIRROR_PIN_BIT(msg.pin);
+    if (task_gpio_bank_write(msg.level ? bit : 0, msg.level ? 0 : bit) != ESP_OK) {
+        mirror_rx_rejected++;
+        return;
+    }
+
+    rp->seen = true;
+    memcpy(rp->src, raw->src, HALOW_RAW_MAC_LEN);
+    rp->epoch = msg.epoch;
+    rp->seq = msg.seq;
+    rp->level = msg.level;
+    rp->applied++;
+    rp->last_us = raw->rx_time_us;
+}
+
+/**
+ * @brief Register the raw handler, the monitor consumer and the refresh timer
+ * Called on first use.
+ */
+static esp_err_t gpio_mirror_init(void)
+{
+    if (mirror_initialized) {
+        return ESP_OK;
+    }
+
+    mirror_epoch = (uint16_t)esp_random();
+
+    esp_err_t err = halow_raw_register_handler(HALOW_RAW_TYPE_GPIO, gpio_mirror_rx_handler, NULL);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = gpio_monitor_add_event_cb(gpio_mirror_edge_cb, NULL);
+    if (err != ESP_OK) {
+        halow_raw_unregister_handler(HALOW_RAW_TYPE_GPIO);
+        return err;
+    }
+
+#if CONFIG_HALOW_GPIO_MIRROR_REFRESH_MS > 0
+    const esp_timer_create_args_t timer_args = {
+        .callback = gpio_mirror_refresh_cb,
+        .name = "gpio_mirror",
+    };
+    err = esp_timer_create(&timer_args, &mirror_refresh_timer);
+    if (err == ESP_OK) {
+        err = esp_timer_start_periodic(mirror_refresh_timer, CONFIG_HALOW_GPIO_MIRROR_REFRESH_MS * 1000ULL);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start refresh timer: %s", esp_err_to_name(err));
+        gpio_monitor_remove_event_cb(gpio_mirror_edge_cb);
+        halow_raw_unregister_handler(HALOW_RAW_TYPE_GPIO);
+        return err;
+    }
+#endif
+
+    mirror_initialized = true;
+    ESP_LOGI(TAG, "GPIO mirror started (epoch %04x)", mirror_epoch);
+    return ESP_OK;
+}
+
+/**
+ * @brief Mirror an input pin to an output pin on a peer
+ */
+esp_err_t gpio_mirror_add(uint8_t in_pin, const uint8_t *dst, uint8_t remote_pin)
+{
+    if (!task_gpio_is_valid_pin(in_pin) || remote_pin > GPIO_MAX_PIN || !dst) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    task_gpio_pin_state_t state;
+    if (task_gpio_get_pin_state(in_pin, &state) != ESP_OK || state.direction != TASK_GPIO_DIR_INPUT) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = gpio_mirror_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Keep the user's edge and debounce settings if the pin is already watched
+    gpio_monitor_stats_t stats;
+    bool owns_watch = false;
+    if (gpio_monitor_get_stats(in_pin, &stats) != ESP_OK) {
+        err = gpio_monitor_watch(in_pin, GPIO_MONITOR_EDGE_BOTH, GPIO_MONITOR_DEBOUNCE_DEFAULT_MS);
+        if (err != ESP_OK) {
+            return err;
+        }
+        owns_watch = true;
+    }
+
+    portENTER_CRITICAL(&mirror_lock);
+    int slot = -1;
+    for (int i = 0; i < GPIO_MIRROR_MAX_LINKS; i++) {
+        if (mirror_links[i].in_use && mirror_links[i].in_pin == in_pin) {
+            slot = i;
+            owns_watch = owns_watch || mirror_links[i].owns_watch;
+            break;
+        }
+        if (slot < 0 && !mirror_links[i].in_use) {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        gpio_mirror_link_t *link = &mirror_links[slot];
+        memset(link, 0, sizeof(*link));
+        link->in_pin = in_pin;
+        link->remote_pin = remote_pin;
+        memcpy(link->dst, dst, HALOW_RAW_MAC_LEN);
+        link->owns_watch = owns_watch;
+        link->seq = ++mirror_seq;
+        link->in_use = true;
+    }
+    uint32_t seq = (slot >= 0) ? mirror_links[slot].seq : 0;
+    portEXIT_CRITICAL(&mirror_lock);
+
+    if (slot < 0) {
+        if (owns_watch) {
+            gpio_monitor_unwatch(in_pin);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Bring the peer in line with the current level straight away
+    int level = task_gpio_get_input_level(in_pin);
+    if (level >= 0) {
+        gpio_mirror_send(dst, remote_pin, level, seq, false);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop mirroring an input pin
+ */
+esp_err_t gpio_mirror_remove(uint8_t in_pin)
+{
+    bool found = false;
+    bool owns_watch = false;
+
+    portENTER_CRITICAL(&mirror_lock);
+    for (int i = 0; i < GPIO_MIRROR_MAX_LINKS; i++) {
+        if (mirror_links[i].in_use && mirror_links[i].in_pin == in_pin) {
+            owns_watch = mirror_links[i].owns_watch;
+            mirror_links[i].in_use = false;
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&mirror_lock);
+
+    if (!found) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (owns_watch) {
+        gpio_monitor_unwatch(in_pin);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Allow or refuse remote control of a local output
+ */
+esp_err_t gpio_mirror_accept(uint8_t out_pin, bool accept)
+{
+    if (!task_gpio_is_valid_pin(out_pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!accept) {
+        mirror_accept_mask &= ~GPIO_MIRROR_PIN_BIT(out_pin);
+        return ESP_OK;
+    }
+
+    if (!(task_gpio_get_output_mask() & GPIO_MIRROR_PIN_BIT(out_pin))) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = gpio_mirror_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    memset(&mirror_rx_pins[out_pin], 0, sizeof(mirror_rx_pins[out_pin]));
+    mirror_accept_mask |= GPIO_MIRROR_PIN_BIT(out_pin);
+    return ESP_OK;
+}
+
+/**
+ * @brief Reset link and receive counters
+ */
+static void gpio_mirror_reset_stats(void)
+{
+    portENTER_CRITICAL(&mirror_lock);
+    for (int i = 0; i < GPIO_MIRROR_MAX_LINKS; i++) {
+        mirror_links[i].edges = 0;
+        mirror_links[i].errors = 0;
+        mirror_links[i].latency_sum_us = 0;
+        mirror_links[i].latency_max_us = 0;
+    }
+    portEXIT_CRITICAL(&mirror_lock);
+
+    for (int pin = 0; pin <= GPIO_MAX_PIN; pin++) {
+        mirror_rx_pins[pin].applied = 0;
+    }
+    mirror_refreshes = 0;
+    mirror_rx_stale = 0;
+    mirror_rx_rejected = 0;
+}
+
+/**
+ * @brief Print links, accepted outputs and counters
+ */
+void gpio_mirror_print(void)
+{
+    int64_t now = esp_timer_get_time();
+    int shown = 0;
+
+    printf(COLOR_CYAN "GPIO mirror, outgoing:\n" COLOR_RESET);
+    printf("%-4s %-17s %-6s %8s %6s %8s %8s\n", "In", "Peer", "Remote", "Edges", "Errors", "Avg(us)", "Max(us)");
+    printf("---- ----------------- ------ -------- ------ -------- --------\n");
+    for (int i = 0; i < GPIO_MIRROR_MAX_LINKS; i++) {
+        portENTER_CRITICAL(&mirror_lock);
+        gpio_mirror_link_t link = mirror_links[i];
+        portEXIT_CRITICAL(&mirror_lock);
+        if (!link.in_use) {
+            continue;
+        }
+
+        char peer[18];
+        if (memcmp(link.dst, halow_raw_broadcast, HALOW_RAW_MAC_LEN) == 0) {
+            strcpy(peer, "broadcast");
+        } else {
+            snprintf(peer, sizeof(peer), "%02x:%02x:%02x:%02x:%02x:%02x",
+                     link.dst[0], link.dst[1], link.dst[2], link.dst[3], link.dst[4], link.dst[5]);
+        }
+        printf("%-4d %-17s %-6d %8lu %6lu %8lu %8lu\n",
+               link.in_pin, peer, link.remote_pin, (unsigned long)link.edges, (unsigned long)link.errors,
+               (unsigned long)(link.edges ? link.latency_sum_us / link.edges : 0),
+               (unsigned long)link.latency_max_us);
+        shown++;
+    }
+    if (shown == 0) {
+        printf(COLOR_YELLOW "  No inputs mirrored, use 'gpio mirror add <pin> <mac|bcast> <remote_pin>'\n" COLOR_RESET);
+    }
+#if CONFIG_HALOW_GPIO_MIRROR_REFRESH_MS > 0
+    printf("Refresh every %d ms, %lu sent\n", CONFIG_HALOW_GPIO_MIRROR_REFRESH_MS, (unsigned long)mirror_refreshes);
+#endif
+
+    shown = 0;
+    printf(COLOR_CYAN "\nGPIO mirror, incoming:\n" COLOR_RESET);
+    printf("%-4s %-17s %-5s %8s %s\n", "Out", "Last sender", "Level", "Applied", "Last(ms ago)");
+    printf("---- ----------------- ----- -------- ------------\n");
+    for (int pin = 0; pin <= GPIO_MAX_PIN; pin++) {
+        if (!(mirror_accept_mask & GPIO_MIRROR_PIN_BIT(pin))) {
+            continue;
+        }
+
+        const gpio_mirror_rx_pin_t *rp = &mirror_rx_pins[pin];
+        if (rp->seen) {
+            printf("%-4d %02x:%02x:%02x:%02x:%02x:%02x %-5s %8lu %lld\n",
+                   pin, rp->src[0], rp->src[1], rp->src[2], rp->src[3], rp->src[4], rp->src[5],
+                   rp->level ? "HIGH" : "LOW", (unsigned long)rp->applied,
+                   (long long)((now - rp->last_us) / 1000));
+        } else {
+            printf("%-4d %-17s %-5s %8lu -\n", pin, "-", "-", (unsigned long)rp->applied);
+        }
+        shown++;
+    }
+    if (shown == 0) {
+        printf(COLOR_YELLOW "  No outputs accepted, use 'gpio mirror accept <pin>'\n" COLOR_RESET);
+    }
+    printf("Stale: %lu, rejected: %lu\n", (unsigned long)mirror_rx_stale, (unsigned long)mirror_rx_rejected);
+}
+
+/**
+ * @brief Console handler for 'gpio mirror'
+ */
+int gpio_mirror_cmd(int argc, char **argv)
+{
+    if (argc < 2 || strcmp(argv[1], "status") == 0) {
+        gpio_mirror_print();
+        return 0;
+    }
+
+    const char *subcmd = argv[1];
+
+    if (strcmp(subcmd, "add") == 0) {
+        uint8_t dst[HALOW_RAW_MAC_LEN];
+        if (argc < 5 || !halow_raw_parse_mac(argv[3], dst)) {
+            printf(COLOR_RED "Error: Usage: gpio mirror add <in_pin> <aa:bb:cc:dd:ee:ff|bcast> <remote_pin>\n" COLOR_RESET);
+            return 1;
+        }
+
+        int in_pin = atoi(argv[2]);
+        int remote_pin = atoi(argv[4]);
+        if (in_pin < GPIO_MIN_PIN || in_pin > GPIO_MAX_PIN || remote_pin < GPIO_MIN_PIN || remote_pin > GPIO_MAX_PIN) {
+            printf(COLOR_RED "Error: Invalid pin number (0-%d)\n" COLOR_RESET, GPIO_MAX_PIN);
+            return 1;
+        }
+
+        esp_err_t err = gpio_mirror_add(in_pin, dst, remote_pin);
+        if (err == ESP_ERR_INVALID_STATE) {
+            printf(COLOR_RED "Error: GPIO %d must be configured as input\n" COLOR_RESET, in_pin);
+            return 1;
+        } else if (err != ESP_OK) {
+            printf(COLOR_RED "Error: Failed to mirror GPIO %d: %s\n" COLOR_RESET, in_pin, esp_err_to_name(err));
+            return 1;
+        }
+
+        printf(COLOR_GREEN "Mirroring GPIO %d to %s GPIO %d\n" COLOR_RESET, in_pin, argv[3], remote_pin);
+        return 0;
+    }
+
+    if (strcmp(subcmd, "del") == 0) {
+        if (argc < 3) {
+            printf(COLOR_RED "Error: Usage: gpio mirror del <in_pin>\n" COLOR_RESET);
+            return 1;
+        }
+        int in_pin = atoi(argv[2]);
+        if (gpio_mirror_remove(in_pin) != ESP_OK) {
+            printf(COLOR_YELLOW "GPIO %d is not mirrored\n" COLOR_RESET, in_pin);
+            return 1;
+        }
+        printf(COLOR_GREEN "Stopped mirroring GPIO %d\n" COLOR_RESET, in_pin);
+        return 0;
+    }
+
+    if (strcmp(subcmd, "accept") == 0 || strcmp(subcmd, "deny") == 0) {
+        bool accept = strcmp(subcmd, "accept") == 0;
+        if (argc < 3) {
+            printf(COLOR_RED "Error: Usage: gpio mirror %s <out_pin>\n" COLOR_RESET, subcmd);
+            return 1;
+        }
+
+        int out_pin = atoi(argv[2]);
+        esp_err_t err = (out_pin < GPIO_MIN_PIN || out_pin > GPIO_MAX_PIN) ? ESP_ERR_INVALID_ARG
+                                                                           : gpio_mirror_accept(out_pin, accept);
+        if (err == ESP_ERR_INVALID_STATE) {
+            printf(COLOR_RED "Error: GPIO %d must be configured as output\n" COLOR_RESET, out_pin);
+            return 1;
+        } else if (err != ESP_OK) {
+            printf(COLOR_RED "Error: GPIO %d is not available\n" COLOR_RESET, out_pin);
+            return 1;
+        }
+
+        printf(COLOR_GREEN "GPIO %d %s remote updates\n" COLOR_RESET, out_pin, accept ? "accepts" : "ignores");
+        return 0;
+    }
+
+    if (strcmp(subcmd, "reset") == 0) {
+        gpio_mirror_reset_stats();
+        printf(COLOR_GREEN "GPIO mirror counters reset\n" COLOR_RESET);
+        return 0;
+    }
+
+    printf(COLOR_RED "Error: Usage: gpio mirror [status|add|del|accept|deny|reset]\n" COLOR_RESET);
+    return 1;
+}
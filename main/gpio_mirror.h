@@ -0,0 +1,68 @@
+/**
+ * @file gpio_mirror.h
+ * @brief GPIO-over-HaLow mirroring for Halow RTOS
+ *
+ * Features:
+ * - Input edges on one node drive an output on a peer (or on every node)
+ *   over raw HaLow frames, without IP or MQTT in the path
+ * - Each edge is sent at once from the GPIO monitor task
+ * - Levels of all mirrored inputs are refreshed in one batched frame every
+ *   CONFIG_HALOW_GPIO_MIRROR_REFRESH_MS, so a lost frame heals itself
+ * - Receivers only drive outputs that were explicitly accepted and drop
+ *   stale or reordered updates
+ * - Per-link edge-to-TX latency and per-pin receive counters
+ */
+
+#ifndef GPIO_MIRROR_H
+#define GPIO_MIRROR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define GPIO_MIRROR_MAX_LINKS   8
+
+/**
+ * @brief Mirror an input pin to an output pin on a peer
+ * Starts edge monitoring on the input (both edges, default debounce) unless
+ * it is already monitored. Adding an input again replaces its link.
+ * @param in_pin Local input pin
+ * @param dst Peer MAC address (halow_raw_broadcast for all nodes)
+ * @param remote_pin Output pin to drive on the peer
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for bad pins,
+ *         ESP_ERR_INVALID_STATE if the pin is not an input,
+ *         ESP_ERR_NO_MEM if GPIO_MIRROR_MAX_LINKS are in use
+ */
+esp_err_t gpio_mirror_add(uint8_t in_pin, const uint8_t *dst, uint8_t remote_pin);
+
+/**
+ * @brief Stop mirroring an input pin
+ * Stops edge monitoring if gpio_mirror_add() started it.
+ * @param in_pin Local input pin
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the pin is not mirrored
+ */
+esp_err_t gpio_mirror_remove(uint8_t in_pin);
+
+/**
+ * @brief Allow or refuse remote control of a local output
+ * @param out_pin Local output pin
+ * @param accept true to let peers drive it
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad pin,
+ *         ESP_ERR_INVALID_STATE if the pin is not an output
+ */
+esp_err_t gpio_mirror_accept(uint8_t out_pin, bool accept);
+
+/**
+ * @brief Print links, accepted outputs and counters
+ */
+void gpio_mirror_print(void);
+
+/**
+ * @brief Console handler for 'gpio mirror [add|del|accept|deny|reset]'
+ * @param argc Argument count (argv[0] is "mirror")
+ * @param argv Arguments
+ * @return 0 on success, 1 on error
+ */
+int gpio_mirror_cmd(int argc, char **argv);
+
+#endif // GPIO_MIRROR_H
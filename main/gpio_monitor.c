@@ -0,0 +1,405 @@
+/**
+ * @file gpio_monitor.c
+ * @brief Interrupt-driven GPIO input monitoring implementation for Halow RTOS
+ *
+ * The ISR reads the input register and the timestamp and queues both; all
+ * filtering happens in the monitor task so the interrupt stays short even
+ * while a contact is bouncing.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "gpio_monitor.h"
+#include "task_gpio.h"
+#include "trace_buffer.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+static const char *TAG = "gpio_monitor";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define GPIO_MONITOR_QUEUE_LEN      64
+#define GPIO_MONITOR_TASK_STACK     3072
+#define GPIO_MONITOR_TASK_PRIORITY  6
+#define GPIO_MONITOR_EWMA_SHIFT     3       // Interval smoothing factor 1/8
+#define GPIO_MONITOR_IDLE_PERIODS   4       // Report 0 Hz after this many missed periods
+
+// Raw edge as queued by the ISR
+typedef struct {
+    uint8_t pin;
+    uint8_t level;
+    int64_t timestamp_us;
+} gpio_monitor_edge_evt_t;
+
+typedef struct {
+    gpio_monitor_stats_t stats;
+    float interval_us;      // Smoothed interval between accepted edges
+} gpio_monitor_pin_t;
+
+static gpio_monitor_pin_t monitor_pins[GPIO_MAX_PIN + 1];
+static portMUX_TYPE monitor_lock = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t monitor_queue = NULL;
+static TaskHandle_t monitor_task_handle = NULL;
+static volatile uint32_t monitor_queue_overflows = 0;
+
+typedef struct {
+    gpio_monitor_event_cb_t cb;
+    void *arg;
+} gpio_monitor_consumer_t;
+
+static gpio_monitor_consumer_t monitor_consumers[GPIO_MONITOR_MAX_CONSUMERS];
+
+static const char *gpio_monitor_edge_names[] = { "rising", "falling", "both" };
+
+/**
+ * @brief Edge ISR: timestamp, sample the level, queue
+ */
+static void IRAM_ATTR gpio_monitor_isr(void *arg)
+{
+    uint32_t pin = (uint32_t)(uintptr_t)arg;
+    TRACE_EVENT(TRACE_EV_GPIO_EDGE, pin);
+    gpio_monitor_edge_evt_t evt = {
+        .pin = (uint8_t)pin,
+        .timestamp_us = esp_timer_get_time(),
+    };
+    uint32_t in = (pin < 32) ? REG_READ(GPIO_IN_REG) >> pin : REG_READ(GPIO_IN1_REG) >> (pin - 32);
+    evt.level = in & 1;
+
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(monitor_queue, &evt, &woken) != pdTRUE) {
+        monitor_queue_overflows++;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Estimated signal frequency from the smoothed edge interval
+ * Caller holds monitor_lock.
+ */
+static float gpio_monitor_frequency(const gpio_monitor_pin_t *mp, int64_t now_us)
+{
+    if (mp->interval_us <= 0 || mp->stats.last_us == 0 ||
+        (now_us - mp->stats.last_us) > (int64_t)(mp->interval_us * GPIO_MONITOR_IDLE_PERIODS)) {
+        return 0.0f;
+    }
+
+    // With both edges subscribed, two edges make one period
+    float edges_per_period = (mp->stats.edge == GPIO_MONITOR_EDGE_BOTH) ? 2.0f : 1.0f;
+    return 1e6f / (mp->interval_us * edges_per_period);
+}
+
+/**
+ * @brief Monitor task: debounce, count and forward edges
+ */
+static void gpio_monitor_task(void *pvParameters)
+{
+    gpio_monitor_edge_evt_t evt;
+
+    while (1) {
+        if (xQueueReceive(monitor_queue, &evt, portMAX_DELAY) != pdTRUE || evt.pin > GPIO_MAX_PIN) {
+            continue;
+        }
+
+        gpio_monitor_pin_t *mp = &monitor_pins[evt.pin];
+        gpio_monitor_event_t out;
+        bool accepted = false;
+
+        portENTER_CRITICAL(&monitor_lock);
+        gpio_monitor_stats_t *s = &mp->stats;
+        if (s->active) {
+            int64_t dt = evt.timestamp_us - s->last_us;
+            // Single-edge subscriptions know the polarity, the sampled level may already have bounced
+            int level = (s->edge == GPIO_MONITOR_EDGE_RISING) ? 1 :
+                        (s->edge == GPIO_MONITOR_EDGE_FALLING) ? 0 : evt.level;
+            bool bounce = s->last_us != 0 &&
+                          (dt < (int64_t)s->debounce_ms * 1000 ||
+                           (s->edge == GPIO_MONITOR_EDGE_BOTH && level == s->level));
+
+            if (bounce) {
+                s->bounced++;
+            } else {
+                if (s->last_us != 0) {
+                    mp->interval_us = (mp->interval_us > 0)
+                        ? mp->interval_us + ((float)dt - mp->interval_us) / (1 << GPIO_MONITOR_EWMA_SHIFT)
+                        : (float)dt;
+                }
+                s->count++;
+                s->level = level;
+                s->last_us = evt.timestamp_us;
+                s->frequency_hz = gpio_monitor_frequency(mp, evt.timestamp_us);
+
+                out.pin = evt.pin;
+                out.level = level;
+                out.timestamp_us = evt.timestamp_us;
+                out.count = s->count;
+                out.frequency_hz = s->frequency_hz;
+                accepted = true;
+            }
+        }
+        gpio_monitor_consumer_t consumers[GPIO_MONITOR_MAX_CONSUMERS];
+        if (accepted) {
+            memcpy(consumers, monitor_consumers, sizeof(consumers));
+        }
+        portEXIT_CRITICAL(&monitor_lock);
+
+        if (accepted) {
+            for (int i = 0; i < GPIO_MONITOR_MAX_CONSUMERS; i++) {
+                if (consumers[i].cb) {
+                    consumers[i].cb(&out, consumers[i].arg);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Initialize edge monitoring
+ */
+esp_err_t gpio_monitor_init(void)
+{
+    if (monitor_task_handle) {
+        return ESP_OK;
+    }
+
+    monitor_queue = xQueueCreate(GPIO_MONITOR_QUEUE_LEN, sizeof(gpio_monitor_edge_evt_t));
+    if (!monitor_queue) {
+        ESP_LOGE(TAG, "Failed to create edge queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // The HaLow HAL may already have installed the ISR service
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(err));
+        vQueueDelete(monitor_queue);
+        monitor_queue = NULL;
+        return err;
+    }
+
+    for (int pin = 0; pin <= GPIO_MAX_PIN; pin++) {
+        monitor_pins[pin].stats.pin = pin;
+    }
+
+    if (xTaskCreate(gpio_monitor_task, "gpio_mon", GPIO_MONITOR_TASK_STACK, NULL,
+                    GPIO_MONITOR_TASK_PRIORITY, &monitor_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create monitor task");
+        vQueueDelete(monitor_queue);
+        monitor_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "GPIO edge monitor started");
+    return ESP_OK;
+}
+
+/**
+ * @brief Subscribe to edges on an input pin
+ */
+esp_err_t gpio_monitor_watch(uint8_t pin, gpio_monitor_edge_t edge, uint32_t debounce_ms)
+{
+    if (!task_gpio_is_valid_pin(pin) || edge > GPIO_MONITOR_EDGE_BOTH ||
+        debounce_ms > GPIO_MONITOR_DEBOUNCE_MAX_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    task_gpio_pin_state_t state;
+    if (task_gpio_get_pin_state(pin, &state) != ESP_OK || state.direction != TASK_GPIO_DIR_INPUT) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = gpio_monitor_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    gpio_monitor_pin_t *mp = &monitor_pins[pin];
+    bool was_active = mp->stats.active;
+
+    portENTER_CRITICAL(&monitor_lock);
+    memset(&mp->stats, 0, sizeof(mp->stats));
+    mp->stats.pin = pin;
+    mp->stats.active = true;
+    mp->stats.edge = edge;
+    mp->stats.debounce_ms = debounce_ms;
+    mp->stats.level = state.level;
+    mp->interval_us = 0;
+    portEXIT_CRITICAL(&monitor_lock);
+
+    static const gpio_int_type_t intr_types[] = { GPIO_INTR_POSEDGE, GPIO_INTR_NEGEDGE, GPIO_INTR_ANYEDGE };
+    err = gpio_set_intr_type(pin, intr_types[edge]);
+    if (err == ESP_OK && !was_active) {
+        err = gpio_isr_handler_add(pin, gpio_monitor_isr, (void *)(uintptr_t)pin);
+    }
+    if (err == ESP_OK) {
+        err = gpio_intr_enable(pin);
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable interrupt on GPIO %d: %s", pin, esp_err_to_name(err));
+        gpio_monitor_unwatch(pin);
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Monitoring GPIO %d (%s edges, debounce %lu ms)",
+             pin, gpio_monitor_edge_names[edge], (unsigned long)debounce_ms);
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop monitoring a pin
+ */
+esp_err_t gpio_monitor_unwatch(uint8_t pin)
+{
+    if (pin > GPIO_MAX_PIN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&monitor_lock);
+    bool was_active = monitor_pins[pin].stats.active;
+    monitor_pins[pin].stats.active = false;
+    portEXIT_CRITICAL(&monitor_lock);
+
+    if (!was_active) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    gpio_intr_disable(pin);
+    gpio_set_intr_type(pin, GPIO_INTR_DISABLE);
+    gpio_isr_handler_remove(pin);
+    return ESP_OK;
+}
+
+/**
+ * @brief Register an event consumer
+ */
+esp_err_t gpio_monitor_add_event_cb(gpio_monitor_event_cb_t cb, void *arg)
+{
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&monitor_lock);
+    int slot = -1;
+    for (int i = 0; i < GPIO_MONITOR_MAX_CONSUMERS; i++) {
+        if (monitor_consumers[i].cb == cb) {
+            slot = i;
+            break;
+        }
+        if (slot < 0 && monitor_consumers[i].cb == NULL) {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        monitor_consumers[slot].cb = cb;
+        monitor_consumers[slot].arg = arg;
+        err = ESP_OK;
+    }
+    portEXIT_CRITICAL(&monitor_lock);
+
+    return err;
+}
+
+/**
+ * @brief Remove an event consumer
+ */
+void gpio_monitor_remove_event_cb(gpio_monitor_event_cb_t cb)
+{
+    portENTER_CRITICAL(&monitor_lock);
+    for (int i = 0; i < GPIO_MONITOR_MAX_CONSUMERS; i++) {
+        if (monitor_consumers[i].cb == cb) {
+            monitor_consumers[i].cb = NULL;
+            monitor_consumers[i].arg = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&monitor_lock);
+}
+
+/**
+ * @brief Get statistics for a monitored pin
+ */
+esp_err_t gpio_monitor_get_stats(uint8_t pin, gpio_monitor_stats_t *stats)
+{
+    if (pin > GPIO_MAX_PIN || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&monitor_lock);
+    *stats = monitor_pins[pin].stats;
+    stats->frequency_hz = gpio_monitor_frequency(&monitor_pins[pin], now);
+    portEXIT_CRITICAL(&monitor_lock);
+
+    return stats->active ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief Reset counters of all monitored pins
+ */
+void gpio_monitor_reset_stats(void)
+{
+    portENTER_CRITICAL(&monitor_lock);
+    for (int pin = 0; pin <= GPIO_MAX_PIN; pin++) {
+        gpio_monitor_pin_t *mp = &monitor_pins[pin];
+        mp->stats.count = 0;
+        mp->stats.bounced = 0;
+        mp->stats.last_us = 0;
+        mp->stats.frequency_hz = 0;
+        mp->interval_us = 0;
+    }
+    monitor_queue_overflows = 0;
+    portEXIT_CRITICAL(&monitor_lock);
+}
+
+/**
+ * @brief Print statistics for all monitored pins
+ */
+void gpio_monitor_print(void)
+{
+    int64_t now = esp_timer_get_time();
+    int shown = 0;
+
+    printf(COLOR_CYAN "GPIO edge monitor:\n" COLOR_RESET);
+    printf("%-4s %-7s %-8s %10s %8s %10s %-5s %s\n",
+           "Pin", "Edge", "Debounce", "Count", "Bounced", "Freq(Hz)", "Level", "Last(ms ago)");
+    printf("---- ------- -------- ---------- -------- ---------- ----- ------------\n");
+
+    for (int pin = 0; pin <= GPIO_MAX_PIN; pin++) {
+        gpio_monitor_stats_t s;
+        if (gpio_monitor_get_stats(pin, &s) != ESP_OK) {
+            continue;
+        }
+
+        char last[16];
+        if (s.last_us != 0) {
+            snprintf(last, sizeof(last), "%lld", (long long)((now - s.last_us) / 1000));
+        } else {
+            strcpy(last, "-");
+        }
+
+        printf("%-4d %-7s %5lums %10lu %8lu %10.2f %-5s %s\n",
+               pin, gpio_monitor_edge_names[s.edge], (unsigned long)s.debounce_ms,
+               (unsigned long)s.count, (unsigned long)s.bounced, s.frequency_hz,
+               s.level ? "HIGH" : "LOW", last);
+        shown++;
+    }
+
+    if (shown == 0) {
+        printf(COLOR_YELLOW "  No pins monitored, use 'gpio watch <pin>'\n" COLOR_RESET);
+    }
+    if (monitor_queue_overflows > 0) {
+        printf(COLOR_YELLOW "Edge queue overflows: %lu\n" COLOR_RESET, (unsigned long)monitor_queue_overflows);
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * @file gpio_monitor.h
+ * @brief Interrupt-driven GPIO input monitoring for Halow RTOS
+ *
+ * Features:
+ * - Per-pin edge subscriptions (rising, falling or both)
+ * - ISR only timestamps the edge and queues it
+ * - Monitor task applies software debouncing per pin
+ * - Pulse counts and frequency estimates per pin
+ * - Accepted events forwarded to registered consumers (MQTT telemetry, GPIO mirror)
+ */
+
+#ifndef GPIO_MONITOR_H
+#define GPIO_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define GPIO_MONITOR_DEBOUNCE_DEFAULT_MS    20
+#define GPIO_MONITOR_DEBOUNCE_MAX_MS        10000
+#define GPIO_MONITOR_MAX_CONSUMERS          4
+
+// Edge selection
+typedef enum {
+    GPIO_MONITOR_EDGE_RISING = 0,
+    GPIO_MONITOR_EDGE_FALLING = 1,
+    GPIO_MONITOR_EDGE_BOTH = 2
+} gpio_monitor_edge_t;
+
+// Debounced edge event
+typedef struct {
+    uint8_t pin;
+    int level;              // Level sampled in the ISR (1 = rising edge, 0 = falling edge)
+    int64_t timestamp_us;   // esp_timer timestamp taken in the ISR
+    uint32_t count;         // Accepted edges since the subscription started
+    float frequency_hz;     // Current frequency estimate
+} gpio_monitor_event_t;
+
+// Per-pin statistics
+typedef struct {
+    uint8_t pin;
+    bool active;
+    gpio_monitor_edge_t edge;
+    uint32_t debounce_ms;
+    uint32_t count;         // Accepted edges
+    uint32_t bounced;       // Edges rejected by the debouncer
+    int level;              // Level of the last accepted edge
+    int64_t last_us;        // Timestamp of the last accepted edge, 0 if none
+    float frequency_hz;     // Smoothed accepted-edge rate, 0 when idle
+} gpio_monitor_stats_t;
+
+/**
+ * @brief Event consumer, called from the monitor task
+ * @param event Debounced event
+ * @param arg User argument given at registration
+ */
+typedef void (*gpio_monitor_event_cb_t)(const gpio_monitor_event_t *event, void *arg);
+
+/**
+ * @brief Initialize edge monitoring (queue, monitor task, GPIO ISR service)
+ * Called on the first subscription; safe to call again.
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t gpio_monitor_init(void);
+
+/**
+ * @brief Subscribe to edges on an input pin
+ * Re-subscribing an active pin updates its edge/debounce and resets its counters.
+ * @param pin GPIO pin number (must be configured as input)
+ * @param edge Edges to report
+ * @param debounce_ms Minimum time between accepted edges
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for bad arguments,
+ *         ESP_ERR_INVALID_STATE if the pin is an output
+ */
+esp_err_t gpio_monitor_watch(uint8_t pin, gpio_monitor_edge_t edge, uint32_t debounce_ms);
+
+/**
+ * @brief Stop monitoring a pin
+ * @param pin GPIO pin number
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the pin was not monitored
+ */
+esp_err_t gpio_monitor_unwatch(uint8_t pin);
+
+/**
+ * @brief Register an event consumer
+ * Adding a callback that is already registered only updates its argument.
+ * @param cb Callback
+ * @param arg User argument
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if cb is NULL,
+ *         ESP_ERR_NO_MEM if GPIO_MONITOR_MAX_CONSUMERS are registered
+ */
+esp_err_t gpio_monitor_add_event_cb(gpio_monitor_event_cb_t cb, void *arg);
+
+/**
+ * @brief Remove an event consumer
+ * @param cb Callback passed to gpio_monitor_add_event_cb()
+ */
+void gpio_monitor_remove_event_cb(gpio_monitor_event_cb_t cb);
+
+/**
+ * @brief Get statistics for a monitored pin
+ * @param pin GPIO pin number
+ * @param stats Pointer to store statistics
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the pin is not monitored
+ */
+esp_err_t gpio_monitor_get_stats(uint8_t pin, gpio_monitor_stats_t *stats);
+
+/**
+ * @brief Reset counters of all monitored pins
+ */
+void gpio_monitor_reset_stats(void);
+
+/**
+ * @brief Print statistics for all monitored pins
+ */
+void gpio_monitor_print(void);
+
+#endif // GPIO_MONITOR_H
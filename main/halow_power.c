@@ -0,0 +1,378 @@
+/**
+ * @file halow_power.c
+ * @brief HaLow power profiles implementation for Halow RTOS
+ *
+ * mmwlan keeps the power save mode across associations, while the listen
+ * interval and the TWT agreement request are only read when the STA
+ * associates. Profiles are therefore applied in two steps: the power save
+ * mode after boot (and immediately on a runtime switch), the rest right
+ * before mmwlan_sta_enable().
+ *
+ * Wake latency is measured with ICMP echoes to the gateway, each sent after
+ * a randomised idle gap. While the STA sleeps the AP buffers the reply until
+ * the next wake-up (DTIM beacon or TWT service period), so the RTT is the
+ * link RTT plus a delay spread evenly over one sleep period: the sleep period
+ * is about twice the mean excess over the fastest probe. mmwlan reports no
+ * awake time, so the duty cycle is the expected awake window per wake-up
+ * over that measured period.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "halow_power.h"
+#include "halow_scan_cache.h"
+#include "task_halow.h"
+#include "task_tool.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mmwlan.h"
+#include "mmipal.h"
+
+static const char *TAG = "halow_power";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_BOLD      "\033[1m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define HALOW_POWER_TU_US               1024
+#define HALOW_POWER_DEFAULT_BEACON_TU   100     // Used when the BSS was not scanned
+#define HALOW_POWER_ACTIVE_PERIOD_MS    100     // Idle gap base for the always-on profile
+#define HALOW_POWER_MAX_GAP_MS          10000
+#define HALOW_POWER_PROBE_TIMEOUT_MS    2000    // On top of the expected sleep period
+#define HALOW_POWER_DEFAULT_PROBES      5
+#define HALOW_POWER_MAX_PROBES          50
+
+static const char *profile_names[HALOW_POWER_PROFILE_COUNT] = {
+    [HALOW_POWER_ACTIVE] = "active",
+    [HALOW_POWER_PS]     = "ps",
+    [HALOW_POWER_TWT]    = "twt",
+};
+
+static halow_power_profile_t power_profile = HALOW_POWER_ACTIVE;
+static halow_power_result_t power_results[HALOW_POWER_PROFILE_COUNT];
+
+/**
+ * @brief Get the profile selected by a HaLow configuration
+ */
+halow_power_profile_t halow_power_profile_from_config(const halow_wifi_config_t *cfg)
+{
+    if (!cfg || !cfg->low_power_mode) {
+        return HALOW_POWER_ACTIVE;
+    }
+    return cfg->low_power_profile == HALOW_POWER_TWT ? HALOW_POWER_TWT : HALOW_POWER_PS;
+}
+
+/**
+ * @brief Get the profile currently applied to the radio
+ */
+halow_power_profile_t halow_power_get_profile(void)
+{
+    return power_profile;
+}
+
+/**
+ * @brief Get the display name of a profile
+ */
+const char *halow_power_profile_name(halow_power_profile_t profile)
+{
+    return profile < HALOW_POWER_PROFILE_COUNT ? profile_names[profile] : "unknown";
+}
+
+/**
+ * @brief Profile from the stored configuration
+ */
+static halow_power_profile_t halow_power_configured(void)
+{
+    halow_wifi_config_t cfg;
+    if (config_load_halow_wifi(&cfg) != ESP_OK) {
+        return HALOW_POWER_ACTIVE;
+    }
+    return halow_power_profile_from_config(&cfg);
+}
+
+/**
+ * @brief Set the mmwlan power save mode for a profile
+ */
+static esp_err_t halow_power_set_ps(halow_power_profile_t profile)
+{
+    enum mmwlan_ps_mode mode = profile == HALOW_POWER_ACTIVE ? MMWLAN_PS_DISABLED : MMWLAN_PS_ENABLED;
+    enum mmwlan_status status = mmwlan_set_power_save_mode(mode);
+    if (status != MMWLAN_SUCCESS) {
+        ESP_LOGE(TAG, "Failed to set power save mode %d: status %d", mode, status);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Apply the configured power save mode after the interface booted
+ */
+esp_err_t halow_power_apply_start(void)
+{
+    power_profile = halow_power_configured();
+    ESP_LOGI(TAG, "Power profile: %s", halow_power_profile_name(power_profile));
+    return halow_power_set_ps(power_profile);
+}
+
+/**
+ * @brief Apply listen interval and TWT settings before an association
+ */
+esp_err_t halow_power_apply_connect(void)
+{
+    esp_err_t err = ESP_OK;
+    power_profile = halow_power_configured();
+
+    if (power_profile != HALOW_POWER_ACTIVE &&
+        mmwlan_set_listen_interval(CONFIG_HALOW_PS_LISTEN_INTERVAL) != MMWLAN_SUCCESS) {
+        ESP_LOGW(TAG, "Failed to set listen interval %d", CONFIG_HALOW_PS_LISTEN_INTERVAL);
+        err = ESP_FAIL;
+    }
+
+    // A disabled configuration withdraws a TWT request left by an earlier profile
+    struct mmwlan_twt_config_args twt = {
+        .twt_mode = power_profile == HALOW_POWER_TWT ? MMWLAN_TWT_REQUESTER : MMWLAN_TWT_DISABLED,
+        .twt_wake_interval_us = (uint64_t)CONFIG_HALOW_TWT_WAKE_INTERVAL_MS * 1000,
+        .twt_min_wake_duration_us = CONFIG_HALOW_TWT_MIN_WAKE_DURATION_US,
+        .twt_setup_command = MMWLAN_TWT_SETUP_REQUEST,
+    };
+    enum mmwlan_status status = mmwlan_twt_add_configuration(&twt);
+    if (status != MMWLAN_SUCCESS && power_profile == HALOW_POWER_TWT) {
+        ESP_LOGE(TAG, "Failed to configure TWT: status %d", status);
+        err = ESP_FAIL;
+    }
+
+    if (halow_power_set_ps(power_profile) != ESP_OK) {
+        err = ESP_FAIL;
+    }
+    return err;
+}
+
+/**
+ * @brief Switch profile at runtime and store it in the HaLow configuration
+ */
+esp_err_t halow_power_set_profile(halow_power_profile_t profile)
+{
+    if (profile >= HALOW_POWER_PROFILE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    halow_wifi_config_t cfg;
+    config_load_halow_wifi(&cfg);
+    halow_power_profile_t previous = halow_power_profile_from_config(&cfg);
+
+    cfg.low_power_mode = profile != HALOW_POWER_ACTIVE;
+    if (profile != HALOW_POWER_ACTIVE) {
+        cfg.low_power_profile = profile;
+    }
+    esp_err_t err = config_save_halow_wifi(&cfg);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (!halow_is_started()) {
+        return ESP_OK;  // Applied by the next halow_start()
+    }
+
+    // TWT is negotiated during association: reassociate through the state machine,
+    // the reconnect applies the saved profile
+    if ((previous == HALOW_POWER_TWT) != (profile == HALOW_POWER_TWT) &&
+        halow_get_conn_state() != HALOW_CONN_IDLE) {
+        err = halow_reassociate_async();
+        if (err == ESP_OK) {
+            printf("Reassociating to %s TWT agreement...\n", profile == HALOW_POWER_TWT ? "request a" : "drop the");
+            return ESP_OK;
+        }
+        printf("TWT change applies at the next connect (%s)\n", esp_err_to_name(err));
+    }
+
+    power_profile = profile;
+    return halow_power_set_ps(profile);
+}
+
+/**
+ * @brief Expected sleep period of the active profile in milliseconds
+ */
+static uint32_t halow_power_expected_period_ms(void)
+{
+    switch (power_profile) {
+    case HALOW_POWER_PS: {
+        uint32_t beacon_tu = HALOW_POWER_DEFAULT_BEACON_TU;
+        uint8_t bssid[MMWLAN_MAC_ADDR_LEN];
+        halow_scan_entry_t bss;
+        if (mmwlan_get_bssid(bssid) == MMWLAN_SUCCESS && halow_scan_cache_find_bssid(bssid, &bss) &&
+            bss.beacon_interval > 0) {
+            beacon_tu = bss.beacon_interval;
+        }
+        return beacon_tu * HALOW_POWER_TU_US * CONFIG_HALOW_PS_LISTEN_INTERVAL / 1000;
+    }
+    case HALOW_POWER_TWT:
+        return CONFIG_HALOW_TWT_WAKE_INTERVAL_MS;
+    default:
+        return HALOW_POWER_ACTIVE_PERIOD_MS;
+    }
+}
+
+/**
+ * @brief Measure wake latency of the active profile against the gateway
+ */
+esp_err_t halow_power_measure(int probes, halow_power_result_t *result)
+{
+    struct mmipal_ip_config ip_config;
+    if (!halow_is_started() || mmipal_get_ip_config(&ip_config) != MMIPAL_SUCCESS ||
+        ip_config.gateway_addr[0] == '\0' || strcmp(ip_config.gateway_addr, "0.0.0.0") == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (probes <= 0) {
+        probes = HALOW_POWER_DEFAULT_PROBES;
+    }
+    if (probes > HALOW_POWER_MAX_PROBES) {
+        probes = HALOW_POWER_MAX_PROBES;
+    }
+
+    uint32_t period_ms = halow_power_expected_period_ms();
+    halow_power_result_t r = { .probes = probes };
+    uint64_t sum_us = 0;
+    uint32_t min_us = UINT32_MAX;
+
+    printf("Probing %s %d times (%s, expected sleep period %lu ms)...\n", ip_config.gateway_addr, probes,
+           halow_power_profile_name(power_profile), (unsigned long)(power_profile == HALOW_POWER_ACTIVE ? 0 : period_ms));
+
+    for (int i = 0; i < probes; i++) {
+        // Idle long enough for the STA to doze, landing anywhere in the next period
+        uint32_t gap_ms = period_ms + esp_random() % period_ms;
+        if (gap_ms > HALOW_POWER_MAX_GAP_MS) {
+            gap_ms = HALOW_POWER_MAX_GAP_MS;
+        }
+        vTaskDelay(pdMS_TO_TICKS(gap_ms));
+
+        uint32_t rtt_us;
+        if (task_tool_ping_once(ip_config.gateway_addr, 0, period_ms + HALOW_POWER_PROBE_TIMEOUT_MS, &rtt_us) != 0) {
+            printf("  probe %d: " COLOR_YELLOW "timeout" COLOR_RESET "\n", i + 1);
+            continue;
+        }
+        printf("  probe %d: %.1f ms\n", i + 1, rtt_us / 1000.0);
+
+        r.replies++;
+        sum_us += rtt_us;
+        min_us = rtt_us < min_us ? rtt_us : min_us;
+        r.latency_max_us = rtt_us > r.latency_max_us ? rtt_us : r.latency_max_us;
+    }
+
+    if (r.replies == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    r.valid = true;
+    r.latency_avg_us = (uint32_t)(sum_us / r.replies);
+    if (power_profile == HALOW_POWER_ACTIVE) {
+        r.duty_permille = 1000;
+    } else {
+        // Uniform wake delay over one period: mean excess is half the period
+        r.wake_period_us = 2 * (r.latency_avg_us - min_us);
+        if (r.replies < 2 || r.wake_period_us == 0) {
+            r.wake_period_us = period_ms * 1000;
+        }
+        uint32_t awake_us = power_profile == HALOW_POWER_TWT ? CONFIG_HALOW_TWT_MIN_WAKE_DURATION_US
+                                                             : CONFIG_HALOW_PS_AWAKE_WINDOW_US;
+        uint64_t duty = (uint64_t)awake_us * 1000 / r.wake_period_us;
+        r.duty_permille = duty > 1000 ? 1000 : (uint32_t)duty;
+    }
+
+    power_results[power_profile] = r;
+    if (result) {
+        *result = r;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Print the active profile and the last measurement of every profile
+ */
+static void halow_power_print_status(void)
+{
+    halow_power_profile_t configured = halow_power_configured();
+
+    printf("\n" COLOR_CYAN COLOR_BOLD "=== HALOW POWER ===" COLOR_RESET "\n\n");
+    printf("Profile:     %s", halow_power_profile_name(power_profile));
+    if (configured != power_profile) {
+        printf(" (configured: %s, applied on next start/connect)", halow_power_profile_name(configured));
+    }
+    printf("\n");
+    printf("PS:          listen interval %d beacons, awake window ~%d us per DTIM\n",
+           CONFIG_HALOW_PS_LISTEN_INTERVAL, CONFIG_HALOW_PS_AWAKE_WINDOW_US);
+    printf("TWT:         wake interval %d ms, min wake duration %d us\n\n",
+           CONFIG_HALOW_TWT_WAKE_INTERVAL_MS, CONFIG_HALOW_TWT_MIN_WAKE_DURATION_US);
+
+    printf(COLOR_YELLOW "%-8s %7s %12s %12s %12s %8s" COLOR_RESET "\n",
+           "Profile", "Replies", "Latency avg", "Latency max", "Wake period", "Duty");
+    for (int p = 0; p < HALOW_POWER_PROFILE_COUNT; p++) {
+        const halow_power_result_t *r = &power_results[p];
+        if (!r->valid) {
+            printf("%-8s %7s %12s %12s %12s %8s\n", profile_names[p], "-", "-", "-", "-", "-");
+            continue;
+        }
+        char period[16];
+        if (r->wake_period_us) {
+            snprintf(period, sizeof(period), "%.1f ms", r->wake_period_us / 1000.0);
+        } else {
+            snprintf(period, sizeof(period), "awake");
+        }
+        printf("%-8s %3u/%-3u %9.1f ms %9.1f ms %12s %6.1f%%\n", profile_names[p], r->replies, r->probes,
+               r->latency_avg_us / 1000.0, r->latency_max_us / 1000.0, period, r->duty_permille / 10.0);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Console handler for 'halow power [active|ps|twt|measure [n]]'
+ */
+int halow_power_cmd(int argc, char **argv)
+{
+    if (argc < 2) {
+        halow_power_print_status();
+        return 0;
+    }
+
+    const char *subcmd = argv[1];
+
+    if (strcmp(subcmd, "measure") == 0) {
+        halow_power_result_t r;
+        esp_err_t err = halow_power_measure(argc > 2 ? atoi(argv[2]) : 0, &r);
+        if (err == ESP_ERR_INVALID_STATE) {
+            printf(COLOR_RED "Not connected (need a gateway address)\n" COLOR_RESET);
+            return 1;
+        } else if (err != ESP_OK) {
+            printf(COLOR_RED "No probe was answered\n" COLOR_RESET);
+            return 1;
+        }
+        halow_power_print_status();
+        return 0;
+    }
+
+    for (int p = 0; p < HALOW_POWER_PROFILE_COUNT; p++) {
+        if (strcmp(subcmd, profile_names[p]) == 0) {
+            if (halow_power_set_profile((halow_power_profile_t)p) != ESP_OK) {
+                printf(COLOR_RED "Failed to switch to %s\n" COLOR_RESET, profile_names[p]);
+                return 1;
+            }
+            printf(COLOR_GREEN "Power profile: %s\n" COLOR_RESET, profile_names[p]);
+            return 0;
+        }
+    }
+
+    printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+    printf("  halow power             - Show profile and measured latency/duty per profile\n");
+    printf("  halow power active      - Radio always on (lowest latency)\n");
+    printf("  halow power ps          - Power save, wake for DTIM beacons\n");
+    printf("  halow power twt         - Power save with TWT service periods (reassociates)\n");
+    printf("  halow power measure [n] - Measure wake latency with n idle-spaced probes (default %d)\n",
+           HALOW_POWER_DEFAULT_PROBES);
+    return 1;
+}
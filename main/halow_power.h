@@ -0,0 +1,99 @@
+/**
+ * @file halow_power.h
+ * @brief HaLow power profiles for Halow RTOS
+ *
+ * Features:
+ * - Three profiles: always-on (lowest latency), 802.11 power save with
+ *   DTIM/listen interval, and scheduled TWT service periods
+ * - Selected by halow_wifi_config_t.low_power_mode / low_power_profile
+ * - Applied at halow_start() (power save mode) and before every association
+ *   (listen interval, TWT agreement request)
+ * - Wake latency measurement with idle-spaced echo probes to the gateway
+ */
+
+#ifndef HALOW_POWER_H
+#define HALOW_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "config_manager.h"
+
+typedef enum {
+    HALOW_POWER_ACTIVE = 0,     // Radio always on
+    HALOW_POWER_PS,             // Power save, wakes for DTIM beacons
+    HALOW_POWER_TWT,            // Power save with a negotiated TWT schedule
+    HALOW_POWER_PROFILE_COUNT
+} halow_power_profile_t;
+
+// Result of the last measurement of a profile
+typedef struct {
+    bool valid;
+    uint8_t probes;             // Echo probes sent
+    uint8_t replies;            // Echo replies received
+    uint32_t latency_avg_us;    // Mean round trip time after an idle gap
+    uint32_t latency_max_us;    // Worst round trip time
+    uint32_t wake_period_us;    // Sleep period derived from the latency spread, 0 if awake
+    uint32_t duty_permille;     // Estimated radio awake share (1000 = always on)
+} halow_power_result_t;
+
+/**
+ * @brief Get the profile selected by a HaLow configuration
+ * @param cfg HaLow configuration
+ * @return Selected profile
+ */
+halow_power_profile_t halow_power_profile_from_config(const halow_wifi_config_t *cfg);
+
+/**
+ * @brief Get the profile currently applied to the radio
+ * @return Active profile
+ */
+halow_power_profile_t halow_power_get_profile(void);
+
+/**
+ * @brief Get the display name of a profile
+ * @param profile Profile
+ * @return Static name string
+ */
+const char *halow_power_profile_name(halow_power_profile_t profile);
+
+/**
+ * @brief Apply the configured power save mode after the interface booted
+ * @return ESP_OK on success, ESP_FAIL if mmwlan rejected the mode
+ */
+esp_err_t halow_power_apply_start(void);
+
+/**
+ * @brief Apply listen interval and TWT settings before an association
+ * @return ESP_OK on success, ESP_FAIL if mmwlan rejected a setting
+ */
+esp_err_t halow_power_apply_connect(void);
+
+/**
+ * @brief Switch profile at runtime and store it in the HaLow configuration
+ * Power save is toggled immediately. Entering or leaving TWT needs a new
+ * association: when connected to the saved network, reassociates through
+ * the connection state machine, otherwise applies at the next connect.
+ * @param profile Profile to select
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t halow_power_set_profile(halow_power_profile_t profile);
+
+/**
+ * @brief Measure wake latency of the active profile against the gateway
+ * @param probes Number of probes (each preceded by an idle gap)
+ * @param result Pointer to store the result (also kept for 'halow power')
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not connected,
+ *         ESP_ERR_TIMEOUT if no probe was answered
+ */
+esp_err_t halow_power_measure(int probes, halow_power_result_t *result);
+
+/**
+ * @brief Console handler for 'halow power [active|ps|twt|measure [n]]'
+ * @param argc Argument count (argv[0] is "power")
+ * @param argv Arguments
+ * @return 0 on success, 1 on error
+ */
+int halow_power_cmd(int argc, char **argv);
+
+#endif // HALOW_POWER_H
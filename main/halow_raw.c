@@ -0,0 +1,926 @@
+/**
+ * @file halow_raw.c
+ * @brief Custom-ethertype peer messaging implementation for Halow RTOS
+ *
+ * A message costs one mmwlan TX call and one pass through the RX pipeline,
+ * with no socket, lwIP or MQTT state on either side. Frames are plain 802.3
+ * frames, so the AP relays them between stations like any other traffic:
+ *
+ *   | dst | src | ethertype | ver | count | seq | type len data | type len data | ...
+ *     6     6       2         1      1      2     1    1   len
+ *
+ * TX writes straight into the packet from mmwlan_alloc_mmpkt_for_tx() and
+ * hands it to mmwlan_tx_pkt(), RX walks the messages in the driver packet
+ * while the RX worker holds it. There is no acknowledgement or retry
+ * beyond the MAC layer; users that need state to converge (the GPIO mirror)
+ * refresh it periodically. Frames go out on CONFIG_HALOW_RAW_TID, by default
+ * the voice access category, so they do not queue behind bulk traffic.
+ *
+ * Sending may wait for mmwlan TX space and the batch lock, which must not
+ * happen on the shared esp_timer task or the RX worker. Timer driven work
+ * (the batch window, the GPIO mirror refresh) and ping replies are handed
+ * to a small TX task through halow_raw_defer() instead.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "halow_raw.h"
+#include "halow_rx.h"
+#include "task_halow.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+// Morse Micro SDK includes
+#include "mmpkt.h"
+#include "mmwlan.h"
+
+static const char *TAG = "halow_raw";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_BOLD      "\033[1m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define HALOW_RAW_VERSION       1
+
+// Frame layout
+#define ETH_HDR_LEN             14
+#define ETH_SRC_OFFSET          6
+#define ETH_TYPE_OFFSET         12
+#define RAW_HDR_LEN             4       // version, count, seq
+#define RAW_MSG_HDR_LEN         2       // type, len
+#define RAW_FRAME_OVERHEAD      (ETH_HDR_LEN + RAW_HDR_LEN)
+
+#define RAW_BATCH_MAX_BYTES     CONFIG_HALOW_RAW_BATCH_MAX_BYTES
+
+_Static_assert(RAW_BATCH_MAX_BYTES >= RAW_FRAME_OVERHEAD + RAW_MSG_HDR_LEN + HALOW_RAW_MAX_MSG_LEN,
+               "CONFIG_HALOW_RAW_BATCH_MAX_BYTES must hold one maximum-size message");
+
+#define RAW_PING_TIMEOUT_MS     1000
+#define RAW_PING_INTERVAL_MS    100
+#define RAW_PING_MAX_COUNT      1000
+
+#define RAW_TX_TASK_STACK       3072
+#define RAW_TX_TASK_PRIORITY    5
+#define RAW_WORK_QUEUE_LEN      4
+#define RAW_PONG_SLOTS          RAW_WORK_QUEUE_LEN
+
+const uint8_t halow_raw_broadcast[HALOW_RAW_MAC_LEN] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+typedef struct {
+    bool in_use;
+    uint8_t type;
+    halow_raw_rx_cb_t cb;
+    void *arg;
+} halow_raw_handler_t;
+
+// Pending batch frame, protected by raw_batch_mutex
+typedef struct {
+    struct mmpkt *pkt;
+    struct mmpktview *view;
+    uint8_t dst[HALOW_RAW_MAC_LEN];
+    size_t len;             // Frame bytes written so far, headers included
+    uint8_t count;
+} halow_raw_batch_t;
+
+// Ping payload, echoed back unchanged by the peer
+typedef struct __attribute__((packed)) {
+    uint32_t id;
+    int64_t tx_time_us;
+} halow_raw_ping_t;
+
+// Pong waiting for the TX task. Claimed by the RX worker, freed by the TX task.
+typedef struct {
+    bool in_use;
+    uint8_t dst[HALOW_RAW_MAC_LEN];
+    halow_raw_ping_t ping;
+} halow_raw_pong_t;
+
+// Deferred work for the TX task
+typedef struct {
+    halow_raw_work_cb_t cb;
+    void *arg;
+} halow_raw_work_t;
+
+static halow_raw_handler_t raw_handlers[HALOW_RAW_MAX_HANDLERS];
+static portMUX_TYPE raw_handlers_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static halow_raw_batch_t raw_batch;
+static SemaphoreHandle_t raw_batch_mutex = NULL;
+static esp_timer_handle_t raw_batch_timer = NULL;
+static QueueHandle_t raw_work_queue = NULL;
+
+static uint8_t raw_own_mac[HALOW_RAW_MAC_LEN];
+static bool raw_own_mac_valid = false;
+static uint16_t raw_tx_seq = 0;
+static int raw_rx_consumer_id = -1;
+
+static halow_raw_stats_t raw_stats;
+static uint64_t raw_ping_rtt_sum_us = 0;     // Written by the RX worker only
+static uint32_t raw_ping_rtt_count = 0;
+
+// Console ping in progress
+static SemaphoreHandle_t raw_ping_sem = NULL;
+static uint32_t raw_ping_next_id = 0;
+static uint32_t raw_ping_wait_id = 0;
+static uint32_t raw_ping_last_rtt_us = 0;
+static uint8_t raw_ping_last_src[HALOW_RAW_MAC_LEN];
+static halow_raw_pong_t raw_pongs[RAW_PONG_SLOTS];
+
+#define RAW_STAT_INC(field, n)  __atomic_fetch_add(&raw_stats.field, (n), __ATOMIC_RELAXED)
+
+/**
+ * @brief Check that frames can go out, and learn the source address once
+ */
+static bool halow_raw_link_up(void)
+{
+    if (!halow_is_started() || mmwlan_get_sta_state() != MMWLAN_STA_CONNECTED) {
+        return false;
+    }
+    if (!raw_own_mac_valid) {
+        raw_own_mac_valid = mmwlan_get_mac_addr(raw_own_mac) == MMWLAN_SUCCESS;
+    }
+    return raw_own_mac_valid;
+}
+
+/**
+ * @brief Allocate a TX packet of alloc_len bytes and reserve the first len
+ * @return Pointer to the start of the frame, NULL (and *pkt NULL) if mmwlan has no buffer
+ */
+static uint8_t *halow_raw_alloc_frame(size_t alloc_len, size_t len, struct mmpkt **pkt, struct mmpktview **view)
+{
+    *pkt = mmwlan_alloc_mmpkt_for_tx(alloc_len, CONFIG_HALOW_RAW_TID);
+    if (*pkt == NULL) {
+        *view = NULL;
+        RAW_STAT_INC(tx_errors, 1);
+        return NULL;
+    }
+    *view = mmpkt_open(*pkt);
+    return mmpkt_append(*view, len);
+}
+
+/**
+ * @brief Fill in the headers and hand the packet to mmwlan
+ * Always consumes the packet and closes the view.
+ */
+static esp_err_t halow_raw_transmit(struct mmpkt *pkt, struct mmpktview *view, const uint8_t *dst, uint8_t count)
+{
+    uint8_t *frame = mmpkt_get_data_start(view);
+    uint16_t seq = __atomic_fetch_add(&raw_tx_seq, 1, __ATOMIC_RELAXED);
+
+    memcpy(frame, dst, HALOW_RAW_MAC_LEN);
+    memcpy(frame + ETH_SRC_OFFSET, raw_own_mac, HALOW_RAW_MAC_LEN);
+    frame[ETH_TYPE_OFFSET] = CONFIG_HALOW_RAW_ETHERTYPE >> 8;
+    frame[ETH_TYPE_OFFSET + 1] = CONFIG_HALOW_RAW_ETHERTYPE & 0xff;
+    frame[ETH_HDR_LEN] = HALOW_RAW_VERSION;
+    frame[ETH_HDR_LEN + 1] = count;
+    frame[ETH_HDR_LEN + 2] = seq >> 8;
+    frame[ETH_HDR_LEN + 3] = seq & 0xff;
+    mmpkt_close(&view);
+
+    if (!halow_raw_link_up()) {
+        mmpkt_release(pkt);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (mmwlan_tx_wait_until_ready(CONFIG_HALOW_RAW_TX_TIMEOUT_MS) != MMWLAN_SUCCESS) {
+        mmpkt_release(pkt);
+        RAW_STAT_INC(tx_busy, 1);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    struct mmwlan_tx_metadata metadata = MMWLAN_TX_METADATA_INIT;
+    metadata.tid = CONFIG_HALOW_RAW_TID;
+    if (mmwlan_tx_pkt(pkt, &metadata) != MMWLAN_SUCCESS) {
+        RAW_STAT_INC(tx_errors, 1);
+        return ESP_FAIL;
+    }
+
+    RAW_STAT_INC(tx_frames, 1);
+    RAW_STAT_INC(tx_msgs, count);
+    return ESP_OK;
+}
+
+/**
+ * @brief Allocate a single-message TX frame
+ */
+esp_err_t halow_raw_alloc(uint8_t type, size_t len, halow_raw_txbuf_t *buf)
+{
+    if (!buf || len > HALOW_RAW_MAX_MSG_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(buf, 0, sizeof(*buf));
+
+    size_t frame_len = RAW_FRAME_OVERHEAD + RAW_MSG_HDR_LEN + len;
+    uint8_t *frame = halow_raw_alloc_frame(frame_len, frame_len, &buf->pkt, &buf->view);
+    if (frame == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    frame[RAW_FRAME_OVERHEAD] = type;
+    frame[RAW_FRAME_OVERHEAD + 1] = (uint8_t)len;
+    buf->payload = frame + RAW_FRAME_OVERHEAD + RAW_MSG_HDR_LEN;
+    buf->len = len;
+    return ESP_OK;
+}
+
+/**
+ * @brief Send a frame from halow_raw_alloc()
+ */
+esp_err_t halow_raw_send_buf(const uint8_t *dst, halow_raw_txbuf_t *buf)
+{
+    if (!buf || !buf->pkt) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct mmpkt *pkt = buf->pkt;
+    struct mmpktview *view = buf->view;
+    memset(buf, 0, sizeof(*buf));
+
+    if (!dst) {
+        mmpkt_close(&view);
+        mmpkt_release(pkt);
+        return ESP_ERR_INVALID_ARG;
+    }
+    return halow_raw_transmit(pkt, view, dst, 1);
+}
+
+/**
+ * @brief Release a buffer from halow_raw_alloc() without sending it
+ */
+void halow_raw_free(halow_raw_txbuf_t *buf)
+{
+    if (!buf || !buf->pkt) {
+        return;
+    }
+    mmpkt_close(&buf->view);
+    mmpkt_release(buf->pkt);
+    memset(buf, 0, sizeof(*buf));
+}
+
+/**
+ * @brief Send one message in its own frame
+ */
+esp_err_t halow_raw_send(const uint8_t *dst, uint8_t type, const void *data, size_t len)
+{
+    if (!halow_raw_link_up()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    halow_raw_txbuf_t buf;
+    esp_err_t err = halow_raw_alloc(type, len, &buf);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (len > 0) {
+        memcpy(buf.payload, data, len);
+    }
+    return halow_raw_send_buf(dst, &buf);
+}
+
+/**
+ * @brief Send the pending batch
+ * Caller holds raw_batch_mutex.
+ */
+static esp_err_t halow_raw_flush_locked(void)
+{
+    if (raw_batch.pkt == NULL) {
+        return ESP_OK;
+    }
+
+    esp_timer_stop(raw_batch_timer);
+
+    struct mmpkt *pkt = raw_batch.pkt;
+    struct mmpktview *view = raw_batch.view;
+    uint8_t count = raw_batch.count;
+    raw_batch.pkt = NULL;
+    raw_batch.view = NULL;
+    raw_batch.len = 0;
+    raw_batch.count = 0;
+
+    return halow_raw_transmit(pkt, view, raw_batch.dst, count);
+}
+
+/**
+ * @brief Deferred batch flush (TX task)
+ */
+static void halow_raw_flush_work(void *arg)
+{
+    halow_raw_flush();
+}
+
+/**
+ * @brief Batch window expired (esp_timer task), hand the flush to the TX task
+ */
+static void halow_raw_batch_timer_cb(void *arg)
+{
+    if (halow_raw_defer(halow_raw_flush_work, NULL) != ESP_OK) {
+        // TX task backed up, try again after another window
+        esp_timer_start_once(raw_batch_timer, CONFIG_HALOW_RAW_BATCH_WINDOW_US);
+    }
+}
+
+/**
+ * @brief TX task: runs deferred work
+ */
+static void halow_raw_tx_task(void *pvParameters)
+{
+    halow_raw_work_t work;
+
+    while (1) {
+        if (xQueueReceive(raw_work_queue, &work, portMAX_DELAY) == pdTRUE) {
+            work.cb(work.arg);
+        }
+    }
+}
+
+/**
+ * @brief Run a function on the TX task
+ */
+esp_err_t halow_raw_defer(halow_raw_work_cb_t cb, void *arg)
+{
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!raw_work_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const halow_raw_work_t work = { .cb = cb, .arg = arg };
+    return xQueueSend(raw_work_queue, &work, 0) == pdTRUE ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+/**
+ * @brief Queue a message in the batch frame
+ */
+esp_err_t halow_raw_send_batched(const uint8_t *dst, uint8_t type, const void *data, size_t len)
+{
+    if (!dst || len > HALOW_RAW_MAX_MSG_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!raw_batch_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!halow_raw_link_up()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(raw_batch_mutex, portMAX_DELAY);
+
+    size_t msg_len = RAW_MSG_HDR_LEN + len;
+    if (raw_batch.pkt &&
+        (memcmp(raw_batch.dst, dst, HALOW_RAW_MAC_LEN) != 0 ||
+         raw_batch.len + msg_len > RAW_BATCH_MAX_BYTES || raw_batch.count == UINT8_MAX)) {
+        err = halow_raw_flush_locked();
+    }
+
+    if (raw_batch.pkt == NULL) {
+        if (halow_raw_alloc_frame(RAW_BATCH_MAX_BYTES, RAW_FRAME_OVERHEAD, &raw_batch.pkt, &raw_batch.view) == NULL) {
+            xSemaphoreGive(raw_batch_mutex);
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(raw_batch.dst, dst, HALOW_RAW_MAC_LEN);
+        raw_batch.len = RAW_FRAME_OVERHEAD;
+        raw_batch.count = 0;
+        esp_timer_start_once(raw_batch_timer, CONFIG_HALOW_RAW_BATCH_WINDOW_US);
+    }
+
+    uint8_t *msg = mmpkt_append(raw_batch.view, msg_len);
+    msg[0] = type;
+    msg[1] = (uint8_t)len;
+    if (len > 0) {
+        memcpy(msg + RAW_MSG_HDR_LEN, data, len);
+    }
+    raw_batch.len += msg_len;
+    raw_batch.count++;
+    RAW_STAT_INC(tx_batched, 1);
+
+    // Not even an empty message fits any more
+    if (raw_batch.len + RAW_MSG_HDR_LEN > RAW_BATCH_MAX_BYTES) {
+        err = halow_raw_flush_locked();
+    }
+
+    xSemaphoreGive(raw_batch_mutex);
+    return err;
+}
+
+/**
+ * @brief Send the pending batch frame now
+ */
+esp_err_t halow_raw_flush(void)
+{
+    if (!raw_batch_mutex) {
+        return ESP_OK;
+    }
+
+    xSemaphoreTake(raw_batch_mutex, portMAX_DELAY);
+    esp_err_t err = halow_raw_flush_locked();
+    xSemaphoreGive(raw_batch_mutex);
+    return err;
+}
+
+/**
+ * @brief Look up the handler for a message type
+ */
+static bool halow_raw_find_handler(uint8_t type, halow_raw_rx_cb_t *cb, void **arg)
+{
+    bool found = false;
+
+    portENTER_CRITICAL(&raw_handlers_lock);
+    for (int i = 0; i < HALOW_RAW_MAX_HANDLERS; i++) {
+        if (raw_handlers[i].in_use && raw_handlers[i].type == type) {
+            *cb = raw_handlers[i].cb;
+            *arg = raw_handlers[i].arg;
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&raw_handlers_lock);
+
+    return found;
+}
+
+/**
+ * @brief RX pipeline consumer: split the frame into messages and dispatch them
+ */
+static bool halow_raw_rx_consumer(const halow_rx_frame_t *frame, void *arg)
+{
+    const uint8_t *data = frame->data;
+    size_t len = frame->len;
+
+    if (len < RAW_FRAME_OVERHEAD || data[ETH_HDR_LEN] != HALOW_RAW_VERSION) {
+        RAW_STAT_INC(rx_malformed, 1);
+        return false;
+    }
+
+    // Our own broadcasts relayed back by the AP
+    if (raw_own_mac_valid && memcmp(data + ETH_SRC_OFFSET, raw_own_mac, HALOW_RAW_MAC_LEN) == 0) {
+        return true;
+    }
+
+    RAW_STAT_INC(rx_frames, 1);
+
+    halow_raw_msg_t msg = {
+        .src = data + ETH_SRC_OFFSET,
+        .broadcast = memcmp(data, halow_raw_broadcast, HALOW_RAW_MAC_LEN) == 0,
+        .seq = ((uint16_t)data[ETH_HDR_LEN + 2] << 8) | data[ETH_HDR_LEN + 3],
+        .rx_time_us = frame->rx_time_us,
+    };
+
+    uint8_t count = data[ETH_HDR_LEN + 1];
+    size_t offset = RAW_FRAME_OVERHEAD;
+
+    // count, not the frame length, ends the list: a bridged frame may be padded
+    for (int i = 0; i < count; i++) {
+        if (offset + RAW_MSG_HDR_LEN > len || offset + RAW_MSG_HDR_LEN + data[offset + 1] > len) {
+            RAW_STAT_INC(rx_malformed, 1);
+            return false;
+        }
+
+        msg.type = data[offset];
+        msg.len = data[offset + 1];
+        msg.data = data + offset + RAW_MSG_HDR_LEN;
+        offset += RAW_MSG_HDR_LEN + msg.len;
+        RAW_STAT_INC(rx_msgs, 1);
+
+        halow_raw_rx_cb_t cb;
+        void *cb_arg;
+        if (halow_raw_find_handler(msg.type, &cb, &cb_arg)) {
+            cb(&msg, cb_arg);
+        } else {
+            RAW_STAT_INC(rx_unhandled, 1);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Send a queued pong (TX task)
+ */
+static void halow_raw_pong_work(void *arg)
+{
+    halow_raw_pong_t *pong = arg;
+
+    halow_raw_send(pong->dst, HALOW_RAW_TYPE_PONG, &pong->ping, sizeof(pong->ping));
+    __atomic_store_n(&pong->in_use, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Answer a ping with the same payload
+ * Runs on the RX worker, which must not wait for TX space: the reply is
+ * copied out of the driver packet and sent from the TX task.
+ */
+static void halow_raw_ping_handler(const halow_raw_msg_t *msg, void *arg)
+{
+    if (msg->len != sizeof(halow_raw_ping_t)) {
+        return;
+    }
+
+    for (int i = 0; i < RAW_PONG_SLOTS; i++) {
+        halow_raw_pong_t *pong = &raw_pongs[i];
+        if (__atomic_load_n(&pong->in_use, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+
+        pong->in_use = true;
+        memcpy(pong->dst, msg->src, HALOW_RAW_MAC_LEN);
+        memcpy(&pong->ping, msg->data, sizeof(pong->ping));
+        if (halow_raw_defer(halow_raw_pong_work, pong) != ESP_OK) {
+            __atomic_store_n(&pong->in_use, false, __ATOMIC_RELEASE);
+            break;
+        }
+        return;
+    }
+
+    // TX task backed up, the peer sees a timeout
+    RAW_STAT_INC(tx_busy, 1);
+}
+
+/**
+ * @brief Account a pong and wake a waiting 'halow raw ping'
+ */
+static void halow_raw_pong_handler(const halow_raw_msg_t *msg, void *arg)
+{
+    halow_raw_ping_t ping;
+    if (msg->len != sizeof(ping)) {
+        return;
+    }
+    memcpy(&ping, msg->data, sizeof(ping));
+
+    int64_t rtt = msg->rx_time_us - ping.tx_time_us;
+    if (rtt < 0 || rtt > (int64_t)UINT32_MAX) {
+        return;
+    }
+    uint32_t rtt_us = (uint32_t)rtt;
+
+    if (raw_ping_rtt_count == 0 || rtt_us < raw_stats.ping_rtt_min_us) {
+        raw_stats.ping_rtt_min_us = rtt_us;
+    }
+    if (rtt_us > raw_stats.ping_rtt_max_us) {
+        raw_stats.ping_rtt_max_us = rtt_us;
+    }
+    raw_ping_rtt_sum_us += rtt_us;
+    raw_ping_rtt_count++;
+    raw_stats.ping_rtt_avg_us = (uint32_t)(raw_ping_rtt_sum_us / raw_ping_rtt_count);
+
+    // Only the first reply to the outstanding ping wakes the console
+    uint32_t expected = ping.id;
+    if (__atomic_compare_exchange_n(&raw_ping_wait_id, &expected, 0, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        raw_ping_last_rtt_us = rtt_us;
+        memcpy(raw_ping_last_src, msg->src, HALOW_RAW_MAC_LEN);
+        xSemaphoreGive(raw_ping_sem);
+    }
+}
+
+/**
+ * @brief Register the RX consumer and the built-in ping handler
+ */
+esp_err_t halow_raw_init(void)
+{
+    if (raw_batch_mutex) {
+        return ESP_OK;
+    }
+
+    raw_batch_mutex = xSemaphoreCreateMutex();
+    raw_ping_sem = xSemaphoreCreateBinary();
+    raw_work_queue = xQueueCreate(RAW_WORK_QUEUE_LEN, sizeof(halow_raw_work_t));
+    if (!raw_batch_mutex || !raw_ping_sem || !raw_work_queue) {
+        ESP_LOGE(TAG, "Failed to create raw messaging semaphores");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(halow_raw_tx_task, "halow_raw_tx", RAW_TX_TASK_STACK, NULL, RAW_TX_TASK_PRIORITY,
+                    NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create raw TX task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = halow_raw_batch_timer_cb,
+        .name = "halow_raw_batch",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &raw_batch_timer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create batch timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    const halow_rx_filter_t filter = {
+        .ethertype = CONFIG_HALOW_RAW_ETHERTYPE,
+    };
+    err = halow_rx_register_consumer("raw", &filter, halow_raw_rx_consumer, NULL, &raw_rx_consumer_id);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    halow_raw_register_handler(HALOW_RAW_TYPE_PING, halow_raw_ping_handler, NULL);
+    halow_raw_register_handler(HALOW_RAW_TYPE_PONG, halow_raw_pong_handler, NULL);
+
+    ESP_LOGI(TAG, "Raw messaging on ethertype 0x%04x (TID %d)", CONFIG_HALOW_RAW_ETHERTYPE, CONFIG_HALOW_RAW_TID);
+    return ESP_OK;
+}
+
+/**
+ * @brief Register the handler for a message type
+ */
+esp_err_t halow_raw_register_handler(uint8_t type, halow_raw_rx_cb_t cb, void *arg)
+{
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&raw_handlers_lock);
+    int slot = -1;
+    for (int i = 0; i < HALOW_RAW_MAX_HANDLERS; i++) {
+        if (raw_handlers[i].in_use && raw_handlers[i].type == type) {
+            err = ESP_ERR_INVALID_STATE;
+            slot = -1;
+            break;
+        }
+        if (slot < 0 && !raw_handlers[i].in_use) {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        raw_handlers[slot].type = type;
+        raw_handlers[slot].cb = cb;
+        raw_handlers[slot].arg = arg;
+        raw_handlers[slot].in_use = true;
+        err = ESP_OK;
+    }
+    portEXIT_CRITICAL(&raw_handlers_lock);
+
+    if (err == ESP_ERR_NO_MEM) {
+        ESP_LOGE(TAG, "Handler table full, cannot register type 0x%02x", type);
+    }
+    return err;
+}
+
+/**
+ * @brief Remove the handler for a message type
+ */
+void halow_raw_unregister_handler(uint8_t type)
+{
+    portENTER_CRITICAL(&raw_handlers_lock);
+    for (int i = 0; i < HALOW_RAW_MAX_HANDLERS; i++) {
+        if (raw_handlers[i].in_use && raw_handlers[i].type == type) {
+            raw_handlers[i].in_use = false;
+        }
+    }
+    portEXIT_CRITICAL(&raw_handlers_lock);
+}
+
+/**
+ * @brief Get counters
+ */
+void halow_raw_get_stats(halow_raw_stats_t *stats)
+{
+    if (stats) {
+        *stats = raw_stats;
+    }
+}
+
+/**
+ * @brief Reset counters
+ */
+void halow_raw_reset_stats(void)
+{
+    memset(&raw_stats, 0, sizeof(raw_stats));
+    raw_ping_rtt_sum_us = 0;
+    raw_ping_rtt_count = 0;
+}
+
+/**
+ * @brief Parse "aa:bb:cc:dd:ee:ff" or "bcast"
+ */
+bool halow_raw_parse_mac(const char *str, uint8_t mac[HALOW_RAW_MAC_LEN])
+{
+    if (strcmp(str, "bcast") == 0 || strcmp(str, "broadcast") == 0) {
+        memcpy(mac, halow_raw_broadcast, HALOW_RAW_MAC_LEN);
+        return true;
+    }
+
+    unsigned int b[HALOW_RAW_MAC_LEN];
+    int consumed = 0;
+    if (sscanf(str, "%2x:%2x:%2x:%2x:%2x:%2x%n", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &consumed) != 6 ||
+        str[consumed] != '\0') {
+        return false;
+    }
+    for (int i = 0; i < HALOW_RAW_MAC_LEN; i++) {
+        mac[i] = (uint8_t)b[i];
+    }
+    return true;
+}
+
+/**
+ * @brief Print counters and registered handlers
+ */
+static void halow_raw_print_stats(void)
+{
+    halow_raw_stats_t s;
+    halow_raw_get_stats(&s);
+
+    printf("\n" COLOR_CYAN COLOR_BOLD "=== HALOW RAW MESSAGING ===" COLOR_RESET "\n\n");
+    printf("Ethertype:   0x%04x, TID %d, batch %d bytes / %d us\n",
+           CONFIG_HALOW_RAW_ETHERTYPE, CONFIG_HALOW_RAW_TID, RAW_BATCH_MAX_BYTES, CONFIG_HALOW_RAW_BATCH_WINDOW_US);
+    if (raw_own_mac_valid) {
+        printf("Address:     %02x:%02x:%02x:%02x:%02x:%02x\n",
+               raw_own_mac[0], raw_own_mac[1], raw_own_mac[2], raw_own_mac[3], raw_own_mac[4], raw_own_mac[5]);
+    }
+    printf("TX:          %lu frames, %lu messages (%lu batched), %lu busy, %lu errors\n",
+           (unsigned long)s.tx_frames, (unsigned long)s.tx_msgs, (unsigned long)s.tx_batched,
+           (unsigned long)s.tx_busy, (unsigned long)s.tx_errors);
+    printf("RX:          %lu frames, %lu messages, %lu unhandled, %lu malformed\n",
+           (unsigned long)s.rx_frames, (unsigned long)s.rx_msgs,
+           (unsigned long)s.rx_unhandled, (unsigned long)s.rx_malformed);
+    if (raw_ping_rtt_count > 0) {
+        printf("Ping RTT:    min %lu / avg %lu / max %lu us (%lu replies)\n",
+               (unsigned long)s.ping_rtt_min_us, (unsigned long)s.ping_rtt_avg_us,
+               (unsigned long)s.ping_rtt_max_us, (unsigned long)raw_ping_rtt_count);
+    }
+
+    printf("Handlers:   ");
+    portENTER_CRITICAL(&raw_handlers_lock);
+    halow_raw_handler_t handlers[HALOW_RAW_MAX_HANDLERS];
+    memcpy(handlers, raw_handlers, sizeof(handlers));
+    portEXIT_CRITICAL(&raw_handlers_lock);
+    for (int i = 0; i < HALOW_RAW_MAX_HANDLERS; i++) {
+        if (handlers[i].in_use) {
+            printf(" 0x%02x", handlers[i].type);
+        }
+    }
+    printf("\n");
+
+    if (raw_rx_consumer_id >= 0) {
+        halow_rx_consumer_stats_t rx;
+        if (halow_rx_get_consumer_stats(raw_rx_consumer_id, &rx) == ESP_OK) {
+            printf("RX pipeline: avg %lu / max %lu us callback to handler\n",
+                   (unsigned long)rx.latency_avg_us, (unsigned long)rx.latency_max_us);
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @brief 'halow raw ping <mac|bcast> [count]'
+ */
+static int halow_raw_ping_cmd(const uint8_t *dst, int count)
+{
+    int received = 0;
+    uint32_t min_us = UINT32_MAX, max_us = 0;
+    uint64_t sum_us = 0;
+
+    for (int i = 0; i < count; i++) {
+        // Id 0 means no ping outstanding
+        if (++raw_ping_next_id == 0) {
+            raw_ping_next_id = 1;
+        }
+        halow_raw_ping_t ping = {
+            .id = raw_ping_next_id,
+        };
+        xSemaphoreTake(raw_ping_sem, 0);
+        __atomic_store_n(&raw_ping_wait_id, ping.id, __ATOMIC_RELEASE);
+        ping.tx_time_us = esp_timer_get_time();
+
+        esp_err_t err = halow_raw_send(dst, HALOW_RAW_TYPE_PING, &ping, sizeof(ping));
+        if (err != ESP_OK) {
+            __atomic_store_n(&raw_ping_wait_id, 0, __ATOMIC_RELEASE);
+            printf(COLOR_RED "Send failed: %s\n" COLOR_RESET, esp_err_to_name(err));
+            return 1;
+        }
+
+        if (xSemaphoreTake(raw_ping_sem, pdMS_TO_TICKS(RAW_PING_TIMEOUT_MS)) == pdTRUE) {
+            uint32_t rtt = raw_ping_last_rtt_us;
+            printf("Reply from %02x:%02x:%02x:%02x:%02x:%02x: seq=%d rtt=%.2f ms\n",
+                   raw_ping_last_src[0], raw_ping_last_src[1], raw_ping_last_src[2],
+                   raw_ping_last_src[3], raw_ping_last_src[4], raw_ping_last_src[5],
+                   i + 1, rtt / 1000.0);
+            received++;
+            sum_us += rtt;
+            if (rtt < min_us) {
+                min_us = rtt;
+            }
+            if (rtt > max_us) {
+                max_us = rtt;
+            }
+        } else {
+            __atomic_store_n(&raw_ping_wait_id, 0, __ATOMIC_RELEASE);
+            printf(COLOR_YELLOW "Timeout: seq=%d\n" COLOR_RESET, i + 1);
+        }
+
+        if (i + 1 < count) {
+            vTaskDelay(pdMS_TO_TICKS(RAW_PING_INTERVAL_MS));
+        }
+    }
+
+    printf("\n%d sent, %d received", count, received);
+    if (received > 0) {
+        printf(", rtt min/avg/max %.2f/%.2f/%.2f ms",
+               min_us / 1000.0, (double)sum_us / received / 1000.0, max_us / 1000.0);
+    }
+    printf("\n");
+    return received > 0 ? 0 : 1;
+}
+
+/**
+ * @brief Console handler for 'halow raw'
+ */
+int halow_raw_cmd(int argc, char **argv)
+{
+    if (!raw_batch_mutex) {
+        printf(COLOR_YELLOW "Raw messaging not initialized\n" COLOR_RESET);
+        return 1;
+    }
+
+    if (argc < 2 || strcmp(argv[1], "stats") == 0) {
+        halow_raw_print_stats();
+        return 0;
+    }
+
+    const char *subcmd = argv[1];
+
+    if (strcmp(subcmd, "reset") == 0) {
+        halow_raw_reset_stats();
+        printf(COLOR_GREEN "Raw messaging statistics reset\n" COLOR_RESET);
+        return 0;
+    }
+
+    if (strcmp(subcmd, "flush") == 0) {
+        esp_err_t err = halow_raw_flush();
+        if (err != ESP_OK) {
+            printf(COLOR_RED "Flush failed: %s\n" COLOR_RESET, esp_err_to_name(err));
+            return 1;
+        }
+        return 0;
+    }
+
+    uint8_t dst[HALOW_RAW_MAC_LEN];
+
+    if (strcmp(subcmd, "ping") == 0) {
+        if (argc < 3 || !halow_raw_parse_mac(argv[2], dst)) {
+            printf("Usage: halow raw ping <aa:bb:cc:dd:ee:ff|bcast> [count]\n");
+            return 1;
+        }
+        int count = argc >= 4 ? atoi(argv[3]) : 4;
+        if (count < 1 || count > RAW_PING_MAX_COUNT) {
+            printf(COLOR_RED "Count must be 1-%d\n" COLOR_RESET, RAW_PING_MAX_COUNT);
+            return 1;
+        }
+        return halow_raw_ping_cmd(dst, count);
+    }
+
+    if (strcmp(subcmd, "send") == 0) {
+        if (argc < 4 || !halow_raw_parse_mac(argv[2], dst)) {
+            printf("Usage: halow raw send <aa:bb:cc:dd:ee:ff|bcast> <text> [--type n] [--batch]\n");
+            return 1;
+        }
+
+        int type = HALOW_RAW_TYPE_USER;
+        bool batch = false;
+        for (int i = 4; i < argc; i++) {
+            if (strcmp(argv[i], "--batch") == 0) {
+                batch = true;
+            } else if (strcmp(argv[i], "--type") == 0 && i + 1 < argc) {
+                type = (int)strtol(argv[++i], NULL, 0);
+            } else {
+                printf(COLOR_RED "Unknown option: %s\n" COLOR_RESET, argv[i]);
+                return 1;
+            }
+        }
+        if (type < 0 || type > 0xff) {
+            printf(COLOR_RED "Type must be 0-255\n" COLOR_RESET);
+            return 1;
+        }
+
+        size_t len = strlen(argv[3]);
+        if (len > HALOW_RAW_MAX_MSG_LEN) {
+            printf(COLOR_RED "Message longer than %d bytes\n" COLOR_RESET, HALOW_RAW_MAX_MSG_LEN);
+            return 1;
+        }
+
+        esp_err_t err = batch ? halow_raw_send_batched(dst, (uint8_t)type, argv[3], len)
+                              : halow_raw_send(dst, (uint8_t)type, argv[3], len);
+        if (err != ESP_OK) {
+            printf(COLOR_RED "Send failed: %s\n" COLOR_RESET, esp_err_to_name(err));
+            return 1;
+        }
+        printf(COLOR_GREEN "%s %u bytes, type 0x%02x\n" COLOR_RESET, batch ? "Queued" : "Sent", (unsigned)len, type);
+        return 0;
+    }
+
+    printf("Usage: halow raw [stats|reset|flush]\n");
+    printf("       halow raw send <aa:bb:cc:dd:ee:ff|bcast> <text> [--type n] [--batch]\n");
+    printf("       halow raw ping <aa:bb:cc:dd:ee:ff|bcast> [count]\n");
+    return 1;
+}
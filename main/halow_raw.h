@@ -0,0 +1,210 @@
+/**
+ * @file halow_raw.h
+ * @brief Custom-ethertype peer messaging over mmwlan for Halow RTOS
+ *
+ * Features:
+ * - Short typed messages in raw Ethernet frames (CONFIG_HALOW_RAW_ETHERTYPE),
+ *   bypassing lwIP, for alarms and GPIO events between nodes
+ * - Zero-copy TX: the caller writes the message into the driver packet and
+ *   hands ownership to mmwlan
+ * - Zero-copy RX: handlers get a view into the driver packet from the RX
+ *   pipeline, dispatched by message type
+ * - Optional batched TX that packs small messages for one destination into
+ *   one frame, flushed when full or after CONFIG_HALOW_RAW_BATCH_WINDOW_US
+ * - Built-in ping/pong for one-way and round-trip latency checks
+ * - A TX task for deferred sends, so timer callbacks never wait for the radio
+ */
+
+#ifndef HALOW_RAW_H
+#define HALOW_RAW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+struct mmpkt;
+struct mmpktview;
+
+#define HALOW_RAW_MAC_LEN           6
+#define HALOW_RAW_MAX_MSG_LEN       255     // Payload bytes per message (one byte length field)
+#define HALOW_RAW_MAX_HANDLERS      8
+
+// Message types. 0x00-0x7f are reserved for the firmware, applications use 0x80-0xff.
+#define HALOW_RAW_TYPE_PING         0x01
+#define HALOW_RAW_TYPE_PONG         0x02
+#define HALOW_RAW_TYPE_GPIO         0x10
+#define HALOW_RAW_TYPE_USER         0x80
+
+// Broadcast destination for halow_raw_send() and friends
+extern const uint8_t halow_raw_broadcast[HALOW_RAW_MAC_LEN];
+
+// TX buffer from halow_raw_alloc(), writable until sent or freed
+typedef struct {
+    struct mmpkt *pkt;
+    struct mmpktview *view;
+    uint8_t *payload;       // Message payload, len bytes
+    size_t len;
+} halow_raw_txbuf_t;
+
+// Received message view. src and data point into the driver packet and are
+// only valid for the duration of the handler call.
+typedef struct {
+    const uint8_t *src;     // Sender MAC address
+    bool broadcast;         // Frame was sent to the broadcast address
+    uint8_t type;
+    const uint8_t *data;
+    size_t len;
+    uint16_t seq;           // Sender frame sequence number
+    int64_t rx_time_us;     // esp_timer timestamp taken in the mmwlan RX callback
+} halow_raw_msg_t;
+
+/**
+ * @brief Message handler, called from the RX worker task
+ * Must not block; replying with halow_raw_send() is fine.
+ * @param msg Message view (valid only during the call)
+ * @param arg User argument given at registration
+ */
+typedef void (*halow_raw_rx_cb_t)(const halow_raw_msg_t *msg, void *arg);
+
+// Counters
+typedef struct {
+    uint32_t tx_frames;         // Frames handed to mmwlan
+    uint32_t tx_msgs;           // Messages in those frames
+    uint32_t tx_batched;        // Messages that went through the batch buffer
+    uint32_t tx_busy;           // Sends refused because the TX path stayed paused
+    uint32_t tx_errors;         // Allocation or mmwlan TX failures
+    uint32_t rx_frames;
+    uint32_t rx_msgs;
+    uint32_t rx_unhandled;      // Messages with no handler registered
+    uint32_t rx_malformed;      // Frames with a bad header or truncated message
+    uint32_t ping_rtt_min_us;   // Ping round-trip times, 0 if no pong yet
+    uint32_t ping_rtt_avg_us;
+    uint32_t ping_rtt_max_us;
+} halow_raw_stats_t;
+
+/**
+ * @brief Register the RX consumer and the built-in ping handler
+ * Needs halow_rx_init() first.
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t halow_raw_init(void);
+
+/**
+ * @brief Allocate a single-message TX frame
+ * The payload is written in place in the driver packet.
+ * @param type Message type
+ * @param len Payload length (at most HALOW_RAW_MAX_MSG_LEN)
+ * @param buf Pointer to store the buffer
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad length,
+ *         ESP_ERR_NO_MEM if mmwlan has no TX buffer
+ */
+esp_err_t halow_raw_alloc(uint8_t type, size_t len, halow_raw_txbuf_t *buf);
+
+/**
+ * @brief Send a frame from halow_raw_alloc()
+ * Ownership of the packet passes to mmwlan whatever the result; buf is
+ * cleared and must not be used again.
+ * @param dst Destination MAC address (halow_raw_broadcast for all nodes)
+ * @param buf Buffer from halow_raw_alloc()
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not connected,
+ *         ESP_ERR_TIMEOUT if TX stayed paused, ESP_FAIL on a driver error
+ */
+esp_err_t halow_raw_send_buf(const uint8_t *dst, halow_raw_txbuf_t *buf);
+
+/**
+ * @brief Release a buffer from halow_raw_alloc() without sending it
+ * @param buf Buffer to release
+ */
+void halow_raw_free(halow_raw_txbuf_t *buf);
+
+/**
+ * @brief Send one message in its own frame
+ * Copies the payload once, straight into the driver packet.
+ * @param dst Destination MAC address
+ * @param type Message type
+ * @param data Payload
+ * @param len Payload length
+ * @return As halow_raw_send_buf(), or an allocation error
+ */
+esp_err_t halow_raw_send(const uint8_t *dst, uint8_t type, const void *data, size_t len);
+
+/**
+ * @brief Queue a message in the batch frame
+ * The batch is sent when the next message would not fit, when a message
+ * for another destination is queued, by halow_raw_flush() or once
+ * CONFIG_HALOW_RAW_BATCH_WINDOW_US has passed since its first message.
+ * @param dst Destination MAC address
+ * @param type Message type
+ * @param data Payload
+ * @param len Payload length
+ * @return ESP_OK if queued, error code of a forced flush or allocation otherwise
+ */
+esp_err_t halow_raw_send_batched(const uint8_t *dst, uint8_t type, const void *data, size_t len);
+
+/**
+ * @brief Send the pending batch frame now
+ * @return ESP_OK on success or if nothing was pending, send error otherwise
+ */
+esp_err_t halow_raw_flush(void);
+
+/**
+ * @brief Deferred work, called from the raw TX task
+ */
+typedef void (*halow_raw_work_cb_t)(void *arg);
+
+/**
+ * @brief Run a function on the raw TX task
+ * Never blocks, for esp_timer callbacks and other contexts that must not
+ * wait for mmwlan TX space or the batch lock.
+ * @param cb Function to run; may send, batch and flush
+ * @param arg Passed to cb
+ * @return ESP_OK if queued, ESP_ERR_NO_MEM if the work queue is full,
+ *         ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t halow_raw_defer(halow_raw_work_cb_t cb, void *arg);
+
+/**
+ * @brief Register the handler for a message type
+ * @param type Message type
+ * @param cb Handler
+ * @param arg User argument
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the type already has a
+ *         handler, ESP_ERR_NO_MEM if the table is full
+ */
+esp_err_t halow_raw_register_handler(uint8_t type, halow_raw_rx_cb_t cb, void *arg);
+
+/**
+ * @brief Remove the handler for a message type
+ * @param type Message type
+ */
+void halow_raw_unregister_handler(uint8_t type);
+
+/**
+ * @brief Get counters
+ * @param stats Pointer to store the counters
+ */
+void halow_raw_get_stats(halow_raw_stats_t *stats);
+
+/**
+ * @brief Reset counters
+ */
+void halow_raw_reset_stats(void);
+
+/**
+ * @brief Parse "aa:bb:cc:dd:ee:ff" or "bcast"
+ * @param str Text to parse
+ * @param mac Pointer to store the address
+ * @return true on success
+ */
+bool halow_raw_parse_mac(const char *str, uint8_t mac[HALOW_RAW_MAC_LEN]);
+
+/**
+ * @brief Console handler for 'halow raw [stats|reset|send|ping]'
+ * @param argc Argument count (argv[0] is "raw")
+ * @param argv Arguments
+ * @return 0 on success, 1 on error
+ */
+int halow_raw_cmd(int argc, char **argv);
+
+#endif // HALOW_RAW_H
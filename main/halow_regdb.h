@@ -0,0 +1,26 @@
+/**
+ * @file halow_regdb.h
+ * @brief Build-time trimmed regulatory database for Halow RTOS
+ *
+ * Features:
+ * - With CONFIG_HALOW_REGDB_TRIM, tools/regdb_trim.py generates the regdb
+ *   from mm_app_regdb.c at build time, keeping only CONFIG_HALOW_COUNTRY_CODE
+ *   and CONFIG_HALOW_REGDB_EXTRA_COUNTRIES
+ * - The configured country's channel list is resolved at build time, so
+ *   bring-up does not search the database
+ * - get_regulatory_db() (mm_app_regdb.h) keeps working on the trimmed set
+ */
+
+#ifndef HALOW_REGDB_H
+#define HALOW_REGDB_H
+
+#include "mmwlan.h"
+
+/**
+ * @brief Channel list of CONFIG_HALOW_COUNTRY_CODE
+ * Only linked when CONFIG_HALOW_REGDB_TRIM is enabled.
+ * @return Pointer to the constant channel list, never NULL
+ */
+const struct mmwlan_s1g_channel_list *halow_regdb_channel_list(void);
+
+#endif // HALOW_REGDB_H
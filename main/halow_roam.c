@@ -0,0 +1,420 @@
+/**
+ * @file halow_roam.c
+ * @brief Background-scan roaming implementation for Halow RTOS
+ *
+ * The task wakes once a second and only reads the link RSSI; nothing goes
+ * on air while the link is good. Once the smoothed RSSI has stayed below
+ * the threshold for the hold time, a background scan refreshes the scan
+ * cache. A candidate must be the same SSID and beat the current RSSI by the
+ * hysteresis margin, so two APs of similar strength do not ping-pong. Each
+ * scan that finds nothing doubles the wait before the next one.
+ *
+ * The handover itself is halow_roam_to(): disable, then a targeted connect
+ * to the candidate's BSSID on its channel only. Latency is measured from
+ * the disable to the STA reporting connected, i.e. the association gap,
+ * not including DHCP.
+ *
+ * A targeted connect (boot fast reconnect or a handover) leaves the channel
+ * list cut to the channels of the network's known APs, and mmwlan only
+ * takes a new list with STA disabled. Background scans stay on that list
+ * rather than dropping the link, so a handover costs one link drop.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "halow_roam.h"
+#include "halow_scan_cache.h"
+#include "task_halow.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mmwlan.h"
+
+static const char *TAG = "halow_roam";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_BOLD      "\033[1m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define HALOW_ROAM_TASK_STACK       3072
+#define HALOW_ROAM_TASK_PRIORITY    2
+#define HALOW_ROAM_CHECK_MS         1000
+#define HALOW_ROAM_SCAN_TIMEOUT_MS  10000
+#define HALOW_ROAM_ASSOC_TIMEOUT_MS 3000
+#define HALOW_ROAM_BACKOFF_MAX      8       // Scan interval multiplier limit
+#define HALOW_ROAM_RSSI_NONE        INT32_MIN
+
+static const uint32_t roam_latency_bounds_ms[HALOW_ROAM_LATENCY_BUCKETS - 1] = {
+    100, 200, 500, 1000, 2000, 5000
+};
+
+static TaskHandle_t roam_task_handle = NULL;
+static bool roam_enabled = CONFIG_HALOW_ROAM_ENABLE;   // Atomic, set from the console
+static int roam_threshold_dbm = CONFIG_HALOW_ROAM_RSSI_THRESHOLD;
+static int roam_hysteresis_db = CONFIG_HALOW_ROAM_HYSTERESIS_DB;
+static bool roam_force = false;             // Atomic, set by 'halow roam now'
+
+// Task state
+static int32_t roam_rssi_avg = HALOW_ROAM_RSSI_NONE;
+static int64_t roam_low_since_us = 0;
+static int64_t roam_last_scan_us = 0;
+static uint32_t roam_backoff = 1;
+static halow_scan_entry_t roam_candidates[MAX_SCAN_RESULTS];
+
+// Statistics, written by the task and read by the console
+static halow_roam_stats_t roam_stats;
+static uint8_t roam_last_from[HALOW_SCAN_BSSID_LEN];
+static uint8_t roam_last_to[HALOW_SCAN_BSSID_LEN];
+static uint32_t roam_last_ms = 0;
+static esp_err_t roam_last_result = ESP_OK;
+static bool roam_last_valid = false;
+static portMUX_TYPE roam_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Record the outcome of one handover
+ */
+static void halow_roam_record(const uint8_t *from, const uint8_t *to, uint32_t ms, esp_err_t result)
+{
+    portENTER_CRITICAL(&roam_lock);
+    if (result == ESP_OK) {
+        int bucket = 0;
+        while (bucket < HALOW_ROAM_LATENCY_BUCKETS - 1 && ms >= roam_latency_bounds_ms[bucket]) {
+            bucket++;
+        }
+        roam_stats.latency_hist[bucket]++;
+        if (roam_stats.roams == 0 || ms < roam_stats.latency_min_ms) {
+            roam_stats.latency_min_ms = ms;
+        }
+        if (ms > roam_stats.latency_max_ms) {
+            roam_stats.latency_max_ms = ms;
+        }
+        roam_stats.latency_sum_ms += ms;
+        roam_stats.roams++;
+    } else {
+        roam_stats.failed++;
+    }
+    memcpy(roam_last_from, from, sizeof(roam_last_from));
+    memcpy(roam_last_to, to, sizeof(roam_last_to));
+    roam_last_ms = ms;
+    roam_last_result = result;
+    roam_last_valid = true;
+    portEXIT_CRITICAL(&roam_lock);
+}
+
+/**
+ * @brief Pick the strongest BSS of the current SSID that beats the link by the hysteresis
+ */
+static bool halow_roam_pick(int32_t rssi_dbm, halow_scan_entry_t *candidate)
+{
+    char ssid[HALOW_SCAN_SSID_MAXLEN + 1];
+    uint8_t current[HALOW_SCAN_BSSID_LEN];
+
+    if (!halow_get_connected_ssid(ssid, sizeof(ssid)) || mmwlan_get_bssid(current) != MMWLAN_SUCCESS) {
+        return false;
+    }
+
+    // Sorted strongest first, the first acceptable entry is the best
+    int n = halow_scan_cache_snapshot(roam_candidates, MAX_SCAN_RESULTS);
+    for (int i = 0; i < n; i++) {
+        const halow_scan_entry_t *e = &roam_candidates[i];
+        if (strcmp(e->ssid, ssid) != 0 || memcmp(e->bssid, current, sizeof(current)) == 0) {
+            continue;
+        }
+        if (e->rssi < rssi_dbm + roam_hysteresis_db) {
+            break;
+        }
+        *candidate = *e;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Hand over to a candidate and time it
+ */
+static void halow_roam_handover(const halow_scan_entry_t *candidate, int32_t rssi_dbm)
+{
+    uint8_t from[HALOW_SCAN_BSSID_LEN] = {0};
+    const uint8_t *to = candidate->bssid;
+
+    mmwlan_get_bssid(from);
+    printf(COLOR_CYAN "Roaming: %ld dBm on %02x:%02x:%02x:%02x:%02x:%02x -> "
+           "%02x:%02x:%02x:%02x:%02x:%02x (%d dBm, %.3f MHz)\n" COLOR_RESET "> ",
+           (long)rssi_dbm, from[0], from[1], from[2], from[3], from[4], from[5],
+           to[0], to[1], to[2], to[3], to[4], to[5], candidate->rssi, candidate->channel_freq_hz / 1e6);
+    fflush(stdout);
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = halow_roam_to(to, candidate->channel_freq_hz, candidate->bw_mhz, HALOW_ROAM_ASSOC_TIMEOUT_MS);
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+
+    if (err == ESP_ERR_INVALID_STATE) {
+        // Nothing was changed (not connected any more or no saved credentials)
+        roam_backoff = HALOW_ROAM_BACKOFF_MAX;
+        return;
+    }
+    halow_roam_record(from, to, ms, err);
+
+    if (err == ESP_OK) {
+        printf(COLOR_GREEN "Roamed in %lu ms\n" COLOR_RESET "> ", (unsigned long)ms);
+    } else if (err == ESP_ERR_TIMEOUT) {
+        printf(COLOR_YELLOW "Roam failed, back on the previous BSS after %lu ms\n" COLOR_RESET "> ", (unsigned long)ms);
+    } else {
+        printf(COLOR_RED "Roam failed, searching for the network\n" COLOR_RESET "> ");
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief One roaming check
+ */
+static void halow_roam_step(void)
+{
+    bool force = __atomic_exchange_n(&roam_force, false, __ATOMIC_ACQ_REL);
+
+    if (mmwlan_get_sta_state() != MMWLAN_STA_CONNECTED) {
+        roam_rssi_avg = HALOW_ROAM_RSSI_NONE;
+        roam_low_since_us = 0;
+        return;
+    }
+    if (!__atomic_load_n(&roam_enabled, __ATOMIC_ACQUIRE) && !force) {
+        // Start from a clean slate when re-enabled
+        roam_low_since_us = 0;
+        roam_backoff = 1;
+        return;
+    }
+
+    int32_t rssi = mmwlan_get_rssi();
+    if (rssi == INT32_MIN) {
+        return;
+    }
+    // Smooth over a few seconds so a single weak beacon does not trigger a scan
+    roam_rssi_avg = (roam_rssi_avg == HALOW_ROAM_RSSI_NONE) ? rssi : (3 * roam_rssi_avg + rssi) / 4;
+
+    int64_t now = esp_timer_get_time();
+    if (!force) {
+        if (roam_rssi_avg >= roam_threshold_dbm) {
+            roam_low_since_us = 0;
+            roam_backoff = 1;
+            return;
+        }
+        if (roam_low_since_us == 0) {
+            roam_low_since_us = now;
+        }
+        if (now - roam_low_since_us < (int64_t)CONFIG_HALOW_ROAM_LOW_RSSI_HOLD_S * 1000000) {
+            return;
+        }
+        if (roam_last_scan_us != 0 &&
+            now - roam_last_scan_us < (int64_t)CONFIG_HALOW_ROAM_SCAN_INTERVAL_S * roam_backoff * 1000000) {
+            return;
+        }
+    }
+
+    roam_last_scan_us = now;
+    esp_err_t err = halow_background_scan(HALOW_ROAM_SCAN_TIMEOUT_MS);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Background scan failed: %s", esp_err_to_name(err));
+        return;
+    }
+
+    halow_scan_entry_t candidate;
+    portENTER_CRITICAL(&roam_lock);
+    roam_stats.scans++;
+    portEXIT_CRITICAL(&roam_lock);
+    if (!halow_roam_pick(roam_rssi_avg, &candidate)) {
+        portENTER_CRITICAL(&roam_lock);
+        roam_stats.no_candidate++;
+        portEXIT_CRITICAL(&roam_lock);
+        if (roam_backoff < HALOW_ROAM_BACKOFF_MAX) {
+            roam_backoff *= 2;
+        }
+        if (force) {
+            printf(COLOR_YELLOW "No BSS %d dB better than %ld dBm\n" COLOR_RESET "> ",
+                   roam_hysteresis_db, (long)roam_rssi_avg);
+            fflush(stdout);
+        }
+        return;
+    }
+
+    roam_backoff = 1;
+    halow_roam_handover(&candidate, roam_rssi_avg);
+
+    // New link, start measuring from scratch
+    roam_rssi_avg = HALOW_ROAM_RSSI_NONE;
+    roam_low_since_us = 0;
+    roam_last_scan_us = esp_timer_get_time();
+}
+
+/**
+ * @brief Roaming task
+ */
+static void halow_roam_task(void *arg)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(HALOW_ROAM_CHECK_MS));
+        halow_roam_step();
+    }
+}
+
+/**
+ * @brief Start the roaming task
+ */
+esp_err_t halow_roam_init(void)
+{
+    if (roam_task_handle) {
+        return ESP_OK;
+    }
+
+    if (xTaskCreate(halow_roam_task, "halow_roam", HALOW_ROAM_TASK_STACK, NULL,
+                    HALOW_ROAM_TASK_PRIORITY, &roam_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create roaming task");
+        roam_task_handle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Roaming %s (threshold %d dBm, hysteresis %d dB)",
+             roam_enabled ? "enabled" : "disabled", roam_threshold_dbm, roam_hysteresis_db);
+    return ESP_OK;
+}
+
+/**
+ * @brief Enable or disable roaming at runtime
+ */
+void halow_roam_set_enabled(bool enable)
+{
+    __atomic_store_n(&roam_enabled, enable, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Get roaming counters and latency distribution
+ */
+void halow_roam_get_stats(halow_roam_stats_t *stats)
+{
+    portENTER_CRITICAL(&roam_lock);
+    *stats = roam_stats;
+    portEXIT_CRITICAL(&roam_lock);
+}
+
+/**
+ * @brief Print settings, state, counters and the latency distribution
+ */
+static void halow_roam_print_status(void)
+{
+    halow_roam_stats_t st;
+    uint8_t from[HALOW_SCAN_BSSID_LEN];
+    uint8_t to[HALOW_SCAN_BSSID_LEN];
+    uint32_t last_ms;
+    esp_err_t last_result;
+    bool last_valid;
+
+    portENTER_CRITICAL(&roam_lock);
+    st = roam_stats;
+    memcpy(from, roam_last_from, sizeof(from));
+    memcpy(to, roam_last_to, sizeof(to));
+    last_ms = roam_last_ms;
+    last_result = roam_last_result;
+    last_valid = roam_last_valid;
+    portEXIT_CRITICAL(&roam_lock);
+
+    printf("\n" COLOR_CYAN COLOR_BOLD "=== HALOW ROAMING ===" COLOR_RESET "\n\n");
+    printf("Roaming:     %s\n", roam_enabled ? COLOR_GREEN "enabled" COLOR_RESET : COLOR_YELLOW "disabled" COLOR_RESET);
+    printf("Threshold:   %d dBm for %d s, hysteresis %d dB\n",
+           roam_threshold_dbm, CONFIG_HALOW_ROAM_LOW_RSSI_HOLD_S, roam_hysteresis_db);
+    printf("Scan every:  %lu s (base %d s, backoff x%lu)\n",
+           (unsigned long)(CONFIG_HALOW_ROAM_SCAN_INTERVAL_S * roam_backoff),
+           CONFIG_HALOW_ROAM_SCAN_INTERVAL_S, (unsigned long)roam_backoff);
+    if (roam_rssi_avg != HALOW_ROAM_RSSI_NONE) {
+        printf("Link RSSI:   %ld dBm (smoothed)%s\n", (long)roam_rssi_avg,
+               roam_low_since_us ? COLOR_YELLOW " below threshold" COLOR_RESET : "");
+    } else {
+        printf("Link RSSI:   n/a\n");
+    }
+    printf("Scans:       %lu (%lu without a better BSS)\n", (unsigned long)st.scans, (unsigned long)st.no_candidate);
+    printf("Handovers:   %lu ok, %lu failed\n", (unsigned long)st.roams, (unsigned long)st.failed);
+
+    if (last_valid) {
+        printf("Last:        %02x:%02x:%02x:%02x:%02x:%02x -> %02x:%02x:%02x:%02x:%02x:%02x, %lu ms, %s\n",
+               from[0], from[1], from[2], from[3], from[4], from[5],
+               to[0], to[1], to[2], to[3], to[4], to[5], (unsigned long)last_ms,
+               last_result == ESP_OK ? "ok" : esp_err_to_name(last_result));
+    }
+
+    if (st.roams > 0) {
+        printf("\nHandover latency: min %lu ms, avg %lu ms, max %lu ms\n",
+               (unsigned long)st.latency_min_ms, (unsigned long)(st.latency_sum_ms / st.roams),
+               (unsigned long)st.latency_max_ms);
+        for (int i = 0; i < HALOW_ROAM_LATENCY_BUCKETS; i++) {
+            if (i < HALOW_ROAM_LATENCY_BUCKETS - 1) {
+                printf("  < %5lu ms  %5lu  %3lu%%\n", (unsigned long)roam_latency_bounds_ms[i],
+                       (unsigned long)st.latency_hist[i], (unsigned long)(st.latency_hist[i] * 100 / st.roams));
+            } else {
+                printf("  >=%5lu ms  %5lu  %3lu%%\n", (unsigned long)roam_latency_bounds_ms[i - 1],
+                       (unsigned long)st.latency_hist[i], (unsigned long)(st.latency_hist[i] * 100 / st.roams));
+            }
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Console handler for 'halow roam ...'
+ */
+int halow_roam_cmd(int argc, char **argv)
+{
+    if (argc < 2 || strcmp(argv[1], "status") == 0) {
+        halow_roam_print_status();
+        return 0;
+    }
+
+    const char *subcmd = argv[1];
+    if (strcmp(subcmd, "on") == 0 || strcmp(subcmd, "off") == 0) {
+        halow_roam_set_enabled(strcmp(subcmd, "on") == 0);
+        printf(COLOR_GREEN "Roaming %s\n" COLOR_RESET, roam_enabled ? "enabled" : "disabled");
+    } else if (strcmp(subcmd, "now") == 0) {
+        if (mmwlan_get_sta_state() != MMWLAN_STA_CONNECTED) {
+            printf(COLOR_YELLOW "Not connected\n" COLOR_RESET);
+            return 1;
+        }
+        __atomic_store_n(&roam_force, true, __ATOMIC_RELEASE);
+        xTaskNotifyGive(roam_task_handle);
+        printf("Background scan requested\n");
+    } else if (strcmp(subcmd, "reset") == 0) {
+        portENTER_CRITICAL(&roam_lock);
+        memset(&roam_stats, 0, sizeof(roam_stats));
+        roam_last_valid = false;
+        portEXIT_CRITICAL(&roam_lock);
+        printf(COLOR_GREEN "Roaming statistics reset\n" COLOR_RESET);
+    } else if (strcmp(subcmd, "threshold") == 0 && argc >= 3) {
+        int dbm = atoi(argv[2]);
+        if (dbm < -120 || dbm > 0) {
+            printf(COLOR_RED "Threshold must be -120..0 dBm\n" COLOR_RESET);
+            return 1;
+        }
+        roam_threshold_dbm = dbm;
+        printf(COLOR_GREEN "Roam threshold %d dBm\n" COLOR_RESET, dbm);
+    } else if (strcmp(subcmd, "hysteresis") == 0 && argc >= 3) {
+        int db = atoi(argv[2]);
+        if (db < 0 || db > 40) {
+            printf(COLOR_RED "Hysteresis must be 0..40 dB\n" COLOR_RESET);
+            return 1;
+        }
+        roam_hysteresis_db = db;
+        printf(COLOR_GREEN "Roam hysteresis %d dB\n" COLOR_RESET, db);
+    } else {
+        printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+        printf("  halow roam [status]            - Settings, counters and handover latency distribution\n");
+        printf("  halow roam on|off              - Enable or disable roaming\n");
+        printf("  halow roam now                 - Background scan and roam if a better BSS is found\n");
+        printf("  halow roam reset               - Clear the statistics\n");
+        printf("  halow roam threshold <dBm>     - RSSI below which background scans start\n");
+        printf("  halow roam hysteresis <dB>     - Margin a candidate must beat the link by\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file halow_roam.h
+ * @brief Background-scan roaming between HaLow APs for Halow RTOS
+ *
+ * Features:
+ * - Low-priority task tracks a smoothed RSSI of the current association
+ * - Background scans only after RSSI stayed below the threshold for a hold
+ *   time, at most once per scan interval (backing off while nothing better
+ *   is found)
+ * - Picks the strongest BSS of the same SSID from the scan cache that beats
+ *   the current RSSI by the hysteresis margin
+ * - Hands over with the targeted reconnect path and times every handover,
+ *   'halow roam' shows the latency distribution
+ */
+
+#ifndef HALOW_ROAM_H
+#define HALOW_ROAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define HALOW_ROAM_LATENCY_BUCKETS  7
+
+// Roaming counters and handover latency distribution
+typedef struct {
+    uint32_t scans;             // Background scans run
+    uint32_t no_candidate;      // Scans that found no better BSS
+    uint32_t roams;             // Successful handovers
+    uint32_t failed;            // Handovers that fell back to the previous BSS or a full search
+    uint32_t latency_min_ms;
+    uint32_t latency_max_ms;
+    uint64_t latency_sum_ms;
+    uint32_t latency_hist[HALOW_ROAM_LATENCY_BUCKETS]; // <100, <200, <500, <1000, <2000, <5000, >=5000 ms
+} halow_roam_stats_t;
+
+/**
+ * @brief Start the roaming task
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t halow_roam_init(void);
+
+/**
+ * @brief Enable or disable roaming at runtime
+ * @param enable true to roam
+ */
+void halow_roam_set_enabled(bool enable);
+
+/**
+ * @brief Get roaming counters and latency distribution
+ * @param stats Pointer to store the statistics
+ */
+void halow_roam_get_stats(halow_roam_stats_t *stats);
+
+/**
+ * @brief Console handler for 'halow roam [on|off|now|reset|threshold <dBm>|hysteresis <dB>]'
+ * @param argc Argument count (argv[0] is "roam")
+ * @param argv Arguments
+ * @return 0 on success, 1 on error
+ */
+int halow_roam_cmd(int argc, char **argv);
+
+#endif // HALOW_ROAM_H
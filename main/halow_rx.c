@@ -0,0 +1,540 @@
+/**
+ * @file halow_rx.c
+ * @brief Zero-copy HaLow RX dispatch pipeline implementation for Halow RTOS
+ *
+ * The mmwlan RX callback runs in the WLAN stack's context, so it must never
+ * block or do real work. It only timestamps the packet and stores the mmpkt
+ * reference in a single-producer/single-consumer ring. The worker task owns
+ * the consumer side: it parses the headers once, hands a view of the frame to
+ * every matching consumer and then releases the packet back to the driver.
+ *
+ * mmwlan has a single RX callback and the pipeline takes it over from mmipal,
+ * so the pipeline is also the IP stack's only source of frames. Frames that
+ * no consumer filter matches go straight to the lwIP netif from the callback,
+ * exactly as mmipal's own handler would; frames that matched but were not
+ * accepted by any consumer are passed on from the worker.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "halow_rx.h"
+#include "trace_buffer.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+
+// Morse Micro SDK includes
+#include "mmpkt.h"
+
+static const char *TAG = "halow_rx";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_BOLD      "\033[1m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define HALOW_RX_RING_SIZE      CONFIG_HALOW_RX_RING_SIZE
+#define HALOW_RX_RING_MASK      (HALOW_RX_RING_SIZE - 1)
+#define HALOW_RX_TASK_PRIORITY  CONFIG_HALOW_RX_TASK_PRIORITY
+#define HALOW_RX_TASK_STACK     CONFIG_HALOW_RX_TASK_STACK_SIZE
+#define HALOW_RX_TASK_CORE      (CONFIG_HALOW_RX_TASK_CORE < 0 ? tskNO_AFFINITY : CONFIG_HALOW_RX_TASK_CORE)
+
+_Static_assert((HALOW_RX_RING_SIZE & HALOW_RX_RING_MASK) == 0,
+               "CONFIG_HALOW_RX_RING_SIZE must be a power of two");
+
+// Frame layout offsets
+#define ETH_HDR_LEN             14
+#define ETH_TYPE_OFFSET         12
+#define IPV4_MIN_HDR_LEN        20
+#define IPV4_PROTO_OFFSET       9
+#define L4_PORTS_LEN            4
+
+// Ring slot: packet reference plus callback timestamp
+typedef struct {
+    struct mmpkt *pkt;
+    int64_t rx_time_us;
+} halow_rx_slot_t;
+
+// SPSC ring. head is written only by the RX callback, tail only by the worker.
+typedef struct {
+    halow_rx_slot_t slots[HALOW_RX_RING_SIZE];
+    uint32_t head;
+    uint32_t tail;
+} halow_rx_ring_t;
+
+// Registered consumer
+typedef struct {
+    bool in_use;
+    char name[HALOW_RX_CONSUMER_NAME_LEN + 1];
+    halow_rx_filter_t filter;
+    halow_rx_consumer_cb_t cb;
+    void *arg;
+    uint32_t delivered;
+    uint32_t dropped;
+    uint64_t latency_sum_us;
+    uint32_t latency_max_us;
+} halow_rx_consumer_t;
+
+static halow_rx_ring_t rx_ring;
+static halow_rx_consumer_t rx_consumers[HALOW_RX_MAX_CONSUMERS];
+static SemaphoreHandle_t rx_consumers_mutex = NULL;
+static TaskHandle_t rx_worker_task = NULL;
+static struct netif *rx_netif = NULL;      // IP stack interface for unclaimed frames
+
+// Pipeline counters
+static uint32_t rx_submitted = 0;
+static uint32_t rx_ring_drops = 0;
+static uint32_t rx_ip_forwarded = 0;      // Updated from the RX callback and the worker
+static uint32_t rx_ip_drops = 0;
+static uint32_t rx_ring_high_water = 0;
+static uint32_t rx_total_frames = 0;       // Lifetime totals of every frame, written by the RX callback only
+static uint32_t rx_total_bytes = 0;
+
+/**
+ * @brief Parse Ethernet/IPv4/L4 headers into a frame view
+ */
+static void halow_rx_parse_frame(const uint8_t *data, size_t len, halow_rx_frame_t *frame)
+{
+    memset(frame, 0, sizeof(*frame));
+    frame->data = data;
+    frame->len = len;
+
+    if (len < ETH_HDR_LEN) {
+        return;
+    }
+    frame->ethertype = ((uint16_t)data[ETH_TYPE_OFFSET] << 8) | data[ETH_TYPE_OFFSET + 1];
+
+    if (frame->ethertype != HALOW_RX_ETHERTYPE_IPV4 || len < ETH_HDR_LEN + IPV4_MIN_HDR_LEN) {
+        return;
+    }
+
+    const uint8_t *ip = data + ETH_HDR_LEN;
+    size_t ihl = (ip[0] & 0x0F) * 4;
+    frame->ip_proto = ip[IPV4_PROTO_OFFSET];
+
+    if ((frame->ip_proto == HALOW_RX_IP_PROTO_TCP || frame->ip_proto == HALOW_RX_IP_PROTO_UDP) &&
+        ihl >= IPV4_MIN_HDR_LEN && len >= ETH_HDR_LEN + ihl + L4_PORTS_LEN) {
+        const uint8_t *l4 = ip + ihl;
+        frame->src_port = ((uint16_t)l4[0] << 8) | l4[1];
+        frame->dst_port = ((uint16_t)l4[2] << 8) | l4[3];
+        frame->l4_offset = ETH_HDR_LEN + ihl;
+    }
+}
+
+/**
+ * @brief Check whether a frame matches a consumer filter
+ */
+static bool halow_rx_filter_match(const halow_rx_filter_t *filter, const halow_rx_frame_t *frame)
+{
+    if (filter->ethertype != HALOW_RX_ETHERTYPE_ANY && filter->ethertype != frame->ethertype) {
+        return false;
+    }
+    if (filter->ip_proto != HALOW_RX_IP_PROTO_ANY && filter->ip_proto != frame->ip_proto) {
+        return false;
+    }
+    if (filter->dst_port != HALOW_RX_PORT_ANY && filter->dst_port != frame->dst_port) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Check whether any registered consumer filter matches a frame
+ * Reads the consumer table without locking, like the overflow path.
+ */
+static bool halow_rx_any_match(const halow_rx_frame_t *frame)
+{
+    for (int i = 0; i < HALOW_RX_MAX_CONSUMERS; i++) {
+        if (__atomic_load_n(&rx_consumers[i].in_use, __ATOMIC_ACQUIRE) &&
+            halow_rx_filter_match(&rx_consumers[i].filter, frame)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Hand an unclaimed packet to the lwIP netif and release it
+ * Safe from both the RX callback and the worker: netif->input queues the
+ * pbuf to the tcpip thread.
+ */
+static void halow_rx_forward(struct mmpkt *pkt)
+{
+    struct netif *netif = __atomic_load_n(&rx_netif, __ATOMIC_ACQUIRE);
+    struct pbuf *p = NULL;
+
+    if (netif) {
+        struct mmpktview *view = mmpkt_open(pkt);
+        uint16_t len = (uint16_t)mmpkt_get_data_length(view);
+        p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
+        if (p) {
+            pbuf_take(p, mmpkt_get_data_start(view), len);
+        }
+        mmpkt_close(&view);
+    }
+    mmpkt_release(pkt);
+
+    if (!p) {
+        __atomic_fetch_add(&rx_ip_drops, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if (netif->input(p, netif) != ERR_OK) {
+        pbuf_free(p);
+        __atomic_fetch_add(&rx_ip_drops, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    __atomic_fetch_add(&rx_ip_forwarded, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Attribute a ring overflow drop to every consumer that would have matched
+ * Only runs on the (rare) overflow path; reads the consumer table without locking.
+ */
+static void halow_rx_account_overflow(const halow_rx_frame_t *frame)
+{
+    for (int i = 0; i < HALOW_RX_MAX_CONSUMERS; i++) {
+        if (rx_consumers[i].in_use && halow_rx_filter_match(&rx_consumers[i].filter, frame)) {
+            __atomic_fetch_add(&rx_consumers[i].dropped, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief Submit a received packet from the mmwlan RX callback
+ */
+bool halow_rx_submit(struct mmpkt *rxpkt)
+{
+    if (rxpkt == NULL) {
+        return false;
+    }
+
+    struct mmpktview *view = mmpkt_open(rxpkt);
+    halow_rx_frame_t frame;
+    halow_rx_parse_frame(mmpkt_get_data_start(view), mmpkt_get_data_length(view), &frame);
+    mmpkt_close(&view);
+
+    // This is the only RX path, so the totals cover IP traffic as well
+    __atomic_store_n(&rx_total_bytes, rx_total_bytes + frame.len, __ATOMIC_RELAXED);
+    __atomic_store_n(&rx_total_frames, rx_total_frames + 1, __ATOMIC_RELAXED);
+
+    // IP traffic nobody filters for skips the ring and the worker hop
+    if (rx_worker_task == NULL || !halow_rx_any_match(&frame)) {
+        halow_rx_forward(rxpkt);
+        return true;
+    }
+
+    uint32_t head = rx_ring.head;
+    uint32_t tail = __atomic_load_n(&rx_ring.tail, __ATOMIC_ACQUIRE);
+    uint32_t depth = head - tail;
+
+    if (depth >= HALOW_RX_RING_SIZE) {
+        rx_ring_drops++;
+        TRACE_EVENT(TRACE_EV_HALOW_RX_DROP, depth);
+        halow_rx_account_overflow(&frame);
+        mmpkt_release(rxpkt);
+        return false;
+    }
+
+    halow_rx_slot_t *slot = &rx_ring.slots[head & HALOW_RX_RING_MASK];
+    slot->pkt = rxpkt;
+    slot->rx_time_us = esp_timer_get_time();
+    __atomic_store_n(&rx_ring.head, head + 1, __ATOMIC_RELEASE);
+
+    rx_submitted++;
+    TRACE_EVENT(TRACE_EV_HALOW_RX_QUEUED, depth + 1);
+    if (depth + 1 > rx_ring_high_water) {
+        rx_ring_high_water = depth + 1;
+    }
+
+    xTaskNotifyGive(rx_worker_task);
+    return true;
+}
+
+/**
+ * @brief Deliver one frame to all matching consumers
+ * Caller holds rx_consumers_mutex.
+ * @return true if at least one consumer accepted the frame
+ */
+static bool halow_rx_dispatch(const halow_rx_frame_t *frame)
+{
+    bool claimed = false;
+
+    for (int i = 0; i < HALOW_RX_MAX_CONSUMERS; i++) {
+        halow_rx_consumer_t *consumer = &rx_consumers[i];
+        if (!consumer->in_use || !halow_rx_filter_match(&consumer->filter, frame)) {
+            continue;
+        }
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - frame->rx_time_us);
+        if (consumer->cb(frame, consumer->arg)) {
+            claimed = true;
+            consumer->delivered++;
+            consumer->latency_sum_us += latency_us;
+            if (latency_us > consumer->latency_max_us) {
+                consumer->latency_max_us = latency_us;
+            }
+        } else {
+            __atomic_fetch_add(&consumer->dropped, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return claimed;
+}
+
+/**
+ * @brief RX worker task: drains the ring and dispatches frames
+ */
+static void halow_rx_worker(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        uint32_t head = __atomic_load_n(&rx_ring.head, __ATOMIC_ACQUIRE);
+        uint32_t tail = rx_ring.tail;
+        if (head == tail) {
+            continue;
+        }
+
+        xSemaphoreTakeRecursive(rx_consumers_mutex, portMAX_DELAY);
+
+        while (tail != head) {
+            halow_rx_slot_t *slot = &rx_ring.slots[tail & HALOW_RX_RING_MASK];
+            struct mmpkt *pkt = slot->pkt;
+
+            struct mmpktview *view = mmpkt_open(pkt);
+            halow_rx_frame_t frame;
+            halow_rx_parse_frame(mmpkt_get_data_start(view), mmpkt_get_data_length(view), &frame);
+            frame.rx_time_us = slot->rx_time_us;
+
+            TRACE_EVENT(TRACE_EV_HALOW_RX_DISPATCH, frame.len);
+            bool claimed = halow_rx_dispatch(&frame);
+            TRACE_EVENT(TRACE_EV_HALOW_RX_DONE, frame.ethertype);
+
+            mmpkt_close(&view);
+            if (claimed) {
+                mmpkt_release(pkt);
+            } else {
+                halow_rx_forward(pkt);
+            }
+
+            tail++;
+            __atomic_store_n(&rx_ring.tail, tail, __ATOMIC_RELEASE);
+
+            // Pick up frames that arrived while dispatching
+            if (tail == head) {
+                head = __atomic_load_n(&rx_ring.head, __ATOMIC_ACQUIRE);
+            }
+        }
+
+        xSemaphoreGiveRecursive(rx_consumers_mutex);
+    }
+}
+
+/**
+ * @brief Initialize the RX pipeline and start the worker task
+ */
+esp_err_t halow_rx_init(void)
+{
+    if (rx_worker_task != NULL) {
+        return ESP_OK;
+    }
+
+    memset(&rx_ring, 0, sizeof(rx_ring));
+    memset(rx_consumers, 0, sizeof(rx_consumers));
+
+    rx_consumers_mutex = xSemaphoreCreateRecursiveMutex();
+    if (!rx_consumers_mutex) {
+        ESP_LOGE(TAG, "Failed to create RX consumer mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    BaseType_t ret = xTaskCreatePinnedToCore(halow_rx_worker, "halow_rx", HALOW_RX_TASK_STACK, NULL,
+                                             HALOW_RX_TASK_PRIORITY, &rx_worker_task, HALOW_RX_TASK_CORE);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create RX worker task");
+        vSemaphoreDelete(rx_consumers_mutex);
+        rx_consumers_mutex = NULL;
+        rx_worker_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "RX pipeline started (ring=%d slots)", HALOW_RX_RING_SIZE);
+    return ESP_OK;
+}
+
+/**
+ * @brief Attach the IP stack interface that receives unclaimed frames
+ */
+void halow_rx_attach_netif(struct netif *netif)
+{
+    __atomic_store_n(&rx_netif, netif, __ATOMIC_RELEASE);
+    ESP_LOGI(TAG, "Unclaimed frames forwarded to netif %c%c",
+             netif ? netif->name[0] : '-', netif ? netif->name[1] : '-');
+}
+
+/**
+ * @brief Register a frame consumer
+ */
+esp_err_t halow_rx_register_consumer(const char *name, const halow_rx_filter_t *filter,
+                                     halow_rx_consumer_cb_t cb, void *arg, int *out_id)
+{
+    if (!cb || !rx_consumers_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    xSemaphoreTakeRecursive(rx_consumers_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < HALOW_RX_MAX_CONSUMERS; i++) {
+        halow_rx_consumer_t *consumer = &rx_consumers[i];
+        if (consumer->in_use) {
+            continue;
+        }
+
+        memset(consumer, 0, sizeof(*consumer));
+        strncpy(consumer->name, name ? name : "anon", HALOW_RX_CONSUMER_NAME_LEN);
+        consumer->name[HALOW_RX_CONSUMER_NAME_LEN] = '\0';
+        if (filter) {
+            consumer->filter = *filter;
+        }
+        consumer->cb = cb;
+        consumer->arg = arg;
+        // Publish last so the overflow path never sees a half-filled entry
+        __atomic_store_n(&consumer->in_use, true, __ATOMIC_RELEASE);
+
+        if (out_id) {
+            *out_id = i;
+        }
+        err = ESP_OK;
+        ESP_LOGI(TAG, "RX consumer '%s' registered (id=%d)", consumer->name, i);
+        break;
+    }
+
+    xSemaphoreGiveRecursive(rx_consumers_mutex);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "RX consumer table full, cannot register '%s'", name ? name : "anon");
+    }
+    return err;
+}
+
+/**
+ * @brief Unregister a frame consumer
+ */
+esp_err_t halow_rx_unregister_consumer(int id)
+{
+    if (id < 0 || id >= HALOW_RX_MAX_CONSUMERS || !rx_consumers_mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTakeRecursive(rx_consumers_mutex, portMAX_DELAY);
+    bool was_in_use = rx_consumers[id].in_use;
+    __atomic_store_n(&rx_consumers[id].in_use, false, __ATOMIC_RELEASE);
+    xSemaphoreGiveRecursive(rx_consumers_mutex);
+
+    return was_in_use ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+/**
+ * @brief Get statistics for a consumer
+ */
+esp_err_t halow_rx_get_consumer_stats(int id, halow_rx_consumer_stats_t *stats)
+{
+    if (id < 0 || id >= HALOW_RX_MAX_CONSUMERS || !stats || !rx_consumers[id].in_use) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const halow_rx_consumer_t *consumer = &rx_consumers[id];
+    memcpy(stats->name, consumer->name, sizeof(stats->name));
+    stats->filter = consumer->filter;
+    stats->delivered = consumer->delivered;
+    stats->dropped = consumer->dropped;
+    stats->latency_avg_us = consumer->delivered ?
+                            (uint32_t)(consumer->latency_sum_us / consumer->delivered) : 0;
+    stats->latency_max_us = consumer->latency_max_us;
+    return ESP_OK;
+}
+
+/**
+ * @brief Get lifetime RX totals
+ */
+void halow_rx_get_totals(uint32_t *frames, uint32_t *bytes)
+{
+    if (frames) {
+        *frames = __atomic_load_n(&rx_total_frames, __ATOMIC_RELAXED);
+    }
+    if (bytes) {
+        *bytes = __atomic_load_n(&rx_total_bytes, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Reset pipeline and consumer counters
+ */
+void halow_rx_reset_stats(void)
+{
+    if (!rx_consumers_mutex) {
+        return;
+    }
+
+    xSemaphoreTakeRecursive(rx_consumers_mutex, portMAX_DELAY);
+    rx_submitted = 0;
+    rx_ring_drops = 0;
+    rx_ip_forwarded = 0;
+    rx_ip_drops = 0;
+    rx_ring_high_water = 0;
+    for (int i = 0; i < HALOW_RX_MAX_CONSUMERS; i++) {
+        rx_consumers[i].delivered = 0;
+        rx_consumers[i].dropped = 0;
+        rx_consumers[i].latency_sum_us = 0;
+        rx_consumers[i].latency_max_us = 0;
+    }
+    xSemaphoreGiveRecursive(rx_consumers_mutex);
+}
+
+/**
+ * @brief Print pipeline and per-consumer statistics
+ */
+void halow_rx_print_stats(void)
+{
+    uint32_t depth = __atomic_load_n(&rx_ring.head, __ATOMIC_ACQUIRE) -
+                     __atomic_load_n(&rx_ring.tail, __ATOMIC_ACQUIRE);
+
+    printf("\n" COLOR_CYAN COLOR_BOLD "=== HALOW RX PIPELINE ===" COLOR_RESET "\n\n");
+    printf("Ring:        %lu/%d in use (high water %lu)\n",
+           (unsigned long)depth, HALOW_RX_RING_SIZE, (unsigned long)rx_ring_high_water);
+    printf("Submitted:   %lu\n", (unsigned long)rx_submitted);
+    printf("Ring drops:  %lu\n", (unsigned long)rx_ring_drops);
+    printf("To IP stack: %lu\n", (unsigned long)rx_ip_forwarded);
+    printf("IP drops:    %lu\n\n", (unsigned long)rx_ip_drops);
+
+    printf(COLOR_YELLOW "Id  Name             Filter                Delivered  Dropped  Avg(us)  Max(us)" COLOR_RESET "\n");
+    printf("--  ---------------  --------------------  ---------  -------  -------  -------\n");
+
+    int count = 0;
+    for (int i = 0; i < HALOW_RX_MAX_CONSUMERS; i++) {
+        halow_rx_consumer_stats_t stats;
+        if (halow_rx_get_consumer_stats(i, &stats) != ESP_OK) {
+            continue;
+        }
+
+        char filter_str[24];
+        snprintf(filter_str, sizeof(filter_str), "0x%04x/%u/%u",
+                 stats.filter.ethertype, stats.filter.ip_proto, stats.filter.dst_port);
+
+        printf("%2d  %-15s  %-20s  %9lu  %7lu  %7lu  %7lu\n",
+               i, stats.name, filter_str,
+               (unsigned long)stats.delivered, (unsigned long)stats.dropped,
+               (unsigned long)stats.latency_avg_us, (unsigned long)stats.latency_max_us);
+        count++;
+    }
+
+    if (count == 0) {
+        printf("    (no consumers registered)\n");
+    }
+    printf("\n");
+}
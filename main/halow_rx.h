@@ -0,0 +1,143 @@
+/**
+ * @file halow_rx.h
+ * @brief Zero-copy HaLow RX dispatch pipeline for Halow RTOS
+ *
+ * Features:
+ * - mmwlan RX callback only stores a frame reference in a lock-free SPSC ring
+ * - Dedicated worker task dispatches frames to registered consumers
+ * - Consumer filters by ethertype, IP protocol and destination port
+ * - Per-consumer delivery, drop and latency counters
+ * - Frames no consumer claims are passed on to the lwIP netif
+ */
+
+#ifndef HALOW_RX_H
+#define HALOW_RX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+struct mmpkt;
+struct netif;
+
+#define HALOW_RX_MAX_CONSUMERS      8
+#define HALOW_RX_CONSUMER_NAME_LEN  15
+
+// Well-known ethertypes / IP protocols used in filters
+#define HALOW_RX_ETHERTYPE_ANY      0x0000
+#define HALOW_RX_ETHERTYPE_IPV4     0x0800
+#define HALOW_RX_ETHERTYPE_ARP      0x0806
+#define HALOW_RX_ETHERTYPE_IPV6     0x86DD
+#define HALOW_RX_IP_PROTO_ANY       0
+#define HALOW_RX_IP_PROTO_TCP       6
+#define HALOW_RX_IP_PROTO_UDP       17
+#define HALOW_RX_PORT_ANY           0
+
+// Consumer filter (zero fields match anything)
+typedef struct {
+    uint16_t ethertype;     // Ethertype to match (HALOW_RX_ETHERTYPE_ANY for all)
+    uint8_t ip_proto;       // IPv4 protocol to match (TCP/UDP), 0 for all
+    uint16_t dst_port;      // TCP/UDP destination port to match, 0 for all
+} halow_rx_filter_t;
+
+// Received frame view handed to consumers. Data points into the driver
+// buffer and is only valid for the duration of the consumer callback.
+typedef struct {
+    const uint8_t *data;    // Start of Ethernet header
+    size_t len;             // Total frame length in bytes
+    uint16_t ethertype;     // Ethertype from the Ethernet header
+    uint8_t ip_proto;       // IPv4 protocol, 0 if not IPv4
+    uint16_t src_port;      // TCP/UDP source port, 0 if not applicable
+    uint16_t dst_port;      // TCP/UDP destination port, 0 if not applicable
+    size_t l4_offset;       // Offset of the TCP/UDP header, 0 if not applicable
+    int64_t rx_time_us;     // esp_timer timestamp taken in the RX callback
+} halow_rx_frame_t;
+
+/**
+ * @brief Consumer callback, called from the RX worker task
+ * @param frame Frame view (valid only during the call)
+ * @param arg User argument given at registration
+ * @return true if the frame was accepted, false to count it as dropped
+ */
+typedef bool (*halow_rx_consumer_cb_t)(const halow_rx_frame_t *frame, void *arg);
+
+// Per-consumer statistics
+typedef struct {
+    char name[HALOW_RX_CONSUMER_NAME_LEN + 1];
+    halow_rx_filter_t filter;
+    uint32_t delivered;         // Frames accepted by the consumer
+    uint32_t dropped;           // Frames rejected by the consumer or lost to ring overflow
+    uint32_t latency_avg_us;    // Average callback-to-delivery latency
+    uint32_t latency_max_us;    // Worst callback-to-delivery latency
+} halow_rx_consumer_stats_t;
+
+/**
+ * @brief Initialize the RX pipeline and start the worker task
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t halow_rx_init(void);
+
+/**
+ * @brief Submit a received packet from the mmwlan RX callback
+ * Never blocks; takes ownership of the packet. Frames no consumer filter
+ * matches are handed to the attached netif directly.
+ * @param rxpkt Packet received from mmwlan
+ * @return true if queued or passed to the netif, false if dropped
+ */
+bool halow_rx_submit(struct mmpkt *rxpkt);
+
+/**
+ * @brief Attach the IP stack interface that receives unclaimed frames
+ * Call after mmipal_init() and before taking over the mmwlan RX callback.
+ * Until then, unclaimed frames are released.
+ * @param netif lwIP interface created by mmipal
+ */
+void halow_rx_attach_netif(struct netif *netif);
+
+/**
+ * @brief Register a frame consumer
+ * @param name Short consumer name for statistics
+ * @param filter Frame filter (NULL to receive all frames)
+ * @param cb Consumer callback
+ * @param arg User argument passed to the callback
+ * @param out_id Optional pointer to store the consumer id
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the table is full
+ */
+esp_err_t halow_rx_register_consumer(const char *name, const halow_rx_filter_t *filter,
+                                     halow_rx_consumer_cb_t cb, void *arg, int *out_id);
+
+/**
+ * @brief Unregister a frame consumer
+ * @param id Consumer id returned by halow_rx_register_consumer()
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the id is unknown
+ */
+esp_err_t halow_rx_unregister_consumer(int id);
+
+/**
+ * @brief Get statistics for a consumer
+ * @param id Consumer id
+ * @param stats Pointer to store statistics
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the id is unknown
+ */
+esp_err_t halow_rx_get_consumer_stats(int id, halow_rx_consumer_stats_t *stats);
+
+/**
+ * @brief Get lifetime RX totals (never reset, wrap at 2^32)
+ * Counts every frame mmwlan delivered, whether a consumer or lwIP took it.
+ * @param frames Optional pointer to store frames received
+ * @param bytes Optional pointer to store bytes received
+ */
+void halow_rx_get_totals(uint32_t *frames, uint32_t *bytes);
+
+/**
+ * @brief Reset pipeline and consumer counters
+ */
+void halow_rx_reset_stats(void);
+
+/**
+ * @brief Print pipeline and per-consumer statistics
+ */
+void halow_rx_print_stats(void);
+
+#endif // HALOW_RX_H
@@ -0,0 +1,289 @@
+/**
+ * @file halow_scan_cache.c
+ * @brief HaLow scan result cache implementation for Halow RTOS
+ *
+ * Full-band scans over an S1G channel list take seconds, so results are kept
+ * instead of being printed and discarded. The table is small enough that
+ * linear search by BSSID is cheaper than maintaining a separate index.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "halow_scan_cache.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Morse Micro SDK includes
+#include "mmwlan.h"
+
+static const char *TAG = "halow_scan";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define SCAN_CACHE_MAX_AGE_US   ((int64_t)CONFIG_HALOW_SCAN_CACHE_MAX_AGE_S * 1000000)
+
+typedef struct {
+    bool in_use;
+    halow_scan_entry_t entry;
+} scan_cache_slot_t;
+
+static scan_cache_slot_t scan_cache[MAX_SCAN_RESULTS];
+static SemaphoreHandle_t scan_cache_mutex = NULL;
+
+/**
+ * @brief Check whether a cached entry is still fresh
+ */
+static bool scan_cache_is_fresh(const halow_scan_entry_t *entry, int64_t now_us)
+{
+    return (now_us - entry->last_seen_us) <= SCAN_CACHE_MAX_AGE_US;
+}
+
+/**
+ * @brief Find the slot holding a BSSID
+ * Caller holds scan_cache_mutex.
+ * @return Slot index, -1 if not cached
+ */
+static int scan_cache_index_of(const uint8_t *bssid)
+{
+    for (int i = 0; i < MAX_SCAN_RESULTS; i++) {
+        if (scan_cache[i].in_use &&
+            memcmp(scan_cache[i].entry.bssid, bssid, HALOW_SCAN_BSSID_LEN) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Pick a slot for a new BSSID: a free slot, else the least recently seen
+ * Caller holds scan_cache_mutex.
+ */
+static int scan_cache_victim(void)
+{
+    int oldest = 0;
+    for (int i = 0; i < MAX_SCAN_RESULTS; i++) {
+        if (!scan_cache[i].in_use) {
+            return i;
+        }
+        if (scan_cache[i].entry.last_seen_us < scan_cache[oldest].entry.last_seen_us) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+/**
+ * @brief Initialize the scan cache
+ */
+esp_err_t halow_scan_cache_init(void)
+{
+    if (scan_cache_mutex) {
+        return ESP_OK;
+    }
+
+    scan_cache_mutex = xSemaphoreCreateMutex();
+    if (!scan_cache_mutex) {
+        ESP_LOGE(TAG, "Failed to create scan cache mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(scan_cache, 0, sizeof(scan_cache));
+    return ESP_OK;
+}
+
+/**
+ * @brief Insert or refresh a scan result
+ */
+bool halow_scan_cache_update(const struct mmwlan_scan_result *result)
+{
+    if (!scan_cache_mutex || !result || !result->bssid) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    bool added = false;
+
+    xSemaphoreTake(scan_cache_mutex, portMAX_DELAY);
+
+    int idx = scan_cache_index_of(result->bssid);
+    if (idx < 0) {
+        idx = scan_cache_victim();
+        memset(&scan_cache[idx], 0, sizeof(scan_cache[idx]));
+        scan_cache[idx].in_use = true;
+        memcpy(scan_cache[idx].entry.bssid, result->bssid, HALOW_SCAN_BSSID_LEN);
+        added = true;
+    }
+
+    halow_scan_entry_t *entry = &scan_cache[idx].entry;
+    size_t ssid_len = result->ssid_len > HALOW_SCAN_SSID_MAXLEN ? HALOW_SCAN_SSID_MAXLEN : result->ssid_len;
+    memcpy(entry->ssid, result->ssid, ssid_len);
+    entry->ssid[ssid_len] = '\0';
+    entry->rssi = result->rssi;
+    entry->op_bw_mhz = result->op_bw_mhz;
+    entry->bw_mhz = result->bw_mhz;
+    entry->channel_freq_hz = result->channel_freq_hz;
+    entry->beacon_interval = result->beacon_interval;
+    entry->capability_info = result->capability_info;
+    entry->seen_count++;
+    entry->last_seen_us = now;
+
+    xSemaphoreGive(scan_cache_mutex);
+    return added;
+}
+
+/**
+ * @brief Find the strongest fresh BSS advertising an SSID
+ */
+bool halow_scan_cache_find_ssid(const char *ssid, halow_scan_entry_t *entry)
+{
+    if (!scan_cache_mutex || !ssid) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    int best = -1;
+
+    xSemaphoreTake(scan_cache_mutex, portMAX_DELAY);
+    for (int i = 0; i < MAX_SCAN_RESULTS; i++) {
+        const halow_scan_entry_t *e = &scan_cache[i].entry;
+        if (!scan_cache[i].in_use || !scan_cache_is_fresh(e, now) || strcmp(e->ssid, ssid) != 0) {
+            continue;
+        }
+        if (best < 0 || e->rssi > scan_cache[best].entry.rssi) {
+            best = i;
+        }
+    }
+    if (best >= 0 && entry) {
+        *entry = scan_cache[best].entry;
+    }
+    xSemaphoreGive(scan_cache_mutex);
+
+    return best >= 0;
+}
+
+/**
+ * @brief Find a fresh entry by BSSID
+ */
+bool halow_scan_cache_find_bssid(const uint8_t *bssid, halow_scan_entry_t *entry)
+{
+    if (!scan_cache_mutex || !bssid) {
+        return false;
+    }
+
+    bool found = false;
+
+    xSemaphoreTake(scan_cache_mutex, portMAX_DELAY);
+    int idx = scan_cache_index_of(bssid);
+    if (idx >= 0 && scan_cache_is_fresh(&scan_cache[idx].entry, esp_timer_get_time())) {
+        if (entry) {
+            *entry = scan_cache[idx].entry;
+        }
+        found = true;
+    }
+    xSemaphoreGive(scan_cache_mutex);
+
+    return found;
+}
+
+/**
+ * @brief Drop an entry
+ */
+void halow_scan_cache_invalidate(const uint8_t *bssid)
+{
+    if (!scan_cache_mutex || !bssid) {
+        return;
+    }
+
+    xSemaphoreTake(scan_cache_mutex, portMAX_DELAY);
+    int idx = scan_cache_index_of(bssid);
+    if (idx >= 0) {
+        scan_cache[idx].in_use = false;
+    }
+    xSemaphoreGive(scan_cache_mutex);
+}
+
+/**
+ * @brief Copy fresh entries sorted by RSSI (strongest first)
+ */
+int halow_scan_cache_snapshot(halow_scan_entry_t *entries, int max_entries)
+{
+    if (!scan_cache_mutex || !entries || max_entries <= 0) {
+        return 0;
+    }
+
+    int64_t now = esp_timer_get_time();
+    int count = 0;
+
+    xSemaphoreTake(scan_cache_mutex, portMAX_DELAY);
+    for (int i = 0; i < MAX_SCAN_RESULTS; i++) {
+        const halow_scan_entry_t *e = &scan_cache[i].entry;
+        if (!scan_cache[i].in_use || !scan_cache_is_fresh(e, now)) {
+            continue;
+        }
+
+        // Insertion sort, the table holds at most MAX_SCAN_RESULTS entries
+        int pos = count < max_entries ? count : max_entries;
+        while (pos > 0 && entries[pos - 1].rssi < e->rssi) {
+            if (pos < max_entries) {
+                entries[pos] = entries[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < max_entries) {
+            entries[pos] = *e;
+            if (count < max_entries) {
+                count++;
+            }
+        }
+    }
+    xSemaphoreGive(scan_cache_mutex);
+
+    return count;
+}
+
+/**
+ * @brief Remove all entries
+ */
+void halow_scan_cache_clear(void)
+{
+    if (!scan_cache_mutex) {
+        return;
+    }
+
+    xSemaphoreTake(scan_cache_mutex, portMAX_DELAY);
+    memset(scan_cache, 0, sizeof(scan_cache));
+    xSemaphoreGive(scan_cache_mutex);
+}
+
+/**
+ * @brief Print the cache contents
+ */
+void halow_scan_cache_print(void)
+{
+    halow_scan_entry_t entries[MAX_SCAN_RESULTS];
+    int count = halow_scan_cache_snapshot(entries, MAX_SCAN_RESULTS);
+    int64_t now = esp_timer_get_time();
+
+    printf(COLOR_CYAN "Cached HaLow networks (max age %ds):\n" COLOR_RESET, CONFIG_HALOW_SCAN_CACHE_MAX_AGE_S);
+    if (count == 0) {
+        printf(COLOR_YELLOW "  No fresh entries, run 'halow scan'\n" COLOR_RESET);
+        return;
+    }
+
+    printf("%-3s %-32s %-17s %-4s %-4s %-9s %s\n", "No", "SSID", "BSSID", "RSSI", "BW", "Freq(MHz)", "Age(s)");
+    printf("--- -------------------------------- ----------------- ---- ---- --------- ------\n");
+    for (int i = 0; i < count; i++) {
+        const halow_scan_entry_t *e = &entries[i];
+        printf("%2d. %-32s %02x:%02x:%02x:%02x:%02x:%02x %4d %4u %9.3f %6lld\n",
+               i + 1, e->ssid,
+               e->bssid[0], e->bssid[1], e->bssid[2], e->bssid[3], e->bssid[4], e->bssid[5],
+               e->rssi, e->op_bw_mhz, e->channel_freq_hz / 1e6,
+               (long long)((now - e->last_seen_us) / 1000000));
+    }
+}
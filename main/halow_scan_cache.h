@@ -0,0 +1,93 @@
+/**
+ * @file halow_scan_cache.h
+ * @brief HaLow scan result cache for Halow RTOS
+ *
+ * Features:
+ * - Fixed-capacity table of scan results (MAX_SCAN_RESULTS entries)
+ * - Deduplication by BSSID, refreshed on every scan
+ * - Aging: entries older than the configured max age are ignored and evicted first
+ * - Lookup by SSID (strongest fresh BSS) and by BSSID
+ */
+
+#ifndef HALOW_SCAN_CACHE_H
+#define HALOW_SCAN_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+struct mmwlan_scan_result;
+
+#define MAX_SCAN_RESULTS            20
+#define HALOW_SCAN_SSID_MAXLEN      32
+#define HALOW_SCAN_BSSID_LEN        6
+
+// Cached BSS
+typedef struct {
+    char ssid[HALOW_SCAN_SSID_MAXLEN + 1];
+    uint8_t bssid[HALOW_SCAN_BSSID_LEN];
+    int16_t rssi;               // Last reported RSSI in dBm
+    uint8_t op_bw_mhz;          // Operating bandwidth
+    uint8_t bw_mhz;             // Bandwidth of the channel the beacon was received on
+    uint32_t channel_freq_hz;   // Centre frequency of the receive channel
+    uint16_t beacon_interval;
+    uint16_t capability_info;
+    uint32_t seen_count;        // Number of times reported since first seen
+    int64_t last_seen_us;       // esp_timer timestamp of the last report
+} halow_scan_entry_t;
+
+/**
+ * @brief Initialize the scan cache
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t halow_scan_cache_init(void);
+
+/**
+ * @brief Insert or refresh a scan result (called from the scan RX callback)
+ * A new BSSID replaces the oldest entry when the table is full.
+ * @param result Scan result from mmwlan
+ * @return true if a new BSSID was added, false if an entry was refreshed
+ */
+bool halow_scan_cache_update(const struct mmwlan_scan_result *result);
+
+/**
+ * @brief Find the strongest fresh BSS advertising an SSID
+ * @param ssid SSID to look up
+ * @param entry Pointer to store the entry (may be NULL)
+ * @return true if found, false otherwise
+ */
+bool halow_scan_cache_find_ssid(const char *ssid, halow_scan_entry_t *entry);
+
+/**
+ * @brief Find a fresh entry by BSSID
+ * @param bssid BSSID to look up
+ * @param entry Pointer to store the entry (may be NULL)
+ * @return true if found, false otherwise
+ */
+bool halow_scan_cache_find_bssid(const uint8_t *bssid, halow_scan_entry_t *entry);
+
+/**
+ * @brief Drop an entry, e.g. after a failed connection attempt
+ * @param bssid BSSID to remove
+ */
+void halow_scan_cache_invalidate(const uint8_t *bssid);
+
+/**
+ * @brief Copy fresh entries sorted by RSSI (strongest first)
+ * @param entries Output array
+ * @param max_entries Capacity of the output array
+ * @return Number of entries copied
+ */
+int halow_scan_cache_snapshot(halow_scan_entry_t *entries, int max_entries);
+
+/**
+ * @brief Remove all entries
+ */
+void halow_scan_cache_clear(void);
+
+/**
+ * @brief Print the cache contents
+ */
+void halow_scan_cache_print(void);
+
+#endif // HALOW_SCAN_CACHE_H
@@ -0,0 +1,330 @@
+/**
+ * @file halow_spibench.c
+ * @brief Host to HaLow chip SPI bus benchmark implementation for Halow RTOS
+ *
+ * The benchmark claims the MM chip SPI bus itself, so it only runs while the
+ * mmhal transport has not been brought up: build with
+ * CONFIG_HALOW_START_AT_BOOT disabled and run it before 'halow on'.
+ * The chip is held in reset and the bus is clocked with 0xFF, the idle
+ * pattern of the SPI protocol, so nothing reaches the chip even if the reset
+ * line is not wired.
+ *
+ * The queued run keeps queue_depth transactions submitted, which is what the
+ * transport needs to overlap DMA setup and completion handling with the next
+ * transfer. The done interrupt is timestamped in post_cb; the time until the
+ * waiting task has the result is the interrupt-to-service latency.
+ *
+ * This is a measurement tool only. The mmhal wlan transport (wlan_hal.c in
+ * the mm-iot-esp32 shims) keeps its own clock, DMA and transfer settings;
+ * the clock, depth and DMA used here are the benchmark's arguments and tune
+ * nothing else. Feeding the results back into the transport is out of scope
+ * for this tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "halow_spibench.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "halow_spibench";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_BOLD      "\033[1m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define SPIBENCH_HOST               SPI2_HOST   // Bus used by the mmhal wlan transport
+#define SPIBENCH_DEFAULT_LEN        4096
+#define SPIBENCH_DEFAULT_TRANSFERS  256
+#define SPIBENCH_DEFAULT_CLOCK_MHZ  20
+#define SPIBENCH_DEFAULT_DEPTH      4
+#define SPIBENCH_DEFAULT_DMA        true
+#define SPIBENCH_TIMEOUT_MS         1000
+
+static volatile int64_t spibench_done_us[HALOW_SPIBENCH_MAX_DEPTH];
+
+/**
+ * @brief Transaction done callback (ISR), timestamps the completion
+ */
+static void IRAM_ATTR spibench_post_cb(spi_transaction_t *t)
+{
+    spibench_done_us[(uintptr_t)t->user] = esp_timer_get_time();
+}
+
+static uint32_t spibench_rate(size_t len, uint32_t transfers, int64_t elapsed_us)
+{
+    if (elapsed_us <= 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)len * transfers * 1000000 / (uint64_t)elapsed_us);
+}
+
+/**
+ * @brief Polling transfers, the CPU spins on each transaction
+ */
+static esp_err_t spibench_polling(spi_device_handle_t dev, spi_transaction_t *t, uint32_t transfers,
+                                  int64_t *elapsed_us)
+{
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < transfers; i++) {
+        esp_err_t err = spi_device_polling_transmit(dev, t);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    *elapsed_us = esp_timer_get_time() - start;
+    return ESP_OK;
+}
+
+/**
+ * @brief Queued transfers with up to depth in flight
+ * @param latency Result latency stats (only filled for depth 1, where the task always waits)
+ */
+static esp_err_t spibench_queued(spi_device_handle_t dev, spi_transaction_t *slots, uint8_t depth,
+                                 uint32_t transfers, int64_t *elapsed_us, halow_spibench_result_t *latency)
+{
+    uint32_t queued = 0;
+    uint32_t done = 0;
+    uint64_t latency_sum = 0;
+    esp_err_t err;
+
+    int64_t start = esp_timer_get_time();
+    for (; queued < depth && queued < transfers; queued++) {
+        err = spi_device_queue_trans(dev, &slots[queued], pdMS_TO_TICKS(SPIBENCH_TIMEOUT_MS));
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    while (done < transfers) {
+        spi_transaction_t *t;
+        err = spi_device_get_trans_result(dev, &t, pdMS_TO_TICKS(SPIBENCH_TIMEOUT_MS));
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (latency) {
+            uint32_t us = (uint32_t)(esp_timer_get_time() - spibench_done_us[(uintptr_t)t->user]);
+            latency_sum += us;
+            if (us < latency->irq_latency_min_us) {
+                latency->irq_latency_min_us = us;
+            }
+            if (us > latency->irq_latency_max_us) {
+                latency->irq_latency_max_us = us;
+            }
+        }
+        done++;
+
+        if (queued < transfers) {
+            err = spi_device_queue_trans(dev, t, pdMS_TO_TICKS(SPIBENCH_TIMEOUT_MS));
+            if (err != ESP_OK) {
+                return err;
+            }
+            queued++;
+        }
+    }
+    *elapsed_us = esp_timer_get_time() - start;
+
+    if (latency && done) {
+        latency->irq_latency_avg_us = (uint32_t)(latency_sum / done);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Run the three modes on an added device
+ */
+static esp_err_t spibench_measure(spi_device_handle_t dev, const halow_spibench_config_t *config,
+                                  halow_spibench_result_t *result)
+{
+    size_t len = result->transfer_len;
+    spi_transaction_t slots[HALOW_SPIBENCH_MAX_DEPTH];
+    int64_t elapsed_us;
+    esp_err_t err;
+
+    // One shared TX pattern, separate RX buffers so in-flight DMA never overlaps
+    uint8_t *tx = heap_caps_malloc(len, MALLOC_CAP_DMA);
+    uint8_t *rx = heap_caps_malloc(len * config->queue_depth, MALLOC_CAP_DMA);
+    if (!tx || !rx) {
+        heap_caps_free(tx);
+        heap_caps_free(rx);
+        return ESP_ERR_NO_MEM;
+    }
+    memset(tx, 0xFF, len);
+
+    memset(slots, 0, sizeof(slots));
+    for (int i = 0; i < config->queue_depth; i++) {
+        slots[i].length = len * 8;
+        slots[i].tx_buffer = tx;
+        slots[i].rx_buffer = rx + (size_t)i * len;
+        slots[i].user = (void *)(uintptr_t)i;
+    }
+
+    err = spibench_polling(dev, &slots[0], config->transfers, &elapsed_us);
+    if (err == ESP_OK) {
+        result->polling_bps = spibench_rate(len, config->transfers, elapsed_us);
+        result->irq_latency_min_us = UINT32_MAX;
+        err = spibench_queued(dev, slots, 1, config->transfers, &elapsed_us, result);
+    }
+    if (err == ESP_OK) {
+        result->queued_single_bps = spibench_rate(len, config->transfers, elapsed_us);
+        err = spibench_queued(dev, slots, config->queue_depth, config->transfers, &elapsed_us, NULL);
+    }
+    if (err == ESP_OK) {
+        result->queued_bps = spibench_rate(len, config->transfers, elapsed_us);
+    }
+
+    heap_caps_free(tx);
+    heap_caps_free(rx);
+    return err;
+}
+
+/**
+ * @brief Run the SPI bus benchmark
+ */
+esp_err_t halow_spibench_run(const halow_spibench_config_t *config, halow_spibench_result_t *result)
+{
+    if (!config || !result || config->transfers == 0 || config->transfer_len == 0 ||
+        config->transfer_len > HALOW_SPIBENCH_MAX_LEN ||
+        config->queue_depth < 1 || config->queue_depth > HALOW_SPIBENCH_MAX_DEPTH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->transfer_len = config->dma ? config->transfer_len :
+                           (config->transfer_len < HALOW_SPIBENCH_NODMA_LEN ?
+                            config->transfer_len : HALOW_SPIBENCH_NODMA_LEN);
+
+    const spi_bus_config_t bus_cfg = {
+        .mosi_io_num = CONFIG_MM_SPI_MOSI,
+        .miso_io_num = CONFIG_MM_SPI_MISO,
+        .sclk_io_num = CONFIG_MM_SPI_SCK,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = (int)result->transfer_len,
+    };
+    esp_err_t err = spi_bus_initialize(SPIBENCH_HOST, &bus_cfg, config->dma ? SPI_DMA_CH_AUTO : SPI_DMA_DISABLED);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "SPI bus init failed: %s", esp_err_to_name(err));
+        return err == ESP_ERR_INVALID_STATE ? err : ESP_ERR_NO_MEM;
+    }
+
+    // Keep the chip out of the way while the bus is clocked; the mmhal
+    // transport resets it again when the interface boots
+    gpio_set_direction(CONFIG_MM_RESET_N, GPIO_MODE_OUTPUT);
+    gpio_set_level(CONFIG_MM_RESET_N, 0);
+
+    const spi_device_interface_config_t dev_cfg = {
+        .mode = 0,
+        .clock_speed_hz = (int)config->clock_hz,
+        .spics_io_num = CONFIG_MM_SPI_CS,
+        .queue_size = config->queue_depth,
+        .post_cb = spibench_post_cb,
+    };
+    spi_device_handle_t dev = NULL;
+    err = spi_bus_add_device(SPIBENCH_HOST, &dev_cfg, &dev);
+    if (err == ESP_OK) {
+        int freq_khz = 0;
+        spi_device_get_actual_freq(dev, &freq_khz);
+        result->actual_clock_khz = (uint32_t)freq_khz;
+
+        err = spibench_measure(dev, config, result);
+        spi_bus_remove_device(dev);
+    } else {
+        ESP_LOGE(TAG, "SPI device add failed: %s", esp_err_to_name(err));
+    }
+
+    spi_bus_free(SPIBENCH_HOST);
+    return err;
+}
+
+static void spibench_print_rate(const char *label, uint32_t bps, uint32_t clock_khz)
+{
+    uint32_t kbit = (uint32_t)((uint64_t)bps * 8 / 1000);
+    uint32_t permille = clock_khz ? (uint32_t)((uint64_t)kbit * 1000 / clock_khz) : 0;
+    printf("  %-20s %6lu.%02lu MB/s  %6lu.%lu Mbit/s  %3lu%% of SCK\n", label,
+           (unsigned long)(bps / 1000000), (unsigned long)(bps % 1000000 / 10000),
+           (unsigned long)(kbit / 1000), (unsigned long)(kbit % 1000 / 100),
+           (unsigned long)(permille / 10));
+}
+
+/**
+ * @brief Console handler for 'halow spibench'
+ */
+int halow_spibench_cmd(int argc, char **argv)
+{
+    halow_spibench_config_t cfg = {
+        .clock_hz = SPIBENCH_DEFAULT_CLOCK_MHZ * 1000000,
+        .transfer_len = SPIBENCH_DEFAULT_LEN,
+        .transfers = SPIBENCH_DEFAULT_TRANSFERS,
+        .queue_depth = SPIBENCH_DEFAULT_DEPTH,
+        .dma = SPIBENCH_DEFAULT_DMA,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            cfg.transfer_len = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            cfg.transfers = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--clock") == 0 && i + 1 < argc) {
+            cfg.clock_hz = (uint32_t)atoi(argv[++i]) * 1000000;
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            cfg.queue_depth = (uint8_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--nodma") == 0) {
+            cfg.dma = false;
+        } else {
+            printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+            printf("  halow spibench [--size <bytes>] [--count <n>] [--clock <MHz>] [--depth <n>] [--nodma]\n");
+            printf("  Defaults: %d bytes x %d, %d MHz, depth %d, DMA %s\n",
+                   SPIBENCH_DEFAULT_LEN, SPIBENCH_DEFAULT_TRANSFERS, SPIBENCH_DEFAULT_CLOCK_MHZ,
+                   SPIBENCH_DEFAULT_DEPTH, SPIBENCH_DEFAULT_DMA ? "on" : "off");
+            printf("  Needs CONFIG_HALOW_START_AT_BOOT=n and runs before 'halow on' (the transport owns the bus afterwards)\n");
+            return 1;
+        }
+    }
+
+    if (cfg.transfer_len == 0 || cfg.transfer_len > HALOW_SPIBENCH_MAX_LEN ||
+        cfg.queue_depth < 1 || cfg.queue_depth > HALOW_SPIBENCH_MAX_DEPTH ||
+        cfg.transfers == 0 || cfg.clock_hz == 0) {
+        printf(COLOR_RED "Size 1-%d bytes, depth 1-%d, count and clock > 0\n" COLOR_RESET,
+               HALOW_SPIBENCH_MAX_LEN, HALOW_SPIBENCH_MAX_DEPTH);
+        return 1;
+    }
+
+    halow_spibench_result_t res;
+    esp_err_t err = halow_spibench_run(&cfg, &res);
+    if (err == ESP_ERR_INVALID_STATE) {
+        printf(COLOR_RED "SPI bus is in use by the HaLow transport\n" COLOR_RESET);
+        return 1;
+    }
+    if (err != ESP_OK) {
+        printf(COLOR_RED "SPI benchmark failed: %s\n" COLOR_RESET, esp_err_to_name(err));
+        return 1;
+    }
+
+    printf("\n" COLOR_CYAN COLOR_BOLD "=== HALOW SPI BENCHMARK ===" COLOR_RESET "\n\n");
+    printf("Bus:       SPI2, SCK %lu kHz (requested %lu kHz), DMA %s\n",
+           (unsigned long)res.actual_clock_khz, (unsigned long)(cfg.clock_hz / 1000), cfg.dma ? "on" : "off");
+    printf("Transfers: %lu x %u bytes per mode%s\n", (unsigned long)cfg.transfers, (unsigned)res.transfer_len,
+           res.transfer_len < cfg.transfer_len ? COLOR_YELLOW " (clamped without DMA)" COLOR_RESET : "");
+    printf("\nThroughput:\n");
+    spibench_print_rate("polling", res.polling_bps, res.actual_clock_khz);
+    spibench_print_rate("queued, depth 1", res.queued_single_bps, res.actual_clock_khz);
+    char label[24];
+    snprintf(label, sizeof(label), "queued, depth %u", cfg.queue_depth);
+    spibench_print_rate(label, res.queued_bps, res.actual_clock_khz);
+    printf("\nDone IRQ to task latency: min %lu us, avg %lu us, max %lu us\n",
+           (unsigned long)res.irq_latency_min_us, (unsigned long)res.irq_latency_avg_us,
+           (unsigned long)res.irq_latency_max_us);
+    return 0;
+}
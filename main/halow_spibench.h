@@ -0,0 +1,67 @@
+/**
+ * @file halow_spibench.h
+ * @brief Host to HaLow chip SPI bus benchmark for Halow RTOS
+ *
+ * Features:
+ * - Raw SPI throughput on the MM chip bus with the configured pins
+ *   (CONFIG_MM_SPI_*), clock, DMA setting and queue depth
+ * - Compares polling transfers with interrupt-driven queued transfers at
+ *   depth 1 and with several DMA transfers in flight
+ * - Transfer-done interrupt to task service latency
+ * - The chip is held in reset while the bus is clocked, so only the host
+ *   side of the link is measured
+ * - Benchmark only: the mmhal transport's own SPI settings are not changed
+ */
+
+#ifndef HALOW_SPIBENCH_H
+#define HALOW_SPIBENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define HALOW_SPIBENCH_MAX_DEPTH    16
+#define HALOW_SPIBENCH_MAX_LEN      16384
+#define HALOW_SPIBENCH_NODMA_LEN    64      // CPU-driven transfers are limited to the SPI FIFO
+
+// Benchmark parameters
+typedef struct {
+    uint32_t clock_hz;          // Requested SCK rate
+    size_t transfer_len;        // Bytes per transaction
+    uint32_t transfers;         // Transactions per mode
+    uint8_t queue_depth;        // Transactions in flight for the queued run
+    bool dma;                   // Use GDMA
+} halow_spibench_config_t;
+
+// Benchmark results
+typedef struct {
+    uint32_t actual_clock_khz;  // SCK rate after clock divider rounding
+    size_t transfer_len;        // Transfer length used (clamped without DMA)
+    uint32_t polling_bps;       // Bytes per second with polling transfers
+    uint32_t queued_single_bps; // Bytes per second, one queued transfer at a time
+    uint32_t queued_bps;        // Bytes per second with queue_depth transfers in flight
+    uint32_t irq_latency_min_us;
+    uint32_t irq_latency_avg_us;
+    uint32_t irq_latency_max_us;
+} halow_spibench_result_t;
+
+/**
+ * @brief Run the SPI bus benchmark
+ * The HaLow interface must not be booted, it owns the bus afterwards.
+ * @param config Benchmark parameters
+ * @param result Pointer to store the results
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the bus is in use,
+ *         ESP_ERR_INVALID_ARG for bad parameters, ESP_ERR_NO_MEM otherwise
+ */
+esp_err_t halow_spibench_run(const halow_spibench_config_t *config, halow_spibench_result_t *result);
+
+/**
+ * @brief Console handler for 'halow spibench [--size b] [--count n] [--clock mhz] [--depth n] [--nodma]'
+ * @param argc Argument count (argv[0] is "spibench")
+ * @param argv Arguments
+ * @return 0 on success, 1 on error
+ */
+int halow_spibench_cmd(int argc, char **argv);
+
+#endif // HALOW_SPIBENCH_H
@@ -0,0 +1,496 @@
+/**
+ * @file halow_stats.c
+ * @brief HaLow link statistics sampler implementation for Halow RTOS
+ *
+ * The sampler keeps the previous cumulative counters and stores only the
+ * per-interval deltas, so any window of the history can be turned into
+ * rates without walking counters back. Rate control counters are matched by
+ * rate_info between polls, which also tells which MCS carried the traffic.
+ * mmwlan resets them on reassociation; a counter that went backwards is taken
+ * as restarted from zero.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "halow_stats.h"
+#include "halow_rx.h"
+#include "task_halow.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mmwlan.h"
+
+static const char *TAG = "halow_stats";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_BOLD      "\033[1m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define HALOW_STATS_HISTORY         CONFIG_HALOW_STATS_HISTORY
+#define HALOW_STATS_TASK_STACK      3072
+#define HALOW_STATS_TASK_PRIORITY   2
+#define HALOW_STATS_RC_MAX          64      // Rate control entries tracked between polls
+#define HALOW_STATS_SHORT_WINDOW_S  10
+
+// Previous cumulative counters of one rate control entry
+typedef struct {
+    uint32_t rate_info;
+    uint32_t sent;
+    uint32_t success;
+} halow_stats_rc_prev_t;
+
+static halow_stats_sample_t stats_ring[HALOW_STATS_HISTORY];
+static size_t stats_head = 0;               // Next slot to write
+static size_t stats_count = 0;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t stats_task_handle = NULL;
+static uint32_t stats_interval_ms = CONFIG_HALOW_STATS_INTERVAL_MS;
+
+// Sampler task state
+static halow_stats_rc_prev_t stats_rc_prev[HALOW_STATS_RC_MAX];
+static size_t stats_rc_prev_count = 0;
+static uint32_t stats_prev_rx_frames = 0;
+static uint32_t stats_prev_rx_bytes = 0;
+static int64_t stats_prev_time_us = 0;
+
+static const uint8_t rc_bw_mhz[] = {1, 2, 4, 8};
+
+/**
+ * @brief Delta of a cumulative counter that may have been reset
+ */
+static uint32_t halow_stats_delta(uint32_t now, uint32_t prev)
+{
+    return now >= prev ? now - prev : now;
+}
+
+/**
+ * @brief Poll rate control statistics into a sample
+ */
+static void halow_stats_poll_rc(halow_stats_sample_t *sample)
+{
+    struct mmwlan_rc_stats *rc = mmwlan_get_rc_stats();
+    if (!rc) {
+        stats_rc_prev_count = 0;
+        return;
+    }
+
+    halow_stats_rc_prev_t next[HALOW_STATS_RC_MAX];
+    size_t n = rc->n_entries < HALOW_STATS_RC_MAX ? rc->n_entries : HALOW_STATS_RC_MAX;
+    uint32_t best_attempts = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        uint32_t prev_sent = 0;
+        uint32_t prev_success = 0;
+        for (size_t j = 0; j < stats_rc_prev_count; j++) {
+            if (stats_rc_prev[j].rate_info == rc->rate_info[i]) {
+                prev_sent = stats_rc_prev[j].sent;
+                prev_success = stats_rc_prev[j].success;
+                break;
+            }
+        }
+
+        uint32_t attempts = halow_stats_delta(rc->total_sent[i], prev_sent);
+        sample->tx_attempts += attempts;
+        sample->tx_success += halow_stats_delta(rc->total_success[i], prev_success);
+
+        if (attempts > best_attempts) {
+            best_attempts = attempts;
+            sample->mcs = (rc->rate_info[i] >> MMWLAN_RC_STATS_RATE_INFO_RATE_OFFSET) & 0x0F;
+            sample->bw_mhz = rc_bw_mhz[(rc->rate_info[i] >> MMWLAN_RC_STATS_RATE_INFO_BW_OFFSET) & 0x03];
+        }
+
+        next[i].rate_info = rc->rate_info[i];
+        next[i].sent = rc->total_sent[i];
+        next[i].success = rc->total_success[i];
+    }
+
+    memcpy(stats_rc_prev, next, n * sizeof(next[0]));
+    stats_rc_prev_count = n;
+    mmwlan_free_rc_stats(rc);
+}
+
+/**
+ * @brief Take one sample and append it to the history
+ */
+static void halow_stats_take_sample(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    halow_stats_sample_t sample = {
+        .uptime_ms = (uint32_t)(now_us / 1000),
+        .interval_ms = stats_prev_time_us ? (uint32_t)((now_us - stats_prev_time_us) / 1000) : stats_interval_ms,
+        .rssi_dbm = HALOW_STATS_RSSI_INVALID,
+        .mcs = HALOW_STATS_MCS_NONE,
+    };
+    stats_prev_time_us = now_us;
+
+    int32_t rssi = INT32_MIN;
+    if (halow_is_started()) {
+        rssi = mmwlan_get_rssi();
+    }
+    if (rssi != INT32_MIN) {
+        sample.rssi_dbm = (int16_t)rssi;
+        halow_stats_poll_rc(&sample);
+    } else {
+        stats_rc_prev_count = 0;    // Counters restart with the next association
+    }
+
+    // Lifetime RX totals wrap; unsigned subtraction handles that
+    uint32_t rx_frames, rx_bytes;
+    halow_rx_get_totals(&rx_frames, &rx_bytes);
+    sample.rx_frames = rx_frames - stats_prev_rx_frames;
+    sample.rx_bytes = rx_bytes - stats_prev_rx_bytes;
+    stats_prev_rx_frames = rx_frames;
+    stats_prev_rx_bytes = rx_bytes;
+
+    taskENTER_CRITICAL(&stats_lock);
+    stats_ring[stats_head] = sample;
+    stats_head = (stats_head + 1) % HALOW_STATS_HISTORY;
+    if (stats_count < HALOW_STATS_HISTORY) {
+        stats_count++;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+/**
+ * @brief Sampler task
+ */
+static void halow_stats_task(void *arg)
+{
+    halow_rx_get_totals(&stats_prev_rx_frames, &stats_prev_rx_bytes);
+    stats_prev_time_us = esp_timer_get_time();
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1) {
+        TickType_t period = pdMS_TO_TICKS(stats_interval_ms);
+        TickType_t elapsed = xTaskGetTickCount() - last_wake;
+        TickType_t wait = elapsed < period ? period - elapsed : 0;
+
+        // A notification means the interval changed: restart the series
+        if (ulTaskNotifyTake(pdTRUE, wait) > 0) {
+            last_wake = xTaskGetTickCount();
+            stats_prev_time_us = esp_timer_get_time();
+            continue;
+        }
+
+        last_wake += period;
+        halow_stats_take_sample();
+    }
+}
+
+/**
+ * @brief Start the sampler task
+ */
+esp_err_t halow_stats_init(void)
+{
+    if (stats_task_handle) {
+        return ESP_OK;
+    }
+
+    if (xTaskCreate(halow_stats_task, "halow_stats", HALOW_STATS_TASK_STACK, NULL,
+                    HALOW_STATS_TASK_PRIORITY, &stats_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create sampler task");
+        stats_task_handle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Link sampler started (%lu ms, %d samples)",
+             (unsigned long)stats_interval_ms, HALOW_STATS_HISTORY);
+    return ESP_OK;
+}
+
+/**
+ * @brief Change the sampling interval (clears the history)
+ */
+esp_err_t halow_stats_set_interval(uint32_t interval_ms)
+{
+    if (interval_ms < HALOW_STATS_INTERVAL_MIN_MS || interval_ms > HALOW_STATS_INTERVAL_MAX_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&stats_lock);
+    stats_interval_ms = interval_ms;
+    stats_head = 0;
+    stats_count = 0;
+    taskEXIT_CRITICAL(&stats_lock);
+
+    if (stats_task_handle) {
+        xTaskNotifyGive(stats_task_handle);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Get the sampling interval
+ */
+uint32_t halow_stats_get_interval(void)
+{
+    return stats_interval_ms;
+}
+
+/**
+ * @brief Copy the newest samples, oldest first
+ */
+size_t halow_stats_get_history(halow_stats_sample_t *samples, size_t max)
+{
+    if (!samples || max == 0) {
+        return 0;
+    }
+
+    taskENTER_CRITICAL(&stats_lock);
+    size_t n = stats_count < max ? stats_count : max;
+    size_t start = (stats_head + HALOW_STATS_HISTORY - n) % HALOW_STATS_HISTORY;
+    for (size_t i = 0; i < n; i++) {
+        samples[i] = stats_ring[(start + i) % HALOW_STATS_HISTORY];
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+
+    return n;
+}
+
+/**
+ * @brief Compute rates over a run of samples
+ */
+static void halow_stats_compute_rates(const halow_stats_sample_t *samples, size_t n, halow_stats_rates_t *rates)
+{
+    uint64_t tx_attempts = 0, tx_success = 0, rx_frames = 0, rx_bytes = 0, window_ms = 0;
+    int32_t rssi_sum = 0;
+    uint32_t rssi_count = 0;
+
+    memset(rates, 0, sizeof(*rates));
+    rates->rssi_avg_dbm = HALOW_STATS_RSSI_INVALID;
+    rates->rssi_min_dbm = HALOW_STATS_RSSI_INVALID;
+    rates->rssi_max_dbm = HALOW_STATS_RSSI_INVALID;
+
+    for (size_t i = 0; i < n; i++) {
+        const halow_stats_sample_t *s = &samples[i];
+        window_ms += s->interval_ms;
+        tx_attempts += s->tx_attempts;
+        tx_success += s->tx_success;
+        rx_frames += s->rx_frames;
+        rx_bytes += s->rx_bytes;
+
+        if (s->rssi_dbm != HALOW_STATS_RSSI_INVALID) {
+            if (rssi_count == 0 || s->rssi_dbm < rates->rssi_min_dbm) {
+                rates->rssi_min_dbm = s->rssi_dbm;
+            }
+            if (rssi_count == 0 || s->rssi_dbm > rates->rssi_max_dbm) {
+                rates->rssi_max_dbm = s->rssi_dbm;
+            }
+            rssi_sum += s->rssi_dbm;
+            rssi_count++;
+        }
+    }
+
+    rates->samples = n;
+    rates->window_ms = (uint32_t)window_ms;
+    if (rssi_count) {
+        rates->rssi_avg_dbm = (int16_t)(rssi_sum / (int32_t)rssi_count);
+    }
+    if (window_ms) {
+        rates->tx_attempts_per_s = (uint32_t)(tx_attempts * 1000 / window_ms);
+        rates->tx_success_per_s = (uint32_t)(tx_success * 1000 / window_ms);
+        rates->rx_frames_per_s = (uint32_t)(rx_frames * 1000 / window_ms);
+        rates->rx_kbps = (uint32_t)(rx_bytes * 8 / window_ms);     // bits per ms = kbit/s
+    }
+    rates->tx_success_pct = tx_attempts ? (uint32_t)(tx_success * 100 / tx_attempts) : 100;
+}
+
+/**
+ * @brief Compute rates over the newest samples
+ */
+esp_err_t halow_stats_get_rates(size_t window, halow_stats_rates_t *rates)
+{
+    if (!rates) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    halow_stats_sample_t *samples = malloc(HALOW_STATS_HISTORY * sizeof(*samples));
+    if (!samples) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t n = halow_stats_get_history(samples, window ? window : HALOW_STATS_HISTORY);
+    if (n > 0) {
+        halow_stats_compute_rates(samples, n, rates);
+    }
+    free(samples);
+    return n > 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief Format an RSSI value, "-" if not associated
+ */
+static const char *halow_stats_rssi_str(int16_t rssi, char *buf, size_t len)
+{
+    if (rssi == HALOW_STATS_RSSI_INVALID) {
+        return "-";
+    }
+    snprintf(buf, len, "%d", rssi);
+    return buf;
+}
+
+/**
+ * @brief Print the summary: rates over the last sample, a short window and the whole history
+ */
+static void halow_stats_print_summary(const halow_stats_sample_t *samples, size_t n)
+{
+    const halow_stats_sample_t *last = &samples[n - 1];
+    size_t short_n = HALOW_STATS_SHORT_WINDOW_S * 1000 / stats_interval_ms;
+    if (short_n == 0) {
+        short_n = 1;
+    }
+    if (short_n > n) {
+        short_n = n;
+    }
+
+    halow_stats_rates_t windows[3];
+    halow_stats_compute_rates(last, 1, &windows[0]);
+    halow_stats_compute_rates(&samples[n - short_n], short_n, &windows[1]);
+    halow_stats_compute_rates(samples, n, &windows[2]);
+
+    char b0[8], b1[8], b2[8];
+    printf("Sampling:    every %lu ms, %u/%d samples (%lu s)\n", (unsigned long)stats_interval_ms,
+           (unsigned)n, HALOW_STATS_HISTORY, (unsigned long)(windows[2].window_ms / 1000));
+    if (last->rssi_dbm != HALOW_STATS_RSSI_INVALID) {
+        printf("RSSI:        %d dBm (avg %s, min %s, max %s over history)\n", last->rssi_dbm,
+               halow_stats_rssi_str(windows[2].rssi_avg_dbm, b0, sizeof(b0)),
+               halow_stats_rssi_str(windows[2].rssi_min_dbm, b1, sizeof(b1)),
+               halow_stats_rssi_str(windows[2].rssi_max_dbm, b2, sizeof(b2)));
+    } else {
+        printf("RSSI:        " COLOR_YELLOW "not associated" COLOR_RESET "\n");
+    }
+    if (last->mcs != HALOW_STATS_MCS_NONE) {
+        printf("TX rate:     MCS%u @ %u MHz\n", last->mcs, last->bw_mhz);
+    }
+
+    printf("\n" COLOR_YELLOW "%-12s %10s %10s %10s" COLOR_RESET "\n", "", "Last", "Short", "History");
+    printf("%-12s %9lus %9lus %9lus\n", "Window", (unsigned long)(windows[0].window_ms / 1000),
+           (unsigned long)(windows[1].window_ms / 1000), (unsigned long)(windows[2].window_ms / 1000));
+    printf("%-12s %10lu %10lu %10lu\n", "TX att/s", (unsigned long)windows[0].tx_attempts_per_s,
+           (unsigned long)windows[1].tx_attempts_per_s, (unsigned long)windows[2].tx_attempts_per_s);
+    printf("%-12s %10lu %10lu %10lu\n", "TX ok/s", (unsigned long)windows[0].tx_success_per_s,
+           (unsigned long)windows[1].tx_success_per_s, (unsigned long)windows[2].tx_success_per_s);
+    printf("%-12s %9lu%% %9lu%% %9lu%%\n", "TX success", (unsigned long)windows[0].tx_success_pct,
+           (unsigned long)windows[1].tx_success_pct, (unsigned long)windows[2].tx_success_pct);
+    printf("%-12s %10lu %10lu %10lu\n", "RX pkt/s", (unsigned long)windows[0].rx_frames_per_s,
+           (unsigned long)windows[1].rx_frames_per_s, (unsigned long)windows[2].rx_frames_per_s);
+    printf("%-12s %10lu %10lu %10lu\n", "RX kbit/s", (unsigned long)windows[0].rx_kbps,
+           (unsigned long)windows[1].rx_kbps, (unsigned long)windows[2].rx_kbps);
+}
+
+/**
+ * @brief Print the rate control table as currently reported by mmwlan
+ */
+static void halow_stats_print_rc_table(void)
+{
+    struct mmwlan_rc_stats *rc = mmwlan_get_rc_stats();
+    if (!rc || rc->n_entries == 0) {
+        if (rc) {
+            mmwlan_free_rc_stats(rc);
+        }
+        return;
+    }
+
+    printf("\n" COLOR_YELLOW "Rate           Attempts    Success   Ok%%" COLOR_RESET "\n");
+    for (uint32_t i = 0; i < rc->n_entries; i++) {
+        uint32_t info = rc->rate_info[i];
+        if (rc->total_sent[i] == 0) {
+            continue;
+        }
+        printf("MCS%-2lu %u MHz %s %10lu %10lu  %3lu\n",
+               (unsigned long)((info >> MMWLAN_RC_STATS_RATE_INFO_RATE_OFFSET) & 0x0F),
+               rc_bw_mhz[(info >> MMWLAN_RC_STATS_RATE_INFO_BW_OFFSET) & 0x03],
+               ((info >> MMWLAN_RC_STATS_RATE_INFO_GUARD_OFFSET) & 0x01) ? "SGI" : "LGI",
+               (unsigned long)rc->total_sent[i], (unsigned long)rc->total_success[i],
+               (unsigned long)((uint64_t)rc->total_success[i] * 100 / rc->total_sent[i]));
+    }
+    mmwlan_free_rc_stats(rc);
+}
+
+/**
+ * @brief Print the newest samples with per-interval rates
+ */
+static void halow_stats_print_history(const halow_stats_sample_t *samples, size_t n)
+{
+    printf(COLOR_YELLOW "%10s %5s %6s %9s %6s %8s %9s" COLOR_RESET "\n",
+           "Time(s)", "RSSI", "Rate", "TX att/s", "TX ok%", "RX pkt/s", "RX kbit/s");
+
+    for (size_t i = 0; i < n; i++) {
+        const halow_stats_sample_t *s = &samples[i];
+        halow_stats_rates_t r;
+        char rssi[8], rate[8];
+
+        halow_stats_compute_rates(s, 1, &r);
+        if (s->mcs != HALOW_STATS_MCS_NONE) {
+            snprintf(rate, sizeof(rate), "%u/%u", s->mcs, s->bw_mhz);
+        } else {
+            snprintf(rate, sizeof(rate), "-");
+        }
+        printf("%10.1f %5s %6s %9lu %5lu%% %8lu %9lu\n", s->uptime_ms / 1000.0,
+               halow_stats_rssi_str(s->rssi_dbm, rssi, sizeof(rssi)), rate,
+               (unsigned long)r.tx_attempts_per_s, (unsigned long)r.tx_success_pct,
+               (unsigned long)r.rx_frames_per_s, (unsigned long)r.rx_kbps);
+    }
+}
+
+/**
+ * @brief Console handler for 'halow stats [--interval <ms>] [--history [n]]'
+ */
+int halow_stats_cmd(int argc, char **argv)
+{
+    size_t history = 0;
+    bool show_history = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            uint32_t interval_ms = (uint32_t)atoi(argv[++i]);
+            if (halow_stats_set_interval(interval_ms) != ESP_OK) {
+                printf(COLOR_RED "Interval must be %d..%d ms\n" COLOR_RESET,
+                       HALOW_STATS_INTERVAL_MIN_MS, HALOW_STATS_INTERVAL_MAX_MS);
+                return 1;
+            }
+            printf(COLOR_GREEN "Sampling every %lu ms (history cleared)\n" COLOR_RESET, (unsigned long)interval_ms);
+            return 0;
+        } else if (strcmp(argv[i], "--history") == 0) {
+            show_history = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                history = (size_t)atoi(argv[++i]);
+            }
+        } else {
+            printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+            printf("  halow stats                 - Link summary with rates over last/short/full history\n");
+            printf("  halow stats --history [n]   - Per-sample table of the newest n samples (default all)\n");
+            printf("  halow stats --interval <ms> - Change the sampling interval (%d..%d ms)\n",
+                   HALOW_STATS_INTERVAL_MIN_MS, HALOW_STATS_INTERVAL_MAX_MS);
+            return 1;
+        }
+    }
+
+    halow_stats_sample_t *samples = malloc(HALOW_STATS_HISTORY * sizeof(*samples));
+    if (!samples) {
+        printf(COLOR_RED "Out of memory\n" COLOR_RESET);
+        return 1;
+    }
+
+    size_t n = halow_stats_get_history(samples, history ? history : HALOW_STATS_HISTORY);
+    printf("\n" COLOR_CYAN COLOR_BOLD "=== HALOW LINK STATISTICS ===" COLOR_RESET "\n\n");
+    if (n == 0) {
+        printf(COLOR_YELLOW "No samples yet (interval %lu ms)\n" COLOR_RESET, (unsigned long)stats_interval_ms);
+    } else if (show_history) {
+        halow_stats_print_history(samples, n);
+    } else {
+        halow_stats_print_summary(samples, n);
+        halow_stats_print_rc_table();
+    }
+    printf("\n");
+
+    free(samples);
+    return 0;
+}
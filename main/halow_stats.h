@@ -0,0 +1,95 @@
+/**
+ * @file halow_stats.h
+ * @brief HaLow link statistics sampler for Halow RTOS
+ *
+ * Features:
+ * - Low-priority task polls RSSI, rate control and RX counters every interval
+ * - Fixed-size in-RAM time series of per-interval samples (no allocation while sampling)
+ * - TX attempts/successes and dominant MCS from mmwlan rate control statistics
+ * - Rate computations (packets/s, kbit/s, TX success ratio) over any window
+ */
+
+#ifndef HALOW_STATS_H
+#define HALOW_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define HALOW_STATS_RSSI_INVALID    INT16_MIN
+#define HALOW_STATS_MCS_NONE        0xFF
+#define HALOW_STATS_INTERVAL_MIN_MS 100
+#define HALOW_STATS_INTERVAL_MAX_MS 60000
+
+// One sample; counters cover the interval ending at uptime_ms
+typedef struct {
+    uint32_t uptime_ms;         // Sample time (ms since boot)
+    uint32_t interval_ms;       // Length of the interval covered
+    int16_t rssi_dbm;           // RSSI at sample time, HALOW_STATS_RSSI_INVALID if not associated
+    uint8_t mcs;                // MCS with most TX attempts in the interval, HALOW_STATS_MCS_NONE if idle
+    uint8_t bw_mhz;             // Bandwidth of that rate
+    uint32_t tx_attempts;       // TX attempts (including retries) in the interval
+    uint32_t tx_success;        // Acknowledged TX attempts in the interval
+    uint32_t rx_frames;         // Frames received in the interval
+    uint32_t rx_bytes;          // Bytes received in the interval
+} halow_stats_sample_t;
+
+// Rates over a window of samples
+typedef struct {
+    uint32_t samples;           // Samples in the window
+    uint32_t window_ms;         // Time covered
+    int16_t rssi_avg_dbm;       // Average RSSI of associated samples
+    int16_t rssi_min_dbm;
+    int16_t rssi_max_dbm;
+    uint32_t tx_attempts_per_s;
+    uint32_t tx_success_per_s;
+    uint32_t tx_success_pct;    // Acknowledged share of TX attempts (100 if idle)
+    uint32_t rx_frames_per_s;
+    uint32_t rx_kbps;
+} halow_stats_rates_t;
+
+/**
+ * @brief Start the sampler task
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t halow_stats_init(void);
+
+/**
+ * @brief Change the sampling interval (clears the history)
+ * @param interval_ms Interval between samples
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if out of range
+ */
+esp_err_t halow_stats_set_interval(uint32_t interval_ms);
+
+/**
+ * @brief Get the sampling interval
+ * @return Interval in milliseconds
+ */
+uint32_t halow_stats_get_interval(void);
+
+/**
+ * @brief Copy the newest samples, oldest first
+ * @param samples Buffer for samples
+ * @param max Capacity of samples
+ * @return Number of samples stored
+ */
+size_t halow_stats_get_history(halow_stats_sample_t *samples, size_t max);
+
+/**
+ * @brief Compute rates over the newest samples
+ * @param window Number of samples to use (0 for the whole history)
+ * @param rates Pointer to store the result
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no sample was taken yet
+ */
+esp_err_t halow_stats_get_rates(size_t window, halow_stats_rates_t *rates);
+
+/**
+ * @brief Console handler for 'halow stats [--interval <ms>] [--history [n]]'
+ * @param argc Argument count (argv[0] is "stats")
+ * @param argv Arguments
+ * @return 0 on success, 1 on error
+ */
+int halow_stats_cmd(int argc, char **argv);
+
+#endif // HALOW_STATS_H
@@ -0,0 +1,505 @@
+/**
+ * @file ota_decoder.c
+ * @brief Streaming OTA package decoder implementation for Halow RTOS
+ *
+ * Decoding is a push pipeline: package bytes -> header -> inflate (optional)
+ * -> delta operations (optional) -> staged output -> sink. Every stage keeps
+ * only its own small state, so an operation or a zlib block may straddle any
+ * number of feed() calls.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ota_decoder.h"
+#include "esp_log.h"
+#include "esp_app_format.h"
+#include "mbedtls/sha256.h"
+#include "miniz.h"
+
+static const char *TAG = "ota_decoder";
+
+#define OTA_DECODER_OUT_SIZE        1024    // Staged output handed to the sink
+#define OTA_DECODER_SCRATCH_SIZE    512     // Source partition reads for COPY/ADD
+
+typedef enum {
+    DELTA_STATE_OP,
+    DELTA_STATE_ARGS,
+    DELTA_STATE_DATA
+} delta_state_t;
+
+struct ota_decoder {
+    const esp_partition_t *source;
+    ota_decoder_write_cb_t write_cb;
+    void *arg;
+
+    ota_package_type_t type;
+    ota_package_header_t header;
+    size_t header_have;             // Header bytes consumed (including skipped extension bytes)
+    bool started;                   // Header done, payload follows
+
+    // Inflate stage
+    tinfl_decompressor *inflator;
+    uint8_t *dict;                  // TINFL_LZ_DICT_SIZE circular window
+    size_t dict_ofs;
+    bool inflate_done;
+
+    // Delta stage
+    delta_state_t delta_state;
+    uint8_t op;
+    uint8_t args[8];
+    size_t args_have;
+    size_t args_need;
+    uint32_t src_offset;
+    uint32_t remaining;
+    uint8_t *scratch;
+
+    // Output stage
+    uint8_t out[OTA_DECODER_OUT_SIZE];
+    size_t out_len;
+    size_t output_size;             // Bytes accepted for output, staged or flushed
+};
+
+static uint32_t read_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Pass staged output to the sink
+ */
+static esp_err_t ota_decoder_flush(ota_decoder_t *dec)
+{
+    if (dec->out_len == 0) {
+        return ESP_OK;
+    }
+    esp_err_t err = dec->write_cb(dec->out, dec->out_len, dec->arg);
+    dec->out_len = 0;
+    return err;
+}
+
+/**
+ * @brief Output stage: stage decoded bytes and enforce the image size
+ */
+static esp_err_t ota_decoder_output(ota_decoder_t *dec, const uint8_t *data, size_t len)
+{
+    if (dec->header.image_size != 0 && dec->output_size + len > dec->header.image_size) {
+        ESP_LOGE(TAG, "Decoded data exceeds image size %lu", (unsigned long)dec->header.image_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    dec->output_size += len;
+
+    while (len > 0) {
+        size_t n = OTA_DECODER_OUT_SIZE - dec->out_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(dec->out + dec->out_len, data, n);
+        dec->out_len += n;
+        data += n;
+        len -= n;
+
+        if (dec->out_len == OTA_DECODER_OUT_SIZE) {
+            esp_err_t err = ota_decoder_flush(dec);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Output len bytes of the source partition, optionally adding diff bytes
+ * @param diff Bytes to add (mod 256) to the source, NULL for a plain copy
+ */
+static esp_err_t ota_decoder_from_source(ota_decoder_t *dec, const uint8_t *diff, size_t len)
+{
+    while (len > 0) {
+        size_t n = len > OTA_DECODER_SCRATCH_SIZE ? OTA_DECODER_SCRATCH_SIZE : len;
+
+        esp_err_t err = esp_partition_read(dec->source, dec->src_offset, dec->scratch, n);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Source read at 0x%lx failed: %s", (unsigned long)dec->src_offset, esp_err_to_name(err));
+            return err;
+        }
+        if (diff) {
+            for (size_t i = 0; i < n; i++) {
+                dec->scratch[i] += diff[i];
+            }
+            diff += n;
+        }
+
+        err = ota_decoder_output(dec, dec->scratch, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+        dec->src_offset += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Delta stage: parse operations and reconstruct the image
+ */
+static esp_err_t ota_decoder_delta(ota_decoder_t *dec, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        switch (dec->delta_state) {
+        case DELTA_STATE_OP:
+            dec->op = *data++;
+            len--;
+            if (dec->op != OTA_DELTA_OP_COPY && dec->op != OTA_DELTA_OP_ADD && dec->op != OTA_DELTA_OP_INSERT) {
+                ESP_LOGE(TAG, "Invalid delta operation 0x%02x", dec->op);
+                return ESP_FAIL;
+            }
+            dec->args_have = 0;
+            dec->args_need = dec->op == OTA_DELTA_OP_INSERT ? 4 : 8;
+            dec->delta_state = DELTA_STATE_ARGS;
+            break;
+
+        case DELTA_STATE_ARGS: {
+            size_t n = dec->args_need - dec->args_have;
+            if (n > len) {
+                n = len;
+            }
+            memcpy(dec->args + dec->args_have, data, n);
+            dec->args_have += n;
+            data += n;
+            len -= n;
+            if (dec->args_have < dec->args_need) {
+                break;
+            }
+
+            if (dec->op == OTA_DELTA_OP_INSERT) {
+                dec->remaining = read_le32(dec->args);
+            } else {
+                dec->src_offset = read_le32(dec->args);
+                dec->remaining = read_le32(dec->args + 4);
+                if ((uint64_t)dec->src_offset + dec->remaining > dec->header.source_size) {
+                    ESP_LOGE(TAG, "Delta reference 0x%lx+%lu outside source image",
+                             (unsigned long)dec->src_offset, (unsigned long)dec->remaining);
+                    return ESP_FAIL;
+                }
+            }
+
+            dec->delta_state = DELTA_STATE_DATA;
+            if (dec->op == OTA_DELTA_OP_COPY) {
+                esp_err_t err = ota_decoder_from_source(dec, NULL, dec->remaining);
+                if (err != ESP_OK) {
+                    return err;
+                }
+                dec->remaining = 0;
+            }
+            if (dec->remaining == 0) {
+                dec->delta_state = DELTA_STATE_OP;
+            }
+            break;
+        }
+
+        case DELTA_STATE_DATA: {
+            size_t n = dec->remaining > len ? len : dec->remaining;
+            esp_err_t err = dec->op == OTA_DELTA_OP_ADD ?
+                            ota_decoder_from_source(dec, data, n) : ota_decoder_output(dec, data, n);
+            if (err != ESP_OK) {
+                return err;
+            }
+            data += n;
+            len -= n;
+            dec->remaining -= n;
+            if (dec->remaining == 0) {
+                dec->delta_state = DELTA_STATE_OP;
+            }
+            break;
+        }
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Route uncompressed payload to the delta or output stage
+ */
+static esp_err_t ota_decoder_payload(ota_decoder_t *dec, const uint8_t *data, size_t len)
+{
+    if (dec->header.flags & OTA_PACKAGE_FLAG_DELTA) {
+        return ota_decoder_delta(dec, data, len);
+    }
+    return ota_decoder_output(dec, data, len);
+}
+
+/**
+ * @brief Inflate stage: decompress into the circular window
+ */
+static esp_err_t ota_decoder_inflate(ota_decoder_t *dec, const uint8_t *data, size_t len)
+{
+    if (dec->inflate_done) {
+        return len ? ESP_ERR_INVALID_SIZE : ESP_OK;
+    }
+
+    while (true) {
+        size_t in_len = len;
+        size_t out_len = TINFL_LZ_DICT_SIZE - dec->dict_ofs;
+        tinfl_status status = tinfl_decompress(dec->inflator, data, &in_len, dec->dict,
+                                               dec->dict + dec->dict_ofs, &out_len,
+                                               TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_COMPUTE_ADLER32 |
+                                               TINFL_FLAG_HAS_MORE_INPUT);
+        data += in_len;
+        len -= in_len;
+
+        if (out_len > 0) {
+            esp_err_t err = ota_decoder_payload(dec, dec->dict + dec->dict_ofs, out_len);
+            if (err != ESP_OK) {
+                return err;
+            }
+            dec->dict_ofs = (dec->dict_ofs + out_len) & (TINFL_LZ_DICT_SIZE - 1);
+        }
+
+        if (status < TINFL_STATUS_DONE) {
+            ESP_LOGE(TAG, "Inflate failed (%d)", status);
+            return ESP_FAIL;
+        }
+        if (status == TINFL_STATUS_DONE) {
+            dec->inflate_done = true;
+            return len ? ESP_ERR_INVALID_SIZE : ESP_OK;
+        }
+        if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) {
+            return ESP_OK;
+        }
+    }
+}
+
+/**
+ * @brief Check that a delta's base matches the source partition
+ */
+static esp_err_t ota_decoder_verify_source(ota_decoder_t *dec)
+{
+    mbedtls_sha256_context sha;
+    uint8_t digest[32];
+    esp_err_t err = ESP_OK;
+
+    if (!dec->source || dec->header.source_size > dec->source->size) {
+        ESP_LOGE(TAG, "Delta base (%lu bytes) larger than source partition",
+                 (unsigned long)dec->header.source_size);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    for (uint32_t ofs = 0; ofs < dec->header.source_size && err == ESP_OK; ofs += OTA_DECODER_SCRATCH_SIZE) {
+        size_t n = dec->header.source_size - ofs;
+        if (n > OTA_DECODER_SCRATCH_SIZE) {
+            n = OTA_DECODER_SCRATCH_SIZE;
+        }
+        err = esp_partition_read(dec->source, ofs, dec->scratch, n);
+        mbedtls_sha256_update(&sha, dec->scratch, n);
+    }
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (memcmp(digest, dec->header.source_sha256, sizeof(digest)) != 0) {
+        ESP_LOGE(TAG, "Delta was built against different firmware than %s", dec->source->label);
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Validate the header and allocate the stages it needs
+ */
+static esp_err_t ota_decoder_start(ota_decoder_t *dec)
+{
+    const ota_package_header_t *hdr = &dec->header;
+
+    if (hdr->magic != OTA_PACKAGE_MAGIC || hdr->version != OTA_PACKAGE_VERSION ||
+        hdr->header_size < sizeof(ota_package_header_t) ||
+        (hdr->flags & ~(OTA_PACKAGE_FLAG_DEFLATE | OTA_PACKAGE_FLAG_DELTA))) {
+        ESP_LOGE(TAG, "Not an application image or supported OTA package");
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    if (hdr->flags & OTA_PACKAGE_FLAG_DEFLATE) {
+        dec->inflator = malloc(sizeof(tinfl_decompressor));
+        dec->dict = malloc(TINFL_LZ_DICT_SIZE);
+        if (!dec->inflator || !dec->dict) {
+            return ESP_ERR_NO_MEM;
+        }
+        tinfl_init(dec->inflator);
+    }
+
+    if (hdr->flags & OTA_PACKAGE_FLAG_DELTA) {
+        dec->scratch = malloc(OTA_DECODER_SCRATCH_SIZE);
+        if (!dec->scratch) {
+            return ESP_ERR_NO_MEM;
+        }
+        esp_err_t err = ota_decoder_verify_source(dec);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    switch (hdr->flags) {
+    case OTA_PACKAGE_FLAG_DEFLATE:
+        dec->type = OTA_PACKAGE_COMPRESSED;
+        break;
+    case OTA_PACKAGE_FLAG_DELTA:
+        dec->type = OTA_PACKAGE_DELTA;
+        break;
+    case OTA_PACKAGE_FLAG_DEFLATE | OTA_PACKAGE_FLAG_DELTA:
+        dec->type = OTA_PACKAGE_COMPRESSED_DELTA;
+        break;
+    default:
+        dec->type = OTA_PACKAGE_RAW;
+        break;
+    }
+
+    ESP_LOGI(TAG, "%s package, image size %lu", ota_decoder_type_name(dec->type), (unsigned long)hdr->image_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief Create a decoder
+ */
+esp_err_t ota_decoder_create(const esp_partition_t *source, ota_decoder_write_cb_t write_cb,
+                             void *arg, ota_decoder_t **out)
+{
+    if (!write_cb || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ota_decoder_t *dec = calloc(1, sizeof(ota_decoder_t));
+    if (!dec) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    dec->source = source;
+    dec->write_cb = write_cb;
+    dec->arg = arg;
+    dec->type = OTA_PACKAGE_UNKNOWN;
+    *out = dec;
+    return ESP_OK;
+}
+
+/**
+ * @brief Feed package bytes
+ */
+esp_err_t ota_decoder_feed(ota_decoder_t *dec, const uint8_t *data, size_t len)
+{
+    if (len == 0) {
+        return ESP_OK;
+    }
+
+    if (!dec->started) {
+        // A plain image starts with the ESP image magic, the package magic never does
+        if (dec->header_have == 0 && data[0] == ESP_IMAGE_HEADER_MAGIC) {
+            dec->type = OTA_PACKAGE_RAW;
+        } else {
+            while (len > 0 && dec->header_have < sizeof(ota_package_header_t)) {
+                ((uint8_t *)&dec->header)[dec->header_have++] = *data++;
+                len--;
+            }
+            if (dec->header_have < sizeof(ota_package_header_t)) {
+                return ESP_OK;
+            }
+            if (dec->type == OTA_PACKAGE_UNKNOWN) {
+                esp_err_t err = ota_decoder_start(dec);
+                if (err != ESP_OK) {
+                    return err;
+                }
+            }
+
+            // Skip header extension bytes written by newer packers
+            size_t skip = dec->header.header_size - dec->header_have;
+            if (skip > len) {
+                skip = len;
+            }
+            dec->header_have += skip;
+            data += skip;
+            len -= skip;
+            if (dec->header_have < dec->header.header_size) {
+                return ESP_OK;
+            }
+        }
+        dec->started = true;
+    }
+
+    if (len == 0) {
+        return ESP_OK;
+    }
+    if (dec->header.flags & OTA_PACKAGE_FLAG_DEFLATE) {
+        return ota_decoder_inflate(dec, data, len);
+    }
+    return ota_decoder_payload(dec, data, len);
+}
+
+/**
+ * @brief Finish decoding and flush buffered output
+ */
+esp_err_t ota_decoder_finish(ota_decoder_t *dec)
+{
+    if (!dec->started) {
+        ESP_LOGE(TAG, "Package truncated in header");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if ((dec->header.flags & OTA_PACKAGE_FLAG_DEFLATE) && !dec->inflate_done) {
+        ESP_LOGE(TAG, "Compressed stream truncated");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if ((dec->header.flags & OTA_PACKAGE_FLAG_DELTA) && dec->delta_state != DELTA_STATE_OP) {
+        ESP_LOGE(TAG, "Delta stream truncated");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (dec->header.image_size != 0 && dec->output_size != dec->header.image_size) {
+        ESP_LOGE(TAG, "Decoded %u bytes, expected %lu", (unsigned)dec->output_size,
+                 (unsigned long)dec->header.image_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ota_decoder_flush(dec);
+}
+
+/**
+ * @brief Get the detected package type
+ */
+ota_package_type_t ota_decoder_get_type(const ota_decoder_t *dec)
+{
+    return dec ? dec->type : OTA_PACKAGE_UNKNOWN;
+}
+
+/**
+ * @brief Get the number of decoded bytes passed to the sink
+ */
+size_t ota_decoder_get_output_size(const ota_decoder_t *dec)
+{
+    return dec ? dec->output_size - dec->out_len : 0;
+}
+
+/**
+ * @brief Get a printable name for a package type
+ */
+const char *ota_decoder_type_name(ota_package_type_t type)
+{
+    switch (type) {
+    case OTA_PACKAGE_RAW:               return "raw";
+    case OTA_PACKAGE_COMPRESSED:        return "compressed";
+    case OTA_PACKAGE_DELTA:             return "delta";
+    case OTA_PACKAGE_COMPRESSED_DELTA:  return "compressed delta";
+    default:                            return "unknown";
+    }
+}
+
+/**
+ * @brief Free a decoder and its buffers
+ */
+void ota_decoder_destroy(ota_decoder_t *dec)
+{
+    if (!dec) {
+        return;
+    }
+    free(dec->inflator);
+    free(dec->dict);
+    free(dec->scratch);
+    free(dec);
+}
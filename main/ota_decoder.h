@@ -0,0 +1,120 @@
+/**
+ * @file ota_decoder.h
+ * @brief Streaming OTA package decoder for Halow RTOS
+ *
+ * Features:
+ * - Plain application images passed through unchanged
+ * - zlib-compressed images inflated on the fly (fixed 32KB window)
+ * - Binary delta patches applied against the running partition
+ * - Bounded RAM: nothing is buffered beyond the window and small scratch buffers
+ *
+ * Package layout (little endian), produced by tools/ota_pack.py:
+ *   ota_package_header_t, then the payload. The payload is the image itself
+ *   or a stream of delta operations, optionally zlib compressed as a whole.
+ *
+ * Delta operations:
+ *   OTA_DELTA_OP_COPY   u32 src_offset, u32 len             out = src[len]
+ *   OTA_DELTA_OP_ADD    u32 src_offset, u32 len, u8 diff[len] out = src[len] + diff[len]
+ *   OTA_DELTA_OP_INSERT u32 len, u8 data[len]                  out = data[len]
+ */
+
+#ifndef OTA_DECODER_H
+#define OTA_DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+
+#define OTA_PACKAGE_MAGIC           0x41544F48  // "HOTA"
+#define OTA_PACKAGE_VERSION         1
+#define OTA_PACKAGE_FLAG_DEFLATE    0x01        // Payload is a zlib stream
+#define OTA_PACKAGE_FLAG_DELTA      0x02        // Payload is a delta against the running image
+
+#define OTA_DELTA_OP_COPY           0x01
+#define OTA_DELTA_OP_ADD            0x02
+#define OTA_DELTA_OP_INSERT         0x03
+
+// Package header
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // OTA_PACKAGE_MAGIC
+    uint8_t version;            // OTA_PACKAGE_VERSION
+    uint8_t flags;              // OTA_PACKAGE_FLAG_*
+    uint16_t header_size;       // sizeof(ota_package_header_t), payload starts here
+    uint32_t image_size;        // Size of the decoded application image
+    uint32_t source_size;       // Delta: bytes of the running partition used as base
+    uint8_t source_sha256[32];  // Delta: SHA-256 of those bytes
+} ota_package_header_t;
+
+// Package type, known once the first bytes have been fed
+typedef enum {
+    OTA_PACKAGE_UNKNOWN,
+    OTA_PACKAGE_RAW,
+    OTA_PACKAGE_COMPRESSED,
+    OTA_PACKAGE_DELTA,
+    OTA_PACKAGE_COMPRESSED_DELTA
+} ota_package_type_t;
+
+/**
+ * @brief Output sink for decoded image bytes
+ * @param data Decoded bytes
+ * @param len Number of bytes
+ * @param arg User argument given to ota_decoder_create()
+ * @return ESP_OK to continue, error code to abort decoding
+ */
+typedef esp_err_t (*ota_decoder_write_cb_t)(const void *data, size_t len, void *arg);
+
+typedef struct ota_decoder ota_decoder_t;
+
+/**
+ * @brief Create a decoder
+ * @param source Partition delta patches refer to (normally the running one)
+ * @param write_cb Sink for decoded bytes
+ * @param arg User argument for write_cb
+ * @param out Pointer to store the decoder
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if allocation fails
+ */
+esp_err_t ota_decoder_create(const esp_partition_t *source, ota_decoder_write_cb_t write_cb,
+                             void *arg, ota_decoder_t **out);
+
+/**
+ * @brief Feed package bytes
+ * Window and scratch buffers are allocated when the header shows they are needed.
+ * @param dec Decoder
+ * @param data Package bytes
+ * @param len Number of bytes
+ * @return ESP_OK on success, ESP_ERR_INVALID_VERSION for a bad header,
+ *         ESP_ERR_INVALID_STATE if a delta does not match the running image,
+ *         ESP_ERR_INVALID_SIZE / ESP_FAIL for corrupt data, or the sink's error
+ */
+esp_err_t ota_decoder_feed(ota_decoder_t *dec, const uint8_t *data, size_t len);
+
+/**
+ * @brief Finish decoding and flush buffered output
+ * @param dec Decoder
+ * @return ESP_OK if the package was complete, ESP_ERR_INVALID_SIZE if truncated
+ */
+esp_err_t ota_decoder_finish(ota_decoder_t *dec);
+
+/**
+ * @brief Get the detected package type
+ */
+ota_package_type_t ota_decoder_get_type(const ota_decoder_t *dec);
+
+/**
+ * @brief Get the number of decoded bytes passed to the sink
+ */
+size_t ota_decoder_get_output_size(const ota_decoder_t *dec);
+
+/**
+ * @brief Get a printable name for a package type
+ */
+const char *ota_decoder_type_name(ota_package_type_t type);
+
+/**
+ * @brief Free a decoder and its buffers
+ */
+void ota_decoder_destroy(ota_decoder_t *dec);
+
+#endif // OTA_DECODER_H
@@ -0,0 +1,743 @@
+/**
+ * @file ota_manager.c
+ * @brief OTA (Over-The-Air) update manager implementation for Halow RTOS
+ *
+ * Over 802.11ah the download is the slow part, so flash work must never stall
+ * the socket. The download task only moves bytes from the socket into a free
+ * buffer; the writer task does SHA-256, sector erase and programming on the
+ * other buffer. The queues below carry buffer indices between the two.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include "lwip/inet.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+
+#include "ota_manager.h"
+#include "dns_cache.h"
+#include "ota_decoder.h"
+#include "trace_buffer.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "esp_app_format.h"
+#include "mbedtls/sha256.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "ota_manager";
+
+#define OTA_DOWNLOAD_TASK_STACK     4096
+#define OTA_DOWNLOAD_TASK_PRIORITY  5
+#define OTA_WRITER_TASK_STACK       4096
+#define OTA_WRITER_TASK_PRIORITY    4
+#define OTA_HTTP_HEADER_MAX         1024
+#define OTA_HTTP_DEFAULT_PORT       80
+#define OTA_HOST_MAX_LEN            64
+#define OTA_RETRY_DELAY_MS          1000
+
+// Buffer handed from the download task to the writer task
+typedef struct {
+    int8_t index;           // Buffer index, -1 for end of stream without data
+    uint16_t len;           // Valid bytes in the buffer
+    bool last;              // No more data follows
+    bool error;             // Download failed, abort the update
+} ota_chunk_t;
+
+// Parsed http:// URL
+typedef struct {
+    char host[OTA_HOST_MAX_LEN];
+    uint16_t port;
+    const char *path;       // Points into ota_info.url
+} ota_url_t;
+
+static ota_status_t ota_status = OTA_STATUS_IDLE;
+static ota_update_info_t ota_info;
+static ota_transfer_stats_t ota_stats;
+static int64_t ota_start_us = 0;
+static volatile bool ota_abort_requested = false;
+
+static uint8_t *ota_buffers[OTA_NUM_BUFFERS];
+static QueueHandle_t ota_free_queue = NULL;    // int8_t buffer indices ready to fill
+static QueueHandle_t ota_full_queue = NULL;    // ota_chunk_t ready to write
+static SemaphoreHandle_t ota_download_done = NULL;
+static portMUX_TYPE ota_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Parse http://host[:port]/path
+ * @return 0 on success, -1 if the URL is not a plain http URL
+ */
+static int ota_parse_url(const char *url, ota_url_t *out)
+{
+    static const char prefix[] = "http://";
+
+    if (strncasecmp(url, prefix, sizeof(prefix) - 1) != 0) {
+        return -1;
+    }
+
+    const char *host = url + sizeof(prefix) - 1;
+    const char *path = strchr(host, '/');
+    const char *host_end = path ? path : host + strlen(host);
+    const char *colon = memchr(host, ':', host_end - host);
+
+    size_t host_len = (colon ? colon : host_end) - host;
+    if (host_len == 0 || host_len >= sizeof(out->host)) {
+        return -1;
+    }
+
+    memcpy(out->host, host, host_len);
+    out->host[host_len] = '\0';
+    out->port = colon ? (uint16_t)atoi(colon + 1) : OTA_HTTP_DEFAULT_PORT;
+    out->path = path ? path : "/";
+    return out->port ? 0 : -1;
+}
+
+/**
+ * @brief Connect and send a GET request, resuming at offset with a Range header
+ * @param url Parsed URL
+ * @param offset Bytes already received
+ * @param body Buffer receiving any body bytes read together with the headers
+ * @param body_max Capacity of body
+ * @param body_len Number of body bytes stored
+ * @param content_len Remaining body length, 0 if unknown
+ * @return Connected socket, -1 on error
+ */
+static int ota_http_get(const ota_url_t *url, size_t offset, uint8_t *body, size_t body_max,
+                        size_t *body_len, size_t *content_len)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(url->port),
+    };
+
+    // Resume requests reuse the cached address instead of a new lookup
+    esp_err_t err = dns_cache_resolve(url->host, &addr.sin_addr);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Could not resolve '%s': %s", url->host, esp_err_to_name(err));
+        return -1;
+    }
+
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Failed to create socket (errno %d)", errno);
+        return -1;
+    }
+
+    struct timeval tv = { .tv_sec = OTA_RECV_TIMEOUT_MS / 1000, .tv_usec = (OTA_RECV_TIMEOUT_MS % 1000) * 1000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        ESP_LOGE(TAG, "Connect to %s:%u failed (errno %d)", url->host, url->port, errno);
+        close(sock);
+        return -1;
+    }
+
+    char header[OTA_HTTP_HEADER_MAX + 1];
+    int len = snprintf(header, sizeof(header),
+                       "GET %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: halow-rtos-ota\r\nConnection: close\r\n",
+                       url->path, url->host);
+    if (offset > 0) {
+        len += snprintf(header + len, sizeof(header) - len, "Range: bytes=%u-\r\n", (unsigned)offset);
+    }
+    len += snprintf(header + len, sizeof(header) - len, "\r\n");
+
+    if (len >= (int)sizeof(header) || send(sock, header, len, 0) != len) {
+        ESP_LOGE(TAG, "Failed to send HTTP request");
+        close(sock);
+        return -1;
+    }
+
+    // Read until the end of the headers; whatever follows is body
+    size_t have = 0;
+    char *end = NULL;
+    while (!end) {
+        if (have >= OTA_HTTP_HEADER_MAX) {
+            ESP_LOGE(TAG, "HTTP response header too large");
+            close(sock);
+            return -1;
+        }
+        int n = recv(sock, header + have, OTA_HTTP_HEADER_MAX - have, 0);
+        if (n <= 0) {
+            ESP_LOGE(TAG, "Connection closed while reading HTTP headers");
+            close(sock);
+            return -1;
+        }
+        have += n;
+        header[have] = '\0';
+        end = strstr(header, "\r\n\r\n");
+    }
+
+    int status = 0;
+    if (sscanf(header, "HTTP/%*d.%*d %d", &status) != 1 ||
+        (offset == 0 && status != 200) || (offset > 0 && status != 206)) {
+        ESP_LOGE(TAG, "Unexpected HTTP status %d%s", status,
+                 (offset > 0 && status == 200) ? " (server does not support resume)" : "");
+        close(sock);
+        return -1;
+    }
+
+    *content_len = 0;
+    for (char *line = strstr(header, "\r\n"); line && line < end; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line + 2, "Content-Length:", 15) == 0) {
+            *content_len = strtoul(line + 2 + 15, NULL, 10);
+        }
+    }
+
+    char *body_start = end + 4;
+    *body_len = have - (body_start - header);
+    if (*body_len > body_max) {
+        *body_len = body_max;   // Cannot happen: header buffer is smaller than a chunk buffer
+    }
+    memcpy(body, body_start, *body_len);
+    return sock;
+}
+
+/**
+ * @brief Add elapsed wait time to a statistics counter
+ */
+static void ota_account_wait(uint32_t *counter, int64_t since_us)
+{
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - since_us) / 1000);
+    portENTER_CRITICAL(&ota_stats_lock);
+    *counter += ms;
+    portEXIT_CRITICAL(&ota_stats_lock);
+}
+
+/**
+ * @brief Use up one download retry, if any are left
+ * @param attempt Optional pointer to store the retry number
+ * @return true if a retry may be made, false once the budget is spent
+ */
+static bool ota_take_retry(unsigned *attempt)
+{
+    portENTER_CRITICAL(&ota_stats_lock);
+    bool ok = ota_stats.retries < OTA_MAX_RETRY;
+    if (ok) {
+        ota_stats.retries++;
+    }
+    unsigned retries = ota_stats.retries;
+    portEXIT_CRITICAL(&ota_stats_lock);
+
+    if (attempt) {
+        *attempt = retries;
+    }
+    return ok;
+}
+
+/**
+ * @brief Download task: socket -> free buffer -> writer
+ */
+static void ota_download_task(void *pvParameters)
+{
+    ota_url_t url;
+    ota_chunk_t chunk = { .index = -1 };
+    size_t received = 0;
+    size_t expected = ota_info.file_size;
+    int sock = -1;
+    bool ok = false;
+
+    ota_parse_url(ota_info.url, &url);
+
+    while (!ota_abort_requested) {
+        // Grab a buffer; time spent here means flash is the bottleneck
+        if (chunk.index < 0) {
+            int64_t wait_start = esp_timer_get_time();
+            if (xQueueReceive(ota_free_queue, &chunk.index, pdMS_TO_TICKS(100)) != pdTRUE) {
+                ota_account_wait(&ota_stats.download_wait_ms, wait_start);
+                chunk.index = -1;
+                continue;
+            }
+            ota_account_wait(&ota_stats.download_wait_ms, wait_start);
+            chunk.len = 0;
+        }
+
+        if (sock < 0) {
+            size_t body_len = 0;
+            size_t content_len = 0;
+            sock = ota_http_get(&url, received, ota_buffers[chunk.index] + chunk.len,
+                                OTA_BUFFER_SIZE - chunk.len, &body_len, &content_len);
+            if (sock < 0) {
+                unsigned attempt;
+                if (!ota_take_retry(&attempt)) {
+                    break;
+                }
+                ESP_LOGW(TAG, "Retrying download at offset %u (%u/%d)",
+                         (unsigned)received, attempt, OTA_MAX_RETRY);
+                vTaskDelay(pdMS_TO_TICKS(OTA_RETRY_DELAY_MS));
+                continue;
+            }
+
+            if (received == 0) {
+                if (expected != 0 && content_len != 0 && content_len != expected) {
+                    ESP_LOGE(TAG, "Server size %u does not match expected size %u",
+                             (unsigned)content_len, (unsigned)expected);
+                    break;
+                }
+                if (expected == 0) {
+                    expected = content_len;
+                    portENTER_CRITICAL(&ota_stats_lock);
+                    ota_stats.total_size = expected;
+                    portEXIT_CRITICAL(&ota_stats_lock);
+                }
+            }
+            chunk.len += body_len;
+            received += body_len;
+        } else {
+            int n = recv(sock, ota_buffers[chunk.index] + chunk.len, OTA_BUFFER_SIZE - chunk.len, 0);
+            if (n < 0 || (n == 0 && expected != 0 && received < expected)) {
+                // Timeout or early close: reconnect and resume where we are, within the
+                // same retry budget so a server that keeps dropping us is given up on
+                ESP_LOGW(TAG, "Connection lost at offset %u (errno %d)", (unsigned)received, errno);
+                close(sock);
+                sock = -1;
+                if (!ota_take_retry(NULL)) {
+                    break;
+                }
+                vTaskDelay(pdMS_TO_TICKS(OTA_RETRY_DELAY_MS));
+                continue;
+            }
+            if (n == 0) {
+                ok = true;  // Unknown length: server closed at end of body
+            }
+            chunk.len += n;
+            received += n;
+        }
+
+        portENTER_CRITICAL(&ota_stats_lock);
+        ota_stats.bytes_received = received;
+        portEXIT_CRITICAL(&ota_stats_lock);
+
+        if (expected != 0 && received >= expected) {
+            ok = true;
+        }
+
+        // Hand over a full buffer, or the partial last one
+        if (chunk.len == OTA_BUFFER_SIZE || ok) {
+            chunk.last = ok;
+            TRACE_EVENT(TRACE_EV_OTA_CHUNK_READY, chunk.len);
+            xQueueSend(ota_full_queue, &chunk, portMAX_DELAY);
+            chunk.index = -1;
+            if (ok) {
+                break;
+            }
+        }
+    }
+
+    if (sock >= 0) {
+        close(sock);
+    }
+
+    if (!ok) {
+        ota_chunk_t fail = { .index = chunk.index, .len = 0, .last = true, .error = true };
+        xQueueSend(ota_full_queue, &fail, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(ota_download_done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Convert a digest to lowercase hex
+ */
+static void ota_sha256_to_hex(const uint8_t *digest, char *hex)
+{
+    for (int i = 0; i < 32; i++) {
+        sprintf(hex + i * 2, "%02x", digest[i]);
+    }
+}
+
+/**
+ * @brief Release update resources
+ */
+static void ota_free_resources(void)
+{
+    for (int i = 0; i < OTA_NUM_BUFFERS; i++) {
+        free(ota_buffers[i]);
+        ota_buffers[i] = NULL;
+    }
+    if (ota_free_queue) {
+        vQueueDelete(ota_free_queue);
+        ota_free_queue = NULL;
+    }
+    if (ota_full_queue) {
+        vQueueDelete(ota_full_queue);
+        ota_full_queue = NULL;
+    }
+    if (ota_download_done) {
+        vSemaphoreDelete(ota_download_done);
+        ota_download_done = NULL;
+    }
+}
+
+/**
+ * @brief Decoder sink: program decoded image bytes
+ */
+static esp_err_t ota_flash_write(const void *data, size_t len, void *arg)
+{
+    esp_ota_handle_t handle = *(esp_ota_handle_t *)arg;
+
+    TRACE_EVENT(TRACE_EV_OTA_FLASH, len);
+    esp_err_t err = esp_ota_write(handle, data, len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_write failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    portENTER_CRITICAL(&ota_stats_lock);
+    ota_stats.image_written += len;
+    portEXIT_CRITICAL(&ota_stats_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief Writer task: buffer -> SHA-256 -> decoder -> esp_ota_write -> free buffer
+ */
+static void ota_writer_task(void *pvParameters)
+{
+    const esp_partition_t *target = (const esp_partition_t *)pvParameters;
+    esp_ota_handle_t handle = 0;
+    ota_decoder_t *decoder = NULL;
+    mbedtls_sha256_context sha;
+    uint8_t digest[32];
+    char digest_hex[65];
+    size_t written = 0;
+    bool ok = false;
+
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+
+    // Sequential writes: esp_ota_write erases each sector just before programming it
+    esp_err_t err = esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_begin failed: %s", esp_err_to_name(err));
+        ota_abort_requested = true;
+    }
+
+    // Deltas are applied against the image we are running from
+    if (err == ESP_OK) {
+        err = ota_decoder_create(esp_ota_get_running_partition(), ota_flash_write, &handle, &decoder);
+        if (err != ESP_OK) {
+            ota_abort_requested = true;
+        }
+    }
+
+    while (err == ESP_OK) {
+        ota_chunk_t chunk;
+        int64_t wait_start = esp_timer_get_time();
+        xQueueReceive(ota_full_queue, &chunk, portMAX_DELAY);
+        ota_account_wait(&ota_stats.writer_wait_ms, wait_start);
+
+        if (chunk.error) {
+            err = ESP_FAIL;
+            break;
+        }
+
+        if (chunk.len > 0) {
+            TRACE_EVENT(TRACE_EV_OTA_WRITE_BEGIN, chunk.len);
+            mbedtls_sha256_update(&sha, ota_buffers[chunk.index], chunk.len);
+            err = ota_decoder_feed(decoder, ota_buffers[chunk.index], chunk.len);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Decoding failed at offset %u: %s", (unsigned)written, esp_err_to_name(err));
+                ota_abort_requested = true;
+                break;
+            }
+            written += chunk.len;
+            TRACE_EVENT(TRACE_EV_OTA_WRITE_END, chunk.len);
+            portENTER_CRITICAL(&ota_stats_lock);
+            ota_stats.bytes_written = written;
+            ota_stats.package_type = ota_decoder_get_type(decoder);
+            portEXIT_CRITICAL(&ota_stats_lock);
+        }
+
+        if (chunk.index >= 0) {
+            xQueueSend(ota_free_queue, &chunk.index, portMAX_DELAY);
+        }
+
+        if (chunk.last) {
+            ok = true;
+            break;
+        }
+    }
+
+    // The download task may still hold a buffer; wait until it is gone
+    xSemaphoreTake(ota_download_done, portMAX_DELAY);
+
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    ota_sha256_to_hex(digest, digest_hex);
+
+    if (ok) {
+        ota_status = OTA_STATUS_VERIFYING;
+        err = ota_decoder_finish(decoder);
+        if (err != ESP_OK) {
+            ok = false;
+        } else if (ota_info.sha256[0] != '\0' && strcasecmp(digest_hex, ota_info.sha256) != 0) {
+            ESP_LOGE(TAG, "SHA-256 mismatch: got %s, expected %s", digest_hex, ota_info.sha256);
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        err = esp_ota_end(handle);
+        handle = 0;
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Image validation failed: %s", esp_err_to_name(err));
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        ota_status = OTA_STATUS_INSTALLING;
+        err = esp_ota_set_boot_partition(target);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to set boot partition: %s", esp_err_to_name(err));
+            ok = false;
+        }
+    }
+
+    if (handle) {
+        esp_ota_abort(handle);
+    }
+    ota_decoder_destroy(decoder);
+
+    portENTER_CRITICAL(&ota_stats_lock);
+    ota_stats.elapsed_ms = (uint32_t)((esp_timer_get_time() - ota_start_us) / 1000);
+    portEXIT_CRITICAL(&ota_stats_lock);
+
+    ota_free_resources();
+
+    if (ok) {
+        ESP_LOGI(TAG, "Update written to %s (%s package, %u bytes -> %u byte image, sha256 %s), restart to boot it",
+                 target->label, ota_decoder_type_name(ota_stats.package_type), (unsigned)written,
+                 (unsigned)ota_stats.image_written, digest_hex);
+        ota_status = OTA_STATUS_COMPLETE;
+    } else {
+        ota_status = OTA_STATUS_FAILED;
+    }
+
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Initialize OTA manager
+ */
+esp_err_t ota_manager_init(void)
+{
+    if (ota_is_first_boot_after_update()) {
+        ESP_LOGW(TAG, "Running new firmware pending verification, call ota_mark_valid() after checks");
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Get current running partition info
+ */
+esp_err_t ota_get_current_partition_info(char* partition_label, size_t label_size,
+                                         esp_app_desc_t* app_desc)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (!running) {
+        return ESP_FAIL;
+    }
+
+    if (partition_label && label_size > 0) {
+        strncpy(partition_label, running->label, label_size - 1);
+        partition_label[label_size - 1] = '\0';
+    }
+
+    if (app_desc) {
+        return esp_ota_get_partition_description(running, app_desc);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Check if system can perform OTA update
+ */
+bool ota_can_update(void)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    esp_ota_img_states_t state;
+
+    if (!esp_ota_get_next_update_partition(NULL)) {
+        return false;
+    }
+
+    // Don't overwrite the fallback image while the running one is unconfirmed
+    if (running && esp_ota_get_state_partition(running, &state) == ESP_OK &&
+        state == ESP_OTA_IMG_PENDING_VERIFY) {
+        return false;
+    }
+
+    return ota_status != OTA_STATUS_DOWNLOADING &&
+           ota_status != OTA_STATUS_VERIFYING &&
+           ota_status != OTA_STATUS_INSTALLING;
+}
+
+/**
+ * @brief Start OTA update from URL
+ */
+esp_err_t ota_start_update(const ota_update_info_t* update_info)
+{
+    ota_url_t url;
+
+    if (!update_info || ota_parse_url(update_info->url, &url) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (update_info->sha256[0] != '\0' && strlen(update_info->sha256) != 64) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!ota_can_update()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const esp_partition_t *target = esp_ota_get_next_update_partition(NULL);
+    if (update_info->file_size > target->size) {
+        ESP_LOGE(TAG, "Image (%u bytes) does not fit %s", (unsigned)update_info->file_size, target->label);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ota_info = *update_info;
+    portENTER_CRITICAL(&ota_stats_lock);
+    memset(&ota_stats, 0, sizeof(ota_stats));
+    ota_stats.total_size = ota_info.file_size;
+    portEXIT_CRITICAL(&ota_stats_lock);
+    ota_abort_requested = false;
+
+    ota_free_queue = xQueueCreate(OTA_NUM_BUFFERS, sizeof(int8_t));
+    ota_full_queue = xQueueCreate(OTA_NUM_BUFFERS + 1, sizeof(ota_chunk_t));
+    ota_download_done = xSemaphoreCreateBinary();
+    for (int8_t i = 0; i < OTA_NUM_BUFFERS; i++) {
+        ota_buffers[i] = malloc(OTA_BUFFER_SIZE);
+        if (ota_buffers[i] && ota_free_queue) {
+            xQueueSend(ota_free_queue, &i, 0);
+        }
+    }
+
+    bool allocated = ota_free_queue && ota_full_queue && ota_download_done;
+    for (int i = 0; i < OTA_NUM_BUFFERS; i++) {
+        allocated = allocated && ota_buffers[i];
+    }
+    if (!allocated) {
+        ota_free_resources();
+        return ESP_ERR_NO_MEM;
+    }
+
+    ota_start_us = esp_timer_get_time();
+    ota_status = OTA_STATUS_DOWNLOADING;
+
+    if (xTaskCreate(ota_writer_task, "ota_writer", OTA_WRITER_TASK_STACK, (void *)target,
+                    OTA_WRITER_TASK_PRIORITY, NULL) != pdPASS) {
+        ota_free_resources();
+        ota_status = OTA_STATUS_FAILED;
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(ota_download_task, "ota_download", OTA_DOWNLOAD_TASK_STACK, NULL,
+                    OTA_DOWNLOAD_TASK_PRIORITY, NULL) != pdPASS) {
+        // Let the writer clean up as if the download failed
+        ota_chunk_t fail = { .index = -1, .last = true, .error = true };
+        xQueueSend(ota_full_queue, &fail, portMAX_DELAY);
+        xSemaphoreGive(ota_download_done);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "OTA update started: %s -> %s", ota_info.url, target->label);
+    return ESP_OK;
+}
+
+/**
+ * @brief Get current OTA status
+ */
+ota_status_t ota_get_status(void)
+{
+    return ota_status;
+}
+
+/**
+ * @brief Get OTA progress percentage (0-100)
+ */
+int ota_get_progress(void)
+{
+    if (ota_status == OTA_STATUS_COMPLETE) {
+        return 100;
+    }
+
+    portENTER_CRITICAL(&ota_stats_lock);
+    size_t total = ota_stats.total_size;
+    size_t written = ota_stats.bytes_written;
+    portEXIT_CRITICAL(&ota_stats_lock);
+
+    if (total == 0) {
+        return 0;
+    }
+    return (int)((uint64_t)written * 100 / total);
+}
+
+/**
+ * @brief Get transfer statistics of the current or last update
+ */
+esp_err_t ota_get_transfer_stats(ota_transfer_stats_t* stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&ota_stats_lock);
+    *stats = ota_stats;
+    portEXIT_CRITICAL(&ota_stats_lock);
+
+    if (ota_status == OTA_STATUS_DOWNLOADING && ota_start_us != 0) {
+        stats->elapsed_ms = (uint32_t)((esp_timer_get_time() - ota_start_us) / 1000);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Mark current firmware as valid (prevent rollback)
+ */
+esp_err_t ota_mark_valid(void)
+{
+    return esp_ota_mark_app_valid_cancel_rollback();
+}
+
+/**
+ * @brief Check if this boot is first boot after OTA update
+ */
+bool ota_is_first_boot_after_update(void)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    esp_ota_img_states_t state;
+
+    return running && esp_ota_get_state_partition(running, &state) == ESP_OK &&
+           state == ESP_OTA_IMG_PENDING_VERIFY;
+}
+
+/**
+ * @brief Perform system rollback to previous firmware
+ */
+esp_err_t ota_rollback(void)
+{
+    ota_status = OTA_STATUS_ROLLBACK;
+    esp_err_t err = esp_ota_mark_app_invalid_rollback_and_reboot();
+
+    // Only returns on failure
+    ota_status = OTA_STATUS_FAILED;
+    return err;
+}
+
+/**
+ * @brief Get available space for OTA update
+ */
+size_t ota_get_available_space(void)
+{
+    const esp_partition_t *target = esp_ota_get_next_update_partition(NULL);
+    return target ? target->size : 0;
+}
@@ -7,6 +7,15 @@
  * - A/B partition switching
  * - Rollback protection
  * - Update verification
+ *
+ * Updates are streamed over HTTP into the inactive slot: a download task
+ * fills two alternating OTA_BUFFER_SIZE buffers while a writer task hashes
+ * (SHA-256) and writes the other one with esp_ota_write(). The slot is
+ * erased sector by sector as it is written rather than wiped up front.
+ *
+ * The writer passes data through ota_decoder, so compressed images and delta
+ * patches against the running partition are expanded on the way to flash
+ * (see ota_decoder.h). The sha256 field always covers the downloaded file.
  */
 
 #ifndef OTA_MANAGER_H
@@ -14,12 +23,14 @@
 
 #include "esp_err.h"
 #include "esp_ota_ops.h"
+#include "ota_decoder.h"
 #include <stdbool.h>
 
 // OTA Configuration
 #define OTA_RECV_TIMEOUT_MS     10000
 #define OTA_MAX_RETRY           3
 #define OTA_BUFFER_SIZE         4096
+#define OTA_NUM_BUFFERS         2       // Download/write double buffering
 
 // OTA Status
 typedef enum {
@@ -40,6 +51,19 @@ typedef struct {
     char sha256[65];  // SHA256 hash for verification
 } ota_update_info_t;
 
+// Transfer statistics of the current or last update
+typedef struct {
+    size_t total_size;          // Expected size, 0 if unknown
+    size_t bytes_received;      // Bytes received from the network
+    size_t bytes_written;       // Downloaded bytes consumed by the writer
+    size_t image_written;       // Decoded image bytes written to flash
+    ota_package_type_t package_type;
+    uint32_t elapsed_ms;        // Time since the update started (or total time when finished)
+    uint32_t download_wait_ms;  // Download task waiting for a free buffer (flash bound)
+    uint32_t writer_wait_ms;    // Writer task waiting for data (network bound)
+    uint8_t retries;            // Reconnects (resumed with an HTTP Range request)
+} ota_transfer_stats_t;
+
 /**
  * @brief Initialize OTA manager
  * @return ESP_OK on success
@@ -64,8 +88,12 @@ bool ota_can_update(void);
 
 /**
  * @brief Start OTA update from URL
+ * Runs in the background; poll ota_get_status()/ota_get_progress(). Only
+ * plain http:// URLs are supported. An empty sha256 skips the hash check.
+ * On success the new slot is set as boot partition; restart to run it.
  * @param update_info OTA update information
- * @return ESP_OK if update started successfully
+ * @return ESP_OK if update started successfully, ESP_ERR_INVALID_STATE if
+ *         an update is already running, ESP_ERR_INVALID_ARG for a bad URL
  */
 esp_err_t ota_start_update(const ota_update_info_t* update_info);
 
@@ -81,6 +109,13 @@ ota_status_t ota_get_status(void);
  */
 int ota_get_progress(void);
 
+/**
+ * @brief Get transfer statistics of the current or last update
+ * @param stats Pointer to store statistics
+ * @return ESP_OK on success
+ */
+esp_err_t ota_get_transfer_stats(ota_transfer_stats_t* stats);
+
 /**
  * @brief Mark current firmware as valid (prevent rollback)
  * Should be called after successful boot and system check
@@ -106,4 +141,4 @@ esp_err_t ota_rollback(void);
  */
 size_t ota_get_available_space(void);
 
-#endif // OTA_MANAGER_H
\ No newline at end of file
+#endif // OTA_MANAGER_H
@@ -8,6 +8,11 @@
 #include "esp_partition.h"
 #include "esp_ota_ops.h"
 #include "esp_app_format.h"
+#include "esp_image_format.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "mbedtls/sha256.h"
+#include "spi_flash_mmap.h"
 #include <string.h>
 
 // static const char *TAG = "ota_test";  // Currently unused
@@ -20,6 +25,8 @@
 #define COLOR_CYAN    "\033[36m"
 #define COLOR_BOLD    "\033[1m"
 
+#define OTA_TEST_COPY_BUFFER_SIZE   (32 * 1024)     // Multiple of SPI_FLASH_SEC_SIZE
+
 void ota_test_show_partition_info(void)
 {
     printf("\n" COLOR_CYAN COLOR_BOLD "=== OTA PARTITION STATUS ===" COLOR_RESET "\n\n");
@@ -89,6 +96,52 @@ esp_err_t ota_test_mark_partition_valid(void)
     return err;
 }
 
+/**
+ * @brief Get the length of the application image in a partition
+ * Walks the image header and segment table the same way the bootloader
+ * does, so only the bytes that make up the image need to be copied.
+ * @param part App partition
+ * @param image_len Pointer to store image length (checksum and appended hash included)
+ * @return ESP_OK on success, ESP_ERR_IMAGE_INVALID if the header is not valid
+ */
+static esp_err_t ota_test_get_image_length(const esp_partition_t *part, size_t *image_len)
+{
+    esp_image_header_t header;
+    esp_image_segment_header_t segment;
+
+    esp_err_t err = esp_partition_read(part, 0, &header, sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (header.magic != ESP_IMAGE_HEADER_MAGIC || header.segment_count > ESP_IMAGE_MAX_SEGMENTS) {
+        return ESP_ERR_IMAGE_INVALID;
+    }
+
+    size_t offset = sizeof(header);
+    for (int i = 0; i < header.segment_count; i++) {
+        err = esp_partition_read(part, offset, &segment, sizeof(segment));
+        if (err != ESP_OK) {
+            return err;
+        }
+        offset += sizeof(segment) + segment.data_len;
+        if (offset > part->size) {
+            return ESP_ERR_IMAGE_INVALID;
+        }
+    }
+
+    // Checksum byte sits at the end of a 16-byte aligned block, then the optional SHA-256
+    offset = (offset + 16) & ~(size_t)15;
+    if (header.hash_appended) {
+        offset += 32;
+    }
+    if (offset > part->size) {
+        return ESP_ERR_IMAGE_INVALID;
+    }
+
+    *image_len = offset;
+    return ESP_OK;
+}
+
 esp_err_t ota_test_copy_firmware_to_other_partition(void)
 {
     const esp_partition_t* running = esp_ota_get_running_partition();
@@ -114,28 +167,46 @@ esp_err_t ota_test_copy_firmware_to_other_partition(void)
         return ESP_FAIL;
     }
     
-    printf(COLOR_YELLOW " Copying firmware from %s to %s...\n" COLOR_RESET, running->label, target->label);
-    printf("   This may take a while (copying %.1fMB)...\n", running->size / 1024.0 / 1024.0);
-    
-    // Erase target partition first
-    printf("    Erasing target partition...\n");
-    esp_err_t err = esp_partition_erase_range(target, 0, target->size);
+    // Only copy the application image, not the whole partition
+    size_t image_len = 0;
+    esp_err_t err = ota_test_get_image_length(running, &image_len);
     if (err != ESP_OK) {
-        printf(COLOR_RED " Failed to erase target partition: %s\n" COLOR_RESET, esp_err_to_name(err));
+        printf(COLOR_RED " Failed to read image length: %s\n" COLOR_RESET, esp_err_to_name(err));
         return err;
     }
+    if (image_len > target->size) {
+        printf(COLOR_RED " Image (%u bytes) does not fit %s\n" COLOR_RESET, (unsigned)image_len, target->label);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    printf(COLOR_YELLOW " Copying firmware from %s to %s...\n" COLOR_RESET, running->label, target->label);
+    printf("   Image size: %.2fMB of %.1fMB partition\n", image_len / 1024.0 / 1024.0, running->size / 1024.0 / 1024.0);
     
-    // Copy data in chunks
-    const size_t chunk_size = 4096;
-    uint8_t *buffer = malloc(chunk_size);
+    // Large internal DMA-capable buffer so flash reads/writes go out in few transactions
+    size_t chunk_size = OTA_TEST_COPY_BUFFER_SIZE;
+    uint8_t *buffer = heap_caps_malloc(chunk_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!buffer) {
+        chunk_size = SPI_FLASH_SEC_SIZE;
+        buffer = heap_caps_malloc(chunk_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    }
     if (!buffer) {
         printf(COLOR_RED " Failed to allocate buffer\n" COLOR_RESET);
         return ESP_ERR_NO_MEM;
     }
     
+    mbedtls_sha256_context sha;
+    uint8_t source_hash[32];
+    uint8_t target_hash[32];
+    int64_t start_us = esp_timer_get_time();
+    
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    
+    // Erase each chunk's sectors right before writing it; chunks are sector aligned
     printf("    Copying firmware data...\n");
-    for (size_t offset = 0; offset < running->size; offset += chunk_size) {
-        size_t read_size = (offset + chunk_size > running->size) ? (running->size - offset) : chunk_size;
+    for (size_t offset = 0; offset < image_len; offset += chunk_size) {
+        size_t read_size = (offset + chunk_size > image_len) ? (image_len - offset) : chunk_size;
+        size_t erase_size = (read_size + SPI_FLASH_SEC_SIZE - 1) & ~(size_t)(SPI_FLASH_SEC_SIZE - 1);
         
         // Read from running partition
         err = esp_partition_read(running, offset, buffer, read_size);
@@ -143,6 +214,13 @@ esp_err_t ota_test_copy_firmware_to_other_partition(void)
             printf(COLOR_RED " Read failed at offset 0x%x: %s\n" COLOR_RESET, offset, esp_err_to_name(err));
             break;
         }
+        mbedtls_sha256_update(&sha, buffer, read_size);
+        
+        err = esp_partition_erase_range(target, offset, erase_size);
+        if (err != ESP_OK) {
+            printf(COLOR_RED " Erase failed at offset 0x%x: %s\n" COLOR_RESET, offset, esp_err_to_name(err));
+            break;
+        }
         
         // Write to target partition
         err = esp_partition_write(target, offset, buffer, read_size);
@@ -151,16 +229,37 @@ esp_err_t ota_test_copy_firmware_to_other_partition(void)
             break;
         }
         
-        // Show progress every 1MB
-        if (offset % (1024 * 1024) == 0) {
-            printf("    Progress: %.1fMB / %.1fMB\n", offset / 1024.0 / 1024.0, running->size / 1024.0 / 1024.0);
+        // Show progress every 256KB
+        if (offset % (256 * 1024) == 0) {
+            printf("    Progress: %.2fMB / %.2fMB\n", offset / 1024.0 / 1024.0, image_len / 1024.0 / 1024.0);
+        }
+    }
+    mbedtls_sha256_finish(&sha, source_hash);
+    
+    // Read the copy back and compare hashes
+    if (err == ESP_OK) {
+        printf("    Verifying copy...\n");
+        mbedtls_sha256_starts(&sha, 0);
+        for (size_t offset = 0; offset < image_len && err == ESP_OK; offset += chunk_size) {
+            size_t read_size = (offset + chunk_size > image_len) ? (image_len - offset) : chunk_size;
+            err = esp_partition_read(target, offset, buffer, read_size);
+            mbedtls_sha256_update(&sha, buffer, read_size);
+        }
+        mbedtls_sha256_finish(&sha, target_hash);
+        
+        if (err == ESP_OK && memcmp(source_hash, target_hash, sizeof(source_hash)) != 0) {
+            printf(COLOR_RED " Verification failed: SHA-256 of copy does not match\n" COLOR_RESET);
+            err = ESP_ERR_INVALID_CRC;
         }
     }
     
-    free(buffer);
+    mbedtls_sha256_free(&sha);
+    heap_caps_free(buffer);
     
     if (err == ESP_OK) {
-        printf(COLOR_GREEN " Firmware copied successfully!\n" COLOR_RESET);
+        double elapsed_s = (esp_timer_get_time() - start_us) / 1000000.0;
+        printf(COLOR_GREEN " Firmware copied and verified in %.1fs (%.0fKB/s)\n" COLOR_RESET,
+               elapsed_s, image_len / 1024.0 / elapsed_s);
     }
     
     return err;
@@ -6,17 +6,46 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 #include "task_gpio.h"
+#include "gpio_monitor.h"
+#ifndef HALOW_DISABLED
+#include "gpio_mirror.h"
+#endif
 #include "esp_log.h"
 #include "esp_console.h"
 #include "driver/gpio.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "esp_cpu.h"
+#include "esp_private/esp_clk.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 static const char* TAG = "task_gpio";
 
 // NVS namespace for GPIO configuration
 #define GPIO_NVS_NAMESPACE "gpio_config"
+#define GPIO_NVS_BLOB_KEY  "pins"
+
+// Packed GPIO table: header with per-pin bitmaps, then a label table of
+// (pin, length, text) entries for configured pins with a label
+#define GPIO_BLOB_VERSION   1
+#define GPIO_PIN_BIT(pin)   (1ULL << (pin))
+#define GPIO_VALID_MASK     (GPIO_PIN_BIT(GPIO_MAX_PIN + 1) - 1)
+#define GPIO_BLOB_MAX_SIZE  (sizeof(gpio_blob_header_t) + (GPIO_MAX_PIN + 1) * (2 + GPIO_LABEL_MAX_LEN))
+
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t pin_count;
+    uint16_t label_count;
+    uint64_t saved_mask;      // Pins with a saved configuration
+    uint64_t output_mask;     // Direction: 1 = output
+    uint64_t pullup_mask;
+    uint64_t pulldown_mask;
+} gpio_blob_header_t;
 
 // ANSI Color Codes
 #define COLOR_RESET     "\033[0m"
@@ -30,6 +59,12 @@ static const char* TAG = "task_gpio";
 
 // GPIO pin state tracking
 static task_gpio_pin_state_t gpio_states[GPIO_MAX_PIN + 1];
+static uint64_t gpio_saved_mask = 0;  // Pins persisted in the blob
+static uint64_t gpio_output_mask = 0; // Pins currently configured as output
+static portMUX_TYPE gpio_bank_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#define GPIO_BENCH_DEFAULT_ITERATIONS   10000
+#define GPIO_BENCH_MAX_ITERATIONS       100000
 
 /**
  * @brief Check if GPIO pin is valid for use
@@ -84,140 +119,283 @@ static bool gpio_supports_pull(uint8_t pin)
 }
 
 /**
- * @brief Save GPIO configuration for a specific pin to NVS
+ * @brief Apply a loaded direction/pull configuration to hardware
  */
-static esp_err_t gpio_save_pin_config(uint8_t pin)
+static void gpio_apply_pin_config(uint8_t pin)
 {
-    if (!task_gpio_is_valid_pin(pin)) {
-        return ESP_ERR_INVALID_ARG;
+    gpio_mode_t mode = (gpio_states[pin].direction == TASK_GPIO_DIR_OUTPUT) ? GPIO_MODE_OUTPUT : GPIO_MODE_INPUT;
+    if (gpio_set_direction(pin, mode) == ESP_OK) {
+        if (mode == GPIO_MODE_OUTPUT) {
+            gpio_output_mask |= GPIO_PIN_BIT(pin);
+        } else {
+            gpio_output_mask &= ~GPIO_PIN_BIT(pin);
+        }
     }
-    
+
+    // Apply pull mode to hardware if it's input
+    if (gpio_states[pin].direction == TASK_GPIO_DIR_INPUT && gpio_supports_pull(pin)) {
+        switch (gpio_states[pin].pull_mode) {
+            case TASK_GPIO_PULL_UP:
+                gpio_set_pull_mode(pin, GPIO_PULLUP_ONLY);
+                break;
+            case TASK_GPIO_PULL_DOWN:
+                gpio_set_pull_mode(pin, GPIO_PULLDOWN_ONLY);
+                break;
+            case TASK_GPIO_PULL_NONE:
+                gpio_set_pull_mode(pin, GPIO_FLOATING);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Pack gpio_states[] into the blob format
+ * @param buf Output buffer of GPIO_BLOB_MAX_SIZE bytes
+ * @return Blob length in bytes
+ */
+static size_t gpio_pack_blob(uint8_t *buf)
+{
+    gpio_blob_header_t hdr = {
+        .version = GPIO_BLOB_VERSION,
+        .pin_count = GPIO_MAX_PIN + 1,
+        .label_count = 0,
+        .saved_mask = gpio_saved_mask,
+    };
+    size_t len = sizeof(hdr);
+
+    for (uint8_t pin = GPIO_MIN_PIN; pin <= GPIO_MAX_PIN; pin++) {
+        if (!(gpio_saved_mask & GPIO_PIN_BIT(pin))) {
+            continue;
+        }
+        if (gpio_states[pin].direction == TASK_GPIO_DIR_OUTPUT) {
+            hdr.output_mask |= GPIO_PIN_BIT(pin);
+        }
+        if (gpio_states[pin].pull_mode == TASK_GPIO_PULL_UP) {
+            hdr.pullup_mask |= GPIO_PIN_BIT(pin);
+        } else if (gpio_states[pin].pull_mode == TASK_GPIO_PULL_DOWN) {
+            hdr.pulldown_mask |= GPIO_PIN_BIT(pin);
+        }
+
+        // Label table entry: pin, length, text without terminator
+        size_t label_len = strnlen(gpio_states[pin].label, GPIO_LABEL_MAX_LEN);
+        if (label_len > 0) {
+            buf[len++] = pin;
+            buf[len++] = (uint8_t)label_len;
+            memcpy(&buf[len], gpio_states[pin].label, label_len);
+            len += label_len;
+            hdr.label_count++;
+        }
+    }
+
+    memcpy(buf, &hdr, sizeof(hdr));
+    return len;
+}
+
+/**
+ * @brief Unpack a blob into gpio_states[]
+ * @return ESP_OK on success, ESP_ERR_INVALID_VERSION or ESP_ERR_INVALID_SIZE if malformed
+ */
+static esp_err_t gpio_unpack_blob(const uint8_t *buf, size_t len)
+{
+    gpio_blob_header_t hdr;
+
+    if (len < sizeof(hdr)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (hdr.version != GPIO_BLOB_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    // Validate the label table before touching any state
+    size_t pos = sizeof(hdr);
+    for (unsigned i = 0; i < hdr.label_count; i++) {
+        if (pos + 2 > len || buf[pos] > GPIO_MAX_PIN || buf[pos + 1] > GPIO_LABEL_MAX_LEN ||
+            pos + 2 + buf[pos + 1] > len) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        pos += 2 + buf[pos + 1];
+    }
+
+    gpio_saved_mask = hdr.saved_mask & GPIO_VALID_MASK;
+    for (uint8_t pin = GPIO_MIN_PIN; pin <= GPIO_MAX_PIN; pin++) {
+        if (!(gpio_saved_mask & GPIO_PIN_BIT(pin))) {
+            continue;
+        }
+        // The blob may come from another board or an older firmware: never configure a pin it names blindly
+        bool output = hdr.output_mask & GPIO_PIN_BIT(pin);
+        if (!GPIO_IS_VALID_GPIO(pin) || !task_gpio_is_valid_pin(pin) ||
+            (output && !GPIO_IS_VALID_OUTPUT_GPIO(pin))) {
+            ESP_LOGW(TAG, "Ignoring saved config for invalid GPIO %d", pin);
+            gpio_saved_mask &= ~GPIO_PIN_BIT(pin);
+            continue;
+        }
+        gpio_states[pin].direction = (hdr.output_mask & GPIO_PIN_BIT(pin)) ? TASK_GPIO_DIR_OUTPUT : TASK_GPIO_DIR_INPUT;
+        gpio_states[pin].pull_mode = (hdr.pullup_mask & GPIO_PIN_BIT(pin)) ? TASK_GPIO_PULL_UP :
+                                     (hdr.pulldown_mask & GPIO_PIN_BIT(pin)) ? TASK_GPIO_PULL_DOWN : TASK_GPIO_PULL_NONE;
+    }
+
+    pos = sizeof(hdr);
+    for (unsigned i = 0; i < hdr.label_count; i++) {
+        uint8_t pin = buf[pos];
+        uint8_t label_len = buf[pos + 1];
+        if (gpio_saved_mask & GPIO_PIN_BIT(pin)) {
+            memcpy(gpio_states[pin].label, &buf[pos + 2], label_len);
+            gpio_states[pin].label[label_len] = '\0';
+        }
+        pos += 2 + label_len;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Write the whole GPIO table to NVS as one blob
+ */
+static esp_err_t gpio_save_all_configs(void)
+{
+    uint8_t buf[GPIO_BLOB_MAX_SIZE];
+    size_t len = gpio_pack_blob(buf);
     nvs_handle_t nvs_handle;
-    esp_err_t err;
-    
-    // Open NVS in config partition
-    err = nvs_open_from_partition("config", GPIO_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+
+    esp_err_t err = nvs_open_from_partition("config", GPIO_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (err != ESP_OK) {
         ESP_LOGW(TAG, "Failed to open NVS for GPIO config: %s", esp_err_to_name(err));
         return err;
     }
-    
-    // Create key names for this pin
-    char dir_key[16], pull_key[16], label_key[16];
-    snprintf(dir_key, sizeof(dir_key), "dir_%d", pin);
-    snprintf(pull_key, sizeof(pull_key), "pull_%d", pin);
-    snprintf(label_key, sizeof(label_key), "label_%d", pin);
-    
-    // Save direction
-    nvs_set_u8(nvs_handle, dir_key, (uint8_t)gpio_states[pin].direction);
-    
-    // Save pull mode
-    nvs_set_u8(nvs_handle, pull_key, (uint8_t)gpio_states[pin].pull_mode);
-    
-    // Save label if not empty
-    if (gpio_states[pin].label[0] != '\0') {
-        nvs_set_str(nvs_handle, label_key, gpio_states[pin].label);
+
+    err = nvs_set_blob(nvs_handle, GPIO_NVS_BLOB_KEY, buf, len);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
     }
-    
-    // Commit changes
-    err = nvs_commit(nvs_handle);
     nvs_close(nvs_handle);
-    
-    if (err == ESP_OK) {
-        ESP_LOGI(TAG, "GPIO %d config saved to NVS", pin);
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save GPIO config: %s", esp_err_to_name(err));
     }
-    
     return err;
 }
 
 /**
- * @brief Load GPIO configuration for a specific pin from NVS
+ * @brief Save GPIO configuration for a specific pin to NVS
+ * The pin is marked as configured and the whole table is written in one blob.
  */
-static esp_err_t gpio_load_pin_config(uint8_t pin)
+static esp_err_t gpio_save_pin_config(uint8_t pin)
 {
     if (!task_gpio_is_valid_pin(pin)) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    nvs_handle_t nvs_handle;
-    esp_err_t err;
-    
-    // Open NVS in config partition
-    err = nvs_open_from_partition("config", GPIO_NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (err != ESP_OK) {
-        // No saved config, not an error
-        return ESP_OK;
+
+    gpio_saved_mask |= GPIO_PIN_BIT(pin);
+
+    esp_err_t err = gpio_save_all_configs();
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "GPIO %d config saved to NVS", pin);
     }
-    
-    // Create key names for this pin
-    char dir_key[16], pull_key[16], label_key[16];
-    snprintf(dir_key, sizeof(dir_key), "dir_%d", pin);
-    snprintf(pull_key, sizeof(pull_key), "pull_%d", pin);
-    snprintf(label_key, sizeof(label_key), "label_%d", pin);
-    
-    // Load direction
-    uint8_t direction;
-    if (nvs_get_u8(nvs_handle, dir_key, &direction) == ESP_OK) {
+    return err;
+}
+
+/**
+ * @brief Import the per-pin keys written by older firmware (dir_N, pull_N, label_N)
+ * @param nvs_handle Open read/write handle on the GPIO namespace
+ * @return true if any legacy key was found
+ */
+static bool gpio_migrate_legacy_configs(nvs_handle_t nvs_handle)
+{
+    bool found = false;
+
+    for (uint8_t pin = GPIO_MIN_PIN; pin <= GPIO_MAX_PIN; pin++) {
+        if (!task_gpio_is_valid_pin(pin)) {
+            continue;
+        }
+
+        char dir_key[16], pull_key[16], label_key[16];
+        snprintf(dir_key, sizeof(dir_key), "dir_%d", pin);
+        snprintf(pull_key, sizeof(pull_key), "pull_%d", pin);
+        snprintf(label_key, sizeof(label_key), "label_%d", pin);
+
+        uint8_t direction;
+        if (nvs_get_u8(nvs_handle, dir_key, &direction) != ESP_OK) {
+            continue;  // Direction and pull were always saved together
+        }
         gpio_states[pin].direction = (task_gpio_direction_t)direction;
-        
-        // Apply the direction to hardware
-        gpio_mode_t mode = (direction == TASK_GPIO_DIR_OUTPUT) ? GPIO_MODE_OUTPUT : GPIO_MODE_INPUT;
-        gpio_set_direction(pin, mode);
-    }
-    
-    // Load pull mode
-    uint8_t pull_mode;
-    if (nvs_get_u8(nvs_handle, pull_key, &pull_mode) == ESP_OK) {
-        gpio_states[pin].pull_mode = (task_gpio_pull_mode_t)pull_mode;
-        
-        // Apply pull mode to hardware if it's input
-        if (gpio_states[pin].direction == TASK_GPIO_DIR_INPUT && gpio_supports_pull(pin)) {
-            switch (pull_mode) {
-                case TASK_GPIO_PULL_UP:
-                    gpio_set_pull_mode(pin, GPIO_PULLUP_ONLY);
-                    break;
-                case TASK_GPIO_PULL_DOWN:
-                    gpio_set_pull_mode(pin, GPIO_PULLDOWN_ONLY);
-                    break;
-                case TASK_GPIO_PULL_NONE:
-                    gpio_set_pull_mode(pin, GPIO_FLOATING);
-                    break;
-            }
+
+        uint8_t pull_mode;
+        if (nvs_get_u8(nvs_handle, pull_key, &pull_mode) == ESP_OK) {
+            gpio_states[pin].pull_mode = (task_gpio_pull_mode_t)pull_mode;
+        }
+
+        size_t label_len = GPIO_LABEL_MAX_LEN + 1;
+        char temp_label[GPIO_LABEL_MAX_LEN + 1];
+        if (nvs_get_str(nvs_handle, label_key, temp_label, &label_len) == ESP_OK) {
+            strncpy(gpio_states[pin].label, temp_label, GPIO_LABEL_MAX_LEN);
+            gpio_states[pin].label[GPIO_LABEL_MAX_LEN] = '\0';
         }
+
+        gpio_saved_mask |= GPIO_PIN_BIT(pin);
+        found = true;
     }
-    
-    // Load label
-    size_t label_len = GPIO_LABEL_MAX_LEN + 1;
-    char temp_label[GPIO_LABEL_MAX_LEN + 1];
-    if (nvs_get_str(nvs_handle, label_key, temp_label, &label_len) == ESP_OK) {
-        strncpy(gpio_states[pin].label, temp_label, GPIO_LABEL_MAX_LEN);
-        gpio_states[pin].label[GPIO_LABEL_MAX_LEN] = '\0';
+
+    if (!found) {
+        return false;
     }
-    
-    nvs_close(nvs_handle);
-    return ESP_OK;
+
+    // Replace the per-pin keys with the blob in one commit
+    uint8_t buf[GPIO_BLOB_MAX_SIZE];
+    size_t len = gpio_pack_blob(buf);
+    esp_err_t err = nvs_erase_all(nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs_handle, GPIO_NVS_BLOB_KEY, buf, len);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Migrated legacy GPIO configuration to blob format");
+    } else {
+        ESP_LOGW(TAG, "Failed to rewrite migrated GPIO config: %s", esp_err_to_name(err));
+    }
+
+    return true;
 }
 
 /**
  * @brief Load all GPIO configurations from NVS
+ * One handle open and one blob read; falls back to migrating the old per-pin keys.
  */
 static void gpio_load_all_configs(void)
 {
     ESP_LOGI(TAG, "Loading GPIO configurations from NVS...");
-    
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open_from_partition("config", GPIO_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        // No saved config, not an error
+        return;
+    }
+
+    uint8_t buf[GPIO_BLOB_MAX_SIZE];
+    size_t len = sizeof(buf);
+    err = nvs_get_blob(nvs_handle, GPIO_NVS_BLOB_KEY, buf, &len);
+    if (err == ESP_OK) {
+        err = gpio_unpack_blob(buf, len);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Ignoring saved GPIO config: %s", esp_err_to_name(err));
+            gpio_saved_mask = 0;
+        }
+    } else if (err == ESP_ERR_NVS_NOT_FOUND) {
+        gpio_migrate_legacy_configs(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
     int loaded_count = 0;
     for (uint8_t pin = GPIO_MIN_PIN; pin <= GPIO_MAX_PIN; pin++) {
-        if (task_gpio_is_valid_pin(pin)) {
-            if (gpio_load_pin_config(pin) == ESP_OK) {
-                // Check if this pin has custom config (non-default label or direction)
-                if (gpio_states[pin].label[0] != '\0' || 
-                    gpio_states[pin].direction != TASK_GPIO_DIR_INPUT) {
-                    loaded_count++;
-                }
-            }
+        if (gpio_saved_mask & GPIO_PIN_BIT(pin)) {
+            gpio_apply_pin_config(pin);
+            loaded_count++;
         }
     }
-    
+
     if (loaded_count > 0) {
         ESP_LOGI(TAG, "Loaded %d GPIO configurations from NVS", loaded_count);
     }
@@ -286,6 +464,13 @@ esp_err_t task_gpio_set_direction(uint8_t pin, task_gpio_direction_t direction)
     
     if (err == ESP_OK) {
         gpio_states[pin].direction = direction;
+        if (direction == TASK_GPIO_DIR_OUTPUT) {
+            gpio_output_mask |= GPIO_PIN_BIT(pin);
+            // Edge monitoring only applies to inputs
+            gpio_monitor_unwatch(pin);
+        } else {
+            gpio_output_mask &= ~GPIO_PIN_BIT(pin);
+        }
         ESP_LOGI(TAG, "GPIO %d set to %s", pin, 
                  direction == TASK_GPIO_DIR_OUTPUT ? "OUTPUT" : "INPUT");
     }
@@ -363,6 +548,59 @@ esp_err_t task_gpio_set_output_level(uint8_t pin, int level)
     return err;
 }
 
+/**
+ * @brief Apply set/clear masks to one 32-pin output register
+ * Only the W1TS/W1TC registers are written. They touch just the given bits,
+ * so gpio_set_level() from another task or an ISR can not be undone, which a
+ * read-modify-write of the output register would allow. Set and clear land
+ * on back-to-back register writes.
+ */
+static inline void gpio_bank_apply_word(uint32_t w1ts_reg, uint32_t w1tc_reg,
+                                        uint32_t set_bits, uint32_t clear_bits)
+{
+    if (set_bits) {
+        REG_WRITE(w1ts_reg, set_bits);
+    }
+    if (clear_bits) {
+        REG_WRITE(w1tc_reg, clear_bits);
+    }
+}
+
+/**
+ * @brief Drive several output pins at once
+ */
+esp_err_t task_gpio_bank_write(uint64_t set_mask, uint64_t clear_mask)
+{
+    if ((set_mask & clear_mask) || ((set_mask | clear_mask) & ~GPIO_VALID_MASK)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if ((set_mask | clear_mask) & ~gpio_output_mask) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&gpio_bank_lock);
+    gpio_bank_apply_word(GPIO_OUT_W1TS_REG, GPIO_OUT_W1TC_REG, (uint32_t)set_mask, (uint32_t)clear_mask);
+    gpio_bank_apply_word(GPIO_OUT1_W1TS_REG, GPIO_OUT1_W1TC_REG,
+                         (uint32_t)(set_mask >> 32), (uint32_t)(clear_mask >> 32));
+    portEXIT_CRITICAL(&gpio_bank_lock);
+
+    for (uint64_t m = set_mask | clear_mask; m; m &= m - 1) {
+        int pin = __builtin_ctzll(m);
+        gpio_states[pin].level = (set_mask & GPIO_PIN_BIT(pin)) ? 1 : 0;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Get the mask of pins currently configured as output
+ */
+uint64_t task_gpio_get_output_mask(void)
+{
+    return gpio_output_mask;
+}
+
 /**
  * @brief Get GPIO input level
  */
@@ -483,6 +721,129 @@ void task_gpio_display_status(void)
     printf("\n");
 }
 
+// Per-call timing of one toggle path, in CPU cycles
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    double sum;
+    double sum_sq;
+} gpio_bench_stats_t;
+
+typedef enum {
+    GPIO_BENCH_PATH_API,        // task_gpio_set_output_level()
+    GPIO_BENCH_PATH_DRIVER,     // gpio_set_level()
+    GPIO_BENCH_PATH_BANK,       // task_gpio_bank_write()
+    GPIO_BENCH_PATH_COUNT
+} gpio_bench_path_t;
+
+static const char *gpio_bench_path_names[GPIO_BENCH_PATH_COUNT] = {
+    "task_gpio_set_output_level",
+    "gpio_set_level",
+    "task_gpio_bank_write",
+};
+
+/**
+ * @brief Toggle a pin through one API path and time every call
+ */
+static void gpio_bench_run(gpio_bench_path_t path, uint8_t pin, int iterations, gpio_bench_stats_t *stats)
+{
+    uint64_t bit = GPIO_PIN_BIT(pin);
+
+    stats->min = UINT32_MAX;
+    stats->max = 0;
+    stats->sum = 0;
+    stats->sum_sq = 0;
+
+    for (int i = 0; i < iterations; i++) {
+        int level = i & 1;
+        uint32_t start = esp_cpu_get_cycle_count();
+
+        switch (path) {
+            case GPIO_BENCH_PATH_API:
+                task_gpio_set_output_level(pin, level);
+                break;
+            case GPIO_BENCH_PATH_DRIVER:
+                gpio_set_level(pin, level);
+                break;
+            default:
+                task_gpio_bank_write(level ? bit : 0, level ? 0 : bit);
+                break;
+        }
+
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        if (cycles < stats->min) {
+            stats->min = cycles;
+        }
+        if (cycles > stats->max) {
+            stats->max = cycles;
+        }
+        stats->sum += cycles;
+        stats->sum_sq += (double)cycles * cycles;
+    }
+}
+
+/**
+ * @brief Benchmark toggle rate and jitter of each output path
+ * With json set, prints one JSON line for the benchmark suite instead of the table.
+ */
+static int gpio_bench(uint8_t pin, int iterations, bool json)
+{
+    if (!(gpio_output_mask & GPIO_PIN_BIT(pin))) {
+        printf(COLOR_RED "Error: GPIO %d must be configured as output ('gpio set %d output')\n" COLOR_RESET, pin, pin);
+        return 1;
+    }
+
+    double cycles_per_ns = esp_clk_cpu_freq() / 1e9;
+    int saved_level = gpio_states[pin].level;
+
+    // The API path logs every call at INFO, keep that out of the measurement
+    esp_log_level_t saved_log_level = esp_log_level_get(TAG);
+    esp_log_level_set(TAG, ESP_LOG_WARN);
+
+    if (json) {
+        printf("{\"bench\":\"gpio\",\"pin\":%d,\"iterations\":%d,\"paths\":{", pin, iterations);
+    } else {
+        printf(COLOR_CYAN "GPIO %d toggle benchmark, %d iterations per path\n" COLOR_RESET, pin, iterations);
+        printf("%-28s %10s %9s %9s %9s %9s\n", "Path", "Rate(k/s)", "Min(ns)", "Avg(ns)", "Max(ns)", "Jitter");
+        printf("---------------------------- ---------- --------- --------- --------- ---------\n");
+    }
+
+    for (int p = 0; p < GPIO_BENCH_PATH_COUNT; p++) {
+        gpio_bench_stats_t stats;
+        gpio_bench_run((gpio_bench_path_t)p, pin, iterations, &stats);
+
+        double avg = stats.sum / iterations;
+        double var = stats.sum_sq / iterations - avg * avg;
+        double stddev_ns = (var > 0 ? sqrt(var) : 0) / cycles_per_ns;
+
+        if (json) {
+            printf("%s\"%s\":{\"rate_kps\":%.1f,\"min_ns\":%.0f,\"avg_ns\":%.0f,\"max_ns\":%.0f,\"jitter_ns\":%.0f}",
+                   p ? "," : "", gpio_bench_path_names[p],
+                   1e6 / (avg / cycles_per_ns),
+                   stats.min / cycles_per_ns, avg / cycles_per_ns, stats.max / cycles_per_ns,
+                   stddev_ns);
+        } else {
+            printf("%-28s %10.1f %9.0f %9.0f %9.0f %9.0f\n",
+                   gpio_bench_path_names[p],
+                   1e6 / (avg / cycles_per_ns),
+                   stats.min / cycles_per_ns, avg / cycles_per_ns, stats.max / cycles_per_ns,
+                   stddev_ns);
+        }
+
+        // Let the idle task run between paths
+        vTaskDelay(1);
+    }
+    if (json) {
+        printf("}}\n");
+    } else {
+        printf("Jitter is the standard deviation of the per-call time.\n");
+    }
+
+    esp_log_level_set(TAG, saved_log_level);
+    task_gpio_set_output_level(pin, saved_level);
+    return 0;
+}
+
 // Console command implementations
 
 static int gpio_cmd(int argc, char **argv)
@@ -493,12 +854,26 @@ static int gpio_cmd(int argc, char **argv)
         printf("  gpio set <pin> <input|output> - Set GPIO direction\n");
         printf("  gpio config <pin> <label>     - Set GPIO label (max 16 chars)\n");
         printf("  gpio <pin> <high|low>         - Set output high/low or pullup/pulldown\n");
+        printf("  gpio bank <set_mask> [clear_mask] - Drive several outputs at once (hex masks)\n");
+        printf("  gpio bench <pin> [iterations] [--json] - Toggle rate/jitter per output path\n");
+        printf("  gpio watch <pin> [rising|falling|both] [debounce_ms] - Monitor input edges\n");
+        printf("  gpio unwatch <pin>            - Stop monitoring a pin\n");
+        printf("  gpio events [reset]           - Show (or reset) edge counts and frequency\n");
+#ifndef HALOW_DISABLED
+        printf("  gpio mirror [add <pin> <mac|bcast> <remote_pin>|del <pin>|accept|deny <pin>|reset] - Mirror inputs to peer outputs over HaLow\n");
+#endif
         printf("\nExamples:\n");
         printf("  gpio status\n");
         printf("  gpio set 2 output\n");
         printf("  gpio config 5 led\n");
         printf("  gpio 2 high              (output: set HIGH, input: set PULLUP)\n");
         printf("  gpio 2 low               (output: set LOW, input: set PULLDOWN)\n");
+        printf("  gpio bank 0x24 0x10      (set GPIO 2 and 5, clear GPIO 4)\n");
+        printf("  gpio bench 2 10000\n");
+        printf("  gpio watch 4 falling 50\n");
+#ifndef HALOW_DISABLED
+        printf("  gpio mirror add 4 bcast 2 (drive GPIO 2 on every node that accepts it)\n");
+#endif
         return 1;
     }
     
@@ -508,6 +883,130 @@ static int gpio_cmd(int argc, char **argv)
         return 0;
     }
     
+    // Handle "gpio bank <set_mask> [clear_mask]"
+    if (strcmp(argv[1], "bank") == 0) {
+        if (argc < 3) {
+            printf(COLOR_RED "Error: Usage: gpio bank <set_mask> [clear_mask]\n" COLOR_RESET);
+            return 1;
+        }
+
+        uint64_t set_mask = strtoull(argv[2], NULL, 0);
+        uint64_t clear_mask = (argc >= 4) ? strtoull(argv[3], NULL, 0) : 0;
+
+        esp_err_t err = task_gpio_bank_write(set_mask, clear_mask);
+        if (err == ESP_ERR_INVALID_STATE) {
+            printf(COLOR_RED "Error: Masks include pins not configured as output (outputs: 0x%010llx)\n" COLOR_RESET,
+                   (unsigned long long)gpio_output_mask);
+            return 1;
+        } else if (err != ESP_OK) {
+            printf(COLOR_RED "Error: Invalid masks (overlapping or pins above %d)\n" COLOR_RESET, GPIO_MAX_PIN);
+            return 1;
+        }
+
+        printf(COLOR_GREEN "GPIO bank: set 0x%010llx, cleared 0x%010llx\n" COLOR_RESET,
+               (unsigned long long)set_mask, (unsigned long long)clear_mask);
+        return 0;
+    }
+
+    // Handle "gpio bench <pin> [iterations]"
+    if (strcmp(argv[1], "bench") == 0) {
+        if (argc < 3) {
+            printf(COLOR_RED "Error: Usage: gpio bench <pin> [iterations] [--json]\n" COLOR_RESET);
+            return 1;
+        }
+
+        int pin = atoi(argv[2]);
+        if (!task_gpio_is_valid_pin(pin)) {
+            printf(COLOR_RED "Error: GPIO %d is not available\n" COLOR_RESET, pin);
+            return 1;
+        }
+
+        bool json = strcmp(argv[argc - 1], "--json") == 0;
+        if (json) {
+            argc--;
+        }
+        int iterations = (argc >= 4) ? atoi(argv[3]) : GPIO_BENCH_DEFAULT_ITERATIONS;
+        if (iterations < 2 || iterations > GPIO_BENCH_MAX_ITERATIONS) {
+            printf(COLOR_RED "Error: Iterations must be 2-%d\n" COLOR_RESET, GPIO_BENCH_MAX_ITERATIONS);
+            return 1;
+        }
+
+        return gpio_bench(pin, iterations, json);
+    }
+
+    // Handle "gpio watch <pin> [rising|falling|both] [debounce_ms]"
+    if (strcmp(argv[1], "watch") == 0) {
+        if (argc < 3) {
+            printf(COLOR_RED "Error: Usage: gpio watch <pin> [rising|falling|both] [debounce_ms]\n" COLOR_RESET);
+            return 1;
+        }
+
+        int pin = atoi(argv[2]);
+        gpio_monitor_edge_t edge = GPIO_MONITOR_EDGE_BOTH;
+        if (argc >= 4) {
+            if (strcmp(argv[3], "rising") == 0) {
+                edge = GPIO_MONITOR_EDGE_RISING;
+            } else if (strcmp(argv[3], "falling") == 0) {
+                edge = GPIO_MONITOR_EDGE_FALLING;
+            } else if (strcmp(argv[3], "both") != 0) {
+                printf(COLOR_RED "Error: Edge must be 'rising', 'falling' or 'both'\n" COLOR_RESET);
+                return 1;
+            }
+        }
+        int debounce_ms = (argc >= 5) ? atoi(argv[4]) : GPIO_MONITOR_DEBOUNCE_DEFAULT_MS;
+        if (debounce_ms < 0 || debounce_ms > GPIO_MONITOR_DEBOUNCE_MAX_MS) {
+            printf(COLOR_RED "Error: Debounce must be 0-%d ms\n" COLOR_RESET, GPIO_MONITOR_DEBOUNCE_MAX_MS);
+            return 1;
+        }
+
+        esp_err_t err = gpio_monitor_watch(pin, edge, debounce_ms);
+        if (err == ESP_ERR_INVALID_STATE) {
+            printf(COLOR_RED "Error: GPIO %d must be configured as input\n" COLOR_RESET, pin);
+            return 1;
+        } else if (err != ESP_OK) {
+            printf(COLOR_RED "Error: Failed to monitor GPIO %d: %s\n" COLOR_RESET, pin, esp_err_to_name(err));
+            return 1;
+        }
+
+        printf(COLOR_GREEN "Monitoring GPIO %d edges (debounce %d ms)\n" COLOR_RESET, pin, debounce_ms);
+        return 0;
+    }
+
+    // Handle "gpio unwatch <pin>"
+    if (strcmp(argv[1], "unwatch") == 0) {
+        if (argc < 3) {
+            printf(COLOR_RED "Error: Usage: gpio unwatch <pin>\n" COLOR_RESET);
+            return 1;
+        }
+
+        int pin = atoi(argv[2]);
+        if (gpio_monitor_unwatch(pin) != ESP_OK) {
+            printf(COLOR_YELLOW "GPIO %d is not monitored\n" COLOR_RESET, pin);
+            return 1;
+        }
+
+        printf(COLOR_GREEN "Stopped monitoring GPIO %d\n" COLOR_RESET, pin);
+        return 0;
+    }
+
+    // Handle "gpio events [reset]"
+    if (strcmp(argv[1], "events") == 0) {
+        if (argc >= 3 && strcmp(argv[2], "reset") == 0) {
+            gpio_monitor_reset_stats();
+            printf(COLOR_GREEN "GPIO edge counters reset\n" COLOR_RESET);
+            return 0;
+        }
+        gpio_monitor_print();
+        return 0;
+    }
+
+#ifndef HALOW_DISABLED
+    // Handle "gpio mirror ..."
+    if (strcmp(argv[1], "mirror") == 0) {
+        return gpio_mirror_cmd(argc - 1, argv + 1);
+    }
+#endif
+
     // Handle "gpio config <pin> <label>"
     if (strcmp(argv[1], "config") == 0) {
         if (argc < 4) {
@@ -642,7 +1141,7 @@ void register_gpio_commands(void)
 {
     const esp_console_cmd_t gpio_cmd_def = {
         .command = "gpio",
-        .help = "GPIO control: 'gpio status' | 'gpio set <pin> <input|output>' | 'gpio config <pin> <label>' | 'gpio <pin> <high|low>'",
+        .help = "GPIO control: 'gpio status' | 'gpio set <pin> <input|output>' | 'gpio config <pin> <label>' | 'gpio <pin> <high|low>' | 'gpio bank <set> [clear]' | 'gpio bench <pin> [n]' | 'gpio watch|unwatch <pin>' | 'gpio events' | 'gpio mirror'",
         .hint = NULL,
         .func = &gpio_cmd,
     };
@@ -7,6 +7,7 @@
  * - Set GPIO direction (input/output)
  * - Configure GPIO pull mode (pullup/pulldown)
  * - Display status of all GPIOs
+ * - Atomic multi-pin output writes (bank API)
  */
 
 #ifndef TASK_GPIO_H
@@ -76,6 +77,25 @@ esp_err_t task_gpio_set_pull(uint8_t pin, task_gpio_pull_mode_t pull_mode);
  */
 esp_err_t task_gpio_set_output_level(uint8_t pin, int level);
 
+/**
+ * @brief Drive several output pins at once
+ * Pins driven high within the same 32-pin register (GPIO 0-31, GPIO 32-39)
+ * change on the same cycle, and so do pins driven low; the low write follows
+ * the high write directly. Other pins are never touched, so concurrent
+ * writers (tasks, ISRs) are safe. All pins in both masks must be outputs.
+ * @param set_mask Bit N set drives GPIO N high
+ * @param clear_mask Bit N set drives GPIO N low
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the masks overlap or name
+ *         invalid pins, ESP_ERR_INVALID_STATE if a pin is not an output
+ */
+esp_err_t task_gpio_bank_write(uint64_t set_mask, uint64_t clear_mask);
+
+/**
+ * @brief Get the mask of pins currently configured as output
+ * @return Bit N set if GPIO N is an output
+ */
+uint64_t task_gpio_get_output_mask(void);
+
 /**
  * @brief Get GPIO input level
  * @param pin GPIO pin number
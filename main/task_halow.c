@@ -1,17 +1,50 @@
 /**
  * @file task_halow.c
  * @brief HaLow WiFi control system implementation for Halow RTOS
+ *
+ * Connection handling is a state machine on its own task (halow_conn),
+ * fed by one queue. Console commands, auto-connect and roaming post
+ * requests to it; the mmwlan STA status callback only posts the new STA
+ * state. The task owns every STA enable/disable and channel list change
+ * after boot, so requests cannot interleave, and the config save after a
+ * successful connect runs there instead of in the WLAN callback.
+ *
+ *   IDLE --request--> CONNECTING --STA connected--> CONNECTED
+ *                       |   ^                          |
+ *               timeout |   | backoff expired          | link lost
+ *                       v   |                          v
+ *                      BACKOFF <----timeout------ CONNECTING
+ *
+ * A request first tries its targeted hints (remembered BSS, roam target,
+ * previous BSS) with the short fast-reconnect timeout, then full searches
+ * with exponential backoff and jitter between them.
  */
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include "task_halow.h"
+#include "halow_rx.h"
+#include "halow_raw.h"
+#include "halow_scan_cache.h"
+#include "halow_stats.h"
+#include "halow_power.h"
+#include "halow_spibench.h"
+#include "halow_roam.h"
+#include "trace_buffer.h"
+#include "async_log.h"
+#include "config_manager.h"
+#include "task_mqtt.h"
 #include "esp_log.h"
 #include "esp_console.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_random.h"
 #include "nvs_flash.h"
+#include "lwip/netif.h"
 
 // Morse Micro SDK includes
 #include "mmhal.h"
@@ -19,6 +52,7 @@
 #include "mmwlan.h"
 #include "mmipal.h"
 #include "mm_app_regdb.h"
+#include "halow_regdb.h"
 
 static const char *TAG = "task_halow";
 
@@ -42,17 +76,13 @@ static const char *TAG = "task_halow";
 #define HALOW_RESET_PIN     CONFIG_MM_RESET_N
 #define HALOW_WAKE_PIN      CONFIG_MM_WAKE
 
-// Default country code - you may need to change this
+// Country code, set from CONFIG_HALOW_COUNTRY_CODE by main/CMakeLists.txt
 #ifndef HALOW_COUNTRY_CODE
 #define HALOW_COUNTRY_CODE "US"
 #endif
 
-#define HALOW_CONNECTED_BIT BIT0
-#define HALOW_FAIL_BIT      BIT1
-#define HALOW_SCAN_DONE_BIT BIT2
 #define MAX_SSID_LEN        32
 #define MAX_PASSWORD_LEN    64
-#define MAX_SCAN_RESULTS    20
 
 // Network configuration for auto-connect
 typedef struct {
@@ -61,64 +91,185 @@ typedef struct {
     bool valid;  // Flag indicating if config is valid
 } network_config_t;
 
-#define AUTO_CONNECT_MAX_ATTEMPTS 3
-#define AUTO_CONNECT_RETRY_DELAY_MS 2000
+#define FAST_RECONNECT_TIMEOUT_MS   3000
+#define FAST_RECONNECT_MAX_CHANNELS 16
 
-static char halow_last_password[MAX_PASSWORD_LEN];
+#define HALOW_CONN_TASK_STACK       4096
+#define HALOW_CONN_TASK_PRIORITY    4
+#define HALOW_CONN_QUEUE_LEN        12
+#define HALOW_CONN_POST_TIMEOUT_MS  100
+#define HALOW_CONN_JITTER_PCT       25
+
+// Last good link, saved next to the credentials for fast reconnect
+typedef struct {
+    uint8_t bssid[MMWLAN_MAC_ADDR_LEN];
+    uint32_t channel_freq_hz;   // 0 if the channel is unknown
+    uint8_t bw_mhz;
+    bool valid;
+} halow_link_hint_t;
+
+// Association phase timestamps (esp_timer, 0 = not seen)
+typedef struct {
+    int64_t start_us;
+    int64_t scan_request_us;
+    int64_t scan_complete_us;
+    int64_t auth_request_us;
+    int64_t assoc_request_us;
+    int64_t ctrl_port_open_us;
+    int64_t connected_us;
+    bool fast;
+} halow_assoc_timing_t;
+
+// Requests and mmwlan reports for the connection state machine
+typedef enum {
+    HALOW_CONN_EV_CONNECT,      // halow_connect_async()
+    HALOW_CONN_EV_AUTO,         // Saved network, from halow_start() and halow_reassociate_async()
+    HALOW_CONN_EV_ROAM,         // halow_roam_to()
+    HALOW_CONN_EV_WIDEN,        // halow_widen_channel_list()
+    HALOW_CONN_EV_DISCONNECT,   // halow_disconnect_async(), halow_reassociate_async(), halow_stop()
+    HALOW_CONN_EV_STA_STATE,    // mmwlan STA status callback
+} halow_conn_ev_type_t;
+
+typedef struct {
+    halow_conn_ev_type_t type;
+    enum mmwlan_sta_state sta_state;    // STA_STATE
+    char ssid[MMWLAN_SSID_MAXLEN + 1];  // CONNECT
+    char password[MAX_PASSWORD_LEN];    // CONNECT
+    halow_link_hint_t hint;             // ROAM target
+    uint32_t timeout_ms;                // ROAM, per targeted attempt
+    halow_conn_cb_t cb;
+    void *cb_arg;
+} halow_conn_event_t;
+
+// State machine context, written only by the state machine task
+typedef struct {
+    halow_conn_state_t state;           // Read by other tasks under halow_conn_lock
+    char ssid[MMWLAN_SSID_MAXLEN + 1];  // Network of the current request, written under halow_conn_lock
+    char password[MAX_PASSWORD_LEN];
+    halow_link_hint_t hints[2];         // Targeted attempts, tried in order before a full search
+    int num_hints;
+    int hint_index;                     // == num_hints: full search
+    uint32_t hint_timeout_ms;
+    bool roam;                          // Completion tells which hint associated
+    uint32_t attempt;                   // Full-search attempts of this request
+    int64_t deadline_us;                // Attempt timeout or end of backoff, 0 = none
+    uint32_t last_backoff_ms;
+    uint32_t connects;
+    uint32_t losses;
+    uint32_t total_attempts;
+    halow_conn_cb_t cb;                 // Completion of the current request
+    void *cb_arg;
+} halow_conn_ctx_t;
+
+static halow_conn_ctx_t halow_conn;
+static QueueHandle_t halow_conn_queue = NULL;
+static portMUX_TYPE halow_conn_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t halow_conn_dropped = 0;     // STA reports lost to a full queue
 
-static EventGroupHandle_t halow_event_group;
 static bool halow_initialized = false;
 static bool halow_started = false;
 static bool halow_booted = false;
 static struct mmosal_semb *halow_scan_semaphore = NULL;
 static struct mmosal_semb *halow_link_semaphore = NULL;
 static uint16_t scan_count = 0;
-static char halow_connected_ssid[MMWLAN_SSID_MAXLEN + 1] = "";
-static char halow_save_pending_ssid[MMWLAN_SSID_MAXLEN + 1] = "";      // SSID to save when connection succeeds
-static char halow_save_pending_password[MAX_PASSWORD_LEN] = "";         // Password to save when connection succeeds
+static uint8_t halow_pending_bssid[MMWLAN_MAC_ADDR_LEN];                 // Cached BSSID used for the current attempt
+static bool halow_pending_bssid_valid = false;
+static const struct mmwlan_s1g_channel_list *halow_channel_list = NULL;  // Full regulatory channel list
+static struct mmwlan_s1g_channel halow_fast_channels[FAST_RECONNECT_MAX_CHANNELS];
+static halow_scan_entry_t halow_fast_peers[MAX_SCAN_RESULTS];               // Scratch for the channel list
+static struct mmwlan_s1g_channel_list halow_fast_channel_list;
+static bool halow_fast_channels_active = false;
+static halow_assoc_timing_t halow_assoc_timing;
 
 // Function forward declarations
-static int halow_auto_connect(void);
+static void halow_auto_connect(void);
 static bool halow_should_save_network_config(const char* ssid, const char* password);
+static void halow_print_assoc_timing(void);
+static bool halow_load_link_hint(halow_link_hint_t *hint);
+static int halow_connect_internal(const char* ssid, const char* password, const halow_link_hint_t *hint);
+static void halow_restore_channel_list(void);
+static void halow_conn_task(void *arg);
+static esp_err_t halow_conn_request_sync(halow_conn_event_t *ev);
 
 /**
- * Link state callback for HaLow connection status
+ * IP link status callback for HaLow connection status
+ * mmwlan has one link state callback and mmipal owns it; mmipal reports the
+ * link up here only once an address is assigned.
  */
-static void halow_link_state_handler(enum mmwlan_link_state link_state, void *arg)
+static void halow_link_status_handler(const struct mmipal_link_status *link_status)
 {
-    printf("HaLow Link went %s\n> ", (link_state == MMWLAN_LINK_DOWN) ? "Down" : "Up");
-    fflush(stdout);
+    bool up = link_status->link_state == MMIPAL_LINK_UP;
 
-    if (link_state == MMWLAN_LINK_UP)
-    {
-        if (halow_event_group) {
-            xEventGroupSetBits(halow_event_group, HALOW_CONNECTED_BIT);
-        }
-        if (halow_link_semaphore) {
-            mmosal_semb_give(halow_link_semaphore);
-        }
+    TRACE_EVENT(TRACE_EV_HALOW_LINK, up);
+    if (up) {
+        async_log_printf("HaLow Link went Up (IP %s)\n> ", link_status->ip_addr);
+    } else {
+        async_log_printf("HaLow Link went Down\n> ");
     }
-    else
-    {
-        if (halow_event_group) {
-            xEventGroupClearBits(halow_event_group, HALOW_CONNECTED_BIT);
-        }
+
+    // MQTT queues while the link is down and drains on reconnect
+    task_mqtt_notify_link(up);
+
+    if (up && halow_link_semaphore) {
+        mmosal_semb_give(halow_link_semaphore);
     }
 }
 
 /**
  * Receive callback for HaLow packets
+ * Runs in WLAN stack context: only hands the packet reference to the RX pipeline
+ */
+static void halow_rx_handler(struct mmpkt *rxpkt, void *arg)
+{
+    TRACE_EVENT(TRACE_EV_HALOW_RX_CB, 0);
+    halow_rx_submit(rxpkt);
+}
+
+#if CONFIG_HALOW_TRACE_ENABLE
+/**
+ * TX flow control callback, only registered to trace TX pauses
+ */
+static void halow_tx_flow_handler(enum mmwlan_tx_flow_control_state state, void *arg)
+{
+    TRACE_EVENT(TRACE_EV_HALOW_TX_FLOW, state == MMWLAN_TX_PAUSED);
+}
+#endif
+
+/**
+ * STA event callback: timestamps the association phases
  */
-static void halow_rx_handler(uint8_t *header, unsigned header_len,
-                            uint8_t *payload, unsigned payload_len,
-                            void *arg)
+static void halow_sta_event_handler(const struct mmwlan_sta_event_cb_args *sta_event, void *arg)
 {
-    // Basic packet handling - just log for now
-    ESP_LOGI(TAG, "HaLow packet received: header_len=%u, payload_len=%u", header_len, payload_len);
+    int64_t now = esp_timer_get_time();
+
+    TRACE_EVENT(TRACE_EV_HALOW_STA_EVENT, sta_event->event);
+    switch (sta_event->event) {
+    case MMWLAN_STA_EVT_SCAN_REQUEST:
+        if (halow_assoc_timing.scan_request_us == 0) {
+            halow_assoc_timing.scan_request_us = now;
+        }
+        break;
+    case MMWLAN_STA_EVT_SCAN_COMPLETE:
+    case MMWLAN_STA_EVT_SCAN_ABORT:
+        halow_assoc_timing.scan_complete_us = now;
+        break;
+    case MMWLAN_STA_EVT_AUTH_REQUEST:
+        halow_assoc_timing.auth_request_us = now;  // Last attempt wins
+        break;
+    case MMWLAN_STA_EVT_ASSOC_REQUEST:
+        halow_assoc_timing.assoc_request_us = now;
+        break;
+    case MMWLAN_STA_EVT_CTRL_PORT_OPEN:
+        halow_assoc_timing.ctrl_port_open_us = now;
+        break;
+    default:
+        break;
+    }
 }
 
 /**
  * STA status callback for HaLow connection state
+ * Runs in WLAN stack context: only hands the new state to the state machine task
  */
 static void halow_sta_status_handler(enum mmwlan_sta_state sta_state)
 {
@@ -127,62 +278,13 @@ static void halow_sta_status_handler(enum mmwlan_sta_state sta_state)
         "CONNECTING",
         "CONNECTED",
     };
-    printf("HaLow STA state: %s (%u)\n> ", sta_state_desc[sta_state], sta_state);
-    fflush(stdout);
-
-    // Set connection status based on STA state
-    if (sta_state == MMWLAN_STA_CONNECTED) {
-        if (halow_event_group) {
-            xEventGroupSetBits(halow_event_group, HALOW_CONNECTED_BIT);
-        }
+    TRACE_EVENT(TRACE_EV_HALOW_STA_STATE, sta_state);
+    async_log_printf("HaLow STA state: %s (%u)\n> ", sta_state_desc[sta_state], sta_state);
 
-        // Save the network configuration when connection succeeds (use dedicated variables)
-        if (halow_save_pending_ssid[0] != '\0') {
-            ESP_LOGI(TAG, "=== HaLow Connection Success! ===");
-            ESP_LOGI(TAG, "Connected to network: '%s'", halow_save_pending_ssid);
-            ESP_LOGI(TAG, "Checking if config should be saved...");
-
-            // Check if we need to save (compare with existing config)
-            if (halow_should_save_network_config(halow_save_pending_ssid, halow_save_pending_password)) {
-                ESP_LOGI(TAG, "Network config needs to be saved (new/different config)");
-                esp_err_t save_err = halow_save_network_config(halow_save_pending_ssid, halow_save_pending_password);
-                if (save_err == ESP_OK) {
-                    ESP_LOGI(TAG, "Network config successfully saved: SSID='%s'", halow_save_pending_ssid);
-                    ESP_LOGI(TAG, "Credentials saved to flash (certs partition)");
-                    ESP_LOGI(TAG, "Auto-connect will be available on reboot");
-                } else {
-                    ESP_LOGE(TAG, "Failed to save network config: %s", esp_err_to_name(save_err));
-                }
-            } else {
-                ESP_LOGI(TAG, "Network config already exists, skipping flash write to preserve life");
-                ESP_LOGI(TAG, "Configuration is identical - no changes needed");
-            }
-
-            // Update connected SSID for status display after successful save
-            strncpy(halow_connected_ssid, halow_save_pending_ssid, sizeof(halow_connected_ssid) - 1);
-            halow_connected_ssid[sizeof(halow_connected_ssid) - 1] = '\0';
-
-            // Clear the pending save config after processing
-            halow_save_pending_ssid[0] = '\0';
-            halow_save_pending_password[0] = '\0';
-
-            ESP_LOGI(TAG, "=== HaLow Setup Complete! ===");
-        } else {
-            ESP_LOGI(TAG, "Connected but no pending config to save");
-            // Still update the connected SSID for status display
-            // This might happen with auto-connect
-            ESP_LOGI(TAG, "Checking if this was an auto-connect...");
-        }
-    } else if (sta_state == MMWLAN_STA_DISABLED || sta_state == MMWLAN_STA_CONNECTING) {
-        // Clear connection status for disconnected/connecting states
-        if (halow_event_group) {
-            xEventGroupClearBits(halow_event_group, HALOW_CONNECTED_BIT);
-        }
-        // Clear SSID if connection failed
-        halow_connected_ssid[0] = '\0';
-
-        // If connection failed, clear the saved password
-        halow_last_password[0] = '\0';
+    // Must not block here; a lost report is caught by the attempt deadline
+    halow_conn_event_t ev = { .type = HALOW_CONN_EV_STA_STATE, .sta_state = sta_state };
+    if (!halow_conn_queue || xQueueSend(halow_conn_queue, &ev, 0) != pdTRUE) {
+        __atomic_fetch_add(&halow_conn_dropped, 1, __ATOMIC_RELAXED);
     }
 }
 
@@ -195,6 +297,7 @@ static void halow_scan_rx_callback(const struct mmwlan_scan_result *result, void
     char ssid_str[MMWLAN_SSID_MAXLEN + 1];
 
     scan_count++;
+    halow_scan_cache_update(result);
     snprintf(bssid_str, sizeof(bssid_str), "%02x:%02x:%02x:%02x:%02x:%02x",
              result->bssid[0], result->bssid[1], result->bssid[2],
              result->bssid[3], result->bssid[4], result->bssid[5]);
@@ -203,8 +306,9 @@ static void halow_scan_rx_callback(const struct mmwlan_scan_result *result, void
     memcpy(ssid_str, result->ssid, result->ssid_len);
     ssid_str[result->ssid_len] = '\0';
 
-    printf("%2d. %-32s %s %4d %4d\n",
-           scan_count, ssid_str, bssid_str, result->rssi, result->op_bw_mhz);
+    async_log_printf("%2d. %-32s %s %4d %4d %9.3f\n",
+                     scan_count, ssid_str, bssid_str, result->rssi, result->op_bw_mhz,
+                     result->channel_freq_hz / 1e6);
 }
 
 /**
@@ -212,12 +316,26 @@ static void halow_scan_rx_callback(const struct mmwlan_scan_result *result, void
  */
 static void halow_scan_complete_callback(enum mmwlan_scan_state state, void *arg)
 {
-    printf("HaLow scan completed. Found %d networks.\n> ", scan_count);
-    fflush(stdout);
+    async_log_printf("HaLow scan completed. Found %d networks.\n> ", scan_count);
 
-    if (halow_event_group) {
-        xEventGroupSetBits(halow_event_group, HALOW_SCAN_DONE_BIT);
+    if (halow_scan_semaphore) {
+        mmosal_semb_give(halow_scan_semaphore);
     }
+}
+
+/**
+ * Background scan result callback, feeds the cache without printing
+ */
+static void halow_bgscan_rx_callback(const struct mmwlan_scan_result *result, void *arg)
+{
+    halow_scan_cache_update(result);
+}
+
+/**
+ * Background scan complete callback
+ */
+static void halow_bgscan_complete_callback(enum mmwlan_scan_state state, void *arg)
+{
     if (halow_scan_semaphore) {
         mmosal_semb_give(halow_scan_semaphore);
     }
@@ -315,11 +433,14 @@ esp_err_t task_halow_init(void)
         return ret;
     }
 
-    // Create event group and semaphores
-    halow_event_group = xEventGroupCreate();
-    if (!halow_event_group) {
-        ESP_LOGE(TAG, "Failed to create HaLow event group");
-        return ESP_FAIL;
+    // Connection state machine, idle until halow_start() queues the auto-connect
+    halow_conn_queue = xQueueCreate(HALOW_CONN_QUEUE_LEN, sizeof(halow_conn_event_t));
+    if (!halow_conn_queue ||
+        xTaskCreatePinnedToCore(halow_conn_task, "halow_conn", HALOW_CONN_TASK_STACK, NULL,
+                                HALOW_CONN_TASK_PRIORITY, NULL,
+                                CONFIG_HALOW_BOOT_TASK_CORE < 0 ? tskNO_AFFINITY : CONFIG_HALOW_BOOT_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create HaLow connection task");
+        return ESP_ERR_NO_MEM;
     }
 
     halow_scan_semaphore = mmosal_semb_create("halow_scan");
@@ -330,6 +451,37 @@ esp_err_t task_halow_init(void)
         return ESP_FAIL;
     }
 
+    // Start the RX dispatch pipeline before any RX callback can fire
+    ret = halow_rx_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start HaLow RX pipeline: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = halow_raw_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start raw peer messaging: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = halow_scan_cache_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize scan cache: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = halow_stats_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start link statistics sampler: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = halow_roam_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start roaming manager: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
     // Initialize Morse Micro HAL and WLAN subsystems
     // Make sure GPIO is not initialized by ESP-IDF driver before we init
     ESP_LOGI(TAG, "Calling mmhal_init()...");
@@ -373,8 +525,12 @@ int halow_start(void)
             enum mmwlan_status status;
             const struct mmwlan_s1g_channel_list* channel_list;
 
-            // Load regulatory domain
+            // Load regulatory domain, resolved at build time when the regdb is trimmed
+#if CONFIG_HALOW_REGDB_TRIM
+            channel_list = halow_regdb_channel_list();
+#else
             channel_list = mmwlan_lookup_regulatory_domain(get_regulatory_db(), HALOW_COUNTRY_CODE);
+#endif
             if (channel_list == NULL) {
                 ESP_LOGE(TAG, "Could not find regulatory domain for country code %s", HALOW_COUNTRY_CODE);
                 return -1;
@@ -385,19 +541,11 @@ int halow_start(void)
                 ESP_LOGE(TAG, "Failed to set country code %s", channel_list->country_code);
                 return -1;
             }
+            halow_channel_list = channel_list;
 
-            // Register callbacks
-            status = mmwlan_register_link_state_cb(halow_link_state_handler, halow_link_semaphore);
-            if (status != MMWLAN_SUCCESS) {
-                ESP_LOGE(TAG, "Failed to register link state callback");
-                return -1;
-            }
-
-            status = mmwlan_register_rx_cb(halow_rx_handler, NULL);
-            if (status != MMWLAN_SUCCESS) {
-                ESP_LOGE(TAG, "Failed to register RX callback");
-                return -1;
-            }
+#if CONFIG_HALOW_TRACE_ENABLE
+            mmwlan_register_tx_flow_control_cb(halow_tx_flow_handler, NULL);
+#endif
 
             struct mmwlan_boot_args boot_args = MMWLAN_BOOT_ARGS_INIT;
             status = mmwlan_boot(&boot_args);
@@ -416,35 +564,32 @@ int halow_start(void)
                 return -1;
             }
             ESP_LOGI(TAG, "Network stack (MMIPAL) initialized successfully");
+            mmipal_set_link_status_callback(halow_link_status_handler);
 
-            halow_booted = true;
-        } else {
-            // Interface already booted, just re-register callbacks
-            enum mmwlan_status status;
-            ESP_LOGI(TAG, "Re-registering HaLow callbacks for restarted interface");
-
-            // Re-register callbacks
-            status = mmwlan_register_link_state_cb(halow_link_state_handler, halow_link_semaphore);
+            // mmwlan has one RX callback and mmipal just took it; the pipeline takes it
+            // over once and passes every frame no consumer claims on to mmipal's netif
+            halow_rx_attach_netif(netif_default);
+            status = mmwlan_register_rx_pkt_cb(halow_rx_handler, NULL);
             if (status != MMWLAN_SUCCESS) {
-                ESP_LOGE(TAG, "Failed to register link state callback: %d", status);
-                // Continue anyway
+                ESP_LOGE(TAG, "Failed to register RX callback");
+                return -1;
             }
 
-            status = mmwlan_register_rx_cb(halow_rx_handler, NULL);
-            if (status != MMWLAN_SUCCESS) {
-                ESP_LOGE(TAG, "Failed to register RX callback: %d", status);
-                // Continue anyway
-            }
+            halow_booted = true;
         }
+        // A restarted interface keeps its callbacks: they belong to mmipal and the pipeline
     }
 
+    // Power save mode persists in mmwlan; listen interval and TWT follow at connect
+    halow_power_apply_start();
+
     halow_started = true;
     printf("HaLow started successfully\n> ");
     fflush(stdout);
 
     ESP_LOGI(TAG, "HaLow started successfully");
 
-    // Attempt auto-connect if we have saved network config
+    // Queue auto-connect if we have saved network config, the state machine runs it
     halow_auto_connect();
 
     return 0;
@@ -461,17 +606,9 @@ int halow_stop(void)
         return 0;
     }
 
-    // Disable STA mode if enabled
-    mmwlan_sta_disable();
-
-    // Unregister callbacks to clean up state
-    mmwlan_register_link_state_cb(NULL, NULL);
-    mmwlan_register_rx_cb(NULL, NULL);
-
-    // Clear connection status
-    if (halow_event_group) {
-        xEventGroupClearBits(halow_event_group, HALOW_CONNECTED_BIT);
-    }
+    // Leave the network through the state machine so it ends up idle
+    halow_conn_event_t ev = { .type = HALOW_CONN_EV_DISCONNECT };
+    halow_conn_request_sync(&ev);
 
     halow_started = false;
     printf("HaLow stopped\n> ");
@@ -482,69 +619,165 @@ int halow_stop(void)
 }
 
 /**
- * @brief Save network configuration to certs partition
- * @param ssid Network SSID
- * @param password Network password (can be NULL for open networks)
- * @return ESP_OK on success, error code otherwise
+ * @brief Capture the current BSS and channel for fast reconnect
+ * The channel comes from the scan cache; it stays 0 if the BSS was never scanned.
+ * @param hint Pointer to store the link hint
+ * @return true if connected to a known BSSID, false otherwise
  */
-esp_err_t halow_save_network_config(const char* ssid, const char* password)
+static bool halow_get_current_link_hint(halow_link_hint_t *hint)
 {
-    if (!ssid || strlen(ssid) == 0) {
-        ESP_LOGE(TAG, "Cannot save network config: invalid SSID");
-        return ESP_ERR_INVALID_ARG;
+    static const uint8_t zero_bssid[MMWLAN_MAC_ADDR_LEN] = {0};
+
+    memset(hint, 0, sizeof(*hint));
+    if (mmwlan_get_bssid(hint->bssid) != MMWLAN_SUCCESS ||
+        memcmp(hint->bssid, zero_bssid, sizeof(zero_bssid)) == 0) {
+        return false;
+    }
+
+    halow_scan_entry_t bss;
+    halow_link_hint_t saved;
+    if (halow_scan_cache_find_bssid(hint->bssid, &bss)) {
+        hint->channel_freq_hz = bss.channel_freq_hz;
+        hint->bw_mhz = bss.bw_mhz;
+    } else if (halow_load_link_hint(&saved) &&
+               memcmp(saved.bssid, hint->bssid, sizeof(saved.bssid)) == 0) {
+        // Same BSS as last time but not scanned since boot: keep its channel
+        hint->channel_freq_hz = saved.channel_freq_hz;
+        hint->bw_mhz = saved.bw_mhz;
     }
+    hint->valid = true;
+    return true;
+}
 
+/**
+ * @brief Move a network config saved by older firmware into the config manager
+ * Older releases stored ssid/password/valid and the link hint as individual
+ * keys in halow_auto on the "certs" NVS. A serial flash of the new table puts
+ * "keys" at the same offset; an OTA update keeps the old table, so the keys
+ * stay in "certs". config_keys_nvs_open() finds either. They are copied once and
+ * then erased.
+ * @param cfg Pointer to store the migrated configuration
+ * @return true if a legacy config was migrated, false otherwise
+ */
+static bool halow_migrate_legacy_config(halow_wifi_config_t *cfg)
+{
     nvs_handle_t handle;
-    esp_err_t err;
 
-    // Open certs partition with namespace "halow_auto"
-    err = nvs_open_from_partition("certs", "halow_auto", NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open certs partition: %s", esp_err_to_name(err));
-        return err;
+    if (config_keys_nvs_open("halow_auto", NVS_READWRITE, &handle) != ESP_OK) {
+        return false;
     }
 
-    // Save SSID
-    err = nvs_set_str(handle, "ssid", ssid);
-    if (err != ESP_OK) {
+    uint8_t valid = 0;
+    size_t ssid_len = sizeof(cfg->ssid);
+    size_t password_len = sizeof(cfg->password);
+    if (nvs_get_u8(handle, "valid", &valid) != ESP_OK || valid != 1 ||
+        nvs_get_str(handle, "ssid", cfg->ssid, &ssid_len) != ESP_OK ||
+        nvs_get_str(handle, "password", cfg->password, &password_len) != ESP_OK) {
         nvs_close(handle);
-        ESP_LOGE(TAG, "Failed to save SSID: %s", esp_err_to_name(err));
-        return err;
+        return false;
     }
 
-    // Save password (can be empty for open networks)
-    const char* password_to_save = password ? password : "";
-    err = nvs_set_str(handle, "password", password_to_save);
-    if (err != ESP_OK) {
-        nvs_close(handle);
-        ESP_LOGE(TAG, "Failed to save password: %s", esp_err_to_name(err));
-        return err;
+    size_t bssid_len = sizeof(cfg->bssid);
+    if (nvs_get_blob(handle, "bssid", cfg->bssid, &bssid_len) != ESP_OK || bssid_len != sizeof(cfg->bssid)) {
+        memset(cfg->bssid, 0, sizeof(cfg->bssid));
+    } else {
+        nvs_get_u32(handle, "chan_freq", &cfg->channel_freq_hz);
+        nvs_get_u8(handle, "chan_bw", &cfg->channel_bw_mhz);
     }
 
-    // Mark config as valid
-    err = nvs_set_u8(handle, "valid", 1);
-    if (err != ESP_OK) {
-        nvs_close(handle);
-        ESP_LOGE(TAG, "Failed to set valid flag: %s", esp_err_to_name(err));
-        return err;
+    // Only drop the old keys once the new blob is on flash
+    if (config_save_halow_wifi(cfg) == ESP_OK && config_flush() == ESP_OK) {
+        nvs_erase_all(handle);
+        nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    ESP_LOGI(TAG, "Migrated network config for SSID=%s from keys partition", cfg->ssid);
+    return true;
+}
+
+/**
+ * @brief Get the saved HaLow configuration from the config cache
+ * @param cfg Pointer to store the configuration
+ * @return true if a network is saved, false otherwise
+ */
+static bool halow_get_saved_config(halow_wifi_config_t *cfg)
+{
+    esp_err_t err = config_load_halow_wifi(cfg);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return halow_migrate_legacy_config(cfg);
+    }
+    return err == ESP_OK && cfg->ssid[0] != '\0';
+}
+
+/**
+ * @brief Load the remembered BSS and channel
+ * @param hint Pointer to store the link hint
+ * @return true if a hint was saved, false otherwise
+ */
+static bool halow_load_link_hint(halow_link_hint_t *hint)
+{
+    static const uint8_t zero_bssid[MMWLAN_MAC_ADDR_LEN] = {0};
+    halow_wifi_config_t cfg;
+
+    memset(hint, 0, sizeof(*hint));
+    if (!halow_get_saved_config(&cfg) || memcmp(cfg.bssid, zero_bssid, sizeof(zero_bssid)) == 0) {
+        return false;
+    }
+
+    // Channel is optional, a BSSID alone still avoids probing every AP
+    memcpy(hint->bssid, cfg.bssid, sizeof(hint->bssid));
+    hint->channel_freq_hz = cfg.channel_freq_hz;
+    hint->bw_mhz = cfg.channel_bw_mhz;
+    hint->valid = true;
+    return true;
+}
+
+/**
+ * @brief Save network configuration
+ * Updates the config cache; the flash write is coalesced by the config manager.
+ * @param ssid Network SSID
+ * @param password Network password (can be NULL for open networks)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t halow_save_network_config(const char* ssid, const char* password)
+{
+    if (!ssid || strlen(ssid) == 0) {
+        ESP_LOGE(TAG, "Cannot save network config: invalid SSID");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    halow_wifi_config_t cfg;
+    if (!halow_get_saved_config(&cfg)) {
+        // Start from defaults so settings other than the network are kept
+        config_load_halow_wifi(&cfg);
     }
 
-    // Commit changes
-    err = nvs_commit(handle);
+    strncpy(cfg.ssid, ssid, sizeof(cfg.ssid) - 1);
+    cfg.ssid[sizeof(cfg.ssid) - 1] = '\0';
+    strncpy(cfg.password, password ? password : "", sizeof(cfg.password) - 1);
+    cfg.password[sizeof(cfg.password) - 1] = '\0';
+
+    // Remember the BSS and channel of the current link for fast reconnect
+    halow_link_hint_t hint;
+    if (halow_get_current_link_hint(&hint)) {
+        memcpy(cfg.bssid, hint.bssid, sizeof(cfg.bssid));
+        cfg.channel_freq_hz = hint.channel_freq_hz;
+        cfg.channel_bw_mhz = hint.bw_mhz;
+    }
+
+    esp_err_t err = config_save_halow_wifi(&cfg);
     if (err != ESP_OK) {
-        nvs_close(handle);
-        ESP_LOGE(TAG, "Failed to commit changes: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Failed to save network config: %s", esp_err_to_name(err));
         return err;
     }
 
-    nvs_close(handle);
-
-    ESP_LOGI(TAG, "Network config saved to certs partition: SSID=%s", ssid);
+    ESP_LOGI(TAG, "Network config saved: SSID=%s", ssid);
     return ESP_OK;
 }
 
 /**
- * @brief Load network configuration from certs partition
+ * @brief Load network configuration
  * @param ssid Buffer to store SSID (must be at least 32 bytes)
  * @param password Buffer to store password (must be at least 64 bytes)
  * @return true if config was loaded successfully, false otherwise
@@ -556,46 +789,18 @@ bool halow_load_network_config(char* ssid, char* password)
         return false;
     }
 
-    nvs_handle_t handle;
-    esp_err_t err;
-
-    // Open certs partition with namespace "halow_auto"
-    err = nvs_open_from_partition("certs", "halow_auto", NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGD(TAG, "No saved network config found (couldn't open partition): %s", esp_err_to_name(err));
-        return false;
-    }
-
-    // Check if config is marked as valid
-    uint8_t valid = 0;
-    err = nvs_get_u8(handle, "valid", &valid);
-    if (err != ESP_OK || valid != 1) {
-        nvs_close(handle);
-        ESP_LOGD(TAG, "Network config not valid or missing");
-        return false;
-    }
-
-    // Load SSID
-    size_t ssid_len = MAX_SSID_LEN;
-    err = nvs_get_str(handle, "ssid", ssid, &ssid_len);
-    if (err != ESP_OK) {
-        nvs_close(handle);
-        ESP_LOGE(TAG, "Failed to load SSID: %s", esp_err_to_name(err));
-        return false;
-    }
-
-    // Load password
-    size_t password_len = MAX_PASSWORD_LEN;
-    err = nvs_get_str(handle, "password", password, &password_len);
-    if (err != ESP_OK) {
-        nvs_close(handle);
-        ESP_LOGE(TAG, "Failed to load password: %s", esp_err_to_name(err));
+    halow_wifi_config_t cfg;
+    if (!halow_get_saved_config(&cfg)) {
+        ESP_LOGD(TAG, "No saved network config found");
         return false;
     }
 
-    nvs_close(handle);
+    strncpy(ssid, cfg.ssid, MAX_SSID_LEN - 1);
+    ssid[MAX_SSID_LEN - 1] = '\0';
+    strncpy(password, cfg.password, MAX_PASSWORD_LEN - 1);
+    password[MAX_PASSWORD_LEN - 1] = '\0';
 
-    ESP_LOGI(TAG, "Network config loaded from certs partition: SSID=%s", ssid);
+    ESP_LOGI(TAG, "Network config loaded: SSID=%s", ssid);
     return true;
 }
 
@@ -629,6 +834,18 @@ bool halow_should_save_network_config(const char* ssid, const char* password)
         return true;
     }
 
+    // Compare the remembered link, a new BSS or channel also needs a save
+    halow_link_hint_t current;
+    halow_link_hint_t saved;
+    if (halow_get_current_link_hint(&current)) {
+        if (!halow_load_link_hint(&saved) ||
+            memcmp(current.bssid, saved.bssid, sizeof(current.bssid)) != 0 ||
+            current.channel_freq_hz != saved.channel_freq_hz ||
+            current.bw_mhz != saved.bw_mhz) {
+            return true;
+        }
+    }
+
     // Config is identical, no need to save
     return false;
 }
@@ -639,128 +856,215 @@ bool halow_should_save_network_config(const char* ssid, const char* password)
  */
 esp_err_t halow_clear_network_config(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err;
-
-    // Open certs partition with namespace "halow_auto"
-    err = nvs_open_from_partition("certs", "halow_auto", NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open certs partition for clearing: %s", esp_err_to_name(err));
-        return err;
+    halow_wifi_config_t cfg;
+    esp_err_t err = ESP_OK;
+
+    // Keep the non-network settings (auto connect, power save)
+    if (config_load_halow_wifi(&cfg) == ESP_OK) {
+        memset(cfg.ssid, 0, sizeof(cfg.ssid));
+        memset(cfg.password, 0, sizeof(cfg.password));
+        memset(cfg.bssid, 0, sizeof(cfg.bssid));
+        cfg.channel_freq_hz = 0;
+        cfg.channel_bw_mhz = 0;
+        err = config_save_halow_wifi(&cfg);
+        if (err == ESP_OK) {
+            err = config_flush();
+        }
     }
 
-    // Clear all keys in the namespace
-    err = nvs_erase_all(handle);
-    if (err != ESP_OK) {
-        nvs_close(handle);
+    if (err != ESP_OK && err != ESP_ERR_NOT_FOUND) {
         ESP_LOGE(TAG, "Failed to erase network config: %s", esp_err_to_name(err));
         return err;
     }
 
-    // Commit changes
-    err = nvs_commit(handle);
-    nvs_close(handle);
-
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit config erase: %s", esp_err_to_name(err));
-        return err;
+    // A legacy config that was never migrated must not come back on the next load
+    nvs_handle_t handle;
+    if (config_keys_nvs_open("halow_auto", NVS_READWRITE, &handle) == ESP_OK) {
+        nvs_erase_all(handle);
+        nvs_commit(handle);
+        nvs_close(handle);
     }
 
-    ESP_LOGI(TAG, "Network config cleared from certs partition");
+    ESP_LOGI(TAG, "Network config cleared");
     return ESP_OK;
 }
 
 /**
- * @brief Attempt automatic connection to saved network
- * @return 0 on success, error code otherwise
+ * @brief Check if a channel covers a frequency
  */
-int halow_auto_connect(void)
+static bool halow_channel_covers(const struct mmwlan_s1g_channel *ch, uint32_t freq_hz)
 {
-    char ssid[MAX_SSID_LEN];
-    char password[MAX_PASSWORD_LEN];
+    int64_t offset = (int64_t)freq_hz - (int64_t)ch->centre_freq_hz;
+    int64_t half_span = (int64_t)ch->bw_mhz * 500000;
+    return offset < half_span && offset > -half_span;
+}
 
-    // Try to load saved network config
-    if (!halow_load_network_config(ssid, password)) {
-        ESP_LOGI(TAG, "No saved network config found, skipping auto-connect");
-        return -1;
+/**
+ * @brief Restrict the channel list to channels overlapping the remembered one
+ * Keeps every bandwidth that covers the frequency so the AP's operating
+ * channel stays available for association. Channels of other cached BSSs of
+ * the same SSID are kept too, but the scan cache is RAM only and empty after
+ * boot. The list stays in force once associated, scans then only cover
+ * these channels; the full list comes back the next time STA is disabled.
+ * Must be called with STA disabled.
+ * @param hint Remembered link
+ * @param ssid Network SSID
+ * @return true if the restricted list is active, false otherwise
+ */
+static bool halow_apply_fast_channel_list(const halow_link_hint_t *hint, const char *ssid)
+{
+    if (!halow_channel_list || hint->channel_freq_hz == 0) {
+        return false;
     }
 
-    printf(COLOR_CYAN "Found saved network config, attempting auto-connect to '%s'...\n" COLOR_RESET, ssid);
-
-    // Try to connect up to 3 times
-    for (int attempt = 1; attempt <= AUTO_CONNECT_MAX_ATTEMPTS; attempt++) {
-        printf("Auto-connect attempt %d/%d...\n> ", attempt, AUTO_CONNECT_MAX_ATTEMPTS);
-        fflush(stdout);
-
-        // Restore password from NVS storage
-        const char* connect_password = (strlen(password) > 0) ? password : NULL;
-
-        // Attempt connection
-        if (halow_connect(ssid, connect_password) == 0) {
-            // Wait for connection result (5 seconds)
-            EventBits_t bits = xEventGroupWaitBits(halow_event_group,
-                                                  HALOW_CONNECTED_BIT,
-                                                  pdFALSE,
-                                                  pdFALSE,
-                                                  pdMS_TO_TICKS(5000));
-
-            if (bits & HALOW_CONNECTED_BIT) {
-                printf(COLOR_GREEN "Auto-connect successful: %s\n" COLOR_RESET, ssid);
-                return 0;
-            } else {
-                printf(COLOR_YELLOW "Auto-connect attempt %d failed, still trying...\n" COLOR_RESET, attempt);
-            }
-        } else {
-            printf(COLOR_RED "Auto-connect attempt %d failed to initiate\n" COLOR_RESET, attempt);
+    int peers = halow_scan_cache_snapshot(halow_fast_peers, MAX_SCAN_RESULTS);
+    unsigned count = 0;
+    for (unsigned i = 0; i < halow_channel_list->num_channels && count < FAST_RECONNECT_MAX_CHANNELS; i++) {
+        const struct mmwlan_s1g_channel *ch = &halow_channel_list->channels[i];
+        bool keep = halow_channel_covers(ch, hint->channel_freq_hz);
+        for (int p = 0; p < peers && !keep; p++) {
+            keep = strcmp(halow_fast_peers[p].ssid, ssid) == 0 &&
+                   halow_channel_covers(ch, halow_fast_peers[p].channel_freq_hz);
         }
-
-        // Wait between attempts (except for the last one)
-        if (attempt < AUTO_CONNECT_MAX_ATTEMPTS) {
-            vTaskDelay(pdMS_TO_TICKS(AUTO_CONNECT_RETRY_DELAY_MS));
+        if (keep) {
+            halow_fast_channels[count++] = *ch;
         }
     }
+    if (count == 0) {
+        ESP_LOGW(TAG, "Remembered channel %lu Hz not in regulatory domain", (unsigned long)hint->channel_freq_hz);
+        return false;
+    }
+
+    memcpy(halow_fast_channel_list.country_code, halow_channel_list->country_code,
+           sizeof(halow_fast_channel_list.country_code));
+    halow_fast_channel_list.num_channels = count;
+    halow_fast_channel_list.channels = halow_fast_channels;
+
+    enum mmwlan_status status = mmwlan_set_channel_list(&halow_fast_channel_list);
+    if (status != MMWLAN_SUCCESS) {
+        ESP_LOGW(TAG, "Could not apply fast reconnect channel list: %d", status);
+        return false;
+    }
 
-    printf(COLOR_RED "Auto-connect failed after %d attempts. Manual connect required.\n" COLOR_RESET, AUTO_CONNECT_MAX_ATTEMPTS);
-    return -1;
+    halow_fast_channels_active = true;
+    ESP_LOGI(TAG, "Fast reconnect restricted to %u channel(s)", count);
+    return true;
 }
 
 /**
- * @brief Connect to a HaLow network
- * @param ssid Network SSID to connect to
- * @param password Password (optional for open networks)
- * @return 0 on success, error code otherwise
+ * @brief Restore the full regulatory channel list after a fast reconnect
+ * Disables STA first when needed, the channel list can only change while inactive.
  */
-int halow_connect(const char* ssid, const char* password)
+static void halow_restore_channel_list(void)
 {
-    if (!halow_started) {
-        ESP_LOGE(TAG, "HaLow not started. Use 'halow on' first.");
-        return -1;
+    if (!halow_fast_channels_active || !halow_channel_list) {
+        return;
     }
 
-    if (!ssid || strlen(ssid) == 0) {
-        ESP_LOGE(TAG, "Invalid SSID");
-        return -1;
+    if (mmwlan_get_sta_state() != MMWLAN_STA_DISABLED) {
+        mmwlan_sta_disable();
+    }
+    if (mmwlan_set_channel_list(halow_channel_list) != MMWLAN_SUCCESS) {
+        ESP_LOGE(TAG, "Failed to restore full channel list");
+        return;
     }
+    halow_fast_channels_active = false;
+}
 
-    // Store the password for auto-save on successful connection
-    if (password && strlen(password) > 0) {
-        strncpy(halow_last_password, password, sizeof(halow_last_password) - 1);
-        halow_last_password[sizeof(halow_last_password) - 1] = '\0';
+/**
+ * @brief Print phase duration between two association timestamps
+ */
+static void halow_print_assoc_phase(const char *name, int64_t from_us, int64_t to_us)
+{
+    if (from_us == 0 || to_us == 0 || to_us < from_us) {
+        printf("  %-22s   n/a\n", name);
     } else {
-        halow_last_password[0] = '\0';  // Empty password for open networks
+        printf("  %-22s %5lld ms\n", name, (long long)((to_us - from_us) / 1000));
     }
+}
 
-    enum mmwlan_status status;
-    struct mmwlan_sta_args sta_args = MMWLAN_STA_ARGS_INIT;
-
-    // Configure STA arguments
-    sta_args.ssid_len = strlen(ssid);
-    if (sta_args.ssid_len > MMWLAN_SSID_MAXLEN) {
+/**
+ * @brief Print the measured association time breakdown
+ */
+static void halow_print_assoc_timing(void)
+{
+    const halow_assoc_timing_t *t = &halow_assoc_timing;
+    int64_t scan_end = t->scan_complete_us ? t->scan_complete_us : t->auth_request_us;
+
+    printf(COLOR_CYAN "Association time (%s path): %lld ms\n" COLOR_RESET,
+           t->fast ? "fast" : "full", (long long)((t->connected_us - t->start_us) / 1000));
+    halow_print_assoc_phase("enable -> scan", t->start_us, t->scan_request_us);
+    halow_print_assoc_phase("scan", t->scan_request_us, scan_end);
+    halow_print_assoc_phase("scan -> auth", scan_end, t->auth_request_us);
+    halow_print_assoc_phase("auth", t->auth_request_us, t->assoc_request_us);
+    halow_print_assoc_phase("assoc + key exchange", t->assoc_request_us, t->ctrl_port_open_us);
+    halow_print_assoc_phase("port open -> connected", t->ctrl_port_open_us, t->connected_us);
+    printf("> ");
+    fflush(stdout);
+}
+
+/**
+ * @brief Connect to a HaLow network
+ * @param ssid Network SSID to connect to
+ * @param password Password (optional for open networks)
+ * @return 0 on success, error code otherwise
+ */
+int halow_connect(const char* ssid, const char* password)
+{
+    // A manual connect always searches the full channel list
+    return halow_connect_async(ssid, password, NULL, NULL) == ESP_OK ? 0 : -1;
+}
+
+/**
+ * @brief Start a connection, optionally targeting a remembered BSS/channel
+ * @param ssid Network SSID to connect to
+ * @param password Password (optional for open networks)
+ * @param hint Remembered link for a targeted reconnect, NULL for a normal search
+ * @return 0 on success, error code otherwise
+ */
+static int halow_connect_internal(const char* ssid, const char* password, const halow_link_hint_t *hint)
+{
+    if (!halow_started) {
+        ESP_LOGE(TAG, "HaLow not started. Use 'halow on' first.");
+        return -1;
+    }
+
+    if (!ssid || strlen(ssid) == 0) {
+        ESP_LOGE(TAG, "Invalid SSID");
+        return -1;
+    }
+
+    enum mmwlan_status status;
+    struct mmwlan_sta_args sta_args = MMWLAN_STA_ARGS_INIT;
+
+    // Configure STA arguments
+    sta_args.ssid_len = strlen(ssid);
+    if (sta_args.ssid_len > MMWLAN_SSID_MAXLEN) {
         ESP_LOGE(TAG, "SSID too long");
         return -1;
     }
     memcpy(sta_args.ssid, ssid, sta_args.ssid_len);
 
+    bool fast = false;
+    halow_scan_entry_t cached;
+    if (hint && hint->valid) {
+        // Targeted reconnect: remembered BSS, few channels
+        memcpy(sta_args.bssid, hint->bssid, MMWLAN_MAC_ADDR_LEN);
+        memcpy(halow_pending_bssid, hint->bssid, MMWLAN_MAC_ADDR_LEN);
+        halow_pending_bssid_valid = true;
+        halow_apply_fast_channel_list(hint, ssid);
+        fast = true;
+    } else if ((halow_pending_bssid_valid = halow_scan_cache_find_ssid(ssid, &cached))) {
+        // Prefer the strongest recently scanned BSS so the supplicant does not
+        // have to search the whole S1G channel list again
+        memcpy(sta_args.bssid, cached.bssid, MMWLAN_MAC_ADDR_LEN);
+        memcpy(halow_pending_bssid, cached.bssid, MMWLAN_MAC_ADDR_LEN);
+        printf("Using cached BSS %02x:%02x:%02x:%02x:%02x:%02x (%d dBm, %.3f MHz)\n",
+               cached.bssid[0], cached.bssid[1], cached.bssid[2],
+               cached.bssid[3], cached.bssid[4], cached.bssid[5],
+               cached.rssi, cached.channel_freq_hz / 1e6);
+    }
+
     if (password && strlen(password) > 0) {
         sta_args.passphrase_len = strlen(password);
         if (sta_args.passphrase_len > MMWLAN_PASSPHRASE_MAXLEN) {
@@ -776,33 +1080,23 @@ int halow_connect(const char* ssid, const char* password)
     printf("Connecting to HaLow network: %s\n> ", ssid);
     fflush(stdout);
 
-    // Store the connected SSID for status display
-    strncpy(halow_connected_ssid, ssid, sizeof(halow_connected_ssid) - 1);
-    halow_connected_ssid[sizeof(halow_connected_ssid) - 1] = '\0';
-
-    // Store SSID and password for potential auto-save when connection succeeds
-    strncpy(halow_save_pending_ssid, ssid, sizeof(halow_save_pending_ssid) - 1);
-    halow_save_pending_ssid[sizeof(halow_save_pending_ssid) - 1] = '\0';
-
-    if (password && strlen(password) > 0) {
-        strncpy(halow_save_pending_password, password, sizeof(halow_save_pending_password) - 1);
-        halow_save_pending_password[sizeof(halow_save_pending_password) - 1] = '\0';
-    } else {
-        halow_save_pending_password[0] = '\0';  // Empty for open networks
-    }
+    // Timestamp association phases from STA events
+    sta_args.sta_evt_cb = halow_sta_event_handler;
+    sta_args.sta_evt_cb_arg = NULL;
+    memset(&halow_assoc_timing, 0, sizeof(halow_assoc_timing));
+    halow_assoc_timing.fast = fast;
+    halow_assoc_timing.start_us = esp_timer_get_time();
+    TRACE_EVENT(TRACE_EV_HALOW_CONNECT, fast);
 
-    ESP_LOGI(TAG, "Set pending save config - SSID='%s', password='%s'",
-             halow_save_pending_ssid, halow_save_pending_password[0] ? "[SET]" : "[OPEN]");
+    // Listen interval and TWT request are sent in the association request
+    halow_power_apply_connect();
 
     // Enable STA mode and start connection
     status = mmwlan_sta_enable(&sta_args, halow_sta_status_handler);
     if (status != MMWLAN_SUCCESS) {
         ESP_LOGE(TAG, "Failed to enable STA mode: status %d", status);
-        // Clear SSID if connection failed
-        halow_connected_ssid[0] = '\0';
-        // Clear pending save config
-        halow_save_pending_ssid[0] = '\0';
-        halow_save_pending_password[0] = '\0';
+        halow_assoc_timing.start_us = 0;
+        halow_restore_channel_list();
         return -1;
     }
 
@@ -810,6 +1104,587 @@ int halow_connect(const char* ssid, const char* password)
     return 0;
 }
 
+/**
+ * @brief Publish a new connection state
+ */
+static void halow_conn_set_state(halow_conn_state_t state)
+{
+    portENTER_CRITICAL(&halow_conn_lock);
+    halow_conn.state = state;
+    portEXIT_CRITICAL(&halow_conn_lock);
+}
+
+/**
+ * @brief Report the outcome of the pending request, at most once
+ */
+static void halow_conn_complete(esp_err_t result)
+{
+    halow_conn_cb_t cb = halow_conn.cb;
+    void *arg = halow_conn.cb_arg;
+
+    halow_conn.cb = NULL;
+    halow_conn.cb_arg = NULL;
+    if (cb) {
+        cb(result, arg);
+    }
+}
+
+/**
+ * @brief Backoff before full-search attempt n+1: doubling from the minimum, capped, +/-25% jitter
+ */
+static uint32_t halow_conn_backoff_ms(uint32_t attempt)
+{
+    uint32_t delay = CONFIG_HALOW_CONNECT_BACKOFF_MIN_MS;
+    for (uint32_t i = 1; i < attempt && delay < CONFIG_HALOW_CONNECT_BACKOFF_MAX_MS; i++) {
+        delay *= 2;
+    }
+    if (delay > CONFIG_HALOW_CONNECT_BACKOFF_MAX_MS) {
+        delay = CONFIG_HALOW_CONNECT_BACKOFF_MAX_MS;
+    }
+
+    // Stations that lost the same AP must not come back in lockstep
+    uint32_t span = delay * HALOW_CONN_JITTER_PCT / 100;
+    return delay - span + (span ? esp_random() % (2 * span + 1) : 0);
+}
+
+/**
+ * @brief Disable STA and drop a restricted channel list before a new attempt
+ */
+static void halow_conn_reset_sta(void)
+{
+    if (mmwlan_get_sta_state() != MMWLAN_STA_DISABLED) {
+        mmwlan_sta_disable();
+    }
+    halow_restore_channel_list();
+}
+
+static void halow_conn_attempt_failed(void);
+
+/**
+ * @brief Start the next attempt of the current request: a targeted one while hints are left, else a full search
+ */
+static void halow_conn_start_attempt(void)
+{
+    const halow_link_hint_t *hint = NULL;
+    uint32_t timeout_ms = CONFIG_HALOW_CONNECT_TIMEOUT_MS;
+
+    halow_conn_reset_sta();
+
+    if (halow_conn.hint_index < halow_conn.num_hints) {
+        hint = &halow_conn.hints[halow_conn.hint_index];
+        timeout_ms = halow_conn.hint_timeout_ms;
+        if (!halow_conn.roam) {
+            printf("Fast reconnect to %02x:%02x:%02x:%02x:%02x:%02x",
+                   hint->bssid[0], hint->bssid[1], hint->bssid[2],
+                   hint->bssid[3], hint->bssid[4], hint->bssid[5]);
+            if (hint->channel_freq_hz != 0) {
+                printf(" on %.3f MHz (%u MHz)", hint->channel_freq_hz / 1e6, hint->bw_mhz);
+            }
+            printf("...\n> ");
+            fflush(stdout);
+        }
+    } else {
+        halow_conn.attempt++;
+        halow_conn.total_attempts++;
+        if (halow_conn.attempt > 1) {
+            printf("Connect attempt %lu to '%s'...\n> ", (unsigned long)halow_conn.attempt, halow_conn.ssid);
+            fflush(stdout);
+        }
+    }
+
+    halow_conn_set_state(HALOW_CONN_CONNECTING);
+    if (halow_connect_internal(halow_conn.ssid, halow_conn.password[0] ? halow_conn.password : NULL, hint) != 0) {
+        halow_conn_attempt_failed();
+        return;
+    }
+    halow_conn.deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+}
+
+/**
+ * @brief Current attempt timed out or could not start: next hint, full search, backoff or give up
+ */
+static void halow_conn_attempt_failed(void)
+{
+    halow_conn.deadline_us = 0;
+
+    if (halow_conn.hint_index < halow_conn.num_hints) {
+        if (halow_conn.roam && halow_conn.hint_index == 0) {
+            // Roam target did not answer, do not pick it again from the cache
+            ESP_LOGW(TAG, "Roam target did not associate, returning to previous BSS");
+            halow_scan_cache_invalidate(halow_conn.hints[0].bssid);
+        }
+        halow_conn.hint_index++;
+        if (halow_conn.hint_index == halow_conn.num_hints) {
+            if (halow_conn.roam) {
+                // Neither BSS answered, the search below is an ordinary reconnect
+                halow_conn.roam = false;
+                halow_conn_complete(ESP_FAIL);
+            } else {
+                printf(COLOR_YELLOW "Fast reconnect failed, falling back to full search\n" COLOR_RESET);
+            }
+        }
+        halow_conn_start_attempt();
+        return;
+    }
+
+    // The cached BSS did not answer, let the next attempt scan the full band
+    if (halow_pending_bssid_valid) {
+        halow_scan_cache_invalidate(halow_pending_bssid);
+        halow_pending_bssid_valid = false;
+    }
+    halow_conn_reset_sta();
+
+#if CONFIG_HALOW_CONNECT_MAX_ATTEMPTS > 0
+    if (halow_conn.attempt >= CONFIG_HALOW_CONNECT_MAX_ATTEMPTS) {
+        printf(COLOR_RED "Connect to '%s' failed after %lu attempts. Manual connect required.\n" COLOR_RESET "> ",
+               halow_conn.ssid, (unsigned long)halow_conn.attempt);
+        fflush(stdout);
+        halow_conn_set_state(HALOW_CONN_IDLE);
+        halow_conn_complete(ESP_ERR_TIMEOUT);
+        return;
+    }
+#endif
+
+    uint32_t delay_ms = halow_conn_backoff_ms(halow_conn.attempt);
+    printf(COLOR_YELLOW "Connect attempt %lu failed, retrying in %lu ms\n" COLOR_RESET "> ",
+           (unsigned long)halow_conn.attempt, (unsigned long)delay_ms);
+    fflush(stdout);
+    halow_conn.last_backoff_ms = delay_ms;
+    halow_conn.deadline_us = esp_timer_get_time() + (int64_t)delay_ms * 1000;
+    halow_conn_set_state(HALOW_CONN_BACKOFF);
+}
+
+/**
+ * @brief Save the credentials and link hint if they changed
+ * Runs in the state machine task, never in the mmwlan callback. The config
+ * manager only updates its RAM copy here; the flash commit is deferred.
+ */
+static void halow_conn_save_network(void)
+{
+    const char *password = halow_conn.password[0] ? halow_conn.password : NULL;
+
+    if (!halow_should_save_network_config(halow_conn.ssid, password)) {
+        ESP_LOGI(TAG, "Network config unchanged, nothing to save");
+        return;
+    }
+
+    esp_err_t err = halow_save_network_config(halow_conn.ssid, password);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save network config: %s", esp_err_to_name(err));
+    }
+}
+
+/**
+ * @brief STA reported connected
+ */
+static void halow_conn_on_connected(void)
+{
+    halow_conn_state_t state = halow_conn.state;
+
+    // A report left over from an attempt that was torn down
+    if (state != HALOW_CONN_CONNECTING || mmwlan_get_sta_state() != MMWLAN_STA_CONNECTED) {
+        return;
+    }
+
+    bool roam = halow_conn.roam;
+    bool first_hint = halow_conn.hint_index == 0;
+
+    halow_conn.deadline_us = 0;
+    halow_conn.attempt = 0;
+    halow_conn.num_hints = 0;
+    halow_conn.hint_index = 0;
+    halow_conn.roam = false;
+    halow_conn.connects++;
+    halow_conn_set_state(HALOW_CONN_CONNECTED);
+
+    if (halow_assoc_timing.start_us != 0 && halow_assoc_timing.connected_us == 0) {
+        halow_assoc_timing.connected_us = esp_timer_get_time();
+        halow_print_assoc_timing();
+    }
+
+    halow_conn_save_network();
+    if (!roam) {
+        printf(COLOR_GREEN "Connected to '%s'\n" COLOR_RESET "> ", halow_conn.ssid);
+        fflush(stdout);
+    }
+
+    // A roam that ended on the previous BSS still reports it
+    halow_conn_complete(!roam || first_hint ? ESP_OK : ESP_ERR_TIMEOUT);
+}
+
+/**
+ * @brief STA went back to connecting while associated: the link was lost
+ */
+static void halow_conn_on_link_lost(void)
+{
+    if (halow_conn.state != HALOW_CONN_CONNECTED || mmwlan_get_sta_state() == MMWLAN_STA_CONNECTED) {
+        return;
+    }
+
+    halow_conn.losses++;
+    halow_conn.attempt = 0;
+    halow_conn.num_hints = 0;
+    halow_conn.hint_index = 0;
+    printf(COLOR_YELLOW "HaLow link to '%s' lost, reconnecting\n" COLOR_RESET "> ", halow_conn.ssid);
+    fflush(stdout);
+
+    if (halow_fast_channels_active) {
+        // The supplicant would only search the restricted list; the AP may have moved
+        halow_conn_start_attempt();
+        return;
+    }
+
+    // Give the supplicant's own reconnect one attempt before taking over
+    halow_conn.attempt = 1;
+    halow_conn.total_attempts++;
+    memset(&halow_assoc_timing, 0, sizeof(halow_assoc_timing));
+    halow_assoc_timing.start_us = esp_timer_get_time();
+    halow_conn.deadline_us = halow_assoc_timing.start_us + (int64_t)CONFIG_HALOW_CONNECT_TIMEOUT_MS * 1000;
+    halow_conn_set_state(HALOW_CONN_CONNECTING);
+}
+
+/**
+ * @brief Take over a new connect request, cancelling the previous one
+ */
+static void halow_conn_begin(const char *ssid, const char *password, const halow_conn_event_t *ev)
+{
+    halow_conn_complete(ESP_ERR_INVALID_STATE);
+
+    portENTER_CRITICAL(&halow_conn_lock);
+    strncpy(halow_conn.ssid, ssid, sizeof(halow_conn.ssid) - 1);
+    halow_conn.ssid[sizeof(halow_conn.ssid) - 1] = '\0';
+    portEXIT_CRITICAL(&halow_conn_lock);
+    strncpy(halow_conn.password, password ? password : "", sizeof(halow_conn.password) - 1);
+    halow_conn.password[sizeof(halow_conn.password) - 1] = '\0';
+
+    halow_conn.attempt = 0;
+    halow_conn.num_hints = 0;
+    halow_conn.hint_index = 0;
+    halow_conn.hint_timeout_ms = FAST_RECONNECT_TIMEOUT_MS;
+    halow_conn.roam = false;
+    halow_conn.cb = ev->cb;
+    halow_conn.cb_arg = ev->cb_arg;
+}
+
+/**
+ * @brief Handle a roam request: targeted attempt at the new BSS, then the previous one
+ */
+static void halow_conn_on_roam(const halow_conn_event_t *ev)
+{
+    char saved_ssid[MAX_SSID_LEN];
+    char password[MAX_PASSWORD_LEN];
+    halow_link_hint_t previous;
+
+    // The password is not kept after a connect from a previous boot, take it from the saved config
+    if (halow_conn.state != HALOW_CONN_CONNECTED || !halow_get_current_link_hint(&previous) ||
+        !halow_load_network_config(saved_ssid, password) || strcmp(saved_ssid, halow_conn.ssid) != 0) {
+        if (halow_conn.state == HALOW_CONN_CONNECTED) {
+            ESP_LOGW(TAG, "Roaming needs the credentials of '%s' saved", halow_conn.ssid);
+        }
+        if (ev->cb) {
+            ev->cb(ESP_ERR_INVALID_STATE, ev->cb_arg);
+        }
+        return;
+    }
+
+    halow_conn_begin(saved_ssid, password, ev);
+    halow_conn.hints[0] = ev->hint;
+    halow_conn.hints[1] = previous;
+    halow_conn.num_hints = 2;
+    halow_conn.hint_timeout_ms = ev->timeout_ms;
+    halow_conn.roam = true;
+    halow_conn_start_attempt();
+}
+
+/**
+ * @brief Handle a widen request: restore the full channel list while STA is inactive
+ * mmwlan only takes a new list while STA is disabled, so while connecting or
+ * associated the restricted list stays; taking the link down for a scan is
+ * not worth it. Completes straight away in every state.
+ */
+static void halow_conn_on_widen(const halow_conn_event_t *ev)
+{
+    esp_err_t result = ESP_OK;
+
+    if (!halow_fast_channels_active) {
+        // Nothing to do, a full search already restored it
+    } else if (halow_conn.state == HALOW_CONN_IDLE || halow_conn.state == HALOW_CONN_BACKOFF) {
+        halow_restore_channel_list();
+    } else {
+        result = ESP_ERR_INVALID_STATE;
+    }
+
+    if (ev->cb) {
+        ev->cb(result, ev->cb_arg);
+    }
+}
+
+/**
+ * @brief Handle a connect to the saved network
+ */
+static void halow_conn_on_auto(const halow_conn_event_t *ev)
+{
+    char ssid[MAX_SSID_LEN];
+    char password[MAX_PASSWORD_LEN];
+
+    if (!halow_load_network_config(ssid, password)) {
+        ESP_LOGI(TAG, "No saved network config found, skipping auto-connect");
+        if (ev->cb) {
+            ev->cb(ESP_ERR_NOT_FOUND, ev->cb_arg);
+        }
+        return;
+    }
+
+    printf(COLOR_CYAN "Found saved network config, attempting auto-connect to '%s'...\n" COLOR_RESET, ssid);
+    halow_conn_begin(ssid, password, ev);
+
+    // Targeted reconnect to the last good BSS/channel first
+    if (halow_load_link_hint(&halow_conn.hints[0])) {
+        halow_conn.num_hints = 1;
+    }
+    halow_conn_start_attempt();
+}
+
+/**
+ * @brief Handle a disconnect: leave the network and stay idle
+ */
+static void halow_conn_on_disconnect(const halow_conn_event_t *ev)
+{
+    halow_conn_complete(ESP_ERR_INVALID_STATE);
+    halow_conn_reset_sta();
+    halow_conn.deadline_us = 0;
+    halow_conn.attempt = 0;
+    halow_conn.num_hints = 0;
+    halow_conn.roam = false;
+    halow_conn.password[0] = '\0';
+    halow_conn_set_state(HALOW_CONN_IDLE);
+    if (ev->cb) {
+        ev->cb(ESP_OK, ev->cb_arg);
+    }
+}
+
+/**
+ * @brief HaLow connection state machine task
+ * Owns the STA: every mmwlan_sta_enable/disable and channel list change
+ * after boot happens here. Waits on the event queue, with a timeout set to
+ * the current attempt or backoff deadline.
+ */
+static void halow_conn_task(void *arg)
+{
+    halow_conn_event_t ev;
+
+    for (;;) {
+        TickType_t wait = portMAX_DELAY;
+        if (halow_conn.deadline_us != 0) {
+            int64_t remaining_us = halow_conn.deadline_us - esp_timer_get_time();
+            wait = remaining_us > 0 ? pdMS_TO_TICKS((remaining_us + 999) / 1000) + 1 : 0;
+        }
+
+        if (xQueueReceive(halow_conn_queue, &ev, wait) != pdTRUE) {
+            // Deadline passed
+            if (halow_conn.state == HALOW_CONN_BACKOFF) {
+                halow_conn.deadline_us = 0;
+                halow_conn_start_attempt();
+            } else if (halow_conn.state == HALOW_CONN_CONNECTING) {
+                if (mmwlan_get_sta_state() == MMWLAN_STA_CONNECTED) {
+                    halow_conn_on_connected();      // Status report was dropped
+                } else {
+                    halow_conn_attempt_failed();
+                }
+            } else {
+                halow_conn.deadline_us = 0;
+            }
+            continue;
+        }
+
+        switch (ev.type) {
+        case HALOW_CONN_EV_CONNECT:
+            halow_conn_begin(ev.ssid, ev.password, &ev);
+            halow_conn_start_attempt();
+            break;
+        case HALOW_CONN_EV_AUTO:
+            halow_conn_on_auto(&ev);
+            break;
+        case HALOW_CONN_EV_ROAM:
+            halow_conn_on_roam(&ev);
+            break;
+        case HALOW_CONN_EV_WIDEN:
+            halow_conn_on_widen(&ev);
+            break;
+        case HALOW_CONN_EV_DISCONNECT:
+            halow_conn_on_disconnect(&ev);
+            break;
+        case HALOW_CONN_EV_STA_STATE:
+            // DISABLED only follows our own mmwlan_sta_disable()
+            if (ev.sta_state == MMWLAN_STA_CONNECTED) {
+                halow_conn_on_connected();
+            } else if (ev.sta_state == MMWLAN_STA_CONNECTING) {
+                halow_conn_on_link_lost();
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Queue a request for the state machine task
+ */
+static esp_err_t halow_conn_post(const halow_conn_event_t *ev)
+{
+    if (!halow_conn_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xQueueSend(halow_conn_queue, ev, pdMS_TO_TICKS(HALOW_CONN_POST_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Connection request queue full");
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+// Completion of a request made by a blocking wrapper
+typedef struct {
+    SemaphoreHandle_t done;
+    esp_err_t result;
+} halow_conn_sync_t;
+
+static void halow_conn_sync_done(esp_err_t result, void *arg)
+{
+    halow_conn_sync_t *sync = arg;
+    sync->result = result;
+    xSemaphoreGive(sync->done);
+}
+
+/**
+ * @brief Queue a request and wait for its completion callback
+ * Every request completes (cancelled ones with ESP_ERR_INVALID_STATE), so
+ * waiting without a timeout is safe. Must not be called from the state
+ * machine task or from a completion callback.
+ */
+static esp_err_t halow_conn_request_sync(halow_conn_event_t *ev)
+{
+    StaticSemaphore_t done_buf;
+    halow_conn_sync_t sync = {
+        .done = xSemaphoreCreateBinaryStatic(&done_buf),
+        .result = ESP_FAIL,
+    };
+
+    ev->cb = halow_conn_sync_done;
+    ev->cb_arg = &sync;
+    esp_err_t err = halow_conn_post(ev);
+    if (err != ESP_OK) {
+        return err;
+    }
+    xSemaphoreTake(sync.done, portMAX_DELAY);
+    return sync.result;
+}
+
+/**
+ * @brief Queue a connect to the saved network (called by halow_start)
+ */
+static void halow_auto_connect(void)
+{
+    halow_conn_event_t ev = { .type = HALOW_CONN_EV_AUTO };
+    halow_conn_post(&ev);
+}
+
+/**
+ * @brief Start connecting to a network without waiting
+ */
+esp_err_t halow_connect_async(const char *ssid, const char *password, halow_conn_cb_t cb, void *arg)
+{
+    if (!halow_started) {
+        ESP_LOGE(TAG, "HaLow not started. Use 'halow on' first.");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!ssid || strlen(ssid) == 0 || strlen(ssid) > MMWLAN_SSID_MAXLEN ||
+        (password && strlen(password) >= MAX_PASSWORD_LEN)) {
+        ESP_LOGE(TAG, "Invalid SSID or password");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    halow_conn_event_t ev = { .type = HALOW_CONN_EV_CONNECT, .cb = cb, .cb_arg = arg };
+    strncpy(ev.ssid, ssid, sizeof(ev.ssid) - 1);
+    if (password) {
+        strncpy(ev.password, password, sizeof(ev.password) - 1);
+    }
+    return halow_conn_post(&ev);
+}
+
+/**
+ * @brief Leave the network without waiting
+ */
+esp_err_t halow_disconnect_async(halow_conn_cb_t cb, void *arg)
+{
+    halow_conn_event_t ev = { .type = HALOW_CONN_EV_DISCONNECT, .cb = cb, .cb_arg = arg };
+    return halow_conn_post(&ev);
+}
+
+/**
+ * @brief Leave and rejoin the saved network without waiting
+ */
+esp_err_t halow_reassociate_async(void)
+{
+    char ssid[MAX_SSID_LEN];
+    char password[MAX_PASSWORD_LEN];
+
+    if (!halow_started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!halow_load_network_config(ssid, password)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Queued back to back: the state machine runs them in order
+    halow_conn_event_t ev = { .type = HALOW_CONN_EV_DISCONNECT };
+    esp_err_t err = halow_conn_post(&ev);
+    if (err != ESP_OK) {
+        return err;
+    }
+    ev.type = HALOW_CONN_EV_AUTO;
+    return halow_conn_post(&ev);
+}
+
+/**
+ * @brief Get the connection state
+ */
+halow_conn_state_t halow_get_conn_state(void)
+{
+    portENTER_CRITICAL(&halow_conn_lock);
+    halow_conn_state_t state = halow_conn.state;
+    portEXIT_CRITICAL(&halow_conn_lock);
+    return state;
+}
+
+/**
+ * @brief Get a printable name of a connection state
+ */
+const char *halow_conn_state_name(halow_conn_state_t state)
+{
+    static const char *names[] = {
+        [HALOW_CONN_IDLE]       = "idle",
+        [HALOW_CONN_CONNECTING] = "connecting",
+        [HALOW_CONN_CONNECTED]  = "connected",
+        [HALOW_CONN_BACKOFF]    = "backoff",
+    };
+    return state <= HALOW_CONN_BACKOFF ? names[state] : "unknown";
+}
+
+/**
+ * @brief Put the full regulatory channel list back after a targeted connect
+ * Never touches the link: only possible while not connecting or associated.
+ * @return ESP_OK if the full list is in force, ESP_ERR_INVALID_STATE if the
+ *         restricted list stays until STA is next disabled
+ */
+static esp_err_t halow_widen_channel_list(void)
+{
+    if (!halow_fast_channels_active) {
+        return ESP_OK;
+    }
+
+    halow_conn_event_t ev = { .type = HALOW_CONN_EV_WIDEN };
+    return halow_conn_request_sync(&ev);
+}
+
 /**
  * @brief Scan for available HaLow networks
  * @return 0 on success, error code otherwise
@@ -821,9 +1696,16 @@ int halow_scan(void)
         return -1;
     }
 
+    // Scanning never drops the link; after a fast reconnect it covers fewer channels
+    if (halow_widen_channel_list() != ESP_OK) {
+        printf(COLOR_YELLOW "Associated after a fast reconnect: scanning its %u channel(s) only, "
+               "the full list returns with the next connect\n" COLOR_RESET,
+               (unsigned)halow_fast_channel_list.num_channels);
+    }
+
     printf("Starting HaLow scan...\n");
-    printf("%-3s %-32s %-17s %-4s %-4s\n", "No", "SSID", "BSSID", "RSSI", "BW");
-    printf("--- -------------------------------- ----------------- ---- ----\n");
+    printf("%-3s %-32s %-17s %-4s %-4s %-9s\n", "No", "SSID", "BSSID", "RSSI", "BW", "Freq(MHz)");
+    printf("--- -------------------------------- ----------------- ---- ---- ---------\n");
     fflush(stdout);
 
     // Reset scan count
@@ -844,6 +1726,73 @@ int halow_scan(void)
     return 0;
 }
 
+/**
+ * @brief Scan while associated, results go to the scan cache only
+ */
+esp_err_t halow_background_scan(uint32_t timeout_ms)
+{
+    if (!halow_started || !halow_scan_semaphore) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Associated after a targeted connect this only covers the network's known channels
+    halow_widen_channel_list();
+
+    // Drop a completion left over from an earlier console scan
+    while (mmosal_semb_wait(halow_scan_semaphore, 0)) {
+    }
+
+    struct mmwlan_scan_req scan_req = MMWLAN_SCAN_REQ_INIT;
+    scan_req.scan_rx_cb = halow_bgscan_rx_callback;
+    scan_req.scan_complete_cb = halow_bgscan_complete_callback;
+
+    enum mmwlan_status status = mmwlan_scan_request(&scan_req);
+    if (status != MMWLAN_SUCCESS) {
+        ESP_LOGW(TAG, "Background scan not started: status %d", status);
+        return ESP_FAIL;
+    }
+    if (!mmosal_semb_wait(halow_scan_semaphore, timeout_ms)) {
+        mmwlan_scan_abort();
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Get the SSID of the current association
+ */
+bool halow_get_connected_ssid(char *ssid, size_t len)
+{
+    bool connected;
+
+    portENTER_CRITICAL(&halow_conn_lock);
+    connected = halow_conn.state == HALOW_CONN_CONNECTED && halow_conn.ssid[0] != '\0';
+    if (connected) {
+        strncpy(ssid, halow_conn.ssid, len - 1);
+        ssid[len - 1] = '\0';
+    }
+    portEXIT_CRITICAL(&halow_conn_lock);
+    return connected;
+}
+
+/**
+ * @brief Hand the association over to another BSS of the same network
+ * Queued to the state machine like any connect: targeted attempt at the new
+ * BSS, then at the previous one, then a full search. Blocks the caller
+ * (the roaming task) until the handover has an outcome.
+ */
+esp_err_t halow_roam_to(const uint8_t *bssid, uint32_t channel_freq_hz, uint8_t bw_mhz, uint32_t timeout_ms)
+{
+    halow_conn_event_t ev = {
+        .type = HALOW_CONN_EV_ROAM,
+        .hint = { .channel_freq_hz = channel_freq_hz, .bw_mhz = bw_mhz, .valid = true },
+        .timeout_ms = timeout_ms,
+    };
+
+    memcpy(ev.hint.bssid, bssid, sizeof(ev.hint.bssid));
+    return halow_conn_request_sync(&ev);
+}
+
 /**
  * @brief Display HaLow version information
  * @return 0 on success, error code otherwise
@@ -933,15 +1882,29 @@ static int halow_cmd(int argc, char **argv)
         printf("  halow on              - Start HaLow networking\n");
         printf("  halow off             - Stop HaLow networking\n");
         printf("  halow scan            - Scan for available networks\n");
-        printf("  halow connect <ssid> [password] - Connect to network\n");
+        printf("  halow scan list|clear - Show or clear cached scan results\n");
+        printf("  halow connect <ssid> [password] - Connect to network (retries with backoff)\n");
+        printf("  halow disconnect      - Leave the network and stop retrying\n");
         printf("  halow version         - Display version information\n");
         printf("  halow status          - Show current status\n");
         printf("  halow refresh         - Refresh network status (polls for IP updates)\n");
+        printf("  halow rx [reset]      - Show (or reset) RX pipeline statistics\n");
+        printf("  halow raw [send <mac|bcast> <text>|ping <mac|bcast> [n]|flush|reset] - Raw ethertype peer messaging\n");
+        printf("  halow stats [--interval <ms>] [--history [n]] - Link statistics time series\n");
+        printf("  halow power [active|ps|twt|measure [n]] - Power profile and wake latency\n");
+        printf("  halow roam [on|off|now|reset|threshold <dBm>|hysteresis <dB>] - Background-scan roaming\n");
+        printf("  halow spibench [--size b] [--count n] [--clock MHz] [--depth n] [--nodma] - SPI bus benchmark\n");
         return 0;
     }
 
     const char *subcmd = argv[1];
 
+    // HaLow is brought up by a boot task, the console can be ahead of it
+    if (!halow_initialized) {
+        printf(COLOR_YELLOW "HaLow not initialized yet (see 'boot_profile')\n" COLOR_RESET);
+        return 1;
+    }
+
     if (strcmp(subcmd, "on") == 0) {
         if (halow_start() == 0) {
             printf(COLOR_GREEN "HaLow started successfully\n" COLOR_RESET);
@@ -959,7 +1922,14 @@ static int halow_cmd(int argc, char **argv)
         }
     }
     else if (strcmp(subcmd, "scan") == 0) {
-        halow_scan();
+        if (argc >= 3 && strcmp(argv[2], "list") == 0) {
+            halow_scan_cache_print();
+        } else if (argc >= 3 && strcmp(argv[2], "clear") == 0) {
+            halow_scan_cache_clear();
+            printf(COLOR_GREEN "Scan cache cleared\n" COLOR_RESET);
+        } else {
+            halow_scan();
+        }
     }
     else if (strcmp(subcmd, "connect") == 0) {
         if (argc < 3) {
@@ -976,22 +1946,40 @@ static int halow_cmd(int argc, char **argv)
             return 1;
         }
     }
+    else if (strcmp(subcmd, "disconnect") == 0) {
+        if (halow_disconnect_async(NULL, NULL) != ESP_OK) {
+            printf(COLOR_RED "Failed to queue disconnect\n" COLOR_RESET);
+            return 1;
+        }
+        printf(COLOR_GREEN "Disconnecting, auto-reconnect stopped until the next connect\n" COLOR_RESET);
+    }
     else if (strcmp(subcmd, "version") == 0) {
         halow_version();
     }
     else if (strcmp(subcmd, "status") == 0) {
-        // Check connection status using event group (set by callbacks)
-        EventBits_t bits = xEventGroupGetBits(halow_event_group);
+        // Connection state comes from the state machine
+        char ssid[MMWLAN_SSID_MAXLEN + 1];
+        halow_conn_state_t state = halow_get_conn_state();
 
-        if (bits & HALOW_CONNECTED_BIT) {
+        if (halow_get_connected_ssid(ssid, sizeof(ssid))) {
             printf("Connected:   " COLOR_GREEN "Yes" COLOR_RESET "\n");
-
-            // Display connected network SSID
-            if (halow_connected_ssid[0] != '\0') {
-                printf("SSID:        %s\n", halow_connected_ssid);
-            } else {
-                printf("SSID:        " COLOR_YELLOW "Unknown" COLOR_RESET "\n");
+            printf("SSID:        %s\n", ssid);
+
+            // Channel details come from the scan cache, no extra scan needed
+            uint8_t bssid[MMWLAN_MAC_ADDR_LEN];
+            halow_scan_entry_t bss;
+            if (mmwlan_get_bssid(bssid) == MMWLAN_SUCCESS) {
+                printf("BSSID:       %02x:%02x:%02x:%02x:%02x:%02x\n",
+                       bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+                if (halow_scan_cache_find_bssid(bssid, &bss)) {
+                    printf("Channel:     %.3f MHz, %u MHz BW\n", bss.channel_freq_hz / 1e6, bss.op_bw_mhz);
+                }
             }
+            int32_t rssi = mmwlan_get_rssi();
+            if (rssi != INT32_MIN) {
+                printf("RSSI:        %ld dBm\n", (long)rssi);
+            }
+            printf("Power:       %s\n", halow_power_profile_name(halow_power_get_profile()));
 
             // Get and display IP address from network stack
             struct mmipal_ip_config ip_config;
@@ -1014,12 +2002,49 @@ static int halow_cmd(int argc, char **argv)
                 printf("Gateway:     N/A\n");
             }
         } else {
-            printf("Connected:   " COLOR_RED "No" COLOR_RESET "\n");
+            printf("Connected:   " COLOR_RED "No" COLOR_RESET " (%s)\n", halow_conn_state_name(state));
+            if (state == HALOW_CONN_BACKOFF) {
+                printf("Retry:       attempt %lu failed, next in up to %lu ms\n",
+                       (unsigned long)halow_conn.attempt, (unsigned long)halow_conn.last_backoff_ms);
+            }
             printf("SSID:        N/A\n");
             printf("IP Address:  N/A\n");
             printf("Netmask:     N/A\n");
             printf("Gateway:     N/A\n");
         }
+        printf("History:     %lu connects, %lu link losses, %lu attempts, %lu dropped reports\n",
+               (unsigned long)halow_conn.connects, (unsigned long)halow_conn.losses,
+               (unsigned long)halow_conn.total_attempts,
+               (unsigned long)__atomic_load_n(&halow_conn_dropped, __ATOMIC_RELAXED));
+    }
+    else if (strcmp(subcmd, "rx") == 0) {
+        if (argc >= 3 && strcmp(argv[2], "reset") == 0) {
+            halow_rx_reset_stats();
+            printf(COLOR_GREEN "RX pipeline statistics reset\n" COLOR_RESET);
+        } else {
+            halow_rx_print_stats();
+        }
+    }
+    else if (strcmp(subcmd, "raw") == 0) {
+        return halow_raw_cmd(argc - 1, argv + 1);
+    }
+    else if (strcmp(subcmd, "stats") == 0) {
+        return halow_stats_cmd(argc - 1, argv + 1);
+    }
+    else if (strcmp(subcmd, "power") == 0) {
+        return halow_power_cmd(argc - 1, argv + 1);
+    }
+    else if (strcmp(subcmd, "roam") == 0) {
+        return halow_roam_cmd(argc - 1, argv + 1);
+    }
+    else if (strcmp(subcmd, "spibench") == 0) {
+        // The transport owns the bus and the chip once the interface booted
+        if (halow_booted) {
+            printf(COLOR_YELLOW "HaLow interface is booted; build with CONFIG_HALOW_START_AT_BOOT=n and run "
+                   "before 'halow on'\n" COLOR_RESET);
+            return 1;
+        }
+        return halow_spibench_cmd(argc - 1, argv + 1);
     }
     else {
         printf(COLOR_RED "Unknown command: %s\n" COLOR_RESET, subcmd);
@@ -1036,7 +2061,7 @@ void register_halow_commands(void)
 {
     const esp_console_cmd_t halow_cmd_def = {
         .command = "halow",
-        .help = "HaLow WiFi control: 'halow on|off|scan|connect <ssid> [pwd]|version|status'",
+        .help = "HaLow WiFi control: 'halow on|off|scan [list|clear]|connect <ssid> [pwd]|disconnect|version|status|rx|raw|stats|power|roam'",
         .hint = NULL,
         .func = &halow_cmd,
     };
@@ -6,7 +6,9 @@
  * - Initialize HaLow hardware and software stack
  * - Start/stop HaLow networking
  * - Scan for available HaLow networks
- * - Connect to HaLow networks (open or secured)
+ * - Connect to HaLow networks (open or secured) through a state machine
+ *   task: async connect/disconnect with completion callbacks, exponential
+ *   backoff with jitter between attempts
  * - Display version information
  */
 
@@ -14,8 +16,29 @@
 #define TASK_HALOW_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "esp_err.h"
 
+// Connection state machine states
+typedef enum {
+    HALOW_CONN_IDLE,            // Not connected and not trying
+    HALOW_CONN_CONNECTING,      // Attempt in progress
+    HALOW_CONN_CONNECTED,       // Associated
+    HALOW_CONN_BACKOFF,         // Waiting before the next attempt
+} halow_conn_state_t;
+
+/**
+ * @brief Completion of an async connection request
+ * Called once from the state machine task, must not block.
+ * @param result ESP_OK when connected (or disconnected, for a disconnect),
+ *        ESP_ERR_TIMEOUT if CONFIG_HALOW_CONNECT_MAX_ATTEMPTS ran out,
+ *        ESP_ERR_NOT_FOUND if no network is saved (auto-connect),
+ *        ESP_ERR_INVALID_STATE if superseded by a newer request
+ * @param arg User argument
+ */
+typedef void (*halow_conn_cb_t)(esp_err_t result, void *arg);
+
 /**
  * @brief Initialize HaLow system
  * Sets up GPIO pins, event groups, semaphores, and initializes Morse Micro SDK
@@ -52,12 +75,56 @@ int halow_scan(void);
 
 /**
  * @brief Connect to a HaLow network
+ * Queues the request and returns, same as halow_connect_async() without callback.
  * @param ssid Network SSID to connect to
  * @param password Password (optional for open networks)
- * @return 0 on success, error code otherwise
+ * @return 0 if queued, error code otherwise
  */
 int halow_connect(const char* ssid, const char* password);
 
+/**
+ * @brief Start connecting to a HaLow network without waiting
+ * Replaces any pending request. Failed attempts are retried with backoff;
+ * the credentials are saved once connected.
+ * @param ssid Network SSID
+ * @param password Password (NULL or empty for open networks)
+ * @param cb Completion callback (can be NULL)
+ * @param arg Callback argument
+ * @return ESP_OK if queued, ESP_ERR_INVALID_STATE if not started,
+ *         ESP_ERR_INVALID_ARG for a bad SSID/password, ESP_ERR_TIMEOUT if the queue is full
+ */
+esp_err_t halow_connect_async(const char *ssid, const char *password, halow_conn_cb_t cb, void *arg);
+
+/**
+ * @brief Leave the network and stop retrying, without waiting
+ * @param cb Completion callback (can be NULL)
+ * @param arg Callback argument
+ * @return ESP_OK if queued, error code otherwise
+ */
+esp_err_t halow_disconnect_async(halow_conn_cb_t cb, void *arg);
+
+/**
+ * @brief Leave the network and auto-connect to the saved one, without waiting
+ * For settings that only take effect in a new association. The link hint
+ * makes the reconnect a targeted one. IP, the RX pipeline and MQTT stay up.
+ * @return ESP_OK if queued, ESP_ERR_INVALID_STATE if not started,
+ *         ESP_ERR_NOT_FOUND if no network is saved
+ */
+esp_err_t halow_reassociate_async(void);
+
+/**
+ * @brief Get the connection state
+ * @return Current state
+ */
+halow_conn_state_t halow_get_conn_state(void);
+
+/**
+ * @brief Get a printable name of a connection state
+ * @param state State
+ * @return Constant string
+ */
+const char *halow_conn_state_name(halow_conn_state_t state);
+
 /**
  * @brief Display HaLow version information
  * Shows firmware, hardware, and chip information
@@ -65,6 +132,41 @@ int halow_connect(const char* ssid, const char* password);
  */
 int halow_version(void);
 
+/**
+ * @brief Scan while associated without printing, results go to the scan cache
+ * Never drops the link: if a targeted connect left the channel list
+ * restricted, only those channels are scanned.
+ * Must not be called from the connection state machine task.
+ * @param timeout_ms Maximum time to wait for the scan to complete
+ * @return ESP_OK when complete, ESP_ERR_INVALID_STATE if not started,
+ *         ESP_ERR_TIMEOUT if aborted, ESP_FAIL if the scan was refused
+ */
+esp_err_t halow_background_scan(uint32_t timeout_ms);
+
+/**
+ * @brief Get the SSID of the current association
+ * @param ssid Buffer for the SSID
+ * @param len Size of the buffer
+ * @return true if connected, false otherwise
+ */
+bool halow_get_connected_ssid(char *ssid, size_t len);
+
+/**
+ * @brief Hand the association over to another BSS of the same SSID
+ * Runs on the state machine task and blocks the caller until done.
+ * Uses the saved credentials and a channel list restricted to the target's
+ * channel. If the target does not associate within the timeout, reconnects
+ * to the previous BSS, and falls back to a full search if that fails too.
+ * @param bssid Target BSSID
+ * @param channel_freq_hz Target channel centre frequency (0 if unknown)
+ * @param bw_mhz Target channel bandwidth
+ * @param timeout_ms Association timeout per attempt
+ * @return ESP_OK when associated to the target, ESP_ERR_TIMEOUT when back on
+ *         the previous BSS, ESP_FAIL when a full search was started,
+ *         ESP_ERR_INVALID_STATE if not connected or credentials not saved
+ */
+esp_err_t halow_roam_to(const uint8_t *bssid, uint32_t channel_freq_hz, uint8_t bw_mhz, uint32_t timeout_ms);
+
 /**
  * @brief Check if HaLow is currently initialized
  * @return true if initialized, false otherwise
@@ -78,7 +180,9 @@ bool halow_is_initialized(void);
 bool halow_is_started(void);
 
 /**
- * @brief Save network configuration to certs partition
+ * @brief Save network configuration (config manager, committed after the commit delay)
+ * When connected, the current BSSID, channel and bandwidth are stored as well
+ * so the next auto-connect can try a targeted reconnect first.
  * @param ssid Network SSID
  * @param password Network password (can be NULL for open networks)
  * @return ESP_OK on success, error code otherwise
@@ -86,7 +190,7 @@ bool halow_is_started(void);
 esp_err_t halow_save_network_config(const char* ssid, const char* password);
 
 /**
- * @brief Load network configuration from certs partition
+ * @brief Load network configuration
  * @param ssid Buffer to store SSID (must be at least 32 bytes)
  * @param password Buffer to store password (must be at least 64 bytes)
  * @return true if config was loaded successfully, false otherwise
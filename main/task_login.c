@@ -11,6 +11,7 @@
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "task_login.h"
+#include "config_manager.h"
 
 // ANSI Color Codes
 #define COLOR_RESET     "\033[0m"
@@ -55,13 +56,13 @@ bool is_first_time_login(void)
     esp_err_t err;
     size_t required_size = 0;
     
-    // Try certs partition first
-    LOGIN_LOGD("is_first_time_login() - trying certs partition...");
-    err = nvs_open_from_partition("certs", CREDS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    LOGIN_LOGD("nvs_open_from_partition(certs) result: %s", esp_err_to_name(err));
+    // Try keys partition first
+    LOGIN_LOGD("is_first_time_login() - trying keys partition...");
+    err = config_keys_nvs_open(CREDS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    LOGIN_LOGD("config_keys_nvs_open() result: %s", esp_err_to_name(err));
     
     if (err != ESP_OK) {
-        LOGIN_LOGD("Certs partition not available, trying default NVS...");
+        LOGIN_LOGD("Keys partition not available, trying default NVS...");
         
         // Fallback to default NVS partition
         err = nvs_open(CREDS_NAMESPACE, NVS_READONLY, &nvs_handle);
@@ -103,13 +104,13 @@ esp_err_t store_credentials(const char* username, const char* password)
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Try to use certs partition first
-    LOGIN_LOGD("Trying to open certs partition for credential storage...");
-    err = nvs_open_from_partition("certs", CREDS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    LOGIN_LOGD("nvs_open_from_partition result: %s", esp_err_to_name(err));
+    // Try to use keys partition first
+    LOGIN_LOGD("Trying to open keys partition for credential storage...");
+    err = config_keys_nvs_open(CREDS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    LOGIN_LOGD("config_keys_nvs_open() result: %s", esp_err_to_name(err));
     
     if (err != ESP_OK) {
-        LOGIN_LOGD("Failed to open certs partition: %s, falling back to default NVS", esp_err_to_name(err));
+        LOGIN_LOGD("Failed to open keys partition: %s, falling back to default NVS", esp_err_to_name(err));
         
         // Fallback to default NVS partition
         err = nvs_open(CREDS_NAMESPACE, NVS_READWRITE, &nvs_handle);
@@ -166,7 +167,7 @@ bool verify_credentials(const char* username, const char* password)
     char stored_password[MAX_PASSWORD_LEN + 1] = {0};
     size_t required_size;
     
-    err = nvs_open_from_partition("certs", CREDS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    err = config_keys_nvs_open(CREDS_NAMESPACE, NVS_READONLY, &nvs_handle);
     if (err != ESP_OK) {
         // Fallback to default NVS partition
         err = nvs_open(CREDS_NAMESPACE, NVS_READONLY, &nvs_handle);
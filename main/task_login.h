@@ -4,7 +4,7 @@
  * 
  * Features:
  * - Username/Password authentication (max 16 chars each)
- * - First-time login creates credentials stored in certs partition
+ * - First-time login creates credentials stored in keys partition
  * - Hidden admin account (admin/12345678) 
  * - Prevents admin account registration by users
  * - Dynamic prompt based on logged-in user
@@ -21,20 +21,14 @@
 #define ADMIN_USERNAME      "admin"
 #define ADMIN_PASSWORD      "12345678"
 
-// Certs partition namespaces (3.375MB total)
+// Namespaces on the keys partition (see config_keys_nvs_open()). Certificates
+// are kept in the blob store instead (see blob_store.h).
 #define CREDS_NAMESPACE     "login_creds"    // User login credentials
-#define TLS_NAMESPACE       "tls_certs"      // Future: HaLow WiFi TLS certificates
-#define DEVICE_NAMESPACE    "device_certs"   // Future: Device identity certificates
 
 // Login credential keys
 #define USERNAME_KEY        "username"
 #define PASSWORD_KEY        "password"
 
-// Future TLS certificate keys (预留)
-#define TLS_CA_CERT_KEY     "ca_cert"        // CA certificate for HaLow
-#define TLS_CLIENT_CERT_KEY "client_cert"    // Client certificate
-#define TLS_CLIENT_KEY_KEY  "client_key"     // Client private key
-
 // Login states
 typedef enum {
     LOGIN_STATE_USERNAME,
@@ -72,7 +66,7 @@ bool is_first_time_login(void);
 login_state_t handle_login_input(const char* input, login_result_t* result);
 
 /**
- * @brief Store user credentials in NVS (certs partition)
+ * @brief Store user credentials in NVS (keys partition)
  * @param username Username to store
  * @param password Password to store
  * @return ESP_OK on success, error code otherwise
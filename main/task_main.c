@@ -1,6 +1,7 @@
 /* Halow RTOS System */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include "esp_system.h"
@@ -14,13 +15,25 @@
 #include "nvs_flash.h"
 #include "esp_task_wdt.h"
 #include "esp_partition.h"
+#include "esp_heap_caps.h"
 #include "esp_ota_ops.h"
+#include "esp_mac.h"
+#include "boot_profile.h"
+#include "config_manager.h"
 #include "task_login.h"
 #include "ota_test.h"
+#include "telemetry_log.h"
+#include "blob_store.h"
+#include "trace_buffer.h"
+#include "task_profiler.h"
+#include "async_log.h"
+#include "console_input.h"
 #include "task_gpio.h"
 #ifndef HALOW_DISABLED
 #include "task_halow.h"
 #include "task_tool.h"
+#include "task_mqtt.h"
+#include "ota_manager.h"
 #endif
 
 /*
@@ -44,6 +57,19 @@ static char current_prompt[32] = {0};
 static login_state_t current_state = LOGIN_STATE_USERNAME;
 static esp_task_wdt_user_handle_t login_wdt_handle = NULL;
 
+// Login input blocks on the console driver; wake only to feed the 30 s watchdog
+#define LOGIN_WDT_FEED_MS   10000
+
+#ifndef HALOW_DISABLED
+// HaLow bring-up runs on the other core so the login prompt is not held up by auto-connect
+#define HALOW_BOOT_TASK_STACK_SIZE  6144
+#define HALOW_BOOT_TASK_PRIORITY    5
+#define HALOW_BOOT_TASK_CORE        (CONFIG_HALOW_BOOT_TASK_CORE < 0 ? tskNO_AFFINITY : CONFIG_HALOW_BOOT_TASK_CORE)
+#endif
+
+// Commands run on the REPL task, keep it off the HaLow core by default
+#define CONSOLE_TASK_CORE           (CONFIG_CONSOLE_TASK_CORE < 0 ? tskNO_AFFINITY : CONFIG_CONSOLE_TASK_CORE)
+
 // ANSI Color Codes
 #define COLOR_RESET     "\033[0m"
 #define COLOR_BOLD      "\033[1m"
@@ -109,10 +135,69 @@ static int restart_cmd(int argc, char **argv)
     return 0;
 }
 
+// Heap regions shown by 'free'
+static const struct {
+    const char *name;
+    uint32_t caps;
+} mem_report_caps[] = {
+    { "internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT },
+    { "dma",      MALLOC_CAP_DMA },
+    { "psram",    MALLOC_CAP_SPIRAM },
+    { "iram",     MALLOC_CAP_IRAM_8BIT },
+};
+
+/**
+ * @brief Heap headroom as one JSON line for the benchmark suite
+ */
+static void free_mem_print_json(void)
+{
+    printf("{\"bench\":\"heap\",\"free\":%lu,\"min_free\":%lu,\"regions\":{",
+           (unsigned long)esp_get_free_heap_size(), (unsigned long)esp_get_minimum_free_heap_size());
+    bool first = true;
+    for (size_t i = 0; i < sizeof(mem_report_caps) / sizeof(mem_report_caps[0]); i++) {
+        size_t total = heap_caps_get_total_size(mem_report_caps[i].caps);
+        if (total == 0) {
+            continue;
+        }
+        multi_heap_info_t info;
+        heap_caps_get_info(&info, mem_report_caps[i].caps);
+        printf("%s\"%s\":{\"total\":%u,\"free\":%u,\"largest\":%u,\"min_free\":%u}",
+               first ? "" : ",", mem_report_caps[i].name, (unsigned)total, (unsigned)info.total_free_bytes,
+               (unsigned)info.largest_free_block, (unsigned)info.minimum_free_bytes);
+        first = false;
+    }
+    printf("}}\n");
+}
+
 static int free_mem_cmd(int argc, char **argv)
 {
+    if (argc >= 2 && strcmp(argv[1], "--json") == 0) {
+        free_mem_print_json();
+        return 0;
+    }
+
     printf("Free heap: %lu bytes\n", esp_get_free_heap_size());
     printf("Min free heap: %lu bytes\n", esp_get_minimum_free_heap_size());
+
+    // Fragmentation: share of free memory not usable for one allocation
+    printf(COLOR_CYAN "\nHeap by capability:\n" COLOR_RESET);
+    printf("  %-9s %8s %8s %8s %8s %6s %7s %7s\n",
+           "Region", "Total", "Free", "Largest", "MinFree", "Frag", "Allocs", "Frees");
+    for (size_t i = 0; i < sizeof(mem_report_caps) / sizeof(mem_report_caps[0]); i++) {
+        size_t total = heap_caps_get_total_size(mem_report_caps[i].caps);
+        if (total == 0) {
+            continue;
+        }
+        multi_heap_info_t info;
+        heap_caps_get_info(&info, mem_report_caps[i].caps);
+        unsigned frag = info.total_free_bytes ?
+                        (unsigned)(100 - (uint64_t)info.largest_free_block * 100 / info.total_free_bytes) : 0;
+        printf("  %-9s %8u %8u %8u %8u %s%5u%%" COLOR_RESET " %7u %7u\n", mem_report_caps[i].name,
+               (unsigned)total, (unsigned)info.total_free_bytes, (unsigned)info.largest_free_block,
+               (unsigned)info.minimum_free_bytes, frag >= 50 ? COLOR_YELLOW : "", frag,
+               (unsigned)info.allocated_blocks, (unsigned)info.free_blocks);
+    }
+    printf("  (Allocs/Frees: allocated and free block counts)\n");
     return 0;
 }
 
@@ -120,6 +205,27 @@ static int version_cmd(int argc, char **argv)
 {
     esp_chip_info_t chip_info;
     esp_chip_info(&chip_info);
+
+    // Identifies firmware and board for stored benchmark results
+    if (argc >= 2 && strcmp(argv[1], "--json") == 0) {
+        const esp_app_desc_t *app = esp_app_get_description();
+        const esp_partition_t *part = esp_ota_get_running_partition();
+        uint8_t mac[6] = {0};
+        esp_read_mac(mac, ESP_MAC_BASE);
+        printf("{\"bench\":\"info\",\"project\":\"%s\",\"fw\":\"%s\",\"idf\":\"%s\",\"built\":\"%s %s\","
+               "\"target\":\"%s\",\"rev\":%d,\"cores\":%d,\"mac\":\"%02x%02x%02x%02x%02x%02x\","
+               "\"partition\":\"%s\",\"halow\":%s}\n",
+               app->project_name, app->version, app->idf_ver, app->date, app->time,
+               CONFIG_IDF_TARGET, chip_info.revision, chip_info.cores,
+               mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], part ? part->label : "",
+#ifndef HALOW_DISABLED
+               "true"
+#else
+               "false"
+#endif
+               );
+        return 0;
+    }
     
     printf("\n" COLOR_CYAN COLOR_BOLD "=== HALOW RTOS SYSTEM INFORMATION ===" COLOR_RESET "\n\n");
     
@@ -183,6 +289,16 @@ static int uptime_cmd(int argc, char **argv)
     return 0;
 }
 
+static int boot_profile_cmd(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "--json") == 0) {
+        boot_profile_print_json();
+        return 0;
+    }
+    boot_profile_print();
+    return 0;
+}
+
 static void register_basic_commands(void)
 {
     const esp_console_cmd_t reboot_cmd_def = {
@@ -195,7 +311,7 @@ static void register_basic_commands(void)
 
     const esp_console_cmd_t free_cmd_def = {
         .command = "free",
-        .help = "Show free memory",
+        .help = "Show free memory, per-capability heap usage, and fragmentation",
         .hint = NULL,
         .func = &free_mem_cmd,
     };
@@ -216,6 +332,14 @@ static void register_basic_commands(void)
         .func = &uptime_cmd,
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&uptime_cmd_def));
+
+    const esp_console_cmd_t boot_profile_cmd_def = {
+        .command = "boot_profile",
+        .help = "Show boot stage timing: 'boot_profile [--json]'",
+        .hint = NULL,
+        .func = &boot_profile_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&boot_profile_cmd_def));
 }
 
 static int ota_info_cmd(int argc, char **argv)
@@ -264,6 +388,85 @@ static int ota_test_cmd(int argc, char **argv)
     return 0;
 }
 
+#ifndef HALOW_DISABLED
+static const char *ota_status_names[] = {
+    [OTA_STATUS_IDLE]        = "idle",
+    [OTA_STATUS_DOWNLOADING] = "downloading",
+    [OTA_STATUS_VERIFYING]   = "verifying",
+    [OTA_STATUS_INSTALLING]  = "installing",
+    [OTA_STATUS_COMPLETE]    = "complete (restart to boot new firmware)",
+    [OTA_STATUS_FAILED]      = "failed",
+    [OTA_STATUS_ROLLBACK]    = "rollback",
+};
+
+static int ota_update_cmd(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("Usage: ota_update <http://host[:port]/path> [sha256] [size]\n");
+        return 1;
+    }
+
+    ota_update_info_t info = {0};
+    if (strlen(argv[1]) >= sizeof(info.url)) {
+        printf("URL too long\n");
+        return 1;
+    }
+    strcpy(info.url, argv[1]);
+    if (argc > 2 && strcmp(argv[2], "-") != 0) {
+        strncpy(info.sha256, argv[2], sizeof(info.sha256) - 1);
+    }
+    if (argc > 3) {
+        info.file_size = strtoul(argv[3], NULL, 10);
+    }
+
+    esp_err_t err = ota_start_update(&info);
+    if (err != ESP_OK) {
+        printf("Failed to start update: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    printf("Update started, use 'ota_status' to follow progress\n");
+    return 0;
+}
+
+static int ota_status_cmd(int argc, char **argv)
+{
+    ota_transfer_stats_t stats;
+    ota_status_t status = ota_get_status();
+
+    ota_get_transfer_stats(&stats);
+    if (argc >= 2 && strcmp(argv[1], "--json") == 0) {
+        printf("{\"bench\":\"ota\",\"status\":\"%s\",\"progress\":%d,\"total\":%u,\"received\":%u,"
+               "\"written\":%u,\"image\":%u,\"package\":\"%s\",\"elapsed_ms\":%lu,\"kbps\":%.1f,"
+               "\"download_wait_ms\":%lu,\"writer_wait_ms\":%lu,\"retries\":%u}\n",
+               status == OTA_STATUS_COMPLETE ? "complete" : ota_status_names[status], ota_get_progress(),
+               (unsigned)stats.total_size, (unsigned)stats.bytes_received, (unsigned)stats.bytes_written,
+               (unsigned)stats.image_written, ota_decoder_type_name(stats.package_type),
+               (unsigned long)stats.elapsed_ms,
+               stats.elapsed_ms > 0 ? stats.bytes_written * 8.0 / stats.elapsed_ms : 0.0,
+               (unsigned long)stats.download_wait_ms, (unsigned long)stats.writer_wait_ms, stats.retries);
+        return 0;
+    }
+    printf("Status:     %s\n", ota_status_names[status]);
+    if (status == OTA_STATUS_IDLE) {
+        return 0;
+    }
+
+    printf("Progress:   %d%% (%u / %u bytes written)\n", ota_get_progress(),
+           (unsigned)stats.bytes_written, (unsigned)stats.total_size);
+    printf("Received:   %u bytes\n", (unsigned)stats.bytes_received);
+    printf("Package:    %s, %u image bytes flashed\n", ota_decoder_type_name(stats.package_type),
+           (unsigned)stats.image_written);
+    printf("Elapsed:    %.1f s", stats.elapsed_ms / 1000.0);
+    if (stats.elapsed_ms > 0) {
+        printf(" (%.1f KB/s)", stats.bytes_written / 1024.0 / (stats.elapsed_ms / 1000.0));
+    }
+    printf("\nWaits:      download %lu ms (flash bound), writer %lu ms (network bound)\n",
+           (unsigned long)stats.download_wait_ms, (unsigned long)stats.writer_wait_ms);
+    printf("Retries:    %u\n", stats.retries);
+    return 0;
+}
+#endif
+
 static void register_ota_commands(void)
 {
     const esp_console_cmd_t ota_info_cmd_def = {
@@ -305,6 +508,24 @@ static void register_ota_commands(void)
         .func = &ota_test_cmd,
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&ota_test_cmd_def));
+
+#ifndef HALOW_DISABLED
+    const esp_console_cmd_t ota_update_cmd_def = {
+        .command = "ota_update",
+        .help = "Download firmware over HTTP into the other partition: ota_update <url> [sha256|-] [size]",
+        .hint = NULL,
+        .func = &ota_update_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&ota_update_cmd_def));
+
+    const esp_console_cmd_t ota_status_cmd_def = {
+        .command = "ota_status",
+        .help = "Show progress and throughput of the current or last OTA update: 'ota_status [--json]'",
+        .hint = NULL,
+        .func = &ota_status_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&ota_status_cmd_def));
+#endif
 }
 
 /**
@@ -369,11 +590,13 @@ static void initialize_nvs(void)
         ESP_LOGW(TAG, "Config partition initialization failed, system may have limited functionality");
     }
     
-    // Initialize certs partition (required for login credentials)
-    // This stores user authentication data
-    esp_err_t certs_err = init_nvs_partition("certs", false);
-    if (certs_err != ESP_OK && certs_err != ESP_ERR_NOT_FOUND) {
-        ESP_LOGW(TAG, "Certs partition initialization failed, login system may fallback to default NVS");
+    // Initialize keys partition (required for login credentials)
+    // Small on purpose: only short keys live here, certificates go to the blob store.
+    // OTA updates keep the old partition table, which has "certs" instead.
+    const char *keys_label = config_keys_partition();
+    esp_err_t keys_err = init_nvs_partition(keys_label ? keys_label : KEYS_PARTITION, false);
+    if (keys_err != ESP_OK && keys_err != ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "Keys partition initialization failed, login system may fallback to default NVS");
     }
     
     // ESP_LOGI(TAG, "🎯 NVS partition initialization complete");
@@ -382,7 +605,7 @@ static void initialize_nvs(void)
     // ESP_LOGI(TAG, " Partition Status:");
     // ESP_LOGI(TAG, "   • Default NVS:  Ready");
     // ESP_LOGI(TAG, "   • Config: %s", (config_err == ESP_OK) ? " Ready" : " Not Available");
-    // ESP_LOGI(TAG, "   • Certs: %s", (certs_err == ESP_OK) ? " Ready" : " Not Available");
+    // ESP_LOGI(TAG, "   • Keys: %s", (keys_err == ESP_OK) ? " Ready" : " Not Available");
     
     // Note: bootloader partition is managed by ESP-IDF and doesn't need NVS initialization
     // The factory app partition is the currently running firmware
@@ -405,14 +628,26 @@ static void check_partition_availability(void)
         // ESP_LOGW(TAG, " Config partition unavailable - using default settings only");
     }
     
-    // Check if we can use certs partition for secure credentials
-    nvs_handle_t certs_handle;
-    err = nvs_open_from_partition("certs", "test", NVS_READWRITE, &certs_handle);
+    // Check if we can use keys partition for secure credentials
+    nvs_handle_t keys_handle;
+    err = config_keys_nvs_open("test", NVS_READWRITE, &keys_handle);
     if (err == ESP_OK) {
-        nvs_close(certs_handle);
-        // ESP_LOGI(TAG, " Certs partition available - secure login supported");
+        nvs_close(keys_handle);
+        // ESP_LOGI(TAG, " Keys partition available - secure login supported");
     } else {
-        // ESP_LOGW(TAG, " Certs partition unavailable - fallback to default NVS");
+        // ESP_LOGW(TAG, " Keys partition unavailable - fallback to default NVS");
+    }
+
+    // Raw flash ring for the telemetry log (older tables do not have it)
+    if (!esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, TELEMETRY_LOG_PARTITION)) {
+        ESP_LOGW(TAG, "⚠️ %s partition missing - telemetry log disabled", TELEMETRY_LOG_PARTITION);
+    }
+    if (!esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, BLOB_STORE_PARTITION)) {
+        ESP_LOGW(TAG, "⚠️ %s partition missing - certificate storage disabled", BLOB_STORE_PARTITION);
+    }
+    if (config_keys_partition() && strcmp(config_keys_partition(), LEGACY_CERTS_PARTITION) == 0) {
+        ESP_LOGW(TAG, "⚠️ Old partition table (%s instead of %s), flash partitions.csv over serial to switch",
+                 LEGACY_CERTS_PARTITION, KEYS_PARTITION);
     }
     
     // Check for OTA partitions availability
@@ -453,6 +688,9 @@ static void handle_login_process(void)
     };
     esp_task_wdt_init(&twdt_config);
     esp_task_wdt_add_user("main", &login_wdt_handle); // Add main task to watchdog
+
+    // Sleep on the driver RX buffer instead of polling stdin
+    console_input_begin();
     
     while (!is_logged_in) {
         // Feed the watchdog
@@ -461,14 +699,12 @@ static void handle_login_process(void)
         // Read input with timeout handling
         fflush(stdout);
         
-        // Use a non-blocking approach with short delays
         size_t input_pos = 0;
         memset(input_buffer, 0, sizeof(input_buffer));
         
         while (input_pos < sizeof(input_buffer) - 1) {
-            int c = getchar();
-            if (c == EOF) {
-                vTaskDelay(pdMS_TO_TICKS(10)); // Small delay
+            int c = console_input_getc(pdMS_TO_TICKS(LOGIN_WDT_FEED_MS));
+            if (c < 0) {
                 if (login_wdt_handle) esp_task_wdt_reset_user(login_wdt_handle); // Feed watchdog
                 continue;
             }
@@ -535,36 +771,122 @@ static void handle_login_process(void)
         
         fflush(stdout);
     }
+
+    // The REPL installs its own console driver
+    console_input_end();
+}
+
+#ifndef HALOW_DISABLED
+/**
+ * @brief HaLow boot stages: init, then start + auto-connect
+ */
+static void halow_boot_stages(void)
+{
+    boot_profile_begin(BOOT_STAGE_HALOW_INIT);
+    esp_err_t err = task_halow_init();
+    boot_profile_end(BOOT_STAGE_HALOW_INIT, err);
+
+#if CONFIG_HALOW_START_AT_BOOT
+    if (err == ESP_OK) {
+        // Auto-start HaLow networking (will attempt auto-connect if config exists)
+        boot_profile_begin(BOOT_STAGE_HALOW_START);
+        int ret = halow_start();
+        boot_profile_end(BOOT_STAGE_HALOW_START, ret == 0 ? ESP_OK : ESP_FAIL);
+    }
+#else
+    // Chip and SPI bus stay untouched until 'halow on'
+    ESP_LOGI(TAG, "HaLow interface not started at boot (CONFIG_HALOW_START_AT_BOOT), use 'halow on'");
+#endif
 }
 
+/**
+ * @brief HaLow boot task
+ * Runs concurrently with the login prompt; booting the chip takes a while. Auto-connect
+ * only queues a request for the HaLow connection task and does not wait.
+ */
+static void halow_boot_task(void *pvParameters)
+{
+    halow_boot_stages();
+    vTaskDelete(NULL);
+}
+#endif
+
 void app_main(void)
 {
     esp_console_repl_t *repl = NULL;
     esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
-    
+    esp_err_t err;
+
+    // Stage order: nvs -> partitions -> config -> login_init, gpio -> halow (own task) -> tools, mqtt -> login -> console
+    // Deferred log sink before any task that logs from a callback exists
+    if (async_log_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Deferred log task not started, logging stays synchronous");
+    }
+
+    boot_profile_begin(BOOT_STAGE_NVS);
     initialize_nvs();
+    boot_profile_end(BOOT_STAGE_NVS, ESP_OK);
+
+    boot_profile_begin(BOOT_STAGE_PARTITIONS);
     check_partition_availability();
-    login_init();
+    boot_profile_end(BOOT_STAGE_PARTITIONS, ESP_OK);
+
+    boot_profile_begin(BOOT_STAGE_CONFIG);
+    err = config_manager_init();
+    boot_profile_end(BOOT_STAGE_CONFIG, err);
+
+    boot_profile_begin(BOOT_STAGE_TLOG);
+    err = telemetry_log_init();
+    boot_profile_end(BOOT_STAGE_TLOG, err);
+
+    boot_profile_begin(BOOT_STAGE_BLOBS);
+    err = blob_store_init();
+    boot_profile_end(BOOT_STAGE_BLOBS, err);
+
+    boot_profile_begin(BOOT_STAGE_LOGIN_INIT);
+    err = login_init();
+    boot_profile_end(BOOT_STAGE_LOGIN_INIT, err);
     
     // Initialize GPIO system
-    task_gpio_init();
+    boot_profile_begin(BOOT_STAGE_GPIO);
+    err = task_gpio_init();
+    boot_profile_end(BOOT_STAGE_GPIO, err);
     
 #ifndef HALOW_DISABLED
-    // Initialize HaLow system
-    task_halow_init();
-
-    // Auto-start HaLow networking (will attempt auto-connect if config exists)
-    halow_start();
+    // HaLow init needs NVS and must follow GPIO init, everything after it is independent
+    if (xTaskCreatePinnedToCore(halow_boot_task, "halow_boot", HALOW_BOOT_TASK_STACK_SIZE, NULL,
+                                HALOW_BOOT_TASK_PRIORITY, NULL, HALOW_BOOT_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create HaLow boot task, starting HaLow inline");
+        halow_boot_stages();
+    }
 
     // Initialize network tools (ping, traceroute, etc.)
-    task_tool_init();
+    boot_profile_begin(BOOT_STAGE_TOOLS);
+    err = task_tool_init();
+    boot_profile_end(BOOT_STAGE_TOOLS, err);
+
+    // MQTT publisher; connects once the HaLow link is up if a broker is configured
+    boot_profile_begin(BOOT_STAGE_MQTT);
+    err = task_mqtt_init();
+    if (err == ESP_OK) {
+        mqtt_config_t mqtt_cfg;
+        if (config_load_mqtt(&mqtt_cfg) == ESP_OK && mqtt_cfg.broker_uri[0] != '\0') {
+            err = task_mqtt_start();
+        }
+    }
+    boot_profile_end(BOOT_STAGE_MQTT, err);
 #endif
 
 #ifdef CONFIG_SYSTEM_LOG_ENABLE
     ESP_LOGI(TAG, "Starting Halow RTOS System");
     ESP_LOGI(TAG, "Max command line length: %d", CONFIG_CONSOLE_MAX_COMMAND_LINE_LENGTH);
+#elif CONFIG_ASYNC_LOG_ENABLE
+    // Only warnings and errors while the login prompt is up, so boot chatter
+    // does not break into it; full logging comes back after login
+    esp_log_level_set("*", ESP_LOG_WARN);
+    vTaskDelay(pdMS_TO_TICKS(200));
 #else
-    // Disable all system logs for clean output
+    // Synchronous logging would hold WLAN callbacks on the UART, keep it off
     esp_log_level_set("*", ESP_LOG_NONE);
     
     // Small delay to let any remaining logs finish
@@ -572,26 +894,38 @@ void app_main(void)
 #endif
 
     // Handle login process first
+    boot_profile_begin(BOOT_STAGE_LOGIN_PROMPT);
     display_login_banner();
     handle_login_process();
+    boot_profile_end(BOOT_STAGE_LOGIN_PROMPT, ESP_OK);
 
-#ifndef CONFIG_SYSTEM_LOG_ENABLE
-    // Keep logs disabled for clean console experience
-    esp_log_level_set("*", ESP_LOG_NONE);
+#if !defined(CONFIG_SYSTEM_LOG_ENABLE) && CONFIG_ASYNC_LOG_ENABLE
+    // Deferred logging never blocks the callbacks, so diagnostics stay on
+    system_config_t system_cfg = { .log_level = ESP_LOG_INFO };
+    config_load_system(&system_cfg);    // Defaults if nothing is stored
+    esp_log_level_set("*", (esp_log_level_t)system_cfg.log_level);
 #endif
     
     // Set console prompt based on logged-in user
     repl_config.prompt = current_prompt;
     repl_config.max_cmdline_length = CONFIG_CONSOLE_MAX_COMMAND_LINE_LENGTH;
+    repl_config.task_core_id = CONSOLE_TASK_CORE;
 
     /* Register basic commands */
+    boot_profile_begin(BOOT_STAGE_CONSOLE);
     esp_console_register_help_command();
     register_basic_commands();
     register_ota_commands();
     register_gpio_commands();
+    register_telemetry_log_commands();
+    register_blob_store_commands();
+    register_trace_commands();
+    register_profiler_commands();
+    register_async_log_commands();
 #ifndef HALOW_DISABLED
     register_halow_commands();
     register_tool_commands();
+    register_mqtt_commands();
 #endif
 
 #if defined(CONFIG_ESP_CONSOLE_UART_DEFAULT) || defined(CONFIG_ESP_CONSOLE_UART_CUSTOM)
@@ -611,4 +945,5 @@ void app_main(void)
 #endif
 
     ESP_ERROR_CHECK(esp_console_start_repl(repl));
+    boot_profile_end(BOOT_STAGE_CONSOLE, ESP_OK);
 }
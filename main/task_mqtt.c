@@ -0,0 +1,961 @@
+/**
+ * @file task_mqtt.c
+ * @brief MQTT publisher implementation for Halow RTOS
+ *
+ * All messages go through one byte ring, whether the broker is reachable or
+ * not. Producers only copy into the ring under a mutex and never block on the
+ * network. The publisher task takes records from the tail, joins batchable
+ * neighbours for the same topic into a single PUBLISH and only removes them
+ * from the ring once esp-mqtt accepted the packet. While the link is down the
+ * ring simply fills up; on reconnect it is drained back to back.
+ *
+ * A tracked publish carries a callback and tag through the ring and the
+ * in-flight window, so its producer learns whether the broker acknowledged
+ * it, or whether it was dropped, expired or lost with the client.
+ *
+ * For mqtts:// brokers the CA certificate (and an optional client
+ * certificate and key) are memory-mapped from the blob store and handed to
+ * esp-mqtt in place. The mappings live as long as the client does.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "task_mqtt.h"
+#include "config_manager.h"
+#include "gpio_monitor.h"
+#include "trace_buffer.h"
+#include "blob_store.h"
+#include "mqtt_client.h"
+#include "mmipal.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_console.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "task_mqtt";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define MQTT_TASK_STACK_SIZE        4096
+#define MQTT_TASK_PRIORITY          4
+#define MQTT_IP_POLL_MS             500     // Waiting for DHCP after link up
+#define MQTT_RETRY_MS               1000    // Publish rejected by the client
+#define MQTT_RECONNECT_TIMEOUT_MS   2000
+#define MQTT_BASE_TOPIC_PREFIX      "halow/"
+#define MQTT_INFLIGHT_RESERVED      -1      // Window slot taken before publish() returned the id
+
+#define MQTT_RECORD_QOS1            0x01
+#define MQTT_RECORD_BATCH           0x02
+#define MQTT_RECORD_TRACKED         0x04    // Header followed by an mqtt_tracking_t
+
+// Ring record header, followed by topic_len topic bytes and payload_len payload bytes
+typedef struct __attribute__((packed)) {
+    uint16_t payload_len;
+    uint8_t topic_len;
+    uint8_t flags;
+} mqtt_record_t;
+
+// Delivery report target of a tracked publish
+typedef struct __attribute__((packed)) {
+    task_mqtt_delivery_cb_t cb;
+    uint32_t tag;
+} mqtt_tracking_t;
+
+// QoS1 publish awaiting its PUBACK
+typedef struct {
+    int msg_id;
+    mqtt_tracking_t tracking;   // cb is NULL for untracked publishes
+} mqtt_inflight_t;
+
+static uint8_t *mqtt_ring = NULL;
+static size_t mqtt_ring_size = 0;
+static size_t mqtt_ring_head = 0;       // Write position
+static size_t mqtt_ring_tail = 0;       // Oldest record
+static size_t mqtt_ring_used = 0;
+static uint16_t mqtt_ring_count = 0;
+static uint32_t mqtt_ring_removed = 0;  // Records ever removed from the tail (sent or dropped)
+static int mqtt_ring_sending = 0;       // Tail records being handed to esp-mqtt right now
+static int64_t mqtt_first_pending_us = 0;
+static bool mqtt_ring_psram = false;
+static SemaphoreHandle_t mqtt_ring_mutex = NULL;
+
+static mqtt_inflight_t mqtt_inflight[CONFIG_HALOW_MQTT_INFLIGHT_WINDOW];
+static int mqtt_inflight_count = 0;
+static int mqtt_inflight_early_id = 0;  // Ack that overtook its esp_mqtt_client_publish() return
+static int mqtt_stale_ids[CONFIG_HALOW_MQTT_INFLIGHT_WINDOW];   // Given up at disconnect, 0 = free
+static int mqtt_stale_next = 0;
+static portMUX_TYPE mqtt_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_mqtt_client_handle_t mqtt_client = NULL;
+static blob_store_map_t mqtt_tls_ca;
+static blob_store_map_t mqtt_tls_cert;
+static blob_store_map_t mqtt_tls_key;
+static TaskHandle_t mqtt_task_handle = NULL;
+static uint8_t *mqtt_batch_buf = NULL;
+static mqtt_config_t mqtt_cfg;
+static char mqtt_client_id[sizeof(mqtt_cfg.client_id)];
+static char mqtt_base_topic[sizeof(MQTT_BASE_TOPIC_PREFIX) + sizeof(mqtt_cfg.client_id)];
+
+static volatile bool mqtt_started = false;
+static volatile bool mqtt_reconfigure = false;
+static volatile bool mqtt_link_up = false;
+static volatile bool mqtt_connected = false;
+static bool mqtt_client_running = false;
+static bool mqtt_ever_connected = false;
+static bool mqtt_gpio_enabled = false;
+
+static task_mqtt_stats_t mqtt_stats;
+
+/**
+ * @brief Wake the publisher task
+ */
+static void mqtt_wake(void)
+{
+    if (mqtt_task_handle) {
+        xTaskNotifyGive(mqtt_task_handle);
+    }
+}
+
+/**
+ * @brief Copy bytes into the ring at the head (caller checked space)
+ */
+static void mqtt_ring_write(const void *src, size_t len)
+{
+    size_t first = mqtt_ring_size - mqtt_ring_head;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(mqtt_ring + mqtt_ring_head, src, first);
+    memcpy(mqtt_ring, (const uint8_t *)src + first, len - first);
+    mqtt_ring_head = (mqtt_ring_head + len) % mqtt_ring_size;
+    mqtt_ring_used += len;
+}
+
+/**
+ * @brief Copy bytes out of the ring starting at pos
+ * @return Position following the copied bytes
+ */
+static size_t mqtt_ring_read(size_t pos, void *dst, size_t len)
+{
+    size_t first = mqtt_ring_size - pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(dst, mqtt_ring + pos, first);
+    memcpy((uint8_t *)dst + first, mqtt_ring, len - first);
+    return (pos + len) % mqtt_ring_size;
+}
+
+/**
+ * @brief Remove the oldest record
+ * @param tracking Pointer to store the tracking of a tracked record, cb set to NULL otherwise (may be NULL)
+ */
+static void mqtt_ring_pop(mqtt_tracking_t *tracking)
+{
+    mqtt_record_t rec;
+    size_t pos = mqtt_ring_read(mqtt_ring_tail, &rec, sizeof(rec));
+
+    size_t size = sizeof(rec) + rec.topic_len + rec.payload_len;
+    if (rec.flags & MQTT_RECORD_TRACKED) {
+        size += sizeof(mqtt_tracking_t);
+    }
+    if (tracking) {
+        tracking->cb = NULL;
+        if (rec.flags & MQTT_RECORD_TRACKED) {
+            mqtt_ring_read(pos, tracking, sizeof(*tracking));
+        }
+    }
+    mqtt_ring_tail = (mqtt_ring_tail + size) % mqtt_ring_size;
+    mqtt_ring_used -= size;
+    mqtt_ring_count--;
+    mqtt_ring_removed++;
+}
+
+/**
+ * @brief Expand "~/" to the device base topic
+ * @return Topic length, -1 if it does not fit
+ */
+static int mqtt_expand_topic(const char *topic, char *out, size_t out_size)
+{
+    int len;
+    if (strncmp(topic, "~/", 2) == 0) {
+        len = snprintf(out, out_size, "%s/%s", mqtt_base_topic, topic + 2);
+    } else {
+        len = snprintf(out, out_size, "%s", topic);
+    }
+    return (len <= 0 || len >= (int)out_size || len > UINT8_MAX) ? -1 : len;
+}
+
+/**
+ * @brief Find a msg_id given up at the last disconnect (call with mqtt_lock held)
+ * @return Index in mqtt_stale_ids, -1 if not stale
+ */
+static int mqtt_stale_find(int msg_id)
+{
+    for (int i = 0; i < CONFIG_HALOW_MQTT_INFLIGHT_WINDOW; i++) {
+        if (mqtt_stale_ids[i] == msg_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Forget a QoS1 publish that was acknowledged or expired
+ * esp-mqtt can deliver the ack before esp_mqtt_client_publish() returned the
+ * id to us. While a slot is reserved, an unknown id is parked for
+ * mqtt_inflight_commit() instead of being lost, and taken as the reserved publish.
+ * @param msg_id Id from the PUBLISHED / DELETED event
+ * @param delivered Passed to the delivery callback of a tracked publish
+ * @return true if msg_id was in flight
+ */
+static bool mqtt_inflight_remove(int msg_id, bool delivered)
+{
+    mqtt_tracking_t tracking = { 0 };
+    int reserved = -1;
+    bool found = false;
+
+    portENTER_CRITICAL(&mqtt_lock);
+    int stale = msg_id > 0 ? mqtt_stale_find(msg_id) : -1;
+    if (stale >= 0) {
+        // Resent from the outbox of an earlier session, already reported as lost
+        mqtt_stale_ids[stale] = 0;
+        portEXIT_CRITICAL(&mqtt_lock);
+        return false;
+    }
+    for (int i = 0; i < mqtt_inflight_count; i++) {
+        if (mqtt_inflight[i].msg_id == msg_id) {
+            tracking = mqtt_inflight[i].tracking;
+            mqtt_inflight[i] = mqtt_inflight[--mqtt_inflight_count];
+            found = true;
+            break;
+        }
+        if (mqtt_inflight[i].msg_id == MQTT_INFLIGHT_RESERVED) {
+            reserved = i;
+        }
+    }
+    if (!found && reserved >= 0) {
+        // The slot is released by mqtt_inflight_commit(), the report goes out now
+        tracking = mqtt_inflight[reserved].tracking;
+        mqtt_inflight[reserved].tracking.cb = NULL;
+        mqtt_inflight_early_id = msg_id;
+        found = true;
+    }
+    portEXIT_CRITICAL(&mqtt_lock);
+
+    if (tracking.cb) {
+        tracking.cb(tracking.tag, delivered);
+    }
+    return found;
+}
+
+/**
+ * @brief Fill in the slot reserved by mqtt_send_batch()
+ * @param msg_id Id returned by esp_mqtt_client_publish(), negative to release the slot
+ */
+static void mqtt_inflight_commit(int msg_id)
+{
+    portENTER_CRITICAL(&mqtt_lock);
+    for (int i = 0; i < mqtt_inflight_count; i++) {
+        if (mqtt_inflight[i].msg_id == MQTT_INFLIGHT_RESERVED) {
+            if (msg_id < 0 || msg_id == mqtt_inflight_early_id) {
+                mqtt_inflight[i] = mqtt_inflight[--mqtt_inflight_count];
+            } else {
+                mqtt_inflight[i].msg_id = msg_id;
+            }
+            break;
+        }
+    }
+    // The id counter wrapped onto a stale id: acks now belong to the new publish
+    int stale = msg_id > 0 ? mqtt_stale_find(msg_id) : -1;
+    if (stale >= 0) {
+        mqtt_stale_ids[stale] = 0;
+    }
+    mqtt_inflight_early_id = 0;
+    portEXIT_CRITICAL(&mqtt_lock);
+}
+
+/**
+ * @brief Give up on the publishes in flight when their session ends
+ * Tracked publishes are reported as not delivered so their owner can send
+ * them again. esp-mqtt keeps its msg_id counter and outbox across reconnects
+ * and may still ack an old id later; those ids stay stale so such an ack is
+ * not taken for a new publish. A slot reserved by a publish in progress is
+ * left to mqtt_inflight_commit().
+ * @param client_gone The client was destroyed with its outbox, nothing old can be acked any more
+ */
+static void mqtt_inflight_reset(bool client_gone)
+{
+    mqtt_inflight_t lost[CONFIG_HALOW_MQTT_INFLIGHT_WINDOW];
+    int lost_count = 0;
+    int kept = 0;
+
+    portENTER_CRITICAL(&mqtt_lock);
+    if (client_gone) {
+        memset(mqtt_stale_ids, 0, sizeof(mqtt_stale_ids));
+    }
+    for (int i = 0; i < mqtt_inflight_count; i++) {
+        if (mqtt_inflight[i].msg_id == MQTT_INFLIGHT_RESERVED) {
+            mqtt_inflight[kept++] = mqtt_inflight[i];
+            continue;
+        }
+        if (!client_gone) {
+            // Oldest stale ids are overwritten first when the table is full
+            int slot = mqtt_stale_find(0);
+            if (slot < 0) {
+                slot = mqtt_stale_next;
+                mqtt_stale_next = (mqtt_stale_next + 1) % CONFIG_HALOW_MQTT_INFLIGHT_WINDOW;
+            }
+            mqtt_stale_ids[slot] = mqtt_inflight[i].msg_id;
+        }
+        lost[lost_count++] = mqtt_inflight[i];
+    }
+    mqtt_inflight_count = kept;
+    portEXIT_CRITICAL(&mqtt_lock);
+
+    for (int i = 0; i < lost_count; i++) {
+        if (lost[i].tracking.cb) {
+            lost[i].tracking.cb(lost[i].tracking.tag, false);
+        }
+    }
+}
+
+/**
+ * @brief esp-mqtt event handler (runs in the esp-mqtt task)
+ */
+static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    esp_mqtt_event_handle_t event = event_data;
+
+    switch ((esp_mqtt_event_id_t)event_id) {
+    case MQTT_EVENT_CONNECTED:
+        ESP_LOGI(TAG, "Connected to %s", mqtt_cfg.broker_uri);
+        if (mqtt_ever_connected) {
+            mqtt_stats.reconnects++;
+        }
+        mqtt_ever_connected = true;
+        mqtt_connected = true;
+        mqtt_wake();
+        break;
+
+    case MQTT_EVENT_DISCONNECTED:
+        ESP_LOGI(TAG, "Disconnected");
+        mqtt_connected = false;
+        mqtt_inflight_reset(false);
+        mqtt_wake();
+        break;
+
+    case MQTT_EVENT_PUBLISHED:
+        if (mqtt_inflight_remove(event->msg_id, true)) {
+            mqtt_stats.acked++;
+        }
+        mqtt_wake();
+        break;
+
+    case MQTT_EVENT_DELETED:
+        // Outbox gave up on a QoS1 publish (CONFIG_MQTT_OUTBOX_EXPIRED_TIMEOUT_MS)
+        if (mqtt_inflight_remove(event->msg_id, false)) {
+            mqtt_stats.expired++;
+        }
+        mqtt_wake();
+        break;
+
+    case MQTT_EVENT_ERROR:
+        ESP_LOGW(TAG, "MQTT error event");
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Check whether the HaLow interface has an address yet
+ */
+static bool mqtt_have_ip(void)
+{
+    struct mmipal_ip_config ip_config;
+
+    return mmipal_get_ip_config(&ip_config) == MMIPAL_SUCCESS &&
+           ip_config.ip_addr[0] != '\0' && strcmp(ip_config.ip_addr, "0.0.0.0") != 0;
+}
+
+/**
+ * @brief Release the TLS blobs mapped for the client
+ */
+static void mqtt_tls_unmap(void)
+{
+    blob_store_munmap(&mqtt_tls_ca);
+    blob_store_munmap(&mqtt_tls_cert);
+    blob_store_munmap(&mqtt_tls_key);
+}
+
+/**
+ * @brief Point the client config at TLS blobs mapped from the blob store
+ * Without a CA blob esp-tls refuses the server, so that is only a warning;
+ * the client certificate is used when both it and the key are stored.
+ */
+static void mqtt_tls_map(esp_mqtt_client_config_t *client_cfg)
+{
+    if (strncmp(mqtt_cfg.broker_uri, "mqtts://", 8) != 0 && strncmp(mqtt_cfg.broker_uri, "wss://", 6) != 0) {
+        return;
+    }
+
+    esp_err_t err = blob_store_mmap(BLOB_MQTT_CA_CERT, &mqtt_tls_ca);
+    if (err == ESP_OK) {
+        client_cfg->broker.verification.certificate = mqtt_tls_ca.data;
+        client_cfg->broker.verification.certificate_len = mqtt_tls_ca.size;
+    } else {
+        ESP_LOGW(TAG, "No '%s' blob for TLS broker (%s), store one with 'blob put %s'",
+                 BLOB_MQTT_CA_CERT, esp_err_to_name(err), BLOB_MQTT_CA_CERT);
+    }
+
+    if (blob_store_mmap(BLOB_MQTT_CLIENT_CERT, &mqtt_tls_cert) == ESP_OK &&
+        blob_store_mmap(BLOB_MQTT_CLIENT_KEY, &mqtt_tls_key) == ESP_OK) {
+        client_cfg->credentials.authentication.certificate = mqtt_tls_cert.data;
+        client_cfg->credentials.authentication.certificate_len = mqtt_tls_cert.size;
+        client_cfg->credentials.authentication.key = mqtt_tls_key.data;
+        client_cfg->credentials.authentication.key_len = mqtt_tls_key.size;
+    } else {
+        blob_store_munmap(&mqtt_tls_cert);
+    }
+}
+
+/**
+ * @brief Create the esp-mqtt client from mqtt_cfg
+ */
+static esp_err_t mqtt_client_create(void)
+{
+    esp_mqtt_client_config_t client_cfg = {
+        .broker.address.uri = mqtt_cfg.broker_uri,
+        .credentials.client_id = mqtt_client_id,
+        .session.keepalive = mqtt_cfg.keepalive,
+        .network.reconnect_timeout_ms = MQTT_RECONNECT_TIMEOUT_MS,
+        .buffer.size = CONFIG_HALOW_MQTT_BATCH_MAX_BYTES + TASK_MQTT_TOPIC_MAX_LEN + 16,
+    };
+
+    // A port in the URI wins over the stored default
+    const char *host = strstr(mqtt_cfg.broker_uri, "://");
+    if (mqtt_cfg.port > 0 && !strchr(host ? host + 3 : mqtt_cfg.broker_uri, ':')) {
+        client_cfg.broker.address.port = mqtt_cfg.port;
+    }
+    if (mqtt_cfg.username[0] != '\0') {
+        client_cfg.credentials.username = mqtt_cfg.username;
+        client_cfg.credentials.authentication.password = mqtt_cfg.password;
+    }
+    mqtt_tls_map(&client_cfg);
+
+    mqtt_client = esp_mqtt_client_init(&client_cfg);
+    if (!mqtt_client) {
+        ESP_LOGE(TAG, "Failed to create MQTT client for '%s'", mqtt_cfg.broker_uri);
+        mqtt_tls_unmap();
+        return ESP_FAIL;
+    }
+    esp_mqtt_client_register_event(mqtt_client, MQTT_EVENT_ANY, mqtt_event_handler, NULL);
+    return ESP_OK;
+}
+
+/**
+ * @brief Send the record(s) at the tail of the ring as one PUBLISH
+ * @return Number of records sent, 0 if nothing can be sent now, -1 on error
+ */
+static int mqtt_send_batch(void)
+{
+    char topic[TASK_MQTT_TOPIC_MAX_LEN + 1];
+    char next_topic[TASK_MQTT_TOPIC_MAX_LEN + 1];
+    mqtt_record_t rec;
+    mqtt_record_t next;
+
+    xSemaphoreTake(mqtt_ring_mutex, portMAX_DELAY);
+
+    if (mqtt_ring_count == 0) {
+        xSemaphoreGive(mqtt_ring_mutex);
+        return 0;
+    }
+
+    size_t pos = mqtt_ring_read(mqtt_ring_tail, &rec, sizeof(rec));
+    int qos = (rec.flags & MQTT_RECORD_QOS1) ? 1 : 0;
+    mqtt_tracking_t tracking = { 0 };
+    if (rec.flags & MQTT_RECORD_TRACKED) {
+        pos = mqtt_ring_read(pos, &tracking, sizeof(tracking));
+    }
+
+    // Reserve the window slot now, the ack may arrive before publish() returns
+    portENTER_CRITICAL(&mqtt_lock);
+    bool window_full = qos && mqtt_inflight_count >= CONFIG_HALOW_MQTT_INFLIGHT_WINDOW;
+    if (qos && !window_full) {
+        mqtt_inflight[mqtt_inflight_count].msg_id = MQTT_INFLIGHT_RESERVED;
+        mqtt_inflight[mqtt_inflight_count++].tracking = tracking;
+    }
+    portEXIT_CRITICAL(&mqtt_lock);
+    if (window_full) {
+        xSemaphoreGive(mqtt_ring_mutex);
+        return 0;
+    }
+
+    pos = mqtt_ring_read(pos, topic, rec.topic_len);
+    topic[rec.topic_len] = '\0';
+    pos = mqtt_ring_read(pos, mqtt_batch_buf, rec.payload_len);
+    size_t len = rec.payload_len;
+    int count = 1;
+
+    // Join following records for the same topic and QoS while they fit
+    while ((rec.flags & MQTT_RECORD_BATCH) && count < mqtt_ring_count) {
+        size_t next_pos = mqtt_ring_read(pos, &next, sizeof(next));
+        if (next.flags != rec.flags || next.topic_len != rec.topic_len ||
+            len + 1 + next.payload_len > CONFIG_HALOW_MQTT_BATCH_MAX_BYTES) {
+            break;
+        }
+        next_pos = mqtt_ring_read(next_pos, next_topic, next.topic_len);
+        if (memcmp(topic, next_topic, next.topic_len) != 0) {
+            break;
+        }
+        mqtt_batch_buf[len++] = '\n';
+        pos = mqtt_ring_read(next_pos, mqtt_batch_buf + len, next.payload_len);
+        len += next.payload_len;
+        count++;
+    }
+
+    uint32_t removed_before = mqtt_ring_removed;
+    mqtt_ring_sending = count;
+    xSemaphoreGive(mqtt_ring_mutex);
+
+    // Records stay in the ring until the client took the packet
+    TRACE_EVENT(TRACE_EV_MQTT_PUBLISH, len);
+    int msg_id = esp_mqtt_client_publish(mqtt_client, topic, (const char *)mqtt_batch_buf, len, qos, 0);
+    if (qos) {
+        mqtt_inflight_commit(msg_id);
+    }
+
+    // Producers may have dropped some of these as oldest while we were sending
+    xSemaphoreTake(mqtt_ring_mutex, portMAX_DELAY);
+    uint32_t dropped = mqtt_ring_removed - removed_before;
+    mqtt_ring_sending = 0;
+    if (msg_id < 0) {
+        xSemaphoreGive(mqtt_ring_mutex);
+        if (dropped > 0 && tracking.cb) {
+            tracking.cb(tracking.tag, false);   // Gone from the ring and never in flight
+        }
+        return -1;
+    }
+    for (int i = dropped; i < count; i++) {
+        mqtt_ring_pop(NULL);
+    }
+    if (mqtt_ring_count == 0) {
+        mqtt_first_pending_us = 0;
+    }
+    xSemaphoreGive(mqtt_ring_mutex);
+
+    mqtt_stats.published += count;
+    mqtt_stats.batches++;
+    return count;
+}
+
+/**
+ * @brief Publisher task: connection management and ring draining
+ */
+static void mqtt_task(void *pvParameters)
+{
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+
+        if (mqtt_reconfigure || (!mqtt_started && mqtt_client)) {
+            if (mqtt_client) {
+                esp_mqtt_client_stop(mqtt_client);
+                esp_mqtt_client_destroy(mqtt_client);
+                mqtt_client = NULL;
+                mqtt_tls_unmap();
+            }
+            mqtt_client_running = false;
+            mqtt_connected = false;
+            // Their outbox went with the client
+            mqtt_inflight_reset(true);
+            mqtt_reconfigure = false;
+        }
+
+        if (mqtt_started && mqtt_link_up && !mqtt_client_running) {
+            if (!mqtt_have_ip()) {
+                wait = pdMS_TO_TICKS(MQTT_IP_POLL_MS);
+            } else if (mqtt_client || mqtt_client_create() == ESP_OK) {
+                mqtt_client_running = esp_mqtt_client_start(mqtt_client) == ESP_OK;
+            }
+        } else if (mqtt_client_running && !mqtt_link_up) {
+            // No point in reconnect attempts without a link; the ring keeps filling
+            esp_mqtt_client_stop(mqtt_client);
+            mqtt_client_running = false;
+            mqtt_connected = false;
+            mqtt_inflight_reset(false);
+        }
+
+        if (mqtt_connected) {
+            xSemaphoreTake(mqtt_ring_mutex, portMAX_DELAY);
+            int64_t first = mqtt_first_pending_us;
+            size_t used = mqtt_ring_used;
+            xSemaphoreGive(mqtt_ring_mutex);
+
+            int64_t age_ms = first ? (esp_timer_get_time() - first) / 1000 : 0;
+
+            if (first && age_ms < CONFIG_HALOW_MQTT_BATCH_MS && used < CONFIG_HALOW_MQTT_BATCH_MAX_BYTES) {
+                // Give more messages a chance to join the batch
+                wait = pdMS_TO_TICKS(CONFIG_HALOW_MQTT_BATCH_MS - age_ms);
+                if (wait == 0) {
+                    wait = 1;
+                }
+            } else if (first) {
+                int sent = 0;
+                while (mqtt_connected && (sent = mqtt_send_batch()) > 0) {
+                }
+                if (sent < 0) {
+                    wait = pdMS_TO_TICKS(MQTT_RETRY_MS);
+                }
+                // sent == 0: empty, or window full until the next PUBACK wakes us
+            }
+        }
+
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+/**
+ * @brief Queue GPIO edges as batched telemetry
+ */
+static void mqtt_gpio_event_cb(const gpio_monitor_event_t *event, void *arg)
+{
+    char payload[96];
+    int len = snprintf(payload, sizeof(payload),
+                       "{\"pin\":%u,\"level\":%d,\"ts\":%lld,\"count\":%lu,\"hz\":%.2f}",
+                       event->pin, event->level, (long long)event->timestamp_us,
+                       (unsigned long)event->count, event->frequency_hz);
+    task_mqtt_publish("~/gpio", payload, len, CONFIG_HALOW_MQTT_TELEMETRY_QOS, true);
+}
+
+/**
+ * @brief Initialize the publisher
+ */
+esp_err_t task_mqtt_init(void)
+{
+    if (mqtt_task_handle) {
+        return ESP_OK;
+    }
+
+    config_load_mqtt(&mqtt_cfg);
+
+    if (mqtt_cfg.client_id[0] != '\0') {
+        strcpy(mqtt_client_id, mqtt_cfg.client_id);
+    } else {
+        uint8_t mac[6] = {0};
+        esp_read_mac(mac, ESP_MAC_WIFI_STA);
+        snprintf(mqtt_client_id, sizeof(mqtt_client_id), "halow-%02x%02x%02x", mac[3], mac[4], mac[5]);
+    }
+    snprintf(mqtt_base_topic, sizeof(mqtt_base_topic), MQTT_BASE_TOPIC_PREFIX "%s", mqtt_client_id);
+
+    // PSRAM if fitted, the ring is only touched by memcpy
+    mqtt_ring_size = CONFIG_HALOW_MQTT_QUEUE_KB * 1024;
+    mqtt_ring = heap_caps_malloc(mqtt_ring_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    mqtt_ring_psram = mqtt_ring != NULL;
+    if (!mqtt_ring) {
+        mqtt_ring = heap_caps_malloc(mqtt_ring_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    mqtt_batch_buf = malloc(CONFIG_HALOW_MQTT_BATCH_MAX_BYTES);
+    mqtt_ring_mutex = xSemaphoreCreateMutex();
+
+    if (!mqtt_ring || !mqtt_batch_buf || !mqtt_ring_mutex) {
+        ESP_LOGE(TAG, "Failed to allocate MQTT queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(mqtt_task, "mqtt_pub", MQTT_TASK_STACK_SIZE, NULL, MQTT_TASK_PRIORITY,
+                    &mqtt_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create MQTT task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "MQTT publisher ready (%u KB %s queue, base topic %s)", CONFIG_HALOW_MQTT_QUEUE_KB,
+             mqtt_ring_psram ? "PSRAM" : "RAM", mqtt_base_topic);
+    return ESP_OK;
+}
+
+/**
+ * @brief Start the MQTT client
+ */
+esp_err_t task_mqtt_start(void)
+{
+    if (!mqtt_task_handle) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (mqtt_cfg.broker_uri[0] == '\0') {
+        return ESP_ERR_INVALID_STATE;
+    }
+    mqtt_started = true;
+    mqtt_wake();
+    return ESP_OK;
+}
+
+/**
+ * @brief Stop the MQTT client
+ */
+esp_err_t task_mqtt_stop(void)
+{
+    mqtt_started = false;
+    mqtt_wake();
+    return ESP_OK;
+}
+
+/**
+ * @brief Report a HaLow link state change
+ */
+void task_mqtt_notify_link(bool up)
+{
+    mqtt_link_up = up;
+    mqtt_wake();
+}
+
+/**
+ * @brief Append a record to the ring, dropping the oldest ones if needed
+ * @param tracking Delivery report target, NULL for an untracked record
+ */
+static esp_err_t mqtt_enqueue(const char *topic, const void *payload, size_t len, uint8_t flags,
+                              const mqtt_tracking_t *tracking)
+{
+    char full_topic[TASK_MQTT_TOPIC_MAX_LEN + 1];
+
+    if (!mqtt_ring_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!topic || (!payload && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t extra = tracking ? sizeof(*tracking) : 0;
+    int topic_len = mqtt_expand_topic(topic, full_topic, sizeof(full_topic));
+    if (topic_len < 0 || len > CONFIG_HALOW_MQTT_BATCH_MAX_BYTES ||
+        sizeof(mqtt_record_t) + extra + topic_len + len > mqtt_ring_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    mqtt_record_t rec = {
+        .payload_len = len,
+        .topic_len = topic_len,
+        .flags = flags | (tracking ? MQTT_RECORD_TRACKED : 0),
+    };
+    size_t size = sizeof(rec) + extra + topic_len + len;
+
+    xSemaphoreTake(mqtt_ring_mutex, portMAX_DELAY);
+    while (mqtt_ring_size - mqtt_ring_used < size) {
+        mqtt_tracking_t dropped;
+        mqtt_ring_pop(&dropped);
+        mqtt_stats.dropped++;
+        if (mqtt_ring_sending > 0) {
+            mqtt_ring_sending--;
+            dropped.cb = NULL;      // Being published, the in-flight window reports it
+        }
+        if (dropped.cb) {
+            dropped.cb(dropped.tag, false);
+        }
+    }
+    mqtt_ring_write(&rec, sizeof(rec));
+    if (tracking) {
+        mqtt_ring_write(tracking, sizeof(*tracking));
+    }
+    mqtt_ring_write(full_topic, topic_len);
+    mqtt_ring_write(payload, len);
+    mqtt_ring_count++;
+    mqtt_stats.queued++;
+    if (mqtt_first_pending_us == 0) {
+        mqtt_first_pending_us = esp_timer_get_time();
+    }
+    xSemaphoreGive(mqtt_ring_mutex);
+
+    mqtt_wake();
+    return ESP_OK;
+}
+
+/**
+ * @brief Queue a message for publishing
+ */
+esp_err_t task_mqtt_publish(const char *topic, const void *payload, size_t len, int qos, bool batch)
+{
+    if (qos < 0 || qos > 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return mqtt_enqueue(topic, payload, len, (qos ? MQTT_RECORD_QOS1 : 0) | (batch ? MQTT_RECORD_BATCH : 0), NULL);
+}
+
+/**
+ * @brief Queue a QoS1 message and report its delivery
+ */
+esp_err_t task_mqtt_publish_tracked(const char *topic, const void *payload, size_t len,
+                                    task_mqtt_delivery_cb_t cb, uint32_t tag)
+{
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mqtt_tracking_t tracking = { .cb = cb, .tag = tag };
+    return mqtt_enqueue(topic, payload, len, MQTT_RECORD_QOS1, &tracking);
+}
+
+/**
+ * @brief Get publisher statistics
+ */
+void task_mqtt_get_stats(task_mqtt_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    *stats = mqtt_stats;
+    stats->started = mqtt_started;
+    stats->link_up = mqtt_link_up;
+    stats->connected = mqtt_connected;
+    stats->ring_size = mqtt_ring_size;
+    stats->ring_psram = mqtt_ring_psram;
+
+    if (mqtt_ring_mutex) {
+        xSemaphoreTake(mqtt_ring_mutex, portMAX_DELAY);
+        stats->pending = mqtt_ring_count;
+        stats->ring_used = mqtt_ring_used;
+        xSemaphoreGive(mqtt_ring_mutex);
+    }
+
+    portENTER_CRITICAL(&mqtt_lock);
+    stats->inflight = mqtt_inflight_count;
+    portEXIT_CRITICAL(&mqtt_lock);
+}
+
+/**
+ * @brief Print publisher status
+ */
+static void mqtt_print_status(void)
+{
+    task_mqtt_stats_t stats;
+    task_mqtt_get_stats(&stats);
+
+    printf(COLOR_CYAN "MQTT publisher:\n" COLOR_RESET);
+    printf("  Broker:     %s\n", mqtt_cfg.broker_uri[0] ? mqtt_cfg.broker_uri : "(not configured)");
+    printf("  Client ID:  %s (base topic %s)\n", mqtt_client_id, mqtt_base_topic);
+    printf("  State:      %s%s\n" COLOR_RESET,
+           stats.connected ? COLOR_GREEN : COLOR_YELLOW,
+           stats.connected ? "connected" : !stats.started ? "stopped" :
+           !stats.link_up ? "waiting for HaLow link (queueing)" : "connecting");
+    printf("  Queue:      %u messages, %u / %u bytes (%s)\n", stats.pending,
+           (unsigned)stats.ring_used, (unsigned)stats.ring_size, stats.ring_psram ? "PSRAM" : "RAM");
+    printf("  Queued:     %lu, dropped %lu\n", (unsigned long)stats.queued, (unsigned long)stats.dropped);
+    printf("  Published:  %lu messages in %lu packets", (unsigned long)stats.published, (unsigned long)stats.batches);
+    if (stats.batches > 0) {
+        printf(" (%.1f per packet)", (double)stats.published / stats.batches);
+    }
+    printf("\n  QoS1:       %u / %d in flight, %lu acked, %lu expired\n", stats.inflight,
+           CONFIG_HALOW_MQTT_INFLIGHT_WINDOW, (unsigned long)stats.acked, (unsigned long)stats.expired);
+    printf("  Reconnects: %lu\n", (unsigned long)stats.reconnects);
+    printf("  GPIO telemetry: %s\n", mqtt_gpio_enabled ? "on" : "off");
+}
+
+static int mqtt_cmd(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+        printf("  mqtt status                            - Show publisher status\n");
+        printf("  mqtt config <uri> [client_id] [user] [password] - Set broker (saved)\n");
+        printf("  mqtt start | stop                      - Start or stop the client\n");
+        printf("  mqtt pub <topic> <message> [qos] [batch] - Queue a message (~/ = base topic)\n");
+        printf("  mqtt gpio on|off                       - Publish gpio_monitor edges to ~/gpio\n");
+        return 0;
+    }
+
+    const char *subcmd = argv[1];
+
+    if (!mqtt_task_handle) {
+        printf(COLOR_RED "MQTT publisher not initialized\n" COLOR_RESET);
+        return 1;
+    }
+
+    if (strcmp(subcmd, "status") == 0) {
+        mqtt_print_status();
+    } else if (strcmp(subcmd, "config") == 0) {
+        if (argc < 3) {
+            printf("Usage: mqtt config <uri> [client_id] [user] [password]\n");
+            return 1;
+        }
+        if (strlen(argv[2]) >= sizeof(mqtt_cfg.broker_uri) ||
+            (argc > 3 && strlen(argv[3]) >= sizeof(mqtt_cfg.client_id)) ||
+            (argc > 4 && strlen(argv[4]) >= sizeof(mqtt_cfg.username)) ||
+            (argc > 5 && strlen(argv[5]) >= sizeof(mqtt_cfg.password))) {
+            printf(COLOR_RED "Argument too long\n" COLOR_RESET);
+            return 1;
+        }
+        strcpy(mqtt_cfg.broker_uri, argv[2]);
+        strcpy(mqtt_cfg.client_id, argc > 3 ? argv[3] : "");
+        strcpy(mqtt_cfg.username, argc > 4 ? argv[4] : "");
+        strcpy(mqtt_cfg.password, argc > 5 ? argv[5] : "");
+        if (mqtt_cfg.client_id[0] != '\0') {
+            strcpy(mqtt_client_id, mqtt_cfg.client_id);
+            snprintf(mqtt_base_topic, sizeof(mqtt_base_topic), MQTT_BASE_TOPIC_PREFIX "%s", mqtt_client_id);
+        }
+        config_save_mqtt(&mqtt_cfg);
+        mqtt_reconfigure = true;
+        mqtt_wake();
+        printf(COLOR_GREEN "MQTT broker set to %s\n" COLOR_RESET, mqtt_cfg.broker_uri);
+    } else if (strcmp(subcmd, "start") == 0) {
+        if (task_mqtt_start() != ESP_OK) {
+            printf(COLOR_RED "No broker configured (use 'mqtt config')\n" COLOR_RESET);
+            return 1;
+        }
+        printf(COLOR_GREEN "MQTT client started\n" COLOR_RESET);
+    } else if (strcmp(subcmd, "stop") == 0) {
+        task_mqtt_stop();
+        printf(COLOR_GREEN "MQTT client stopped (queued messages kept)\n" COLOR_RESET);
+    } else if (strcmp(subcmd, "pub") == 0) {
+        if (argc < 4) {
+            printf("Usage: mqtt pub <topic> <message> [qos] [batch]\n");
+            return 1;
+        }
+        int qos = argc > 4 ? atoi(argv[4]) : 0;
+        bool batch = argc > 5 && strcmp(argv[5], "batch") == 0;
+        esp_err_t err = task_mqtt_publish(argv[2], argv[3], strlen(argv[3]), qos, batch);
+        if (err != ESP_OK) {
+            printf(COLOR_RED "Failed to queue message: %s\n" COLOR_RESET, esp_err_to_name(err));
+            return 1;
+        }
+    } else if (strcmp(subcmd, "gpio") == 0) {
+        if (argc < 3 || (strcmp(argv[2], "on") != 0 && strcmp(argv[2], "off") != 0)) {
+            printf("Usage: mqtt gpio on|off\n");
+            return 1;
+        }
+        mqtt_gpio_enabled = strcmp(argv[2], "on") == 0;
+        if (mqtt_gpio_enabled) {
+            gpio_monitor_add_event_cb(mqtt_gpio_event_cb, NULL);
+        } else {
+            gpio_monitor_remove_event_cb(mqtt_gpio_event_cb);
+        }
+        printf("GPIO telemetry %s (subscribe pins with 'gpio watch')\n", mqtt_gpio_enabled ? "on" : "off");
+    } else {
+        printf(COLOR_RED "Unknown subcommand: %s\n" COLOR_RESET, subcmd);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Register MQTT console commands
+ */
+void register_mqtt_commands(void)
+{
+    const esp_console_cmd_t mqtt_cmd_def = {
+        .command = "mqtt",
+        .help = "MQTT publisher: status, config, start, stop, pub, gpio",
+        .hint = NULL,
+        .func = &mqtt_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&mqtt_cmd_def));
+}
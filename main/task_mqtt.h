@@ -0,0 +1,120 @@
+/**
+ * @file task_mqtt.h
+ * @brief MQTT publisher for Halow RTOS
+ *
+ * Features:
+ * - esp-mqtt client over the HaLow (mmipal) lwIP interface
+ * - Small messages to the same topic coalesced into one batched publish
+ * - QoS1 publishes pipelined with a bounded in-flight window
+ * - Tracked publishes that report broker acknowledgement to their producer
+ * - Messages kept in a RAM/PSRAM ring while the HaLow link is down and
+ *   drained in bulk on reconnect (oldest dropped when full)
+ * - Optional GPIO edge telemetry from gpio_monitor
+ */
+
+#ifndef TASK_MQTT_H
+#define TASK_MQTT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define TASK_MQTT_TOPIC_MAX_LEN     96
+
+/**
+ * @brief Delivery report of a tracked publish
+ * Called exactly once per tracked message: from the esp-mqtt task on PUBACK
+ * (delivered) or outbox expiry, from a producer when the message is dropped
+ * from a full ring, or from the publisher task when the client is torn down.
+ * Must not block or queue MQTT messages.
+ * @param tag Tag given to task_mqtt_publish_tracked()
+ * @param delivered true if the broker acknowledged the message
+ */
+typedef void (*task_mqtt_delivery_cb_t)(uint32_t tag, bool delivered);
+
+// Publisher statistics
+typedef struct {
+    bool started;               // Client started by task_mqtt_start()
+    bool link_up;               // HaLow link state
+    bool connected;             // Broker session established
+    uint32_t queued;            // Messages accepted into the ring
+    uint32_t dropped;           // Messages dropped because the ring was full
+    uint32_t published;         // Messages sent (inside batches)
+    uint32_t batches;           // MQTT PUBLISH packets sent
+    uint32_t acked;             // QoS1 publishes acknowledged by the broker
+    uint32_t expired;           // QoS1 publishes given up by the client outbox
+    uint32_t reconnects;        // Broker connections after the first
+    uint16_t pending;           // Messages waiting in the ring
+    uint16_t inflight;          // QoS1 publishes awaiting PUBACK
+    size_t ring_used;           // Ring bytes in use
+    size_t ring_size;           // Ring capacity
+    bool ring_psram;            // Ring allocated in PSRAM
+} task_mqtt_stats_t;
+
+/**
+ * @brief Initialize the publisher (ring, task); does not connect
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t task_mqtt_init(void);
+
+/**
+ * @brief Start the MQTT client with the stored mqtt_config_t
+ * Connects as soon as the HaLow link is up and has an address.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no broker is configured
+ */
+esp_err_t task_mqtt_start(void);
+
+/**
+ * @brief Stop the MQTT client; queued messages are kept
+ * @return ESP_OK on success
+ */
+esp_err_t task_mqtt_stop(void);
+
+/**
+ * @brief Report a HaLow link state change
+ * Non-blocking, safe to call from the mmipal link status callback.
+ * @param up true if the link came up
+ */
+void task_mqtt_notify_link(bool up);
+
+/**
+ * @brief Queue a message for publishing
+ * Non-blocking. Batchable messages to the same topic and QoS are joined
+ * with '\n' into one publish of up to CONFIG_HALOW_MQTT_BATCH_MAX_BYTES.
+ * @param topic Topic, a leading "~/" is replaced by the device base topic (halow/<client_id>/)
+ * @param payload Message payload
+ * @param len Payload length
+ * @param qos 0 or 1
+ * @param batch Allow coalescing with neighbouring messages
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG / ESP_ERR_INVALID_SIZE for bad input,
+ *         ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t task_mqtt_publish(const char *topic, const void *payload, size_t len, int qos, bool batch);
+
+/**
+ * @brief Queue a QoS1 message whose delivery is reported to a callback
+ * The message is never batched. Use it when the producer must not forget its
+ * data before the broker has it.
+ * @param topic Topic, as task_mqtt_publish()
+ * @param payload Message payload
+ * @param len Payload length
+ * @param cb Delivery report callback
+ * @param tag Passed to cb
+ * @return As task_mqtt_publish()
+ */
+esp_err_t task_mqtt_publish_tracked(const char *topic, const void *payload, size_t len,
+                                    task_mqtt_delivery_cb_t cb, uint32_t tag);
+
+/**
+ * @brief Get publisher statistics
+ * @param stats Pointer to store statistics
+ */
+void task_mqtt_get_stats(task_mqtt_stats_t *stats);
+
+/**
+ * @brief Register MQTT console commands
+ */
+void register_mqtt_commands(void);
+
+#endif // TASK_MQTT_H
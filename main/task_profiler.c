@@ -0,0 +1,295 @@
+/**
+ * @file task_profiler.c
+ * @brief Task and CPU profiler implementation for Halow RTOS
+ *
+ * Two uxTaskGetSystemState() snapshots are taken around the interval and the
+ * run-time counter deltas are turned into shares of one core, so the tasks of
+ * a core plus its idle task add up to 100%. FreeRTOS keeps no switch counter,
+ * so a tick hook on each core counts how often the interrupted task differs
+ * from the previous tick. That is a lower bound: switches that happen and
+ * return within one tick are not seen.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "task_profiler.h"
+#include "esp_console.h"
+#include "esp_cpu.h"
+#include "esp_attr.h"
+#include "esp_freertos_hooks.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_BOLD      "\033[1m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define PROFILER_DEFAULT_INTERVAL_MS    1000
+#define PROFILER_MIN_INTERVAL_MS        100
+#define PROFILER_MAX_INTERVAL_MS        60000
+#define PROFILER_MAX_ITERATIONS         100
+#define PROFILER_TASK_SLACK             8       // Room for tasks created between count and snapshot
+#define PROFILER_STACK_LOW              512     // Bytes, printed red
+#define PROFILER_STACK_WARN             1024    // Bytes, printed yellow
+
+// Task snapshot
+typedef struct {
+    TaskStatus_t *tasks;
+    UBaseType_t count;
+    uint32_t switches[portNUM_PROCESSORS];
+} profiler_snapshot_t;
+
+// One line of the report
+typedef struct {
+    const TaskStatus_t *status;
+    uint32_t delta;
+} profiler_row_t;
+
+static volatile uint32_t profiler_switches[portNUM_PROCESSORS];
+static TaskHandle_t profiler_last_task[portNUM_PROCESSORS];
+
+/**
+ * @brief Tick hook, counts changes of the running task per core
+ */
+static void IRAM_ATTR profiler_tick_hook(void)
+{
+    int core = esp_cpu_get_core_id();
+    TaskHandle_t current = xTaskGetCurrentTaskHandleForCore(core);
+
+    if (current != profiler_last_task[core]) {
+        profiler_last_task[core] = current;
+        profiler_switches[core]++;
+    }
+}
+
+static const char *profiler_state_name(eTaskState state)
+{
+    switch (state) {
+        case eRunning:   return "Run";
+        case eReady:     return "Ready";
+        case eBlocked:   return "Block";
+        case eSuspended: return "Susp";
+        case eDeleted:   return "Del";
+        default:         return "?";
+    }
+}
+
+/**
+ * @brief Take a task snapshot
+ * @param snap Snapshot to fill (tasks array allocated here)
+ * @return ESP_OK on success, ESP_ERR_NO_MEM otherwise
+ */
+static esp_err_t profiler_snapshot(profiler_snapshot_t *snap)
+{
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + PROFILER_TASK_SLACK;
+
+    snap->tasks = malloc(capacity * sizeof(TaskStatus_t));
+    if (!snap->tasks) {
+        return ESP_ERR_NO_MEM;
+    }
+    snap->count = uxTaskGetSystemState(snap->tasks, capacity, NULL);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        snap->switches[core] = profiler_switches[core];
+    }
+    // 0 means the array was too small
+    return snap->count ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+/**
+ * @brief Run time of a task between two snapshots
+ */
+static uint32_t profiler_task_delta(const profiler_snapshot_t *before, const TaskStatus_t *task)
+{
+    for (UBaseType_t i = 0; i < before->count; i++) {
+        if (before->tasks[i].xHandle == task->xHandle &&
+            before->tasks[i].xTaskNumber == task->xTaskNumber) {
+            return task->ulRunTimeCounter - before->tasks[i].ulRunTimeCounter;
+        }
+    }
+    // Created during the interval
+    return task->ulRunTimeCounter;
+}
+
+/**
+ * @brief Print a report from two snapshots
+ */
+static void profiler_print(const profiler_snapshot_t *before, const profiler_snapshot_t *after,
+                           uint32_t interval_ms)
+{
+    profiler_row_t *rows = calloc(after->count, sizeof(profiler_row_t));
+    if (!rows) {
+        printf(COLOR_RED "Out of memory\n" COLOR_RESET);
+        return;
+    }
+
+    uint64_t total = 0;
+    uint32_t idle[portNUM_PROCESSORS] = {0};
+    for (UBaseType_t i = 0; i < after->count; i++) {
+        rows[i].status = &after->tasks[i];
+        rows[i].delta = profiler_task_delta(before, &after->tasks[i]);
+        total += rows[i].delta;
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            if (after->tasks[i].xHandle == xTaskGetIdleTaskHandleForCore(core)) {
+                idle[core] = rows[i].delta;
+            }
+        }
+    }
+
+    // Insertion sort by CPU time, the list is a few dozen entries
+    for (UBaseType_t i = 1; i < after->count; i++) {
+        profiler_row_t row = rows[i];
+        UBaseType_t j = i;
+        while (j > 0 && rows[j - 1].delta < row.delta) {
+            rows[j] = rows[j - 1];
+            j--;
+        }
+        rows[j] = row;
+    }
+
+    // Every core runs for the whole interval, idle task included
+    uint64_t per_core = total / portNUM_PROCESSORS;
+    if (per_core == 0) {
+        per_core = 1;
+    }
+
+    printf(COLOR_CYAN "Tasks: %u, interval %lu ms\n" COLOR_RESET, (unsigned)after->count,
+           (unsigned long)interval_ms);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint64_t busy = idle[core] < per_core ? per_core - idle[core] : 0;
+        uint32_t load = (uint32_t)(busy * 1000 / per_core);
+        uint32_t switches = after->switches[core] - before->switches[core];
+        printf("  Core %d: load %s%3lu.%lu%%" COLOR_RESET ", %lu switches/s (tick sampled)\n", core,
+               load >= 900 ? COLOR_RED : (load >= 600 ? COLOR_YELLOW : COLOR_GREEN),
+               (unsigned long)(load / 10), (unsigned long)(load % 10),
+               (unsigned long)(switches * 1000 / interval_ms));
+    }
+
+    printf(COLOR_BOLD "  %-16s %4s %4s %-5s %7s %10s\n" COLOR_RESET,
+           "Task", "Core", "Prio", "State", "CPU%", "Stack free");
+    for (UBaseType_t i = 0; i < after->count; i++) {
+        const TaskStatus_t *t = rows[i].status;
+        uint32_t cpu = (uint32_t)((uint64_t)rows[i].delta * 1000 / per_core);
+        char core[5];
+
+#if CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+        if (t->xCoreID == tskNO_AFFINITY) {
+            strcpy(core, "any");
+        } else {
+            snprintf(core, sizeof(core), "%d", (int)t->xCoreID);
+        }
+#else
+        strcpy(core, "-");
+#endif
+
+        uint32_t stack = t->usStackHighWaterMark;
+        printf("  %-16s %4s %4u %-5s %5lu.%lu %s%10lu" COLOR_RESET "\n",
+               t->pcTaskName, core, (unsigned)t->uxCurrentPriority, profiler_state_name(t->eCurrentState),
+               (unsigned long)(cpu / 10), (unsigned long)(cpu % 10),
+               stack < PROFILER_STACK_LOW ? COLOR_RED : (stack < PROFILER_STACK_WARN ? COLOR_YELLOW : ""),
+               (unsigned long)stack);
+    }
+
+    free(rows);
+}
+
+/**
+ * @brief Print one task/CPU report sampled over an interval
+ */
+esp_err_t task_profiler_report(uint32_t interval_ms)
+{
+#if !CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    profiler_snapshot_t before = {0};
+    profiler_snapshot_t after = {0};
+    esp_err_t err;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        profiler_last_task[core] = NULL;
+        esp_register_freertos_tick_hook_for_cpu(profiler_tick_hook, core);
+    }
+
+    err = profiler_snapshot(&before);
+    if (err == ESP_OK) {
+        vTaskDelay(pdMS_TO_TICKS(interval_ms));
+        err = profiler_snapshot(&after);
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        esp_deregister_freertos_tick_hook_for_cpu(profiler_tick_hook, core);
+    }
+
+    if (err == ESP_OK) {
+        profiler_print(&before, &after, interval_ms);
+    }
+
+    free(before.tasks);
+    free(after.tasks);
+    return err;
+#endif
+}
+
+static int top_cmd(int argc, char **argv)
+{
+    uint32_t interval_ms = PROFILER_DEFAULT_INTERVAL_MS;
+    int iterations = 1;
+
+    if (argc > 1 && (strcmp(argv[1], "help") == 0 || strcmp(argv[1], "-h") == 0)) {
+        printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+        printf("  top [interval_ms] [count]  - Per-task CPU %%, core load, stack and switch rate\n");
+        printf("                               (default %d ms, 1 report)\n", PROFILER_DEFAULT_INTERVAL_MS);
+        return 0;
+    }
+    if (argc > 1) {
+        int value = atoi(argv[1]);
+        if (value < PROFILER_MIN_INTERVAL_MS || value > PROFILER_MAX_INTERVAL_MS) {
+            printf(COLOR_RED "Interval must be %d-%d ms\n" COLOR_RESET,
+                   PROFILER_MIN_INTERVAL_MS, PROFILER_MAX_INTERVAL_MS);
+            return 1;
+        }
+        interval_ms = value;
+    }
+    if (argc > 2) {
+        iterations = atoi(argv[2]);
+        if (iterations < 1 || iterations > PROFILER_MAX_ITERATIONS) {
+            printf(COLOR_RED "Count must be 1-%d\n" COLOR_RESET, PROFILER_MAX_ITERATIONS);
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < iterations; i++) {
+        esp_err_t err = task_profiler_report(interval_ms);
+        if (err == ESP_ERR_NOT_SUPPORTED) {
+            printf(COLOR_YELLOW "Run-time stats are compiled out (enable CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)\n"
+                   COLOR_RESET);
+            return 1;
+        }
+        if (err != ESP_OK) {
+            printf(COLOR_RED "Task snapshot failed: %s\n" COLOR_RESET, esp_err_to_name(err));
+            return 1;
+        }
+        if (i + 1 < iterations) {
+            printf("\n");
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Register profiler console commands
+ */
+void register_profiler_commands(void)
+{
+    const esp_console_cmd_t top_cmd_def = {
+        .command = "top",
+        .help = "Show per-task CPU usage, core load and stack usage. Usage: top [interval_ms] [count]",
+        .hint = NULL,
+        .func = &top_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&top_cmd_def));
+}
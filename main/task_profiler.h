@@ -0,0 +1,33 @@
+/**
+ * @file task_profiler.h
+ * @brief Task and CPU profiler for Halow RTOS
+ *
+ * Features:
+ * - 'top' console command built on FreeRTOS run-time stats
+ * - Per-task CPU share over a sampling interval, priority, state and
+ *   core affinity
+ * - Per-core load derived from the idle tasks
+ * - Stack high-water marks with a low-stack warning
+ * - Per-core context switch rate, sampled from the tick hook
+ */
+
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Print one task/CPU report sampled over an interval
+ * @param interval_ms Sampling interval in milliseconds
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task snapshot failed,
+ *         ESP_ERR_NOT_SUPPORTED if run-time stats are not compiled in
+ */
+esp_err_t task_profiler_report(uint32_t interval_ms);
+
+/**
+ * @brief Register profiler console commands ('top')
+ */
+void register_profiler_commands(void);
+
+#endif // TASK_PROFILER_H
@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <string.h>
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "lwip/inet.h"
 #include "lwip/netdb.h"
 #include "lwip/sockets.h"
@@ -16,10 +17,13 @@
 #include "lwip/raw.h"
 
 #include "task_tool.h"
+#include "dns_cache.h"
+#include "tool_iperf.h"
 #include "esp_log.h"
 #include "esp_console.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "task_tool";
 
@@ -33,6 +37,15 @@ static const char *TAG = "task_tool";
 #define PING_DEFAULT_COUNT 4
 #define PING_DEFAULT_INTERVAL 1000
 #define PING_TIMEOUT_MS   3000
+#define PING_DEFAULT_PAYLOAD 56       // Standard ping data size
+#define PING_MAX_PAYLOAD  1400
+#define PING_SLOT_COUNT   64          // Maximum echoes in flight
+#define PING_MAX_SAMPLES  4096        // RTT samples kept for percentiles
+#define PING_RX_POLL_MS   50
+#define PING_MIN_INTERVAL_US 100      // esp_timer periodic floor with headroom
+#define PING_RX_TASK_STACK 4096
+#define PING_RX_TASK_PRIORITY 6
+#define PING_RX_TASK_CORE (CONFIG_TOOL_TASK_CORE < 0 ? tskNO_AFFINITY : CONFIG_TOOL_TASK_CORE)
 
 /**
  * @brief Calculate checksum for ICMP packet
@@ -54,7 +67,7 @@ static uint16_t icmp_checksum(uint16_t *data, int len)
     return ~sum;
 }
 
-// ICMP Echo Request/Reply structures
+// ICMP Echo Request/Reply header
 #pragma pack(1)
 typedef struct {
     uint8_t type;
@@ -62,10 +75,92 @@ typedef struct {
     uint16_t checksum;
     uint16_t id;
     uint16_t sequence;
-    uint8_t data[56]; // Standard ping data size
-} icmp_packet_t;
+} icmp_echo_hdr_t;
 #pragma pack()
 
+// RTT histogram bucket upper bounds in microseconds (last bucket is open-ended)
+static const uint32_t ping_hist_bounds_us[] = {
+    100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000,
+};
+#define PING_HIST_BUCKETS (sizeof(ping_hist_bounds_us) / sizeof(ping_hist_bounds_us[0]) + 1)
+
+// One outstanding echo request
+typedef struct {
+    int64_t send_us;
+    uint16_t seq;
+    bool pending;
+} ping_slot_t;
+
+// State shared between the sending task and the receive task
+typedef struct {
+    int sock;
+    uint16_t id;
+    uint32_t timeout_us;
+    bool quiet;                         // Flood mode: no per-reply lines
+    TaskHandle_t sender;                // Notified on replies in flood mode
+    volatile bool done;
+    SemaphoreHandle_t rx_exit;
+    portMUX_TYPE lock;
+    ping_slot_t slots[PING_SLOT_COUNT];
+    uint32_t received;
+    uint32_t late;
+    uint32_t duplicates;
+    volatile uint32_t in_flight;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t hist[PING_HIST_BUCKETS];
+    uint32_t *samples;
+    uint32_t n_samples;
+} ping_session_t;
+
+/**
+ * @brief Format a microsecond value as milliseconds with three decimals
+ * @param us Value in microseconds
+ * @param buf Output buffer
+ * @param len Output buffer length
+ * @return buf
+ */
+static const char *ping_fmt_ms(uint32_t us, char *buf, size_t len)
+{
+    snprintf(buf, len, "%lu.%03lu", (unsigned long)(us / 1000), (unsigned long)(us % 1000));
+    return buf;
+}
+
+/**
+ * @brief Resolve a host name or dotted address
+ * @param host IP address or hostname
+ * @param addr Pointer to store the resolved address (port left at 0)
+ * @param verbose Print resolution progress
+ * @return 0 on success, -1 on error
+ */
+static int task_tool_resolve(const char *host, struct sockaddr_in *addr, bool verbose)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+
+    // Try to parse as IP address first
+    if (inet_pton(AF_INET, host, &addr->sin_addr) == 1) {
+        return 0;
+    }
+
+    // Not a valid IP address, resolve through the shared cache
+    if (verbose) {
+        printf("Resolving hostname %s...\n", host);
+    }
+    esp_err_t err = dns_cache_resolve(host, &addr->sin_addr);
+    if (err != ESP_OK) {
+        printf(COLOR_RED "Error: Could not resolve hostname '%s' (%s)\n" COLOR_RESET, host,
+               err == ESP_ERR_NOT_FOUND ? "no such name" : esp_err_to_name(err));
+        return -1;
+    }
+
+    if (verbose) {
+        printf("Resolved to %s\n", inet_ntoa(addr->sin_addr));
+    }
+    return 0;
+}
+
 /**
  * @brief Alternative TCP-based connectivity test (fallback)
  * @param host IP address or hostname to test
@@ -77,33 +172,25 @@ static int task_tool_tcp_ping(const char* host, int count, int interval_ms)
 {
     printf("Using TCP connectivity test (ICMP not available):\n\n");
 
-    // Resolve hostname to IP
     struct sockaddr_in dest_addr;
-    memset(&dest_addr, 0, sizeof(dest_addr));
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_port = htons(80); // HTTP port for connectivity test
-
-    // Try to parse as IP address first
-    if (inet_pton(AF_INET, host, &dest_addr.sin_addr) != 1) {
-        // Not a valid IP address, try to resolve hostname
-        struct hostent *hostent = gethostbyname(host);
-        if (!hostent || !hostent->h_addr_list[0]) {
-            printf(COLOR_RED "Error: Could not resolve hostname '%s'\n" COLOR_RESET, host);
-            return -1;
-        }
-
-        memcpy(&dest_addr.sin_addr.s_addr, hostent->h_addr_list[0],
-               sizeof(dest_addr.sin_addr.s_addr));
+    if (task_tool_resolve(host, &dest_addr, false) != 0) {
+        return -1;
     }
+    dest_addr.sin_port = htons(80); // HTTP port for connectivity test
 
     int success_count = 0;
     int fail_count = 0;
     uint32_t min_rtt = UINT32_MAX;
     uint32_t max_rtt = 0;
     uint64_t total_rtt = 0;
+    char a[16], b[16], c[16];
+
+    if (interval_ms <= 0) {
+        interval_ms = PING_DEFAULT_INTERVAL;
+    }
 
     for (int i = 0; i < count; i++) {
-        TickType_t start_time = xTaskGetTickCount();
+        int64_t start_time = esp_timer_get_time();
 
         // Create TCP socket and try to connect (as connectivity test)
         int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
@@ -124,15 +211,14 @@ static int task_tool_tcp_ping(const char* host, int count, int interval_ms)
         // Try to connect
         int result = connect(sock, (struct sockaddr*)&dest_addr, sizeof(dest_addr));
 
-        TickType_t end_time = xTaskGetTickCount();
-        uint32_t rtt = (end_time - start_time) * portTICK_PERIOD_MS; // Convert to milliseconds
+        uint32_t rtt = (uint32_t)(esp_timer_get_time() - start_time);
 
         close(sock);
 
         if (result == 0) {
             success_count++;
-            printf(COLOR_GREEN "TCP Connection to %s: succeeded (time=%ldms)\n" COLOR_RESET,
-                   inet_ntoa(dest_addr.sin_addr), (long)rtt);
+            printf(COLOR_GREEN "TCP Connection to %s: succeeded (time=%s ms)\n" COLOR_RESET,
+                   inet_ntoa(dest_addr.sin_addr), ping_fmt_ms(rtt, a, sizeof(a)));
 
             min_rtt = (rtt < min_rtt) ? rtt : min_rtt;
             max_rtt = (rtt > max_rtt) ? rtt : max_rtt;
@@ -154,9 +240,10 @@ static int task_tool_tcp_ping(const char* host, int count, int interval_ms)
            count > 0 ? (fail_count * 100) / count : 0);
 
     if (success_count > 0) {
-        printf("Approximate connection times in milli-seconds:\n");
-        printf("    Minimum = %ldms, Maximum = %ldms, Average = %ldms\n",
-               (long)min_rtt, (long)max_rtt, (long)(total_rtt / success_count));
+        printf("Connection times in milli-seconds:\n");
+        printf("    Minimum = %s ms, Maximum = %s ms, Average = %s ms\n",
+               ping_fmt_ms(min_rtt, a, sizeof(a)), ping_fmt_ms(max_rtt, b, sizeof(b)),
+               ping_fmt_ms((uint32_t)(total_rtt / success_count), c, sizeof(c)));
         printf("Note: These results show TCP connectivity, not ICMP ping\n");
     }
 
@@ -164,196 +251,532 @@ static int task_tool_tcp_ping(const char* host, int count, int interval_ms)
 }
 
 /**
- * @brief Send a real ICMP ping to a remote host
- * @param host IP address or hostname to test
- * @param count Number of packets to send
- * @param interval_ms Interval between packets in milliseconds
+ * @brief Receive task: match echo replies to outstanding requests
+ * @param arg Ping session
+ */
+static void ping_rx_task(void *arg)
+{
+    ping_session_t *s = (ping_session_t *)arg;
+    uint8_t buffer[PING_MAX_PAYLOAD + 64]; // IP header + ICMP packet
+    char ms[16];
+
+    while (!s->done) {
+        struct sockaddr_in src_addr;
+        socklen_t src_len = sizeof(src_addr);
+        int received = recvfrom(s->sock, buffer, sizeof(buffer), 0,
+                                (struct sockaddr *)&src_addr, &src_len);
+        int64_t rx_us = esp_timer_get_time();
+        if (received <= 0) {
+            continue;
+        }
+
+        // Skip the IP header (IHL is in 32-bit words)
+        int ip_hdr_len = (buffer[0] & 0x0F) * 4;
+        if (received < ip_hdr_len + (int)sizeof(icmp_echo_hdr_t)) {
+            continue;
+        }
+        const icmp_echo_hdr_t *reply = (const icmp_echo_hdr_t *)(buffer + ip_hdr_len);
+        if (reply->type != 0 || reply->code != 0 || ntohs(reply->id) != s->id) {
+            continue; // Not an echo reply for this session
+        }
+
+        uint16_t seq = ntohs(reply->sequence);
+        ping_slot_t *slot = &s->slots[seq % PING_SLOT_COUNT];
+        uint32_t rtt = 0;
+        enum { PING_RX_OK, PING_RX_LATE, PING_RX_DUP } outcome;
+
+        taskENTER_CRITICAL(&s->lock);
+        if (!slot->pending || slot->seq != seq) {
+            s->duplicates++;
+            outcome = PING_RX_DUP;
+        } else {
+            rtt = (uint32_t)(rx_us - slot->send_us);
+            slot->pending = false;
+            s->in_flight--;
+            if (rtt > s->timeout_us) {
+                s->late++;
+                outcome = PING_RX_LATE;
+            } else {
+                s->received++;
+                s->sum_us += rtt;
+                s->min_us = rtt < s->min_us ? rtt : s->min_us;
+                s->max_us = rtt > s->max_us ? rtt : s->max_us;
+                size_t b = 0;
+                while (b < PING_HIST_BUCKETS - 1 && rtt >= ping_hist_bounds_us[b]) {
+                    b++;
+                }
+                s->hist[b]++;
+                if (s->samples && s->n_samples < PING_MAX_SAMPLES) {
+                    s->samples[s->n_samples++] = rtt;
+                }
+                outcome = PING_RX_OK;
+            }
+        }
+        taskEXIT_CRITICAL(&s->lock);
+
+        if (s->quiet) {
+            if (outcome != PING_RX_DUP) {
+                xTaskNotifyGive(s->sender);
+            }
+            if (outcome == PING_RX_OK) {
+                printf("\b \b");
+            }
+        } else if (outcome == PING_RX_OK) {
+            printf(COLOR_GREEN "Reply from %s: bytes=%d seq=%u time=%s ms\n" COLOR_RESET,
+                   inet_ntoa(src_addr.sin_addr), received - ip_hdr_len, seq,
+                   ping_fmt_ms(rtt, ms, sizeof(ms)));
+        } else if (outcome == PING_RX_LATE) {
+            printf(COLOR_YELLOW "Late reply seq=%u time=%s ms\n" COLOR_RESET,
+                   seq, ping_fmt_ms(rtt, ms, sizeof(ms)));
+        } else {
+            printf(COLOR_YELLOW "Duplicate or unknown reply seq=%u\n" COLOR_RESET, seq);
+        }
+    }
+
+    xSemaphoreGive(s->rx_exit);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Expire outstanding requests older than the timeout
+ * @param s Ping session
+ * @param now_us Current esp_timer time
+ * @param verbose Print a line per expired request
+ * @return Number of requests expired
+ */
+static int ping_expire(ping_session_t *s, int64_t now_us, bool verbose)
+{
+    int expired = 0;
+    for (int i = 0; i < PING_SLOT_COUNT; i++) {
+        ping_slot_t *slot = &s->slots[i];
+        bool hit = false;
+        uint16_t seq = 0;
+
+        taskENTER_CRITICAL(&s->lock);
+        if (slot->pending && now_us - slot->send_us > (int64_t)s->timeout_us) {
+            slot->pending = false;
+            s->in_flight--;
+            seq = slot->seq;
+            hit = true;
+        }
+        taskEXIT_CRITICAL(&s->lock);
+
+        if (hit) {
+            expired++;
+            if (verbose) {
+                printf(COLOR_RED "Request seq=%u: Request timed out\n" COLOR_RESET, seq);
+            }
+        }
+    }
+    return expired;
+}
+
+/**
+ * @brief esp_timer callback releasing the next echo request
+ * @param arg Sending task handle
+ */
+static void ping_interval_timer_cb(void *arg)
+{
+    xTaskNotifyGive((TaskHandle_t)arg);
+}
+
+static int ping_compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Sort the RTT samples and pick the median and 99th percentile
+ * @param s Ping session
+ * @param p50 Pointer to store the median in microseconds
+ * @param p99 Pointer to store the 99th percentile in microseconds
+ */
+static void ping_percentiles(ping_session_t *s, uint32_t *p50, uint32_t *p99)
+{
+    *p50 = 0;
+    *p99 = 0;
+    if (s->n_samples > 0) {
+        qsort(s->samples, s->n_samples, sizeof(uint32_t), ping_compare_u32);
+        *p50 = s->samples[(s->n_samples - 1) * 50 / 100];
+        *p99 = s->samples[(s->n_samples - 1) * 99 / 100];
+    }
+}
+
+/**
+ * @brief Print RTT summary, percentiles and histogram
+ * @param s Ping session
+ */
+static void ping_print_rtt_summary(ping_session_t *s)
+{
+    char a[16], b[16], c[16], d[16], e[16];
+    uint32_t p50;
+    uint32_t p99;
+
+    ping_percentiles(s, &p50, &p99);
+
+    printf("Round trip times in milli-seconds:\n");
+    printf("    min/avg/p50/p99/max = %s/%s/%s/%s/%s ms\n",
+           ping_fmt_ms(s->min_us, a, sizeof(a)),
+           ping_fmt_ms((uint32_t)(s->sum_us / s->received), b, sizeof(b)),
+           ping_fmt_ms(p50, c, sizeof(c)), ping_fmt_ms(p99, d, sizeof(d)),
+           ping_fmt_ms(s->max_us, e, sizeof(e)));
+    if (s->received > s->n_samples) {
+        printf(COLOR_YELLOW "    (percentiles over the first %lu replies)\n" COLOR_RESET,
+               (unsigned long)s->n_samples);
+    }
+
+    uint32_t peak = 0;
+    for (size_t i = 0; i < PING_HIST_BUCKETS; i++) {
+        peak = s->hist[i] > peak ? s->hist[i] : peak;
+    }
+
+    printf("RTT histogram:\n");
+    for (size_t i = 0; i < PING_HIST_BUCKETS; i++) {
+        if (s->hist[i] == 0) {
+            continue;
+        }
+        char label[24];
+        if (i < PING_HIST_BUCKETS - 1) {
+            snprintf(label, sizeof(label), "< %s ms", ping_fmt_ms(ping_hist_bounds_us[i], a, sizeof(a)));
+        } else {
+            snprintf(label, sizeof(label), ">= %s ms", ping_fmt_ms(ping_hist_bounds_us[i - 1], a, sizeof(a)));
+        }
+        int bar = (int)((uint64_t)s->hist[i] * 40 / peak);
+        printf("    %-14s %6lu " COLOR_CYAN, label, (unsigned long)s->hist[i]);
+        for (int j = 0; j < (bar > 0 ? bar : 1); j++) {
+            printf("#");
+        }
+        printf(COLOR_RESET "\n");
+    }
+}
+
+/**
+ * @brief Run a pipelined ICMP ping with microsecond timing
+ * @param host IP address or hostname to ping
+ * @param opts Ping options
  * @return 0 on success, error code otherwise
  */
-int task_tool_ping(const char* host, int count, int interval_ms)
+int task_tool_ping_ex(const char* host, const task_tool_ping_opts_t *opts)
 {
     if (!host || strlen(host) == 0) {
         printf(COLOR_RED "Error: Host address cannot be empty\n" COLOR_RESET);
         return -1;
     }
 
-    if (count <= 0) {
-        count = PING_DEFAULT_COUNT;
+    int count = (opts && opts->count > 0) ? opts->count : PING_DEFAULT_COUNT;
+    bool flood = opts && opts->flood;
+    int64_t interval_us = (opts && opts->interval_us > 0) ? opts->interval_us : PING_DEFAULT_INTERVAL * 1000;
+    int payload = (opts && opts->payload > 0) ? opts->payload : PING_DEFAULT_PAYLOAD;
+    int timeout_ms = (opts && opts->timeout_ms > 0) ? opts->timeout_ms : PING_TIMEOUT_MS;
+    if (payload > PING_MAX_PAYLOAD) {
+        payload = PING_MAX_PAYLOAD;
     }
-
-    if (interval_ms <= 0) {
-        interval_ms = PING_DEFAULT_INTERVAL;
+    if (interval_us < PING_MIN_INTERVAL_US) {
+        interval_us = PING_MIN_INTERVAL_US;
     }
+    int packet_len = sizeof(icmp_echo_hdr_t) + payload;
 
-    printf("Pinging %s with 64 bytes of data:\n", host);
+    if (flood) {
+        printf("Flood pinging %s with %d bytes of data:\n", host, packet_len);
+    } else {
+        printf("Pinging %s with %d bytes of data:\n", host, packet_len);
+    }
 
-    // Resolve hostname to IP
     struct sockaddr_in dest_addr;
-    memset(&dest_addr, 0, sizeof(dest_addr));
-    dest_addr.sin_family = AF_INET;
-
-    // Try to parse as IP address first
-    if (inet_pton(AF_INET, host, &dest_addr.sin_addr) != 1) {
-        // Not a valid IP address, try to resolve hostname
-        printf("Resolving hostname %s...\n", host);
-
-        struct hostent *hostent = gethostbyname(host);
-        if (!hostent || !hostent->h_addr_list[0]) {
-            printf(COLOR_RED "Error: Could not resolve hostname '%s'\n" COLOR_RESET, host);
-            return -1;
-        }
-
-        memcpy(&dest_addr.sin_addr.s_addr, hostent->h_addr_list[0],
-               sizeof(dest_addr.sin_addr.s_addr));
-        printf("Resolved to %s\n", inet_ntoa(dest_addr.sin_addr));
+    if (task_tool_resolve(host, &dest_addr, true) != 0) {
+        return -1;
     }
 
-    // Create raw ICMP socket (without ICMP headers in payload)
-    int sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
-    if (sock < 0) {
+    // Separate raw sockets for sending and receiving, each gets a copy of
+    // incoming ICMP so the receive task never shares a socket with the sender
+    int tx_sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+    int rx_sock = tx_sock >= 0 ? socket(AF_INET, SOCK_RAW, IPPROTO_ICMP) : -1;
+    if (tx_sock < 0 || rx_sock < 0) {
+        if (tx_sock >= 0) {
+            close(tx_sock);
+        }
         printf(COLOR_RED "Error: Could not create ICMP socket. Raw sockets not available.\n" COLOR_RESET);
         printf(COLOR_YELLOW "Note: ICMP ping requires raw socket support. Using alternative test.\n" COLOR_RESET);
 
         // Fall back to TCP connection test
-        return task_tool_tcp_ping(host, count, interval_ms);
+        return task_tool_tcp_ping(host, count, (int)(interval_us / 1000));
     }
 
-    // Set receive timeout
     struct timeval tv;
-    tv.tv_sec = PING_TIMEOUT_MS / 1000;
-    tv.tv_usec = (PING_TIMEOUT_MS % 1000) * 1000;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-    int success_count = 0;
-    int fail_count = 0;
-    uint32_t min_rtt = UINT32_MAX;
-    uint32_t max_rtt = 0;
-    uint64_t total_rtt = 0;
+    tv.tv_sec = 0;
+    tv.tv_usec = PING_RX_POLL_MS * 1000;
+    setsockopt(rx_sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    ping_session_t *s = calloc(1, sizeof(ping_session_t));
+    uint8_t *packet = malloc(packet_len);
+    if (!s || !packet) {
+        printf(COLOR_RED "Error: Out of memory\n" COLOR_RESET);
+        free(s);
+        free(packet);
+        close(tx_sock);
+        close(rx_sock);
+        return -1;
+    }
+    s->sock = rx_sock;
+    s->id = (uint16_t)(esp_random() & 0xFFFF);
+    s->timeout_us = (uint32_t)timeout_ms * 1000;
+    s->quiet = flood;
+    s->sender = xTaskGetCurrentTaskHandle();
+    s->min_us = UINT32_MAX;
+    portMUX_INITIALIZE(&s->lock);
+    s->samples = malloc(sizeof(uint32_t) * (count < PING_MAX_SAMPLES ? count : PING_MAX_SAMPLES));
+    s->rx_exit = xSemaphoreCreateBinary();
+
+    if (!s->rx_exit ||
+        xTaskCreatePinnedToCore(ping_rx_task, "ping_rx", PING_RX_TASK_STACK, s,
+                                PING_RX_TASK_PRIORITY, NULL, PING_RX_TASK_CORE) != pdPASS) {
+        printf(COLOR_RED "Error: Could not start ping receive task\n" COLOR_RESET);
+        if (s->rx_exit) {
+            vSemaphoreDelete(s->rx_exit);
+        }
+        free(s->samples);
+        free(s);
+        free(packet);
+        close(tx_sock);
+        close(rx_sock);
+        return -1;
+    }
 
-    uint16_t ping_id = (uint16_t)(esp_random() & 0xFFFF);
+    // Fill data with pattern
+    icmp_echo_hdr_t *request = (icmp_echo_hdr_t *)packet;
+    for (int i = 0; i < payload; i++) {
+        packet[sizeof(icmp_echo_hdr_t) + i] = 'A' + (i % 26);
+    }
 
-    for (int seq = 0; seq < count; seq++) {
-        // Prepare ICMP Echo Request packet
-        icmp_packet_t request;
-        memset(&request, 0, sizeof(request));
-        request.type = 8; // ICMP Echo Request
-        request.code = 0;
-        request.id = htons(ping_id);
-        request.sequence = htons(seq);
-        request.checksum = 0;
-
-        // Fill data with pattern
-        for (int i = 0; i < sizeof(request.data); i++) {
-            request.data[i] = 'A' + (i % 26);
+    // Requests are paced by a periodic esp_timer so intervals below one
+    // FreeRTOS tick are honoured without busy waiting
+    esp_timer_handle_t interval_timer = NULL;
+    if (!flood) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = ping_interval_timer_cb,
+            .arg = s->sender,
+            .name = "ping",
+        };
+        if (esp_timer_create(&timer_args, &interval_timer) != ESP_OK) {
+            interval_timer = NULL;
         }
+    }
 
-        // Calculate checksum
-        request.checksum = icmp_checksum((uint16_t*)&request, sizeof(request));
+    int sent_count = 0;
+    int send_errors = 0;
+    int timed_out = 0;
+    ulTaskNotifyTake(pdTRUE, 0);
+    int64_t start_us = esp_timer_get_time();
+    if (interval_timer) {
+        esp_timer_start_periodic(interval_timer, interval_us);
+    }
 
-        // Send the packet
-        TickType_t start_time = xTaskGetTickCount();
-        int sent = sendto(sock, &request, sizeof(request), 0,
-                         (struct sockaddr*)&dest_addr, sizeof(dest_addr));
+    for (int seq = 0; seq < count; seq++) {
+        ping_slot_t *slot = &s->slots[seq % PING_SLOT_COUNT];
 
-        if (sent < 0) {
-            printf(COLOR_RED "Request %d: Send failed\n" COLOR_RESET, seq + 1);
-            fail_count++;
-            if (seq < count - 1) {
-                vTaskDelay(pdMS_TO_TICKS(interval_ms));
+        if (flood) {
+            // Send on each reply, or after one tick if nothing came back
+            if (s->in_flight > 0) {
+                ulTaskNotifyTake(pdTRUE, 1);
+            }
+        } else if (seq > 0) {
+            if (interval_timer) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            } else {
+                vTaskDelay(pdMS_TO_TICKS(interval_us / 1000));
             }
-            continue;
         }
 
-        // Receive response with timeout
-        uint8_t buffer[256]; // Buffer for IP header + ICMP packet
-        struct sockaddr_in src_addr;
-        socklen_t src_len = sizeof(src_addr);
-
-        // Use select with timeout to avoid blocking indefinitely
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(sock, &readfds);
-
-        struct timeval timeout;
-        timeout.tv_sec = PING_TIMEOUT_MS / 1000;
-        timeout.tv_usec = (PING_TIMEOUT_MS % 1000) * 1000;
-
-        int select_result = select(sock + 1, &readfds, NULL, NULL, &timeout);
-        int received = 0;
-
-        if (select_result > 0 && FD_ISSET(sock, &readfds)) {
-            // Data is available
-            received = recvfrom(sock, buffer, sizeof(buffer), 0,
-                               (struct sockaddr*)&src_addr, &src_len);
-        } else if (select_result == 0) {
-            // Timeout
-            printf(COLOR_RED "Request %d: Request timed out\n" COLOR_RESET, seq + 1);
-            fail_count++;
-            if (seq < count - 1) {
-                vTaskDelay(pdMS_TO_TICKS(interval_ms));
+        // Never reuse a slot that still waits for its reply
+        while (slot->pending) {
+            timed_out += ping_expire(s, esp_timer_get_time(), !flood);
+            if (slot->pending) {
+                vTaskDelay(1);
             }
-            continue;
-        } else {
-            // Error
-            printf(COLOR_RED "Request %d: Select error\n" COLOR_RESET, seq + 1);
-            fail_count++;
-            if (seq < count - 1) {
-                vTaskDelay(pdMS_TO_TICKS(interval_ms));
+        }
+        timed_out += ping_expire(s, esp_timer_get_time(), !flood);
+
+        request->type = 8; // ICMP Echo Request
+        request->code = 0;
+        request->id = htons(s->id);
+        request->sequence = htons((uint16_t)seq);
+        request->checksum = 0;
+        request->checksum = icmp_checksum((uint16_t *)packet, packet_len);
+
+        taskENTER_CRITICAL(&s->lock);
+        slot->seq = (uint16_t)seq;
+        slot->send_us = esp_timer_get_time();
+        slot->pending = true;
+        s->in_flight++;
+        taskEXIT_CRITICAL(&s->lock);
+
+        int sent = sendto(tx_sock, packet, packet_len, 0,
+                          (struct sockaddr *)&dest_addr, sizeof(dest_addr));
+        if (sent < 0) {
+            taskENTER_CRITICAL(&s->lock);
+            slot->pending = false;
+            s->in_flight--;
+            taskEXIT_CRITICAL(&s->lock);
+            send_errors++;
+            if (!flood) {
+                printf(COLOR_RED "Request seq=%d: Send failed\n" COLOR_RESET, seq);
             }
             continue;
         }
 
-        TickType_t end_time = xTaskGetTickCount();
-        uint32_t rtt = (end_time - start_time) * portTICK_PERIOD_MS; // Convert to milliseconds
+        sent_count++;
+        if (flood) {
+            printf(".");
+        }
+    }
+
+    if (interval_timer) {
+        esp_timer_stop(interval_timer);
+        esp_timer_delete(interval_timer);
+    }
 
-        if (received < 0) {
-            printf(COLOR_RED "Request %d: Request timed out\n" COLOR_RESET, seq + 1);
-            fail_count++;
-        } else {
-            // Extract ICMP response from buffer (skip IP header)
-            icmp_packet_t *response = (icmp_packet_t *)(buffer + 20); // Skip 20-byte IP header
+    // Wait for outstanding replies
+    int64_t drain_deadline = esp_timer_get_time() + s->timeout_us;
+    while (s->in_flight > 0 && esp_timer_get_time() < drain_deadline) {
+        vTaskDelay(pdMS_TO_TICKS(PING_RX_POLL_MS));
+    }
+    timed_out += ping_expire(s, INT64_MAX, !flood);
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    s->done = true;
+    xSemaphoreTake(s->rx_exit, portMAX_DELAY);
+    vSemaphoreDelete(s->rx_exit);
+    close(tx_sock);
+    close(rx_sock);
+    free(packet);
+
+    if (flood) {
+        printf("\n");
+    }
 
-            if (response->type == 0 &&  // ICMP Echo Reply
-                response->code == 0 &&
-                ntohs(response->id) == ping_id &&
-                ntohs(response->sequence) == seq) {
+    // Print final statistics
+    uint32_t received = s->received;
+    printf("\nPing statistics for %s:\n", inet_ntoa(dest_addr.sin_addr));
+    printf("    Packets: Sent = %d, Received = %d, Lost = %d (%d%% loss), time %lldms\n",
+           sent_count, (int)received, sent_count - (int)received,
+           sent_count > 0 ? ((sent_count - (int)received) * 100) / sent_count : 0,
+           (long long)(elapsed_us / 1000));
+    if (send_errors > 0 || s->late > 0 || s->duplicates > 0) {
+        printf("    Send errors = %d, Late = %lu, Duplicates = %lu, Timed out = %d\n",
+               send_errors, (unsigned long)s->late, (unsigned long)s->duplicates, timed_out);
+    }
 
-                printf(COLOR_GREEN "Reply from %s: bytes=64 time=%ldms\n" COLOR_RESET,
-                       inet_ntoa(src_addr.sin_addr), rtt / 1000);
+    if (received > 0) {
+        ping_print_rtt_summary(s);
+    }
 
-                success_count++;
+    if (opts && opts->json) {
+        uint32_t p50;
+        uint32_t p99;
+        ping_percentiles(s, &p50, &p99);
+        printf("{\"bench\":\"ping\",\"host\":\"%s\",\"payload\":%d,\"flood\":%s,\"sent\":%d,\"received\":%lu,"
+               "\"loss_pct\":%.1f,\"min_us\":%lu,\"avg_us\":%lu,\"p50_us\":%lu,\"p99_us\":%lu,\"max_us\":%lu,"
+               "\"time_ms\":%lld}\n",
+               inet_ntoa(dest_addr.sin_addr), payload, flood ? "true" : "false", sent_count, (unsigned long)received,
+               sent_count > 0 ? (sent_count - (int)received) * 100.0 / sent_count : 0.0,
+               (unsigned long)(received ? s->min_us : 0),
+               (unsigned long)(received ? s->sum_us / received : 0),
+               (unsigned long)p50, (unsigned long)p99, (unsigned long)s->max_us,
+               (long long)(elapsed_us / 1000));
+    }
 
-                min_rtt = (rtt / 1000) < min_rtt ? (rtt / 1000) : min_rtt;
-                max_rtt = (rtt / 1000) > max_rtt ? (rtt / 1000) : max_rtt;
-                total_rtt += rtt / 1000;
-            } else {
-                printf(COLOR_RED "Request %d: Invalid ICMP response (type=%d, code=%d, id=%d, seq=%d)\n" COLOR_RESET,
-                       seq + 1, response->type, response->code,
-                       ntohs(response->id), ntohs(response->sequence));
-                fail_count++;
-            }
-        }
+    free(s->samples);
+    free(s);
 
-        if (seq < count - 1) {
-            vTaskDelay(pdMS_TO_TICKS(interval_ms));
-        }
+    return received > 0 ? 0 : -1;
+}
+
+/**
+ * @brief Send a real ICMP ping to a remote host
+ * @param host IP address or hostname to test
+ * @param count Number of packets to send
+ * @param interval_ms Interval between packets in milliseconds
+ * @return 0 on success, error code otherwise
+ */
+int task_tool_ping(const char* host, int count, int interval_ms)
+{
+    task_tool_ping_opts_t opts = {
+        .count = count,
+        .interval_us = interval_ms > 0 ? interval_ms * 1000 : 0,
+    };
+    return task_tool_ping_ex(host, &opts);
+}
+
+/**
+ * @brief Send one ICMP echo request and wait for its reply, without printing
+ */
+int task_tool_ping_once(const char* host, int payload, int timeout_ms, uint32_t *rtt_us)
+{
+    struct sockaddr_in addr;
+    uint8_t buffer[PING_MAX_PAYLOAD + 64];   // IP header + ICMP packet
+
+    if (!host || !rtt_us || task_tool_resolve(host, &addr, false) != 0) {
+        return -1;
+    }
+    if (payload <= 0) {
+        payload = PING_DEFAULT_PAYLOAD;
+    }
+    if (payload > PING_MAX_PAYLOAD) {
+        payload = PING_MAX_PAYLOAD;
     }
 
-    close(sock);
+    int sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+    if (sock < 0) {
+        return -1;
+    }
 
-    // Print final statistics
-    printf("\nPing statistics for %s:\n", inet_ntoa(dest_addr.sin_addr));
-    printf("    Packets: Sent = %d, Received = %d, Lost = %d (%d%% loss)\n",
-           count, success_count, count - success_count,
-           count > 0 ? ((count - success_count) * 100) / count : 0);
+    int packet_len = sizeof(icmp_echo_hdr_t) + payload;
+    icmp_echo_hdr_t *request = (icmp_echo_hdr_t *)buffer;
+    uint16_t id = (uint16_t)(esp_random() & 0xFFFF);
+    memset(request, 0, sizeof(*request));
+    request->type = 8;  // Echo request
+    request->id = htons(id);
+    request->sequence = htons(1);
+    for (int i = 0; i < payload; i++) {
+        buffer[sizeof(icmp_echo_hdr_t) + i] = 'A' + (i % 26);
+    }
+    request->checksum = icmp_checksum((uint16_t *)buffer, packet_len);
 
-    if (success_count > 0) {
-        printf("Approximate round trip times in milli-seconds:\n");
-        printf("    Minimum = %ldms, Maximum = %ldms, Average = %ldms\n",
-               (long)min_rtt, (long)max_rtt, (long)(total_rtt / success_count));
+    int64_t send_us = esp_timer_get_time();
+    int64_t deadline_us = send_us + (int64_t)timeout_ms * 1000;
+    int result = -1;
+
+    if (sendto(sock, buffer, packet_len, 0, (struct sockaddr *)&addr, sizeof(addr)) == packet_len) {
+        while (result != 0) {
+            int64_t left_us = deadline_us - esp_timer_get_time();
+            if (left_us <= 0) {
+                break;
+            }
+            struct timeval tv = { .tv_sec = left_us / 1000000, .tv_usec = left_us % 1000000 };
+            setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+            int received = recv(sock, buffer, sizeof(buffer), 0);
+            int64_t rx_us = esp_timer_get_time();
+            if (received <= 0) {
+                continue;
+            }
+
+            int ip_hdr_len = (buffer[0] & 0x0F) * 4;
+            if (received < ip_hdr_len + (int)sizeof(icmp_echo_hdr_t)) {
+                continue;
+            }
+            const icmp_echo_hdr_t *reply = (const icmp_echo_hdr_t *)(buffer + ip_hdr_len);
+            if (reply->type == 0 && reply->code == 0 && ntohs(reply->id) == id) {
+                *rtt_us = (uint32_t)(rx_us - send_us);
+                result = 0;
+            }
+        }
     }
 
-    return success_count > 0 ? 0 : -1;
+    close(sock);
+    return result;
 }
 
 /**
@@ -362,6 +785,12 @@ int task_tool_ping(const char* host, int count, int interval_ms)
  */
 esp_err_t task_tool_init(void)
 {
+    // Shared by the tools, iperf and the OTA client
+    esp_err_t err = dns_cache_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+
     ESP_LOGI(TAG, "Network tools initialized");
     return ESP_OK;
 }
@@ -372,23 +801,52 @@ esp_err_t task_tool_init(void)
 static int ping_cmd(int argc, char **argv)
 {
     if (argc < 2) {
-        printf(COLOR_CYAN "Usage: ping <host> [count] [interval_ms]\n" COLOR_RESET);
+        printf(COLOR_CYAN "Usage: ping <host> [count] [interval_ms] [-f] [-s bytes] [-W timeout_ms] [--json]\n" COLOR_RESET);
         printf("  host        - IP address or hostname to test\n");
-        printf("  count       - Number of connection tests to run (default: 4)\n");
-        printf("  interval_ms - Interval between tests in milliseconds (default: 1000)\n");
+        printf("  count       - Number of echo requests to send (default: 4)\n");
+        printf("  interval_ms - Interval between requests in milliseconds, fractions allowed (default: 1000)\n");
+        printf("  -f          - Flood: send on every reply, at least one request per tick\n");
+        printf("  -s bytes    - Echo payload size (default: %d)\n", PING_DEFAULT_PAYLOAD);
+        printf("  -W ms       - Reply timeout (default: %d)\n", PING_TIMEOUT_MS);
+        printf("  --json      - Also print the summary as one JSON line\n");
         printf(COLOR_YELLOW "\nNote: This ping implementation uses ICMP Echo packets to test\n" COLOR_RESET);
         printf(COLOR_YELLOW "      HaLow network connectivity at the IP layer.\n" COLOR_RESET);
-        printf(COLOR_YELLOW "      With timeout protection to prevent hanging.\n" COLOR_RESET);
+        printf(COLOR_YELLOW "      Up to %d requests are kept in flight, timed in microseconds.\n" COLOR_RESET,
+               PING_SLOT_COUNT);
         return 0;
     }
 
     const char *host = argv[1];
-    int count = (argc >= 3) ? atoi(argv[2]) : PING_DEFAULT_COUNT;
-    int interval_ms = (argc >= 4) ? atoi(argv[3]) : PING_DEFAULT_INTERVAL;
+    task_tool_ping_opts_t opts = {
+        .count = PING_DEFAULT_COUNT,
+        .interval_us = PING_DEFAULT_INTERVAL * 1000,
+    };
+    int positional = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0) {
+            opts.flood = true;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            opts.payload = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-W") == 0 && i + 1 < argc) {
+            opts.timeout_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0) {
+            opts.json = true;
+        } else if (positional == 0) {
+            opts.count = atoi(argv[i]);
+            positional++;
+        } else if (positional == 1) {
+            opts.interval_us = (int)(strtof(argv[i], NULL) * 1000.0f);
+            positional++;
+        } else {
+            printf(COLOR_RED "Unknown option: %s\n" COLOR_RESET, argv[i]);
+            return 1;
+        }
+    }
 
     printf(COLOR_GREEN "Testing HaLow network connectivity...\n\n" COLOR_RESET);
 
-    int result = task_tool_ping(host, count, interval_ms);
+    int result = task_tool_ping_ex(host, &opts);
 
     printf("\nConnectivity test %s\n",
            result == 0 ? COLOR_GREEN "PASSED" COLOR_RESET : COLOR_RED "FAILED" COLOR_RESET);
@@ -396,6 +854,107 @@ static int ping_cmd(int argc, char **argv)
     return result;
 }
 
+/**
+ * @brief Print iperf command usage
+ */
+static void iperf_print_usage(void)
+{
+    printf(COLOR_CYAN "Usage: iperf -c <host> | -s [options]\n" COLOR_RESET);
+    printf("       iperf stop\n");
+    printf("  -c <host>   - Run as client, sending to host\n");
+    printf("  -s          - Run as server until 'iperf stop'\n");
+    printf("  -u          - Use UDP instead of TCP (reports jitter and loss on server)\n");
+    printf("  -p <port>   - Port (default: %d)\n", IPERF_DEFAULT_PORT);
+    printf("  -l <bytes>  - Payload per write/datagram (default: TCP %d, UDP %d)\n",
+           IPERF_DEFAULT_TCP_LEN, IPERF_DEFAULT_UDP_LEN);
+    printf("  -w <bytes>  - Socket window (default: lwIP setting)\n");
+    printf("  -t <sec>    - Client test duration (default: %d)\n", IPERF_DEFAULT_DURATION_S);
+    printf("  -i <sec>    - Report interval (default: %d)\n", IPERF_DEFAULT_INTERVAL_S);
+    printf("  -b <kbps>   - UDP client target rate (default: %d)\n", IPERF_DEFAULT_UDP_KBPS);
+    printf("  -J, --json  - Also print each run summary as one JSON line\n");
+}
+
+/**
+ * @brief Console command handler for iperf command
+ */
+static int iperf_cmd(int argc, char **argv)
+{
+    if (argc < 2) {
+        iperf_print_usage();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "stop") == 0) {
+        if (tool_iperf_stop() != ESP_OK) {
+            printf(COLOR_YELLOW "No benchmark running\n" COLOR_RESET);
+            return 1;
+        }
+        printf("Stopping benchmark...\n");
+        return 0;
+    }
+
+    tool_iperf_config_t config;
+    memset(&config, 0, sizeof(config));
+    bool role_set = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *opt = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(opt, "-s") == 0) {
+            config.role = IPERF_ROLE_SERVER;
+            role_set = true;
+        } else if (strcmp(opt, "-u") == 0) {
+            config.proto = IPERF_PROTO_UDP;
+        } else if (strcmp(opt, "-J") == 0 || strcmp(opt, "--json") == 0) {
+            config.json = true;
+        } else if (strcmp(opt, "-c") == 0 && val) {
+            config.role = IPERF_ROLE_CLIENT;
+            strncpy(config.host, val, sizeof(config.host) - 1);
+            role_set = true;
+            i++;
+        } else if (strcmp(opt, "-p") == 0 && val) {
+            config.port = (uint16_t)atoi(val);
+            i++;
+        } else if (strcmp(opt, "-l") == 0 && val) {
+            config.len = (uint32_t)atoi(val);
+            i++;
+        } else if (strcmp(opt, "-w") == 0 && val) {
+            config.window = (uint32_t)atoi(val);
+            i++;
+        } else if (strcmp(opt, "-t") == 0 && val) {
+            config.duration_s = (uint32_t)atoi(val);
+            i++;
+        } else if (strcmp(opt, "-i") == 0 && val) {
+            config.interval_s = (uint32_t)atoi(val);
+            i++;
+        } else if (strcmp(opt, "-b") == 0 && val) {
+            config.bandwidth_kbps = (uint32_t)atoi(val);
+            i++;
+        } else {
+            printf(COLOR_RED "Unknown or incomplete option: %s\n" COLOR_RESET, opt);
+            iperf_print_usage();
+            return 1;
+        }
+    }
+
+    if (!role_set) {
+        printf(COLOR_RED "Error: Specify -c <host> or -s\n" COLOR_RESET);
+        return 1;
+    }
+
+    esp_err_t err = tool_iperf_start(&config);
+    if (err == ESP_ERR_INVALID_STATE) {
+        printf(COLOR_YELLOW "A benchmark is already running, use 'iperf stop'\n" COLOR_RESET);
+        return 1;
+    } else if (err != ESP_OK) {
+        printf(COLOR_RED "Failed to start benchmark: %s\n" COLOR_RESET, esp_err_to_name(err));
+        return 1;
+    }
+
+    return 0;
+}
+
 /**
  * @brief Register network tools console commands
  */
@@ -403,9 +962,19 @@ void register_tool_commands(void)
 {
     const esp_console_cmd_t ping_cmd_def = {
         .command = "ping",
-        .help = "Test HaLow network connectivity: 'ping <host> [count] [interval_ms]'",
+        .help = "Test HaLow network connectivity: 'ping <host> [count] [interval_ms] [-f] [-s bytes] [-W timeout_ms] [--json]'",
         .hint = NULL,
         .func = &ping_cmd,
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&ping_cmd_def));
+
+    const esp_console_cmd_t iperf_cmd_def = {
+        .command = "iperf",
+        .help = "Throughput benchmark: 'iperf -c <host> | -s [-u] [-p port] [-l len] [-w window] [-t sec] [-i sec] [-b kbps] [-J]', 'iperf stop'",
+        .hint = NULL,
+        .func = &iperf_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&iperf_cmd_def));
+
+    register_dns_commands();
 }
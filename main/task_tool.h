@@ -10,6 +10,8 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <esp_err.h>
 
 /**
@@ -23,6 +25,16 @@ esp_err_t task_tool_init(void);
  */
 void register_tool_commands(void);
 
+// Options for task_tool_ping_ex() (zero fields select defaults)
+typedef struct {
+    int count;          // Number of echo requests
+    int interval_us;    // Interval between requests, may be below one tick
+    bool flood;         // Send on every reply instead of at a fixed interval
+    int payload;        // Echo payload bytes
+    int timeout_ms;     // Reply timeout
+    bool json;          // Also print the summary as one JSON line
+} task_tool_ping_opts_t;
+
 /**
  * @brief Ping a remote host to test network connectivity
  * @param host IP address or hostname to ping
@@ -32,6 +44,26 @@ void register_tool_commands(void);
  */
 int task_tool_ping(const char* host, int count, int interval_ms);
 
+/**
+ * @brief Pipelined ping with microsecond RTTs, percentiles and histogram
+ * Keeps several echo requests in flight and matches replies by id/sequence
+ * from a receive task.
+ * @param host IP address or hostname to ping
+ * @param opts Ping options (NULL for defaults)
+ * @return 0 if at least one reply was received, error code otherwise
+ */
+int task_tool_ping_ex(const char* host, const task_tool_ping_opts_t *opts);
+
+/**
+ * @brief Send one ICMP echo request and wait for its reply, without printing
+ * @param host IP address or hostname to ping
+ * @param payload Echo payload bytes (0 for the default)
+ * @param timeout_ms Reply timeout
+ * @param rtt_us Pointer to store the round trip time in microseconds
+ * @return 0 if a reply arrived, -1 on timeout or error
+ */
+int task_tool_ping_once(const char* host, int payload, int timeout_ms, uint32_t *rtt_us);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,820 @@
+/**
+ * @file telemetry_log.c
+ * @brief Flash-backed store-and-forward telemetry log implementation for Halow RTOS
+ *
+ * Layout: every 4KB sector starts with a 64-byte header slot followed by 63
+ * record slots. Sectors are filled and erased strictly in ring order; the
+ * header's sector_seq tells the mount code which sector was written last.
+ * A slot whose seq is 0xFFFFFFFF is erased. A slot with a bad CRC (power
+ * lost mid-write) is skipped.
+ *
+ * Producers only fill a RAM stage. The log task programs the stage when it
+ * completes the current 256-byte flash page, or after
+ * CONFIG_TELEMETRY_LOG_FLUSH_MS. In HaLow builds it also uploads unsent
+ * records over MQTT, one tracked QoS1 publish at a time; the upload cursor
+ * only moves when the broker acknowledged the publish. A publish that was
+ * dropped, expired or lost with the client is sent again from the cursor.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "telemetry_log.h"
+#include "esp_log.h"
+#include "esp_crc.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "esp_console.h"
+#include "spi_flash_mmap.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#ifndef HALOW_DISABLED
+#include "task_mqtt.h"
+#endif
+
+static const char *TAG = "telemetry_log";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define TLOG_SECTOR_MAGIC           0x474F4C54  // "TLOG"
+#define TLOG_FORMAT_VERSION         1
+#define TLOG_SLOTS_PER_SECTOR       (SPI_FLASH_SEC_SIZE / TELEMETRY_LOG_RECORD_SIZE)
+#define TLOG_FLASH_PAGE_SIZE        256
+#define TLOG_SLOTS_PER_PAGE         (TLOG_FLASH_PAGE_SIZE / TELEMETRY_LOG_RECORD_SIZE)
+#define TLOG_ERASED_SEQ             0xFFFFFFFF
+
+#define TLOG_TASK_STACK_SIZE        4096
+#define TLOG_TASK_PRIORITY          3
+#define TLOG_NVS_NAMESPACE          "tlog"
+#define TLOG_NVS_SENT_KEY           "sent_seq"
+#define TLOG_SENT_SAVE_INTERVAL     16          // Acknowledged upload publishes between cursor saves
+#define TLOG_UPLOAD_TOPIC           "~/tlog"
+
+// Header slot at the start of every sector
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // TLOG_SECTOR_MAGIC
+    uint16_t version;           // TLOG_FORMAT_VERSION
+    uint16_t record_size;       // TELEMETRY_LOG_RECORD_SIZE
+    uint32_t sector_seq;        // Incremented each time a sector is started
+    uint32_t first_seq;         // Sequence number of the first record in the sector
+    uint8_t reserved[44];
+    uint32_t crc;
+} tlog_sector_header_t;
+
+_Static_assert(sizeof(telemetry_log_record_t) == TELEMETRY_LOG_RECORD_SIZE, "record size");
+_Static_assert(sizeof(tlog_sector_header_t) == TELEMETRY_LOG_RECORD_SIZE, "header size");
+
+static const esp_partition_t *tlog_part = NULL;
+static uint32_t tlog_sector_count = 0;
+static uint32_t *tlog_sector_first = NULL;  // first_seq per sector, 0 = not in use
+static uint32_t tlog_sector_seq = 0;        // sector_seq of the head sector
+static uint32_t tlog_head = 0;              // Sector being written
+static uint32_t tlog_head_slot = 1;         // Next free slot in the head sector
+static uint32_t tlog_tail = 0;              // Oldest sector
+static uint32_t tlog_flash_next_seq = 1;    // Seq following the newest record in flash
+static SemaphoreHandle_t tlog_flash_mutex = NULL;
+
+// RAM stage, swapped with tlog_write_buf by the writer
+static telemetry_log_record_t *tlog_stage = NULL;
+static telemetry_log_record_t *tlog_write_buf = NULL;
+static uint32_t tlog_stage_count = 0;
+static int64_t tlog_stage_first_us = 0;
+static uint32_t tlog_next_seq = 1;
+static SemaphoreHandle_t tlog_stage_mutex = NULL;
+
+static TaskHandle_t tlog_task_handle = NULL;
+static telemetry_log_stats_t tlog_stats;
+static uint32_t tlog_sent_seq = 0;         // Last record acknowledged by the broker, flash mutex after init
+
+#ifndef HALOW_DISABLED
+// Upload publish awaiting its delivery report
+typedef enum {
+    TLOG_UPLOAD_IDLE = 0,
+    TLOG_UPLOAD_WAITING,
+    TLOG_UPLOAD_ACKED,
+    TLOG_UPLOAD_FAILED,
+} tlog_upload_state_t;
+
+static tlog_upload_state_t tlog_upload_state = TLOG_UPLOAD_IDLE;
+static uint32_t tlog_upload_last_seq = 0;   // Last record in that publish
+static portMUX_TYPE tlog_upload_lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+/**
+ * @brief CRC of a record or header slot (all bytes but the trailing CRC)
+ */
+static uint32_t tlog_slot_crc(const void *slot)
+{
+    return esp_crc32_le(0, slot, TELEMETRY_LOG_RECORD_SIZE - sizeof(uint32_t));
+}
+
+/**
+ * @brief Erase a sector and write its header
+ */
+static esp_err_t tlog_start_sector(uint32_t sector, uint32_t first_seq)
+{
+    tlog_sector_header_t hdr = {
+        .magic = TLOG_SECTOR_MAGIC,
+        .version = TLOG_FORMAT_VERSION,
+        .record_size = TELEMETRY_LOG_RECORD_SIZE,
+        .sector_seq = tlog_sector_seq + 1,
+        .first_seq = first_seq,
+    };
+    memset(hdr.reserved, 0xFF, sizeof(hdr.reserved));
+    hdr.crc = tlog_slot_crc(&hdr);
+
+    esp_err_t err = esp_partition_erase_range(tlog_part, sector * SPI_FLASH_SEC_SIZE, SPI_FLASH_SEC_SIZE);
+    if (err == ESP_OK) {
+        err = esp_partition_write(tlog_part, sector * SPI_FLASH_SEC_SIZE, &hdr, sizeof(hdr));
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start sector %lu: %s", (unsigned long)sector, esp_err_to_name(err));
+        tlog_sector_first[sector] = 0;
+        return err;
+    }
+
+    tlog_stats.erases++;
+    tlog_sector_seq = hdr.sector_seq;
+    tlog_sector_first[sector] = first_seq;
+    tlog_head = sector;
+    tlog_head_slot = 1;
+    return ESP_OK;
+}
+
+/**
+ * @brief Move the head to the next sector, dropping the oldest one if the ring is full
+ */
+static esp_err_t tlog_advance_sector(uint32_t first_seq)
+{
+    uint32_t next = (tlog_head + 1) % tlog_sector_count;
+
+    if (next == tlog_tail && tlog_sector_first[next] != 0) {
+        uint32_t new_tail = (tlog_tail + 1) % tlog_sector_count;
+        uint32_t survivor_first = tlog_sector_first[new_tail] ? tlog_sector_first[new_tail] : first_seq;
+        uint32_t lost_from = tlog_sent_seq + 1 > tlog_sector_first[next] ? tlog_sent_seq + 1 : tlog_sector_first[next];
+
+        // Unsent records in the dropped sector are gone; move the upload cursor past them
+        if (survivor_first > lost_from) {
+            tlog_stats.overwritten += survivor_first - lost_from;
+            tlog_sent_seq = survivor_first - 1;
+        }
+        tlog_tail = new_tail;
+    }
+
+    esp_err_t err = tlog_start_sector(next, first_seq);
+    if (err == ESP_OK && tlog_sector_first[tlog_tail] == 0) {
+        tlog_tail = next;
+    }
+    return err;
+}
+
+/**
+ * @brief Program records into the ring (flash mutex held)
+ */
+static esp_err_t tlog_write_records(const telemetry_log_record_t *records, uint32_t count)
+{
+    while (count > 0) {
+        if (tlog_head_slot >= TLOG_SLOTS_PER_SECTOR) {
+            esp_err_t err = tlog_advance_sector(records->seq);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+
+        uint32_t n = TLOG_SLOTS_PER_SECTOR - tlog_head_slot;
+        if (n > count) {
+            n = count;
+        }
+
+        esp_err_t err = esp_partition_write(tlog_part,
+                                            tlog_head * SPI_FLASH_SEC_SIZE + tlog_head_slot * TELEMETRY_LOG_RECORD_SIZE,
+                                            records, n * TELEMETRY_LOG_RECORD_SIZE);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Record write failed: %s", esp_err_to_name(err));
+            return err;
+        }
+
+        tlog_stats.page_writes++;
+        tlog_head_slot += n;
+        tlog_flash_next_seq = records[n - 1].seq + 1;
+        records += n;
+        count -= n;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Write the RAM stage to flash
+ */
+esp_err_t telemetry_log_flush(void)
+{
+    if (!tlog_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // One flush at a time: the write buffer belongs to the flash mutex holder
+    xSemaphoreTake(tlog_flash_mutex, portMAX_DELAY);
+
+    xSemaphoreTake(tlog_stage_mutex, portMAX_DELAY);
+    telemetry_log_record_t *records = tlog_stage;
+    uint32_t count = tlog_stage_count;
+    tlog_stage = tlog_write_buf;
+    tlog_write_buf = records;
+    tlog_stage_count = 0;
+    tlog_stage_first_us = 0;
+    xSemaphoreGive(tlog_stage_mutex);
+
+    esp_err_t err = count ? tlog_write_records(records, count) : ESP_OK;
+    xSemaphoreGive(tlog_flash_mutex);
+    return err;
+}
+
+/**
+ * @brief Read records starting at a sequence number
+ */
+esp_err_t telemetry_log_read(uint32_t from_seq, telemetry_log_record_t *records, size_t max, size_t *count)
+{
+    if (!records || !count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *count = 0;
+    if (!tlog_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(tlog_flash_mutex, portMAX_DELAY);
+
+    // Find the newest sector starting at or before from_seq
+    uint32_t sector = tlog_tail;
+    if (from_seq < tlog_sector_first[tlog_tail]) {
+        from_seq = tlog_sector_first[tlog_tail];
+    }
+    for (uint32_t s = tlog_tail; s != tlog_head; ) {
+        s = (s + 1) % tlog_sector_count;
+        if (tlog_sector_first[s] != 0 && tlog_sector_first[s] <= from_seq) {
+            sector = s;
+        } else {
+            break;
+        }
+    }
+
+    esp_err_t err = ESP_OK;
+    size_t got = 0;
+
+    while (got < max && err == ESP_OK) {
+        uint32_t end_slot = sector == tlog_head ? tlog_head_slot : TLOG_SLOTS_PER_SECTOR;
+
+        // Each slot holds at most one new sequence number, so earlier slots can be skipped
+        uint32_t slot = 1;
+        if (from_seq > tlog_sector_first[sector]) {
+            uint64_t skip = (uint64_t)from_seq - tlog_sector_first[sector];
+            slot = skip + 1 < end_slot ? (uint32_t)skip + 1 : end_slot;
+        }
+
+        while (slot < end_slot && got < max) {
+            size_t n = end_slot - slot;
+            if (n > max - got) {
+                n = max - got;
+            }
+
+            // One large sequential read straight into the caller's buffer, then compact
+            err = esp_partition_read(tlog_part, sector * SPI_FLASH_SEC_SIZE + slot * TELEMETRY_LOG_RECORD_SIZE,
+                                     &records[got], n * TELEMETRY_LOG_RECORD_SIZE);
+            if (err != ESP_OK) {
+                break;
+            }
+            slot += n;
+
+            size_t kept = got;
+            for (size_t i = got; i < got + n; i++) {
+                if (records[i].seq == TLOG_ERASED_SEQ || records[i].seq < from_seq ||
+                    records[i].crc != tlog_slot_crc(&records[i])) {
+                    continue;
+                }
+                if (kept != i) {
+                    records[kept] = records[i];
+                }
+                kept++;
+            }
+            got = kept;
+        }
+
+        if (sector == tlog_head) {
+            break;
+        }
+        sector = (sector + 1) % tlog_sector_count;
+    }
+
+    xSemaphoreGive(tlog_flash_mutex);
+    *count = got;
+    return err;
+}
+
+/**
+ * @brief Append a record
+ */
+esp_err_t telemetry_log_append(uint16_t type, const void *data, size_t len)
+{
+    if (!tlog_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len > TELEMETRY_LOG_DATA_MAX || (!data && len > 0)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    time_t now = time(NULL);
+    uint32_t uptime_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+    xSemaphoreTake(tlog_stage_mutex, portMAX_DELAY);
+    if (tlog_stage_count >= CONFIG_TELEMETRY_LOG_STAGE_RECORDS) {
+        tlog_stats.dropped++;
+        xSemaphoreGive(tlog_stage_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+
+    telemetry_log_record_t *rec = &tlog_stage[tlog_stage_count++];
+    memset(rec, 0, sizeof(*rec));
+    rec->seq = tlog_next_seq++;
+    rec->time_s = now > 1600000000 ? (uint32_t)now : 0;    // Clock not set before SNTP
+    rec->uptime_ms = uptime_ms;
+    rec->type = type;
+    rec->len = len;
+    rec->reserved = 0xFF;
+    memcpy(rec->data, data, len);
+    rec->crc = tlog_slot_crc(rec);
+
+    if (tlog_stage_first_us == 0) {
+        tlog_stage_first_us = esp_timer_get_time();
+    }
+    tlog_stats.appended++;
+    xSemaphoreGive(tlog_stage_mutex);
+
+    xTaskNotifyGive(tlog_task_handle);
+    return ESP_OK;
+}
+
+/**
+ * @brief Persist the upload cursor
+ * @param seq Cursor value read under the flash mutex
+ */
+static void tlog_save_sent_seq(uint32_t seq)
+{
+    nvs_handle_t handle;
+    if (nvs_open(TLOG_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        nvs_set_u32(handle, TLOG_NVS_SENT_KEY, seq);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+}
+
+#ifndef HALOW_DISABLED
+/**
+ * @brief Read the upload cursor
+ * tlog_advance_sector() moves it under the flash mutex when unsent records are overwritten.
+ */
+static uint32_t tlog_get_sent_seq(void)
+{
+    xSemaphoreTake(tlog_flash_mutex, portMAX_DELAY);
+    uint32_t seq = tlog_sent_seq;
+    xSemaphoreGive(tlog_flash_mutex);
+    return seq;
+}
+
+/**
+ * @brief Delivery report of an upload publish (esp-mqtt or producer context)
+ */
+static void tlog_upload_delivered(uint32_t last_seq, bool delivered)
+{
+    portENTER_CRITICAL(&tlog_upload_lock);
+    // A late ack of an earlier copy of the same run counts as well
+    bool ours = tlog_upload_state == TLOG_UPLOAD_WAITING && last_seq == tlog_upload_last_seq;
+    if (ours) {
+        tlog_upload_state = delivered ? TLOG_UPLOAD_ACKED : TLOG_UPLOAD_FAILED;
+    }
+    portEXIT_CRITICAL(&tlog_upload_lock);
+
+    if (ours) {
+        xTaskNotifyGive(tlog_task_handle);
+    }
+}
+
+/**
+ * @brief Upload the next run of unsent records
+ * @return true if an upload was acknowledged and more may follow
+ */
+static bool tlog_upload_step(telemetry_log_record_t *buf, size_t max)
+{
+    static uint32_t publishes_since_save = 0;
+    task_mqtt_stats_t mqtt;
+
+    portENTER_CRITICAL(&tlog_upload_lock);
+    tlog_upload_state_t state = tlog_upload_state;
+    uint32_t last_seq = tlog_upload_last_seq;
+    if (state == TLOG_UPLOAD_ACKED || state == TLOG_UPLOAD_FAILED) {
+        tlog_upload_state = TLOG_UPLOAD_IDLE;
+    }
+    portEXIT_CRITICAL(&tlog_upload_lock);
+
+    if (state == TLOG_UPLOAD_WAITING) {
+        return false;
+    }
+    if (state == TLOG_UPLOAD_ACKED) {
+        // Overwritten records may have moved the cursor past the run meanwhile
+        xSemaphoreTake(tlog_flash_mutex, portMAX_DELAY);
+        if (last_seq > tlog_sent_seq) {
+            tlog_stats.uploaded += last_seq - tlog_sent_seq;
+            tlog_sent_seq = last_seq;
+        }
+        uint32_t sent_seq = tlog_sent_seq;
+        xSemaphoreGive(tlog_flash_mutex);
+
+        if (++publishes_since_save >= TLOG_SENT_SAVE_INTERVAL) {
+            tlog_save_sent_seq(sent_seq);
+            publishes_since_save = 0;
+        }
+        return true;
+    }
+    // TLOG_UPLOAD_FAILED: the cursor did not move, the run goes out again
+
+    uint32_t sent_seq = tlog_get_sent_seq();
+    if (sent_seq + 1 >= tlog_flash_next_seq) {
+        if (publishes_since_save) {
+            tlog_save_sent_seq(sent_seq);   // Caught up
+            publishes_since_save = 0;
+        }
+        return false;
+    }
+
+    // Only hand over what the MQTT queue can take without dropping anything
+    task_mqtt_get_stats(&mqtt);
+    if (!mqtt.connected || mqtt.ring_size - mqtt.ring_used < 2 * max * TELEMETRY_LOG_RECORD_SIZE) {
+        return false;
+    }
+
+    size_t count = 0;
+    if (telemetry_log_read(sent_seq + 1, buf, max, &count) != ESP_OK || count == 0) {
+        return false;
+    }
+
+    // The report may come before task_mqtt_publish_tracked() returns
+    portENTER_CRITICAL(&tlog_upload_lock);
+    tlog_upload_state = TLOG_UPLOAD_WAITING;
+    tlog_upload_last_seq = buf[count - 1].seq;
+    portEXIT_CRITICAL(&tlog_upload_lock);
+
+    if (task_mqtt_publish_tracked(TLOG_UPLOAD_TOPIC, buf, count * TELEMETRY_LOG_RECORD_SIZE,
+                                  tlog_upload_delivered, buf[count - 1].seq) != ESP_OK) {
+        portENTER_CRITICAL(&tlog_upload_lock);
+        tlog_upload_state = TLOG_UPLOAD_IDLE;
+        portEXIT_CRITICAL(&tlog_upload_lock);
+    }
+    return false;
+}
+#endif
+
+/**
+ * @brief Log task: page-batched flushing and upload
+ */
+static void tlog_task(void *pvParameters)
+{
+#ifndef HALOW_DISABLED
+    // One upload publish carries as many whole records as a batched MQTT payload
+    size_t upload_max = CONFIG_HALOW_MQTT_BATCH_MAX_BYTES / TELEMETRY_LOG_RECORD_SIZE;
+    telemetry_log_record_t *upload_buf = malloc(upload_max * TELEMETRY_LOG_RECORD_SIZE);
+#endif
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+
+        xSemaphoreTake(tlog_stage_mutex, portMAX_DELAY);
+        uint32_t staged = tlog_stage_count;
+        int64_t first_us = tlog_stage_first_us;
+        xSemaphoreGive(tlog_stage_mutex);
+
+        if (staged > 0) {
+            // Flush when the stage completes the current flash page, or when it got old
+            uint32_t page_room = TLOG_SLOTS_PER_PAGE - (tlog_head_slot % TLOG_SLOTS_PER_PAGE);
+            int64_t age_ms = (esp_timer_get_time() - first_us) / 1000;
+
+            if (staged >= page_room || age_ms >= CONFIG_TELEMETRY_LOG_FLUSH_MS) {
+                telemetry_log_flush();
+                continue;
+            }
+            wait = pdMS_TO_TICKS(CONFIG_TELEMETRY_LOG_FLUSH_MS - age_ms);
+            if (wait == 0) {
+                wait = 1;
+            }
+        }
+
+#ifndef HALOW_DISABLED
+        if (upload_buf && tlog_upload_step(upload_buf, upload_max)) {
+            continue;
+        }
+        // Poll for reconnects and MQTT queue space while records are unsent
+        if (tlog_get_sent_seq() + 1 < tlog_flash_next_seq && wait > pdMS_TO_TICKS(1000)) {
+            wait = pdMS_TO_TICKS(1000);
+        }
+#endif
+
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+/**
+ * @brief Scan the partition and restore the ring state
+ */
+static esp_err_t tlog_mount(void)
+{
+    tlog_sector_header_t hdr;
+    bool found = false;
+
+    for (uint32_t s = 0; s < tlog_sector_count; s++) {
+        tlog_sector_first[s] = 0;
+        if (esp_partition_read(tlog_part, s * SPI_FLASH_SEC_SIZE, &hdr, sizeof(hdr)) != ESP_OK) {
+            continue;
+        }
+        if (hdr.magic != TLOG_SECTOR_MAGIC || hdr.version != TLOG_FORMAT_VERSION ||
+            hdr.record_size != TELEMETRY_LOG_RECORD_SIZE || hdr.crc != tlog_slot_crc(&hdr)) {
+            continue;
+        }
+        tlog_sector_first[s] = hdr.first_seq;
+        if (!found || hdr.sector_seq > tlog_sector_seq) {
+            tlog_sector_seq = hdr.sector_seq;
+            tlog_head = s;
+        }
+        found = true;
+    }
+
+    if (!found) {
+        ESP_LOGI(TAG, "Formatting telemetry log (%lu sectors)", (unsigned long)tlog_sector_count);
+        tlog_sector_seq = 0;
+        tlog_tail = 0;
+        tlog_flash_next_seq = tlog_sent_seq + 1;
+        return tlog_start_sector(0, tlog_flash_next_seq);
+    }
+
+    // Oldest sector: first one in use after the head in ring order
+    tlog_tail = tlog_head;
+    for (uint32_t k = 1; k < tlog_sector_count; k++) {
+        uint32_t s = (tlog_head + k) % tlog_sector_count;
+        if (tlog_sector_first[s] != 0) {
+            tlog_tail = s;
+            break;
+        }
+    }
+
+    // Find the end of the head sector
+    telemetry_log_record_t rec;
+    tlog_flash_next_seq = tlog_sector_first[tlog_head];
+    tlog_head_slot = 1;
+    for (uint32_t slot = 1; slot < TLOG_SLOTS_PER_SECTOR; slot++) {
+        esp_err_t err = esp_partition_read(tlog_part, tlog_head * SPI_FLASH_SEC_SIZE + slot * TELEMETRY_LOG_RECORD_SIZE,
+                                           &rec, sizeof(rec));
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (rec.seq == TLOG_ERASED_SEQ) {
+            break;
+        }
+        tlog_head_slot = slot + 1;
+        if (rec.crc == tlog_slot_crc(&rec)) {
+            tlog_flash_next_seq = rec.seq + 1;
+        } else {
+            tlog_stats.corrupt++;
+        }
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Mount the log partition and start the writer task
+ */
+esp_err_t telemetry_log_init(void)
+{
+    if (tlog_part) {
+        return ESP_OK;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                           TELEMETRY_LOG_PARTITION);
+    if (!part) {
+        ESP_LOGW(TAG, "No '%s' partition, telemetry log disabled", TELEMETRY_LOG_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    tlog_sector_count = part->size / SPI_FLASH_SEC_SIZE;
+    tlog_sector_first = calloc(tlog_sector_count, sizeof(uint32_t));
+    tlog_stage = malloc(CONFIG_TELEMETRY_LOG_STAGE_RECORDS * sizeof(telemetry_log_record_t));
+    tlog_write_buf = malloc(CONFIG_TELEMETRY_LOG_STAGE_RECORDS * sizeof(telemetry_log_record_t));
+    tlog_flash_mutex = xSemaphoreCreateMutex();
+    tlog_stage_mutex = xSemaphoreCreateMutex();
+    if (tlog_sector_count < 2 || !tlog_sector_first || !tlog_stage || !tlog_write_buf ||
+        !tlog_flash_mutex || !tlog_stage_mutex) {
+        ESP_LOGE(TAG, "Failed to set up telemetry log");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Upload cursor survives reboots; a fresh log continues after it
+    nvs_handle_t handle;
+    if (nvs_open(TLOG_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        nvs_get_u32(handle, TLOG_NVS_SENT_KEY, &tlog_sent_seq);
+        nvs_close(handle);
+    }
+
+    tlog_part = part;
+    esp_err_t err = tlog_mount();
+    if (err != ESP_OK) {
+        tlog_part = NULL;
+        return err;
+    }
+
+    tlog_next_seq = tlog_flash_next_seq;
+    if (tlog_sent_seq >= tlog_next_seq) {
+        tlog_sent_seq = tlog_next_seq - 1;  // Log erased or replaced behind our back
+    } else if (tlog_sent_seq + 1 < tlog_sector_first[tlog_tail]) {
+        tlog_sent_seq = tlog_sector_first[tlog_tail] - 1;  // Unsent records were overwritten
+    }
+
+    if (xTaskCreate(tlog_task, "tlog", TLOG_TASK_STACK_SIZE, NULL, TLOG_TASK_PRIORITY,
+                    &tlog_task_handle) != pdPASS) {
+        tlog_part = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Telemetry log mounted: seq %lu..%lu, %lu unsent",
+             (unsigned long)tlog_sector_first[tlog_tail], (unsigned long)(tlog_next_seq - 1),
+             (unsigned long)(tlog_next_seq - 1 - tlog_sent_seq));
+    return ESP_OK;
+}
+
+/**
+ * @brief Erase the whole log
+ */
+esp_err_t telemetry_log_erase(void)
+{
+    if (!tlog_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    telemetry_log_flush();
+
+    xSemaphoreTake(tlog_flash_mutex, portMAX_DELAY);
+    esp_err_t err = ESP_OK;
+    for (uint32_t s = 0; s < tlog_sector_count && err == ESP_OK; s++) {
+        if (tlog_sector_first[s] != 0) {
+            err = esp_partition_erase_range(tlog_part, s * SPI_FLASH_SEC_SIZE, SPI_FLASH_SEC_SIZE);
+            tlog_sector_first[s] = 0;
+        }
+    }
+    if (err == ESP_OK) {
+        tlog_tail = 0;
+        err = tlog_start_sector(0, tlog_flash_next_seq);
+    }
+    tlog_sent_seq = tlog_flash_next_seq - 1;
+    uint32_t sent_seq = tlog_sent_seq;
+    xSemaphoreGive(tlog_flash_mutex);
+
+    tlog_save_sent_seq(sent_seq);
+    return err;
+}
+
+/**
+ * @brief Get log statistics
+ */
+void telemetry_log_get_stats(telemetry_log_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    *stats = tlog_stats;
+    stats->mounted = tlog_part != NULL;
+    if (!tlog_part) {
+        return;
+    }
+
+    xSemaphoreTake(tlog_stage_mutex, portMAX_DELAY);
+    stats->staged = tlog_stage_count;
+    stats->next_seq = tlog_next_seq;
+    xSemaphoreGive(tlog_stage_mutex);
+
+    xSemaphoreTake(tlog_flash_mutex, portMAX_DELAY);
+    stats->sectors = tlog_sector_count;
+    stats->capacity = (tlog_sector_count - 1) * (TLOG_SLOTS_PER_SECTOR - 1);
+    stats->oldest_seq = tlog_sector_first[tlog_tail] < tlog_flash_next_seq ? tlog_sector_first[tlog_tail] : 0;
+    stats->sent_seq = tlog_sent_seq;
+    xSemaphoreGive(tlog_flash_mutex);
+}
+
+/**
+ * @brief Print the most recent records
+ */
+static void tlog_dump(uint32_t count)
+{
+    telemetry_log_record_t rec[8];
+    size_t n = 0;
+    uint32_t from = tlog_flash_next_seq > count ? tlog_flash_next_seq - count : 1;
+
+    telemetry_log_flush();
+    printf("%-10s %-10s %-12s %-6s  %s\n", "Seq", "Time", "Uptime(ms)", "Type", "Data");
+    while (count > 0 && telemetry_log_read(from, rec, count < 8 ? count : 8, &n) == ESP_OK && n > 0) {
+        for (size_t i = 0; i < n; i++) {
+            printf("%-10lu %-10lu %-12lu %-6u  ", (unsigned long)rec[i].seq, (unsigned long)rec[i].time_s,
+                   (unsigned long)rec[i].uptime_ms, rec[i].type);
+            if (rec[i].type == TELEMETRY_LOG_TYPE_TEXT) {
+                printf("%.*s\n", rec[i].len, (const char *)rec[i].data);
+            } else {
+                for (int j = 0; j < rec[i].len; j++) {
+                    printf("%02x", rec[i].data[j]);
+                }
+                printf("\n");
+            }
+        }
+        from = rec[n - 1].seq + 1;
+        count -= n < count ? n : count;
+    }
+}
+
+static int tlog_cmd(int argc, char **argv)
+{
+    if (argc < 2 || strcmp(argv[1], "status") == 0) {
+        telemetry_log_stats_t stats;
+        telemetry_log_get_stats(&stats);
+        if (!stats.mounted) {
+            printf(COLOR_YELLOW "Telemetry log not available (no '%s' partition)\n" COLOR_RESET, TELEMETRY_LOG_PARTITION);
+            return 1;
+        }
+        printf(COLOR_CYAN "Telemetry log:\n" COLOR_RESET);
+        printf("  Partition:  %lu sectors, %lu records capacity\n",
+               (unsigned long)stats.sectors, (unsigned long)stats.capacity);
+        printf("  Sequence:   oldest %lu, next %lu, uploaded up to %lu (%lu unsent)\n",
+               (unsigned long)stats.oldest_seq, (unsigned long)stats.next_seq, (unsigned long)stats.sent_seq,
+               (unsigned long)(stats.next_seq - 1 - stats.sent_seq));
+        printf("  Since boot: %lu appended, %lu uploaded, %lu dropped, %lu overwritten unsent\n",
+               (unsigned long)stats.appended, (unsigned long)stats.uploaded,
+               (unsigned long)stats.dropped, (unsigned long)stats.overwritten);
+        printf("  Flash:      %lu staged, %lu page writes, %lu erases, %lu corrupt slots\n",
+               (unsigned long)stats.staged, (unsigned long)stats.page_writes,
+               (unsigned long)stats.erases, (unsigned long)stats.corrupt);
+        return 0;
+    }
+
+    const char *subcmd = argv[1];
+
+    if (strcmp(subcmd, "write") == 0) {
+        if (argc < 3) {
+            printf("Usage: tlog write <text>\n");
+            return 1;
+        }
+        esp_err_t err = telemetry_log_append(TELEMETRY_LOG_TYPE_TEXT, argv[2], strnlen(argv[2], TELEMETRY_LOG_DATA_MAX));
+        if (err != ESP_OK) {
+            printf(COLOR_RED "Append failed: %s\n" COLOR_RESET, esp_err_to_name(err));
+            return 1;
+        }
+    } else if (strcmp(subcmd, "dump") == 0) {
+        tlog_dump(argc > 2 ? (uint32_t)atoi(argv[2]) : 20);
+    } else if (strcmp(subcmd, "flush") == 0) {
+        esp_err_t err = telemetry_log_flush();
+        printf("%s\n", err == ESP_OK ? "Flushed" : esp_err_to_name(err));
+    } else if (strcmp(subcmd, "erase") == 0) {
+        esp_err_t err = telemetry_log_erase();
+        if (err != ESP_OK) {
+            printf(COLOR_RED "Erase failed: %s\n" COLOR_RESET, esp_err_to_name(err));
+            return 1;
+        }
+        printf(COLOR_GREEN "Telemetry log erased\n" COLOR_RESET);
+    } else {
+        printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+        printf("  tlog [status]      - Show log state and upload progress\n");
+        printf("  tlog write <text>  - Append a text record\n");
+        printf("  tlog dump [count]  - Print the newest records (default 20)\n");
+        printf("  tlog flush         - Write staged records to flash now\n");
+        printf("  tlog erase         - Erase all records\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Register telemetry log console commands
+ */
+void register_telemetry_log_commands(void)
+{
+    const esp_console_cmd_t tlog_cmd_def = {
+        .command = "tlog",
+        .help = "Telemetry log: status, write, dump, flush, erase",
+        .hint = NULL,
+        .func = &tlog_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&tlog_cmd_def));
+}
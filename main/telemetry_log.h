@@ -0,0 +1,112 @@
+/**
+ * @file telemetry_log.h
+ * @brief Flash-backed store-and-forward telemetry log for Halow RTOS
+ *
+ * Features:
+ * - Dedicated "tlog" data partition, raw flash (not NVS)
+ * - Append-only ring of fixed-size records with sequence numbers and CRC32
+ * - Sectors are reused strictly in order, so every sector sees the same erase count
+ * - Records staged in RAM and programmed a flash page (256 bytes) at a time
+ * - Upload over MQTT in large sequential reads, resuming from a persisted cursor
+ */
+
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define TELEMETRY_LOG_PARTITION     "tlog"
+#define TELEMETRY_LOG_RECORD_SIZE   64
+#define TELEMETRY_LOG_DATA_MAX      44
+
+// Record types (application defined above TELEMETRY_LOG_TYPE_USER)
+#define TELEMETRY_LOG_TYPE_TEXT     1
+#define TELEMETRY_LOG_TYPE_GPIO     2
+#define TELEMETRY_LOG_TYPE_USER     0x100
+
+// On-flash record, also the upload format (little endian)
+typedef struct __attribute__((packed)) {
+    uint32_t seq;               // Monotonic sequence number, 0xFFFFFFFF = erased slot
+    uint32_t time_s;            // Wall clock seconds (0 if the clock was not set)
+    uint32_t uptime_ms;         // Milliseconds since boot
+    uint16_t type;              // TELEMETRY_LOG_TYPE_*
+    uint8_t len;                // Valid bytes in data
+    uint8_t reserved;
+    uint8_t data[TELEMETRY_LOG_DATA_MAX];
+    uint32_t crc;               // CRC32 of all preceding bytes
+} telemetry_log_record_t;
+
+// Log statistics
+typedef struct {
+    bool mounted;
+    uint32_t sectors;           // Sectors in the partition
+    uint32_t capacity;          // Records the ring can hold
+    uint32_t oldest_seq;        // Oldest record still in flash, 0 if empty
+    uint32_t next_seq;          // Sequence number of the next record
+    uint32_t sent_seq;          // Last record acknowledged by the MQTT broker
+    uint32_t staged;            // Records waiting in RAM for a page write
+    uint32_t appended;          // Records accepted since boot
+    uint32_t dropped;           // Records dropped because the RAM stage was full
+    uint32_t page_writes;       // Flash program operations
+    uint32_t erases;            // Sectors erased since boot
+    uint32_t corrupt;           // Slots skipped because of a bad CRC
+    uint32_t overwritten;       // Records overwritten before they were uploaded
+    uint32_t uploaded;          // Records acknowledged by the broker since boot
+} telemetry_log_stats_t;
+
+/**
+ * @brief Mount the log partition and start the writer task
+ * Formats the partition if it holds no valid log.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no "tlog" partition
+ */
+esp_err_t telemetry_log_init(void);
+
+/**
+ * @brief Append a record
+ * Non-blocking: the record is staged in RAM and written with the next page.
+ * @param type Record type
+ * @param data Record data
+ * @param len Data length (at most TELEMETRY_LOG_DATA_MAX)
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if too long,
+ *         ESP_ERR_NO_MEM if the RAM stage is full, ESP_ERR_INVALID_STATE if not mounted
+ */
+esp_err_t telemetry_log_append(uint16_t type, const void *data, size_t len);
+
+/**
+ * @brief Write all staged records to flash now
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t telemetry_log_flush(void);
+
+/**
+ * @brief Read records starting at a sequence number
+ * Reads whole sectors sequentially; records older than the log are skipped.
+ * @param from_seq First sequence number wanted
+ * @param records Buffer for records
+ * @param max Capacity of records
+ * @param count Number of records stored
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t telemetry_log_read(uint32_t from_seq, telemetry_log_record_t *records, size_t max, size_t *count);
+
+/**
+ * @brief Erase the whole log (sequence numbers continue)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t telemetry_log_erase(void);
+
+/**
+ * @brief Get log statistics
+ * @param stats Pointer to store statistics
+ */
+void telemetry_log_get_stats(telemetry_log_stats_t *stats);
+
+/**
+ * @brief Register telemetry log console commands
+ */
+void register_telemetry_log_commands(void);
+
+#endif // TELEMETRY_LOG_H
@@ -0,0 +1,710 @@
+/**
+ * @file tool_iperf.c
+ * @brief iperf-style throughput benchmark implementation for ESP32 RTOS
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "lwip/inet.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+
+#include "tool_iperf.h"
+#include "dns_cache.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "tool_iperf";
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#define IPERF_TASK_STACK_SIZE   4096
+#define IPERF_TASK_PRIORITY     5
+#define IPERF_TASK_CORE         (CONFIG_TOOL_TASK_CORE < 0 ? tskNO_AFFINITY : CONFIG_TOOL_TASK_CORE)
+#define IPERF_SOCKET_TIMEOUT_MS 100     // Receive poll period so stop requests are seen
+#define IPERF_SERVER_IDLE_US    3000000 // UDP stream considered finished after this much silence
+#define IPERF_UDP_FIN_COUNT     3       // Number of end-of-stream datagrams sent by the client
+
+// iperf2 UDP datagram header (network byte order)
+typedef struct {
+    int32_t id;
+    uint32_t tv_sec;
+    uint32_t tv_usec;
+} iperf_udp_hdr_t;
+
+// Running byte/datagram counters
+typedef struct {
+    uint64_t bytes;
+    uint32_t packets;
+    uint32_t lost;
+    uint32_t out_of_order;
+} iperf_counters_t;
+
+// One measurement run (a client test or one accepted server stream)
+typedef struct {
+    bool udp_server;
+    int64_t start_us;
+    int64_t end_us;             // Client deadline, INT64_MAX for servers
+    int64_t interval_us;
+    int64_t last_report_us;
+    int64_t next_report_us;
+    iperf_counters_t total;
+    iperf_counters_t snap;      // Totals at the last interval report
+    int32_t max_seq;            // Highest UDP sequence seen, -1 before the first datagram
+    int64_t last_transit_us;
+    uint32_t jitter_us;         // RFC 3550 interarrival jitter estimate
+} iperf_run_t;
+
+static tool_iperf_config_t s_config;
+static TaskHandle_t s_iperf_task = NULL;
+static volatile bool s_iperf_running = false;
+static volatile bool s_iperf_stop = false;
+
+/**
+ * @brief Start a measurement run
+ * @param run Run state to initialize
+ * @param cfg Benchmark configuration
+ * @param udp_server true if jitter/loss should be reported
+ */
+static void iperf_run_begin(iperf_run_t *run, const tool_iperf_config_t *cfg, bool udp_server)
+{
+    memset(run, 0, sizeof(*run));
+    run->udp_server = udp_server;
+    run->start_us = esp_timer_get_time();
+    run->end_us = (cfg->role == IPERF_ROLE_CLIENT) ?
+                  run->start_us + (int64_t)cfg->duration_s * 1000000 : INT64_MAX;
+    run->interval_us = (int64_t)cfg->interval_s * 1000000;
+    run->last_report_us = run->start_us;
+    run->next_report_us = run->start_us + run->interval_us;
+    run->max_seq = -1;
+}
+
+/**
+ * @brief Print one report line for a time span
+ * @param run Run state
+ * @param from_us Start of the span
+ * @param to_us End of the span
+ * @param cur Counters at the end of the span
+ * @param prev Counters at the start of the span
+ */
+static void iperf_print_report(const iperf_run_t *run, int64_t from_us, int64_t to_us,
+                               const iperf_counters_t *cur, const iperf_counters_t *prev)
+{
+    uint64_t bytes = cur->bytes - prev->bytes;
+    int64_t span_us = to_us - from_us;
+    double mbps = span_us > 0 ? (double)bytes * 8.0 / (double)span_us : 0.0;
+
+    printf("[%5.1f-%5.1f s] %9.1f KBytes  %6.2f Mbits/s",
+           (from_us - run->start_us) / 1e6, (to_us - run->start_us) / 1e6,
+           bytes / 1024.0, mbps);
+
+    if (run->udp_server) {
+        uint32_t lost = cur->lost - prev->lost;
+        uint32_t total = (cur->packets - prev->packets) + lost;
+        printf("  %7.3f ms  %lu/%lu (%.1f%%)", run->jitter_us / 1000.0,
+               (unsigned long)lost, (unsigned long)total,
+               total > 0 ? lost * 100.0 / total : 0.0);
+        if (cur->out_of_order != prev->out_of_order) {
+            printf("  %lu out-of-order", (unsigned long)(cur->out_of_order - prev->out_of_order));
+        }
+    } else {
+        printf("  %lu pkts", (unsigned long)(cur->packets - prev->packets));
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Emit an interval report if the interval elapsed
+ * @param run Run state
+ * @param now_us Current esp_timer time
+ */
+static void iperf_run_tick(iperf_run_t *run, int64_t now_us)
+{
+    if (run->interval_us <= 0 || now_us < run->next_report_us) {
+        return;
+    }
+
+    iperf_print_report(run, run->last_report_us, now_us, &run->total, &run->snap);
+    run->snap = run->total;
+    run->last_report_us = now_us;
+    while (run->next_report_us <= now_us) {
+        run->next_report_us += run->interval_us;
+    }
+}
+
+/**
+ * @brief Print the summary of a finished run
+ * @param run Run state
+ * @param end_us Time of the last transfer
+ */
+static void iperf_run_finish(iperf_run_t *run, int64_t end_us)
+{
+    const iperf_counters_t zero = { 0 };
+
+    if (run->interval_us > 0 && end_us > run->last_report_us &&
+        run->total.bytes != run->snap.bytes) {
+        iperf_print_report(run, run->last_report_us, end_us, &run->total, &run->snap);
+    }
+    printf(COLOR_CYAN "- - - - - - - - - - - - - - - - - - - - - - - - -\n" COLOR_RESET);
+    printf(COLOR_GREEN);
+    iperf_print_report(run, run->start_us, end_us, &run->total, &zero);
+    printf(COLOR_RESET);
+
+    if (s_config.json) {
+        int64_t span_us = end_us - run->start_us;
+        uint32_t total = run->total.packets + run->total.lost;
+        printf("{\"bench\":\"iperf\",\"proto\":\"%s\",\"role\":\"%s\",\"len\":%lu,\"duration_s\":%.2f,"
+               "\"bytes\":%llu,\"mbps\":%.3f,\"packets\":%lu",
+               s_config.proto == IPERF_PROTO_UDP ? "udp" : "tcp",
+               s_config.role == IPERF_ROLE_CLIENT ? "client" : "server",
+               (unsigned long)s_config.len, span_us / 1e6, (unsigned long long)run->total.bytes,
+               span_us > 0 ? (double)run->total.bytes * 8.0 / (double)span_us : 0.0,
+               (unsigned long)run->total.packets);
+        if (run->udp_server) {
+            printf(",\"lost\":%lu,\"loss_pct\":%.2f,\"jitter_ms\":%.3f,\"out_of_order\":%lu",
+                   (unsigned long)run->total.lost, total > 0 ? run->total.lost * 100.0 / total : 0.0,
+                   run->jitter_us / 1000.0, (unsigned long)run->total.out_of_order);
+        }
+        printf("}\n");
+    }
+}
+
+/**
+ * @brief Apply the requested socket buffer size
+ * @param sock Socket descriptor
+ * @param window Buffer size in bytes, 0 to keep the default
+ */
+static void iperf_set_window(int sock, uint32_t window)
+{
+    if (window == 0) {
+        return;
+    }
+
+    int value = (int)window;
+    bool ok = true;
+    if (setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &value, sizeof(value)) != 0) {
+        ok = false;
+    }
+    if (setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &value, sizeof(value)) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        printf(COLOR_YELLOW "Note: socket window not adjustable, using lwIP defaults\n" COLOR_RESET);
+    }
+}
+
+/**
+ * @brief Set the socket receive timeout used for stop polling
+ * @param sock Socket descriptor
+ * @param timeout_ms Timeout in milliseconds
+ */
+static void iperf_set_rcv_timeout(int sock, int timeout_ms)
+{
+    struct timeval tv;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+/**
+ * @brief Resolve the client target address
+ * @param host IP address or hostname
+ * @param port Destination port
+ * @param addr Pointer to store the resolved address
+ * @return 0 on success, -1 on error
+ */
+static int iperf_resolve(const char *host, uint16_t port, struct sockaddr_in *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+
+    if (inet_pton(AF_INET, host, &addr->sin_addr) == 1) {
+        return 0;
+    }
+
+    if (dns_cache_resolve(host, &addr->sin_addr) != ESP_OK) {
+        printf(COLOR_RED "Error: Could not resolve hostname '%s'\n" COLOR_RESET, host);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Run a TCP client test
+ * @param cfg Benchmark configuration
+ * @param buf Payload buffer of cfg->len bytes
+ * @return 0 on success, -1 on error
+ */
+static int iperf_tcp_client(const tool_iperf_config_t *cfg, uint8_t *buf)
+{
+    struct sockaddr_in addr;
+    if (iperf_resolve(cfg->host, cfg->port, &addr) != 0) {
+        return -1;
+    }
+
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        printf(COLOR_RED "Error: Failed to create TCP socket (errno %d)\n" COLOR_RESET, errno);
+        return -1;
+    }
+    iperf_set_window(sock, cfg->window);
+
+    struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        printf(COLOR_RED "Error: Connect to %s:%u failed (errno %d)\n" COLOR_RESET,
+               inet_ntoa(addr.sin_addr), cfg->port, errno);
+        close(sock);
+        return -1;
+    }
+    printf(COLOR_GREEN "Connected to %s:%u (TCP, %lu byte writes)\n" COLOR_RESET,
+           inet_ntoa(addr.sin_addr), cfg->port, (unsigned long)cfg->len);
+
+    iperf_run_t run;
+    iperf_run_begin(&run, cfg, false);
+    int64_t now = run.start_us;
+    int result = 0;
+
+    while (!s_iperf_stop) {
+        now = esp_timer_get_time();
+        if (now >= run.end_us) {
+            break;
+        }
+
+        int sent = send(sock, buf, cfg->len, 0);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == ENOMEM) {
+                vTaskDelay(1);
+                continue;
+            }
+            printf(COLOR_RED "Error: Send failed (errno %d)\n" COLOR_RESET, errno);
+            result = -1;
+            break;
+        }
+
+        run.total.bytes += sent;
+        run.total.packets++;
+        iperf_run_tick(&run, now);
+    }
+
+    iperf_run_finish(&run, esp_timer_get_time());
+    close(sock);
+    return result;
+}
+
+/**
+ * @brief Run a TCP server, serving one client at a time until stopped
+ * @param cfg Benchmark configuration
+ * @param buf Receive buffer of cfg->len bytes
+ * @return 0 on success, -1 on error
+ */
+static int iperf_tcp_server(const tool_iperf_config_t *cfg, uint8_t *buf)
+{
+    int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_sock < 0) {
+        printf(COLOR_RED "Error: Failed to create TCP socket (errno %d)\n" COLOR_RESET, errno);
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(cfg->port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(listen_sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listen_sock, 1) != 0) {
+        printf(COLOR_RED "Error: Cannot listen on TCP port %u (errno %d)\n" COLOR_RESET,
+               cfg->port, errno);
+        close(listen_sock);
+        return -1;
+    }
+    printf(COLOR_GREEN "Server listening on TCP port %u\n" COLOR_RESET, cfg->port);
+
+    while (!s_iperf_stop) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(listen_sock, &readfds);
+        struct timeval timeout = { .tv_sec = 0, .tv_usec = IPERF_SOCKET_TIMEOUT_MS * 1000 };
+        if (select(listen_sock + 1, &readfds, NULL, NULL, &timeout) <= 0) {
+            continue;
+        }
+
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        int sock = accept(listen_sock, (struct sockaddr *)&peer, &peer_len);
+        if (sock < 0) {
+            continue;
+        }
+        iperf_set_window(sock, cfg->window);
+        iperf_set_rcv_timeout(sock, IPERF_SOCKET_TIMEOUT_MS);
+        printf(COLOR_GREEN "Accepted connection from %s:%u\n" COLOR_RESET,
+               inet_ntoa(peer.sin_addr), ntohs(peer.sin_port));
+
+        iperf_run_t run;
+        iperf_run_begin(&run, cfg, false);
+        int64_t last_rx = run.start_us;
+
+        while (!s_iperf_stop) {
+            int received = recv(sock, buf, cfg->len, 0);
+            int64_t now = esp_timer_get_time();
+            if (received > 0) {
+                run.total.bytes += received;
+                run.total.packets++;
+                last_rx = now;
+            } else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                break;
+            }
+            iperf_run_tick(&run, now);
+        }
+
+        iperf_run_finish(&run, last_rx);
+        close(sock);
+    }
+
+    close(listen_sock);
+    return 0;
+}
+
+/**
+ * @brief Run a paced UDP client test
+ * @param cfg Benchmark configuration
+ * @param buf Payload buffer of cfg->len bytes
+ * @return 0 on success, -1 on error
+ */
+static int iperf_udp_client(const tool_iperf_config_t *cfg, uint8_t *buf)
+{
+    struct sockaddr_in addr;
+    if (iperf_resolve(cfg->host, cfg->port, &addr) != 0) {
+        return -1;
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        printf(COLOR_RED "Error: Failed to create UDP socket (errno %d)\n" COLOR_RESET, errno);
+        return -1;
+    }
+    iperf_set_window(sock, cfg->window);
+
+    // Inter-datagram gap for the target rate; 0 means send as fast as possible
+    int64_t gap_us = cfg->bandwidth_kbps > 0 ?
+                     (int64_t)cfg->len * 8000 / cfg->bandwidth_kbps : 0;
+
+    printf(COLOR_GREEN "Sending %lu byte datagrams to %s:%u at %lu Kbits/s\n" COLOR_RESET,
+           (unsigned long)cfg->len, inet_ntoa(addr.sin_addr), cfg->port,
+           (unsigned long)cfg->bandwidth_kbps);
+
+    iperf_run_t run;
+    iperf_run_begin(&run, cfg, false);
+    int64_t next_send = run.start_us;
+    int32_t seq = 0;
+    uint32_t send_errors = 0;
+    iperf_udp_hdr_t *hdr = (iperf_udp_hdr_t *)buf;
+
+    while (!s_iperf_stop) {
+        int64_t now = esp_timer_get_time();
+        if (now >= run.end_us) {
+            break;
+        }
+
+        if (gap_us > 0) {
+            // Datagrams due within the current tick are sent right away, the
+            // schedule keeps the average rate on target without busy waiting
+            if (next_send - now >= portTICK_PERIOD_MS * 1000) {
+                vTaskDelay((next_send - now) / (portTICK_PERIOD_MS * 1000));
+                continue;
+            }
+            // Do not try to catch up on more than one second of backlog
+            if (now - next_send > 1000000) {
+                next_send = now;
+            }
+            next_send += gap_us;
+        }
+
+        hdr->id = htonl(seq);
+        hdr->tv_sec = htonl((uint32_t)(now / 1000000));
+        hdr->tv_usec = htonl((uint32_t)(now % 1000000));
+
+        int sent = sendto(sock, buf, cfg->len, 0, (struct sockaddr *)&addr, sizeof(addr));
+        if (sent < 0) {
+            // lwIP returns ENOMEM when its pbuf pool is exhausted; back off one tick
+            send_errors++;
+            vTaskDelay(1);
+            continue;
+        }
+
+        seq++;
+        run.total.bytes += sent;
+        run.total.packets++;
+        iperf_run_tick(&run, now);
+    }
+
+    int64_t end = esp_timer_get_time();
+
+    // Tell the server the stream ended (negative sequence number, iperf2 convention)
+    for (int i = 0; i < IPERF_UDP_FIN_COUNT; i++) {
+        hdr->id = htonl(-seq);
+        hdr->tv_sec = htonl((uint32_t)(end / 1000000));
+        hdr->tv_usec = htonl((uint32_t)(end % 1000000));
+        sendto(sock, buf, cfg->len, 0, (struct sockaddr *)&addr, sizeof(addr));
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    iperf_run_finish(&run, end);
+    if (send_errors > 0) {
+        printf(COLOR_YELLOW "Send errors (buffer exhaustion): %lu\n" COLOR_RESET,
+               (unsigned long)send_errors);
+    }
+    close(sock);
+    return 0;
+}
+
+/**
+ * @brief Account one received UDP datagram
+ * @param run Run state
+ * @param hdr Datagram header
+ * @param len Datagram length
+ * @param now_us Receive time
+ */
+static void iperf_udp_account(iperf_run_t *run, const iperf_udp_hdr_t *hdr, int len, int64_t now_us)
+{
+    int32_t seq = (int32_t)ntohl(hdr->id);
+    int64_t sent_us = (int64_t)ntohl(hdr->tv_sec) * 1000000 + ntohl(hdr->tv_usec);
+
+    run->total.bytes += len;
+    run->total.packets++;
+
+    if (seq > run->max_seq + 1) {
+        run->total.lost += seq - run->max_seq - 1;
+    } else if (seq <= run->max_seq) {
+        // Late datagram was already counted as lost
+        run->total.out_of_order++;
+        if (run->total.lost > 0) {
+            run->total.lost--;
+        }
+    }
+    if (seq > run->max_seq) {
+        run->max_seq = seq;
+    }
+
+    // Sender and receiver clocks differ, only the transit time delta matters
+    int64_t transit = now_us - sent_us;
+    if (run->total.packets > 1) {
+        int64_t d = transit - run->last_transit_us;
+        if (d < 0) {
+            d = -d;
+        }
+        run->jitter_us += ((int64_t)d - (int64_t)run->jitter_us) / 16;
+    }
+    run->last_transit_us = transit;
+}
+
+/**
+ * @brief Run a UDP server, measuring one stream at a time until stopped
+ * @param cfg Benchmark configuration
+ * @param buf Receive buffer of cfg->len bytes
+ * @return 0 on success, -1 on error
+ */
+static int iperf_udp_server(const tool_iperf_config_t *cfg, uint8_t *buf)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        printf(COLOR_RED "Error: Failed to create UDP socket (errno %d)\n" COLOR_RESET, errno);
+        return -1;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(cfg->port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        printf(COLOR_RED "Error: Cannot bind UDP port %u (errno %d)\n" COLOR_RESET, cfg->port, errno);
+        close(sock);
+        return -1;
+    }
+    iperf_set_window(sock, cfg->window);
+    iperf_set_rcv_timeout(sock, IPERF_SOCKET_TIMEOUT_MS);
+    printf(COLOR_GREEN "Server listening on UDP port %u\n" COLOR_RESET, cfg->port);
+
+    iperf_run_t run;
+    bool active = false;
+    int64_t last_rx = 0;
+
+    while (!s_iperf_stop) {
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        int received = recvfrom(sock, buf, cfg->len, 0, (struct sockaddr *)&peer, &peer_len);
+        int64_t now = esp_timer_get_time();
+
+        if (received >= (int)sizeof(iperf_udp_hdr_t)) {
+            const iperf_udp_hdr_t *hdr = (const iperf_udp_hdr_t *)buf;
+            int32_t seq = (int32_t)ntohl(hdr->id);
+
+            if (seq < 0) {
+                // End-of-stream marker (sent several times by the client)
+                if (active) {
+                    iperf_run_finish(&run, last_rx);
+                    active = false;
+                }
+                continue;
+            }
+            if (!active) {
+                printf(COLOR_GREEN "UDP stream from %s:%u\n" COLOR_RESET,
+                       inet_ntoa(peer.sin_addr), ntohs(peer.sin_port));
+                iperf_run_begin(&run, cfg, true);
+                active = true;
+            }
+            iperf_udp_account(&run, hdr, received, now);
+            last_rx = now;
+        }
+
+        if (active) {
+            if (now - last_rx > IPERF_SERVER_IDLE_US) {
+                printf(COLOR_YELLOW "UDP stream timed out\n" COLOR_RESET);
+                iperf_run_finish(&run, last_rx);
+                active = false;
+                continue;
+            }
+            iperf_run_tick(&run, now);
+        }
+    }
+
+    if (active) {
+        iperf_run_finish(&run, last_rx);
+    }
+    close(sock);
+    return 0;
+}
+
+/**
+ * @brief Benchmark task entry
+ * @param arg Unused
+ */
+static void iperf_task(void *arg)
+{
+    const tool_iperf_config_t *cfg = &s_config;
+    uint8_t *buf = malloc(cfg->len);
+    int result = -1;
+
+    if (!buf) {
+        printf(COLOR_RED "Error: Cannot allocate %lu byte buffer\n" COLOR_RESET, (unsigned long)cfg->len);
+    } else {
+        for (uint32_t i = 0; i < cfg->len; i++) {
+            buf[i] = '0' + (i % 10);
+        }
+
+        if (cfg->proto == IPERF_PROTO_TCP) {
+            result = (cfg->role == IPERF_ROLE_CLIENT) ?
+                     iperf_tcp_client(cfg, buf) : iperf_tcp_server(cfg, buf);
+        } else {
+            result = (cfg->role == IPERF_ROLE_CLIENT) ?
+                     iperf_udp_client(cfg, buf) : iperf_udp_server(cfg, buf);
+        }
+        free(buf);
+    }
+
+    printf("iperf %s\n", result == 0 ? COLOR_GREEN "done" COLOR_RESET : COLOR_RED "failed" COLOR_RESET);
+    ESP_LOGI(TAG, "Benchmark task finished (%d)", result);
+
+    s_iperf_task = NULL;
+    s_iperf_running = false;
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Start a benchmark in the background
+ * @param config Benchmark configuration
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if a benchmark is running
+ */
+esp_err_t tool_iperf_start(const tool_iperf_config_t *config)
+{
+    if (!config) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_iperf_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config->role == IPERF_ROLE_CLIENT && config->host[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_config = *config;
+    if (s_config.port == 0) {
+        s_config.port = IPERF_DEFAULT_PORT;
+    }
+    if (s_config.duration_s == 0) {
+        s_config.duration_s = IPERF_DEFAULT_DURATION_S;
+    }
+    if (s_config.interval_s == 0) {
+        s_config.interval_s = IPERF_DEFAULT_INTERVAL_S;
+    }
+    if (s_config.proto == IPERF_PROTO_UDP) {
+        if (s_config.len == 0) {
+            s_config.len = IPERF_DEFAULT_UDP_LEN;
+        }
+        if (s_config.len > IPERF_MAX_UDP_LEN) {
+            s_config.len = IPERF_MAX_UDP_LEN;
+        }
+        if (s_config.len < sizeof(iperf_udp_hdr_t)) {
+            s_config.len = sizeof(iperf_udp_hdr_t);
+        }
+        if (s_config.bandwidth_kbps == 0) {
+            s_config.bandwidth_kbps = IPERF_DEFAULT_UDP_KBPS;
+        }
+    } else {
+        if (s_config.len == 0) {
+            s_config.len = IPERF_DEFAULT_TCP_LEN;
+        }
+        if (s_config.len > IPERF_MAX_LEN) {
+            s_config.len = IPERF_MAX_LEN;
+        }
+    }
+
+    s_iperf_stop = false;
+    s_iperf_running = true;
+    if (xTaskCreatePinnedToCore(iperf_task, "iperf", IPERF_TASK_STACK_SIZE, NULL,
+                                IPERF_TASK_PRIORITY, &s_iperf_task, IPERF_TASK_CORE) != pdPASS) {
+        s_iperf_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Request the running benchmark to stop
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if nothing is running
+ */
+esp_err_t tool_iperf_stop(void)
+{
+    if (!s_iperf_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_iperf_stop = true;
+    return ESP_OK;
+}
+
+/**
+ * @brief Check if a benchmark is running
+ * @return true if running, false otherwise
+ */
+bool tool_iperf_is_running(void)
+{
+    return s_iperf_running;
+}
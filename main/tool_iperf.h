@@ -0,0 +1,81 @@
+/**
+ * @file tool_iperf.h
+ * @brief iperf-style throughput benchmark for ESP32 RTOS
+ *
+ * Features:
+ * - TCP and UDP client/server modes
+ * - Configurable payload size, socket window, duration and report interval
+ * - UDP datagrams carry the iperf2 sequence/timestamp header so jitter and
+ *   loss can be measured against a desktop iperf2 peer
+ * - Interval and summary reports timed with esp_timer microseconds
+ */
+
+#ifndef TOOL_IPERF_H
+#define TOOL_IPERF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <esp_err.h>
+
+#define IPERF_DEFAULT_PORT          5001
+#define IPERF_DEFAULT_DURATION_S    10
+#define IPERF_DEFAULT_INTERVAL_S    1
+#define IPERF_DEFAULT_TCP_LEN       1460
+#define IPERF_DEFAULT_UDP_LEN       1470
+#define IPERF_DEFAULT_UDP_KBPS      1000
+#define IPERF_MAX_LEN               8192
+#define IPERF_MAX_UDP_LEN           1472
+#define IPERF_HOST_MAX_LEN          64
+
+typedef enum {
+    IPERF_ROLE_CLIENT,
+    IPERF_ROLE_SERVER,
+} tool_iperf_role_t;
+
+typedef enum {
+    IPERF_PROTO_TCP,
+    IPERF_PROTO_UDP,
+} tool_iperf_proto_t;
+
+// Benchmark configuration (zero fields select defaults)
+typedef struct {
+    tool_iperf_role_t role;
+    tool_iperf_proto_t proto;
+    char host[IPERF_HOST_MAX_LEN];  // Server address (client role only)
+    uint16_t port;                  // TCP/UDP port
+    uint32_t len;                   // Payload bytes per send/datagram
+    uint32_t window;                // Socket buffer size in bytes, 0 keeps lwIP default
+    uint32_t duration_s;            // Client test duration; server idles until stopped
+    uint32_t interval_s;            // Report interval
+    uint32_t bandwidth_kbps;        // UDP client target rate
+    bool json;                      // Also print each run summary as one JSON line
+} tool_iperf_config_t;
+
+/**
+ * @brief Start a benchmark in the background
+ * @param config Benchmark configuration
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if a benchmark is running
+ */
+esp_err_t tool_iperf_start(const tool_iperf_config_t *config);
+
+/**
+ * @brief Request the running benchmark to stop
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if nothing is running
+ */
+esp_err_t tool_iperf_stop(void);
+
+/**
+ * @brief Check if a benchmark is running
+ * @return true if running, false otherwise
+ */
+bool tool_iperf_is_running(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOOL_IPERF_H
@@ -0,0 +1,328 @@
+/**
+ * @file trace_buffer.c
+ * @brief Lock-free per-core hot-path trace buffer implementation for Halow RTOS
+ *
+ * Each core writes its own ring. A writer claims a slot with an atomic
+ * increment of the ring head, so an ISR that interrupts a task in the middle
+ * of a record (or a task that migrated to the other core) simply gets the
+ * next slot. Nothing ever blocks; once a ring is full the oldest records are
+ * overwritten, and the low bits of the write index stored in each record let
+ * the decoder detect that.
+ *
+ * Dumping stops recording first and merges both rings by timestamp.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace_buffer.h"
+#include "esp_attr.h"
+#include "esp_console.h"
+#include "esp_cpu.h"
+#include "esp_crc.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ANSI Color Codes
+#define COLOR_RESET     "\033[0m"
+#define COLOR_RED       "\033[31m"
+#define COLOR_GREEN     "\033[32m"
+#define COLOR_YELLOW    "\033[33m"
+#define COLOR_CYAN      "\033[36m"
+
+#if CONFIG_HALOW_TRACE_ENABLE
+
+#define TRACE_BIN_VERSION           1
+#define TRACE_BIN_RECORDS_PER_LINE  4
+
+static const char *trace_event_names[] = {
+    [TRACE_EV_NONE]                 = "none",
+    [TRACE_EV_HALOW_RX_CB]          = "halow_rx_cb",
+    [TRACE_EV_HALOW_RX_QUEUED]      = "halow_rx_queued",
+    [TRACE_EV_HALOW_RX_DROP]        = "halow_rx_drop",
+    [TRACE_EV_HALOW_RX_DISPATCH]    = "halow_rx_dispatch",
+    [TRACE_EV_HALOW_RX_DONE]        = "halow_rx_done",
+    [TRACE_EV_HALOW_TX_FLOW]        = "halow_tx_flow",
+    [TRACE_EV_HALOW_CONNECT]        = "halow_connect",
+    [TRACE_EV_HALOW_STA_EVENT]      = "halow_sta_event",
+    [TRACE_EV_HALOW_STA_STATE]      = "halow_sta_state",
+    [TRACE_EV_HALOW_LINK]           = "halow_link",
+    [TRACE_EV_OTA_CHUNK_READY]      = "ota_chunk_ready",
+    [TRACE_EV_OTA_WRITE_BEGIN]      = "ota_write_begin",
+    [TRACE_EV_OTA_WRITE_END]        = "ota_write_end",
+    [TRACE_EV_OTA_FLASH]            = "ota_flash",
+    [TRACE_EV_MQTT_PUBLISH]         = "mqtt_publish",
+    [TRACE_EV_GPIO_EDGE]            = "gpio_edge",
+};
+
+#define TRACE_EVENT_NAME_COUNT  (sizeof(trace_event_names) / sizeof(trace_event_names[0]))
+
+#define TRACE_RECORDS           CONFIG_HALOW_TRACE_RECORDS
+#define TRACE_RECORDS_MASK      (TRACE_RECORDS - 1)
+
+_Static_assert((TRACE_RECORDS & TRACE_RECORDS_MASK) == 0, "CONFIG_HALOW_TRACE_RECORDS must be a power of two");
+
+// One trace record (12 bytes)
+typedef struct {
+    uint32_t ts_us;             // esp_timer time, low 32 bits
+    uint16_t event;             // trace_event_t
+    uint16_t seq;               // Low bits of the ring write index
+    uint32_t arg;
+} trace_rec_t;
+
+volatile bool trace_buffer_active = false;
+
+static trace_rec_t trace_rings[portNUM_PROCESSORS][TRACE_RECORDS];
+static uint32_t trace_heads[portNUM_PROCESSORS];
+
+/**
+ * @brief Append a record to the current core's ring
+ */
+void IRAM_ATTR trace_buffer_record(uint16_t event, uint32_t arg)
+{
+    uint32_t core = (uint32_t)esp_cpu_get_core_id();
+    uint32_t idx = __atomic_fetch_add(&trace_heads[core], 1, __ATOMIC_RELAXED);
+    trace_rec_t *rec = &trace_rings[core][idx & TRACE_RECORDS_MASK];
+
+    rec->ts_us = (uint32_t)esp_timer_get_time();
+    rec->event = event;
+    rec->seq = (uint16_t)idx;
+    rec->arg = arg;
+}
+
+/**
+ * @brief Clear the rings and start recording
+ */
+void trace_buffer_start(void)
+{
+    trace_buffer_active = false;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        __atomic_store_n(&trace_heads[core], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    trace_buffer_active = true;
+}
+
+/**
+ * @brief Stop recording
+ */
+void trace_buffer_stop(void)
+{
+    trace_buffer_active = false;
+    // Let writers that already passed the enable check finish their record
+    vTaskDelay(1);
+}
+
+/**
+ * @brief Valid record range of a core's ring
+ */
+static void trace_ring_range(int core, uint32_t *first, uint32_t *count)
+{
+    uint32_t head = __atomic_load_n(&trace_heads[core], __ATOMIC_RELAXED);
+    *count = head < TRACE_RECORDS ? head : TRACE_RECORDS;
+    *first = head - *count;
+}
+
+static const char *trace_event_name(uint16_t event, char *buf, size_t len)
+{
+    if (event < TRACE_EVENT_NAME_COUNT && trace_event_names[event]) {
+        return trace_event_names[event];
+    }
+    snprintf(buf, len, "user_%u", event - TRACE_EV_USER);
+    return buf;
+}
+
+/**
+ * @brief Walk all records merged by timestamp
+ * @param max Newest records to visit (0 for all)
+ * @param visit Called with core and record, oldest first
+ * @param ctx Passed to visit
+ * @return Records visited
+ */
+static uint32_t trace_merge(uint32_t max, void (*visit)(int core, const trace_rec_t *rec, void *ctx), void *ctx)
+{
+    uint32_t pos[portNUM_PROCESSORS];
+    uint32_t end[portNUM_PROCESSORS];
+    uint32_t total = 0;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t count;
+        trace_ring_range(core, &pos[core], &count);
+        end[core] = pos[core] + count;
+        total += count;
+    }
+
+    // Keep the newest max records: skip the oldest ones in merge order
+    uint32_t skip = (max && total > max) ? total - max : 0;
+    uint32_t visited = 0;
+
+    while (1) {
+        int best = -1;
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            if (pos[core] == end[core]) {
+                continue;
+            }
+            if (best < 0 || (int32_t)(trace_rings[core][pos[core] & TRACE_RECORDS_MASK].ts_us -
+                                      trace_rings[best][pos[best] & TRACE_RECORDS_MASK].ts_us) < 0) {
+                best = core;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+
+        const trace_rec_t *rec = &trace_rings[best][pos[best] & TRACE_RECORDS_MASK];
+        pos[best]++;
+        if (skip) {
+            skip--;
+            continue;
+        }
+        visit(best, rec, ctx);
+        visited++;
+    }
+    return visited;
+}
+
+static void trace_visit_csv(int core, const trace_rec_t *rec, void *ctx)
+{
+    char name[16];
+    printf("%lu,%d,%s,%lu\n", (unsigned long)rec->ts_us, core,
+           trace_event_name(rec->event, name, sizeof(name)), (unsigned long)rec->arg);
+}
+
+// Binary export state: hex lines of 13-byte records (core + record)
+typedef struct {
+    uint32_t crc;
+    int in_line;
+} trace_bin_ctx_t;
+
+static void trace_visit_bin(int core, const trace_rec_t *rec, void *ctx)
+{
+    trace_bin_ctx_t *bin = (trace_bin_ctx_t *)ctx;
+    uint8_t raw[1 + sizeof(trace_rec_t)];
+
+    raw[0] = (uint8_t)core;
+    memcpy(&raw[1], rec, sizeof(*rec));
+    bin->crc = esp_crc32_le(bin->crc, raw, sizeof(raw));
+
+    for (size_t i = 0; i < sizeof(raw); i++) {
+        printf("%02x", raw[i]);
+    }
+    if (++bin->in_line == TRACE_BIN_RECORDS_PER_LINE) {
+        printf("\n");
+        bin->in_line = 0;
+    }
+}
+
+static void trace_dump(bool binary, uint32_t max)
+{
+    bool was_active = trace_buffer_active;
+    if (was_active) {
+        trace_buffer_stop();
+    }
+
+    if (binary) {
+        // Header, event name table, records, trailer with count and CRC32
+        trace_bin_ctx_t bin = { 0 };
+        printf("TRACEBIN %d cores=%d record=%u\n", TRACE_BIN_VERSION, portNUM_PROCESSORS,
+               (unsigned)(1 + sizeof(trace_rec_t)));
+        printf("TRACENAMES");
+        for (size_t i = 1; i < TRACE_EVENT_NAME_COUNT; i++) {
+            printf(" %u=%s", (unsigned)i, trace_event_names[i]);
+        }
+        printf("\n");
+        uint32_t n = trace_merge(max, trace_visit_bin, &bin);
+        if (bin.in_line) {
+            printf("\n");
+        }
+        printf("TRACEEND %lu %08lx\n", (unsigned long)n, (unsigned long)bin.crc);
+    } else {
+        printf("ts_us,core,event,arg\n");
+        trace_merge(max, trace_visit_csv, NULL);
+    }
+
+    if (was_active) {
+        trace_buffer_active = true;     // Continue without clearing
+    }
+}
+
+static void trace_print_status(void)
+{
+    printf(COLOR_CYAN "Trace buffer:\n" COLOR_RESET);
+    printf("  State:     %s\n", trace_buffer_active ? COLOR_GREEN "recording" COLOR_RESET : "stopped");
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t head = __atomic_load_n(&trace_heads[core], __ATOMIC_RELAXED);
+        printf("  Core %d:    %lu records written, %lu kept, %lu overwritten\n", core, (unsigned long)head,
+               (unsigned long)(head < TRACE_RECORDS ? head : TRACE_RECORDS),
+               (unsigned long)(head > TRACE_RECORDS ? head - TRACE_RECORDS : 0));
+    }
+    printf("  Capacity:  %d records per core (%u bytes each)\n", TRACE_RECORDS, (unsigned)sizeof(trace_rec_t));
+}
+
+#else
+
+void trace_buffer_start(void)
+{
+}
+
+void trace_buffer_stop(void)
+{
+}
+
+#endif // CONFIG_HALOW_TRACE_ENABLE
+
+static int trace_cmd(int argc, char **argv)
+{
+#if CONFIG_HALOW_TRACE_ENABLE
+    const char *subcmd = argc > 1 ? argv[1] : "status";
+
+    if (strcmp(subcmd, "status") == 0) {
+        trace_print_status();
+    } else if (strcmp(subcmd, "start") == 0) {
+        trace_buffer_start();
+        printf(COLOR_GREEN "Tracing started\n" COLOR_RESET);
+    } else if (strcmp(subcmd, "stop") == 0) {
+        trace_buffer_stop();
+        printf(COLOR_GREEN "Tracing stopped\n" COLOR_RESET);
+    } else if (strcmp(subcmd, "dump") == 0) {
+        bool binary = false;
+        uint32_t max = 0;
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "bin") == 0) {
+                binary = true;
+            } else if (strcmp(argv[i], "csv") == 0) {
+                binary = false;
+            } else {
+                max = (uint32_t)atoi(argv[i]);
+            }
+        }
+        trace_dump(binary, max);
+    } else {
+        printf(COLOR_CYAN "Usage:\n" COLOR_RESET);
+        printf("  trace [status]           - Show recording state and ring usage\n");
+        printf("  trace start              - Clear the rings and start recording\n");
+        printf("  trace stop               - Stop recording\n");
+        printf("  trace dump [csv|bin] [n] - Export the newest n records (default all) merged by time\n");
+        return 1;
+    }
+    return 0;
+#else
+    printf(COLOR_YELLOW "Tracing is compiled out (enable CONFIG_HALOW_TRACE_ENABLE)\n" COLOR_RESET);
+    return 1;
+#endif
+}
+
+/**
+ * @brief Register trace console commands
+ */
+void register_trace_commands(void)
+{
+    const esp_console_cmd_t trace_cmd_def = {
+        .command = "trace",
+        .help = "Hot-path trace buffer: status, start, stop, dump [csv|bin] [n]",
+        .hint = NULL,
+        .func = &trace_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&trace_cmd_def));
+}
@@ -0,0 +1,82 @@
+/**
+ * @file trace_buffer.h
+ * @brief Lock-free per-core hot-path trace buffer for Halow RTOS
+ *
+ * Features:
+ * - Compiled in with CONFIG_HALOW_TRACE_ENABLE, TRACE_EVENT() is empty otherwise
+ * - One ring of (timestamp, event id, arg) records per core, no locks,
+ *   safe from ISRs and from tasks on either core
+ * - Trace points in the HaLow RX/TX callbacks, connect state transitions,
+ *   the OTA writer, the MQTT publisher and GPIO edge ISRs
+ * - Export as time-merged CSV or as a compact hex-encoded binary block
+ *   (see tools/trace_decode.py)
+ */
+
+#ifndef TRACE_BUFFER_H
+#define TRACE_BUFFER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// Event ids (names in trace_buffer.c, exported with every dump)
+typedef enum {
+    TRACE_EV_NONE = 0,
+    TRACE_EV_HALOW_RX_CB,           // mmwlan RX callback entered
+    TRACE_EV_HALOW_RX_QUEUED,       // Frame queued for the RX worker, arg = ring depth
+    TRACE_EV_HALOW_RX_DROP,         // RX ring overflow, arg = ring depth
+    TRACE_EV_HALOW_RX_DISPATCH,     // RX worker dispatch start, arg = frame length
+    TRACE_EV_HALOW_RX_DONE,         // RX worker dispatch end, arg = ethertype
+    TRACE_EV_HALOW_TX_FLOW,         // mmwlan TX flow control, arg = 1 paused, 0 ready
+    TRACE_EV_HALOW_CONNECT,         // Connect requested, arg = 1 for a targeted reconnect
+    TRACE_EV_HALOW_STA_EVENT,       // Association phase event, arg = mmwlan_sta_event
+    TRACE_EV_HALOW_STA_STATE,       // STA state change, arg = mmwlan_sta_state
+    TRACE_EV_HALOW_LINK,            // Link state change, arg = 1 up, 0 down
+    TRACE_EV_OTA_CHUNK_READY,       // Download buffer handed to the writer, arg = bytes
+    TRACE_EV_OTA_WRITE_BEGIN,       // Writer starts on a buffer, arg = bytes
+    TRACE_EV_OTA_WRITE_END,         // Writer done with a buffer, arg = bytes
+    TRACE_EV_OTA_FLASH,             // esp_ota_write of decoded bytes, arg = bytes
+    TRACE_EV_MQTT_PUBLISH,          // MQTT PUBLISH handed to the client, arg = bytes
+    TRACE_EV_GPIO_EDGE,             // GPIO monitor edge ISR, arg = pin
+    TRACE_EV_USER = 0x100           // First application defined id
+} trace_event_t;
+
+#if CONFIG_HALOW_TRACE_ENABLE
+
+extern volatile bool trace_buffer_active;
+
+/**
+ * @brief Append a record to the current core's ring (ISR safe, IRAM)
+ * @param event Event id
+ * @param arg Event argument
+ */
+void trace_buffer_record(uint16_t event, uint32_t arg);
+
+#define TRACE_EVENT(event, arg) do {                                \
+        if (trace_buffer_active) {                                  \
+            trace_buffer_record((uint16_t)(event), (uint32_t)(arg)); \
+        }                                                           \
+    } while (0)
+
+#else
+
+#define TRACE_EVENT(event, arg) do { } while (0)
+
+#endif // CONFIG_HALOW_TRACE_ENABLE
+
+/**
+ * @brief Clear the rings and start recording
+ */
+void trace_buffer_start(void);
+
+/**
+ * @brief Stop recording (the rings are kept for dumping)
+ */
+void trace_buffer_stop(void);
+
+/**
+ * @brief Register trace console commands
+ */
+void register_trace_commands(void);
+
+#endif // TRACE_BUFFER_H
@@ -1,5 +1,11 @@
 # SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
 # SPDX-License-Identifier: CC0-1.0
+import json
+import os
+import re
+import time
+from typing import Any, Callable, Dict, Optional, Tuple
+
 import pytest
 from pytest_embedded import Dut
 from pytest_embedded_idf.utils import idf_parametrize
@@ -20,3 +26,204 @@ def test_console_basic(config: str, dut: Dut) -> None:
         dut.expect('Command history enabled')
     elif config == 'nohistory':
         dut.expect('Command history disabled')
+
+
+# ---------------------------------------------------------------------------
+# On-target benchmark suite
+#
+# Drives the benchmark commands over the console, reads their JSON summary
+# lines ({"bench": ...}) and stores one result file per firmware version and
+# board. A run fails when a metric regressed past its tolerance against the
+# board's pinned baseline (or the file named by BENCH_BASELINE). The first
+# run on a board pins itself; later runs only move the pin with BENCH_ACCEPT,
+# so a series of small regressions can not walk the baseline down. Failed
+# runs are kept as <fw>.failed.json and never become a baseline.
+#
+# Environment:
+#   BENCH_USER / BENCH_PASSWORD  console login (registered on a fresh board)
+#   BENCH_RESULTS_DIR            result store (default: bench_results)
+#   BENCH_BOARD                  board name (default: <target>-<mac>)
+#   BENCH_BASELINE               explicit baseline result file
+#   BENCH_ACCEPT                 pin this run as the board baseline (after an
+#                                intended change), even if it regressed
+#   BENCH_GPIO_PIN               free GPIO for 'gpio bench'
+#   BENCH_PING_HOST              host for 'ping' over HaLow
+#   BENCH_IPERF_HOST             iperf2 server for 'iperf -c'
+#   BENCH_OTA_URL                firmware image URL for 'ota_update'
+#   BENCH_RAW_PEER               MAC of a station running this firmware,
+#                                for the raw frame check (with BENCH_PING_HOST)
+# Benchmarks whose variable is unset are skipped.
+# ---------------------------------------------------------------------------
+
+BENCH_BASELINE_FILE = 'baseline.json'
+
+BENCH_LINE = re.compile(rb'(\{"bench":"(\w+)".*\})\r?\n')
+
+# (benchmark, metric path) -> (direction, tolerance). 'higher' metrics fail
+# when they drop by more than the tolerance, 'lower' ones when they grow.
+BENCH_THRESHOLDS: Dict[Tuple[str, str], Tuple[str, float]] = {
+    ('boot', 'ready_ms'): ('lower', 0.10),
+    ('boot', 'init_done_ms'): ('lower', 0.10),
+    ('heap', 'free'): ('higher', 0.10),
+    ('heap', 'min_free'): ('higher', 0.10),
+    ('heap_after', 'free'): ('higher', 0.10),
+    ('heap_after', 'min_free'): ('higher', 0.10),
+    ('gpio', 'paths.task_gpio_set_output_level.rate_kps'): ('higher', 0.10),
+    ('gpio', 'paths.gpio_set_level.rate_kps'): ('higher', 0.10),
+    ('gpio', 'paths.task_gpio_bank_write.rate_kps'): ('higher', 0.10),
+    ('ping', 'avg_us'): ('lower', 0.20),
+    ('ping', 'p99_us'): ('lower', 0.20),
+    ('ping', 'loss_pct'): ('lower', 0.0),
+    ('iperf_tcp', 'mbps'): ('higher', 0.10),
+    ('iperf_udp', 'mbps'): ('higher', 0.10),
+    ('ota', 'kbps'): ('higher', 0.15),
+}
+
+# Absolute slack so near-zero metrics (loss, tiny latencies) do not flap
+BENCH_ABS_SLACK = {'loss_pct': 1.0, 'avg_us': 500.0, 'p99_us': 1000.0}
+
+
+def bench_login(dut: Dut) -> None:
+    user = os.environ.get('BENCH_USER', 'bench')
+    password = os.environ.get('BENCH_PASSWORD', 'bench123')
+    dut.expect(r'Username \(max \d+ chars\): ', timeout=30)
+    dut.write(user)
+    dut.expect(r'Password \(max \d+ chars, hidden\): ', timeout=10)
+    dut.write(password)
+    dut.expect(r'Login successful!|First-time setup complete!', timeout=10)
+    dut.expect(re.escape(user) + '>', timeout=10)
+
+
+def bench_run(dut: Dut, command: str, bench: str, timeout: float = 30) -> Dict[str, Any]:
+    """Run a command and return its JSON summary line of the given kind."""
+    dut.write(command)
+    deadline = time.monotonic() + timeout
+    while True:
+        remaining = deadline - time.monotonic()
+        if remaining <= 0:
+            raise AssertionError('no "%s" result from: %s' % (bench, command))
+        match = dut.expect(BENCH_LINE, timeout=remaining)
+        if match.group(2).decode() == bench:
+            return json.loads(match.group(1).decode())
+
+
+def bench_metric(result: Dict[str, Any], path: str) -> Optional[float]:
+    value: Any = result
+    for key in path.split('.'):
+        if not isinstance(value, dict) or key not in value:
+            return None
+        value = value[key]
+    return float(value) if isinstance(value, (int, float)) else None
+
+
+def bench_compare(current: Dict[str, Any], baseline: Dict[str, Any]) -> list:
+    failures = []
+    for (bench, path), (direction, tolerance) in BENCH_THRESHOLDS.items():
+        if bench not in current or bench not in baseline:
+            continue
+        now = bench_metric(current[bench], path)
+        before = bench_metric(baseline[bench], path)
+        if now is None or before is None:
+            continue
+        slack = max(abs(before) * tolerance, BENCH_ABS_SLACK.get(path.split('.')[-1], 0.0))
+        if direction == 'higher' and now < before - slack:
+            failures.append('%s.%s dropped %.2f -> %.2f' % (bench, path, before, now))
+        elif direction == 'lower' and now > before + slack:
+            failures.append('%s.%s rose %.2f -> %.2f' % (bench, path, before, now))
+    return failures
+
+
+def bench_baseline(board_dir: str) -> Tuple[Optional[str], Dict[str, Any]]:
+    path = os.environ.get('BENCH_BASELINE') or os.path.join(board_dir, BENCH_BASELINE_FILE)
+    if not os.path.exists(path):
+        return None, {}
+    with open(path) as f:
+        return path, json.load(f)
+
+
+def bench_store(path: str, results: Dict[str, Any]) -> None:
+    with open(path, 'w') as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+
+
+def bench_ota(dut: Dut, url: str) -> Dict[str, Any]:
+    dut.write('ota_update %s' % url)
+    dut.expect('Update started', timeout=10)
+    deadline = time.monotonic() + 600
+    while time.monotonic() < deadline:
+        status = bench_run(dut, 'ota_status --json', 'ota', timeout=10)
+        if status['status'] == 'complete':
+            return status
+        assert status['status'] not in ('failed', 'rollback'), 'OTA %s' % status['status']
+        time.sleep(2)
+    raise AssertionError('OTA did not complete')
+
+
+@pytest.mark.bench
+@idf_parametrize('target', ['esp32s3'], indirect=['target'])
+def test_console_bench(dut: Dut) -> None:
+    env = os.environ.get
+    bench_login(dut)
+
+    info = bench_run(dut, 'version --json', 'info')
+    results: Dict[str, Any] = {
+        'info': info,
+        'boot': bench_run(dut, 'boot_profile --json', 'boot'),
+        'heap': bench_run(dut, 'free --json', 'heap'),
+    }
+
+    steps: Dict[str, Tuple[str, Callable[[str], Dict[str, Any]]]] = {
+        'gpio': ('BENCH_GPIO_PIN',
+                 lambda pin: bench_run(dut, 'gpio bench %s 10000 --json' % pin, 'gpio', 60)),
+        'ping': ('BENCH_PING_HOST',
+                 lambda host: bench_run(dut, 'ping %s 50 100 --json' % host, 'ping', 60)),
+        'iperf_tcp': ('BENCH_IPERF_HOST',
+                      lambda host: bench_run(dut, 'iperf -c %s -t 10 -J' % host, 'iperf', 40)),
+        'iperf_udp': ('BENCH_IPERF_HOST',
+                      lambda host: bench_run(dut, 'iperf -c %s -u -t 10 -J' % host, 'iperf', 40)),
+        # OTA last: it leaves a new image in the other slot
+        'ota': ('BENCH_OTA_URL', lambda url: bench_ota(dut, url)),
+    }
+    for name, (var, step) in steps.items():
+        value = env(var)
+        if value:
+            results[name] = step(value)
+    # Heap headroom after the network benchmarks have run
+    results['heap_after'] = bench_run(dut, 'free --json', 'heap')
+
+    board = env('BENCH_BOARD') or '%s-%s' % (info['target'], info['mac'])
+    board_dir = os.path.join(env('BENCH_RESULTS_DIR', 'bench_results'), board)
+    os.makedirs(board_dir, exist_ok=True)
+    fw = re.sub(r'[^\w.+-]', '_', info['fw'])
+    baseline_path, baseline = bench_baseline(board_dir)
+
+    failures = bench_compare(results, baseline)
+    accept = bool(env('BENCH_ACCEPT'))
+    if failures and not accept:
+        bench_store(os.path.join(board_dir, fw + '.failed.json'), results)
+    else:
+        bench_store(os.path.join(board_dir, fw + '.json'), results)
+        if accept or not baseline_path:
+            bench_store(os.path.join(board_dir, BENCH_BASELINE_FILE), results)
+    assert accept or not failures, 'regressions against %s:\n  %s' % (baseline_path, '\n  '.join(failures))
+
+
+@pytest.mark.bench
+@idf_parametrize('target', ['esp32s3'], indirect=['target'])
+def test_console_halow_raw(dut: Dut) -> None:
+    """Raw ping round-trips through the RX pipeline while IP keeps working."""
+    peer = os.environ.get('BENCH_RAW_PEER')
+    host = os.environ.get('BENCH_PING_HOST')
+    if not peer or not host:
+        pytest.skip('BENCH_RAW_PEER and BENCH_PING_HOST not set')
+    bench_login(dut)
+
+    before = bench_run(dut, 'ping %s 10 100 --json' % host, 'ping', 30)
+    assert before['loss_pct'] < 100, 'no IP connectivity before the raw ping'
+
+    dut.write('halow raw ping %s 10' % peer)
+    match = dut.expect(rb'(\d+) sent, (\d+) received', timeout=30)
+    assert int(match.group(2)) > 0, 'no raw pong from %s' % peer
+
+    after = bench_run(dut, 'ping %s 10 100 --json' % host, 'ping', 30)
+    assert after['loss_pct'] < 100, 'IP connectivity lost after the raw ping'
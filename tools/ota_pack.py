@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Build compressed and/or delta OTA packages for ota_update.
+
+The layout matches main/ota_decoder.h:
+
+    ota_package_header_t (48 bytes) + payload
+
+The payload is the new image or a stream of delta operations against the
+image currently running on the device, optionally zlib compressed.
+
+Examples:
+    ota_pack.py build/halow_rtos.bin fw.hota --compress
+    ota_pack.py build/halow_rtos.bin fw.hota --base old/halow_rtos.bin --compress
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+MAGIC = 0x41544F48  # "HOTA"
+VERSION = 1
+FLAG_DEFLATE = 0x01
+FLAG_DELTA = 0x02
+HEADER = struct.Struct('<IBBHII32s')
+
+OP_COPY = 0x01
+OP_ADD = 0x02
+OP_INSERT = 0x03
+
+BLOCK = 32          # Match granularity of the base index
+MIN_MATCH = 64      # Shorter matches are cheaper as ADD/INSERT
+MAX_OP_LEN = 1 << 20
+
+
+def delta_encode(base: bytes, new: bytes) -> bytes:
+    """Greedy block-matching diff.
+
+    Exact matches become COPY. Bytes between matches become ADD against the
+    base bytes that follow the previous match, like bsdiff: recompiled code
+    usually differs there only in a few relocated addresses, so the diff is
+    mostly zeros and compresses well. INSERT is used past the end of base.
+    """
+    index = {}
+    for ofs in range(0, len(base) - BLOCK + 1, BLOCK):
+        index.setdefault(base[ofs:ofs + BLOCK], ofs)
+
+    ops = bytearray()
+    scan = 0
+    lit_start = 0
+    src_next = 0    # Base position following the previous match
+
+    def emit_literal(end):
+        start = lit_start
+        nonlocal src_next
+        while start < end:
+            n = min(end - start, MAX_OP_LEN)
+            if src_next + n <= len(base):
+                diff = bytes((new[start + i] - base[src_next + i]) & 0xFF for i in range(n))
+                ops.extend(struct.pack('<BII', OP_ADD, src_next, n))
+                ops.extend(diff)
+                src_next += n
+            else:
+                ops.extend(struct.pack('<BI', OP_INSERT, n))
+                ops.extend(new[start:start + n])
+            start += n
+
+    while scan + BLOCK <= len(new):
+        src = index.get(new[scan:scan + BLOCK])
+        if src is None:
+            scan += 1
+            continue
+
+        # Extend the match forwards and backwards into the pending literal
+        pos = scan
+        length = BLOCK
+        while pos + length < len(new) and src + length < len(base) and new[pos + length] == base[src + length]:
+            length += 1
+        while pos > lit_start and src > 0 and new[pos - 1] == base[src - 1]:
+            pos -= 1
+            src -= 1
+            length += 1
+
+        if length < MIN_MATCH:
+            scan += 1
+            continue
+
+        emit_literal(pos)
+        remaining = length
+        while remaining:
+            n = min(remaining, MAX_OP_LEN)
+            ops.extend(struct.pack('<BII', OP_COPY, src, n))
+            src += n
+            remaining -= n
+        scan = pos + length
+        lit_start = scan
+        src_next = src
+
+    emit_literal(len(new))
+    return bytes(ops)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('image', help='new application image (.bin)')
+    parser.add_argument('output', help='package to write')
+    parser.add_argument('--base', help='image running on the target, produces a delta')
+    parser.add_argument('--compress', action='store_true', help='zlib compress the payload')
+    parser.add_argument('--level', type=int, default=9, help='zlib level (default 9)')
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        image = f.read()
+    if not image or image[0] != 0xE9:
+        print('%s is not an ESP application image' % args.image, file=sys.stderr)
+        return 1
+
+    flags = 0
+    source_size = 0
+    source_sha = bytes(32)
+    payload = image
+
+    if args.base:
+        with open(args.base, 'rb') as f:
+            base = f.read()
+        flags |= FLAG_DELTA
+        source_size = len(base)
+        source_sha = hashlib.sha256(base).digest()
+        payload = delta_encode(base, image)
+
+    if args.compress:
+        flags |= FLAG_DEFLATE
+        payload = zlib.compress(payload, args.level)
+
+    header = HEADER.pack(MAGIC, VERSION, flags, HEADER.size, len(image), source_size, source_sha)
+    package = header + payload
+    with open(args.output, 'wb') as f:
+        f.write(package)
+
+    print('%s: %d -> %d bytes (%.1f%%), sha256 %s' % (
+        args.output, len(image), len(package), 100.0 * len(package) / len(image),
+        hashlib.sha256(package).hexdigest()))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Generate a regulatory database holding only the selected countries.
+
+Reads the upstream template main/mm_app_regdb.c (copied from the
+mm-iot-esp32 scan example) and writes a C file with the same
+get_regulatory_db() API, restricted to the given country codes, plus
+halow_regdb_channel_list() (see main/halow_regdb.h) which returns the first
+country's channel list without a runtime lookup.
+
+Run by main/CMakeLists.txt when CONFIG_HALOW_REGDB_TRIM is set.
+
+Examples:
+    regdb_trim.py main/mm_app_regdb.c -o build/mm_app_regdb_trimmed.c US
+    regdb_trim.py main/mm_app_regdb.c -o regdb.c EU GB
+"""
+
+import argparse
+import re
+import sys
+
+# Doc comment + definition of each per-country object in the template
+CHANNELS_RE = re.compile(
+    r'(/\*\*[^*]*\*/\s*)?const struct mmwlan_s1g_channel s1g_channels_(\w+)\[\]\s*=\s*\{.*?\n\};',
+    re.S)
+LIST_RE = re.compile(
+    r'(/\*\*[^*]*\*/\s*)?const struct mmwlan_s1g_channel_list s1g_channel_list_(\w+)\s*=\s*\{.*?\n\};',
+    re.S)
+
+
+def parse(text):
+    """Return {country: (channels_block, list_block)} from the template."""
+    channels = {m.group(2): m.group(0) for m in CHANNELS_RE.finditer(text)}
+    lists = {m.group(2): m.group(0) for m in LIST_RE.finditer(text)}
+    return {cc: (channels[cc], lists[cc]) for cc in lists if cc in channels}
+
+
+def make_static(block):
+    """Give a definition internal linkage so unused ones cannot leak in."""
+    return re.sub(r'^const struct', 'static const struct', block, count=1, flags=re.M)
+
+
+def generate(domains, countries, source):
+    out = [
+        '/*',
+        ' * Generated by tools/regdb_trim.py from %s, do not edit.' % source,
+        ' *',
+        ' * Copyright 2022-2024 Morse Micro',
+        ' *',
+        ' * SPDX-License-Identifier: Apache-2.0',
+        ' *',
+        ' * Countries: %s' % ' '.join(countries),
+        ' */',
+        '',
+        '#include "mm_app_regdb.h"',
+        '#include "halow_regdb.h"',
+        '',
+    ]
+    for cc in countries:
+        channels, channel_list = domains[cc]
+        out.append(make_static(channels))
+        out.append('')
+        out.append(make_static(channel_list))
+        out.append('')
+
+    out.append('static const struct mmwlan_s1g_channel_list *regulatory_db_domains[] = {')
+    out.extend('    &s1g_channel_list_%s,' % cc for cc in countries)
+    out.append('};')
+    out.append('')
+    out.append('static const struct mmwlan_regulatory_db regulatory_db = {')
+    out.append('    .num_domains = (sizeof(regulatory_db_domains)/sizeof(regulatory_db_domains[0])),')
+    out.append('    .domains = regulatory_db_domains,')
+    out.append('};')
+    out.append('')
+    out.append('const struct mmwlan_regulatory_db *get_regulatory_db(void)')
+    out.append('{')
+    out.append('    return &regulatory_db;')
+    out.append('}')
+    out.append('')
+    out.append('const struct mmwlan_s1g_channel_list *halow_regdb_channel_list(void)')
+    out.append('{')
+    out.append('    return &s1g_channel_list_%s;' % countries[0])
+    out.append('}')
+    out.append('')
+    return '\n'.join(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    ap.add_argument('template', help='upstream mm_app_regdb.c')
+    ap.add_argument('countries', nargs='+', help='country codes to keep, the first is the default')
+    ap.add_argument('-o', '--output', required=True, help='generated C file')
+    args = ap.parse_args()
+
+    with open(args.template) as f:
+        domains = parse(f.read())
+
+    countries = []
+    for cc in args.countries:
+        cc = cc.upper()
+        if cc not in domains:
+            sys.exit('regdb_trim: country %s not in %s (have: %s)'
+                     % (cc, args.template, ' '.join(sorted(domains))))
+        if cc not in countries:
+            countries.append(cc)
+
+    text = generate(domains, countries, args.template.replace('\\', '/').split('/')[-1])
+
+    # Leave the file untouched when nothing changed, so it is not rebuilt
+    try:
+        with open(args.output) as f:
+            if f.read() == text:
+                return
+    except OSError:
+        pass
+    with open(args.output, 'w') as f:
+        f.write(text)
+
+
+if __name__ == '__main__':
+    main()
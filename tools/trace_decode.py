@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Decode a 'trace dump bin' capture from the console.
+
+The block layout matches main/trace_buffer.c:
+
+    TRACEBIN <version> cores=<n> record=13
+    TRACENAMES 1=halow_rx_cb 2=...
+    <hex lines, 13 bytes per record: core byte + trace_rec_t>
+    TRACEEND <count> <crc32>
+
+Any other console output around the block is ignored, so a raw serial log
+can be passed in directly.
+
+Examples:
+    trace_decode.py capture.log > trace.csv
+    trace_decode.py capture.log --chrome trace.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+import zlib
+
+VERSION = 1
+RECORD = struct.Struct('<BIHHI')  # core, ts_us, event, seq, arg
+EV_USER = 0x100
+
+
+def parse(lines):
+    """Return (names, records) from the first complete TRACEBIN block."""
+    names = {}
+    data = bytearray()
+    in_block = False
+
+    for line in lines:
+        line = line.strip()
+        if line.startswith('TRACEBIN'):
+            fields = line.split()
+            if int(fields[1]) != VERSION:
+                raise ValueError(f'unsupported trace version {fields[1]}')
+            opts = dict(f.split('=', 1) for f in fields[2:])
+            if int(opts.get('record', RECORD.size)) != RECORD.size:
+                raise ValueError(f'unexpected record size {opts["record"]}')
+            names.clear()
+            data.clear()
+            in_block = True
+        elif not in_block:
+            continue
+        elif line.startswith('TRACENAMES'):
+            for item in line.split()[1:]:
+                ev, name = item.split('=', 1)
+                names[int(ev)] = name
+        elif line.startswith('TRACEEND'):
+            _, count, crc = line.split()
+            if zlib.crc32(data) != int(crc, 16):
+                raise ValueError('CRC mismatch, capture is corrupt')
+            records = [RECORD.unpack_from(data, off) for off in range(0, len(data), RECORD.size)]
+            if len(records) != int(count):
+                raise ValueError(f'expected {count} records, got {len(records)}')
+            return names, records
+        elif line:
+            try:
+                data += bytes.fromhex(line)
+            except ValueError:
+                continue  # Interleaved log output
+
+    raise ValueError('no complete TRACEBIN block found')
+
+
+def event_name(names, event):
+    if event in names:
+        return names[event]
+    if event >= EV_USER:
+        return f'user_{event - EV_USER}'
+    return f'event_{event}'
+
+
+def unwrap(records):
+    """Extend the 32-bit microsecond timestamps across wraps."""
+    base = 0
+    last = None
+    for core, ts, event, seq, arg in records:
+        if last is not None and ts + base < last - (1 << 31):
+            base += 1 << 32
+        last = ts + base
+        yield core, last, event, seq, arg
+
+
+def write_csv(out, names, records):
+    out.write('ts_us,core,event,arg\n')
+    for core, ts, event, _, arg in unwrap(records):
+        out.write(f'{ts},{core},{event_name(names, event)},{arg}\n')
+
+
+def write_chrome(path, names, records):
+    """Chrome trace / Perfetto JSON, one thread per core."""
+    events = []
+    for core, ts, event, _, arg in unwrap(records):
+        events.append({'name': event_name(names, event), 'ph': 'i', 's': 't',
+                       'ts': ts, 'pid': 0, 'tid': core, 'args': {'arg': arg}})
+    with open(path, 'w') as f:
+        json.dump({'traceEvents': events, 'displayTimeUnit': 'ms'}, f)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('capture', help="console log containing a 'trace dump bin' block, - for stdin")
+    parser.add_argument('--chrome', metavar='JSON', help='also write Chrome trace JSON')
+    args = parser.parse_args()
+
+    src = sys.stdin if args.capture == '-' else open(args.capture, errors='replace')
+    try:
+        names, records = parse(src)
+    except ValueError as e:
+        sys.exit(f'trace_decode: {e}')
+
+    write_csv(sys.stdout, names, records)
+    if args.chrome:
+        write_chrome(args.chrome, names, records)
+    print(f'{len(records)} records', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()